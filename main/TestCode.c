@@ -4,11 +4,34 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "gga_parser.h"
+#include "gga_validate.h"
+#include "gga_encode.h"
+#include "gga_emit.h"
+#include "gga_compress.h"
+#include "gga_wcet.h"
+#include "gga_pool.h"
+#include "gga_window.h"
+#include "gga_fusion.h"
+#include "gga_filter.h"
+#include "gga_forward.h"
+#include "gga_queue.h"
+#include "gga_pipeline.h"
+#include "gga_delta.h"
+#include "gga_track.h"
+#include "gga_snapshot.h"
+#include "gga_flashlog.h"
+#ifdef __linux__
+#include "gga_ingest.h"
+#include "gga_merge.h"
+#include "gga_replay.h"
+#include "gga_shm.h"
+#endif
 
 void app_main()
 {
     //Valid GGA-SENTENCE
     char* nmea = "$GPGGA,002153.000,3342.6618,N,11751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000*5E";
+#ifdef CONFIG_GGA_PARSER_GETTERS
     char* drs = malloc(5); //to hold drs ID minimum memory size is 5
 
     /**
@@ -59,6 +82,226 @@ void app_main()
     nmea = "$GPGGA,002153.000,3342.6618,N,1751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000*5E";
     printf("\n\nThe GGA sentence will be confirmed but the data will invalid and an error will be generated.\n\n");
     printParsedData(Parse_gps_data(nmea));
+#endif
 
+    //Loopback encoding i.e., the parsed data is written back into a GGA sentence which is parsed again
+    nmea = "$GPGGA,002153.000,3342.6618,N,11751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000*5E";
+    nmea_ParseResult_t result;
+    char encoded[ENCODE_MAX_SENTENCE_LEN + 1];
+    nmea_gga_parse_r(nmea, strlen(nmea), &result);
+    encoded[nmea_encode_fix(&result, encoded, ENCODE_MAX_SENTENCE_LEN)] = '\0';
+    printf("\n\nThe parsed data is encoded again into a GGA sentence and parsed back.\n\n%s", encoded);
+#ifdef CONFIG_GGA_PARSER_PRINT
+    printParsedData(Parse_gps_data(encoded));
+#endif
+
+    //Fixed-point parse straight into the packed record, without float arithmetic
+    nmea_PackedFix_t packed;
+    nmea_gga_parse_fixed(encoded, strlen(encoded), &packed);
+    printf("\n\nFixed-point record: %lu ms, latitude %ld, longitude %ld (1/10000 min), altitude %ld cm\n\n",
+           (unsigned long) packed.timeMs, (long) packed.latitude, (long) packed.longitude, (long) packed.altitude);
+
+    //Validate-only scan of the good sentence and of one bad line per reason, every line is checked on its own and then
+    //the capture as a whole, which gives the bad lines back with their offsets
+    static const char *const s_validateLines[] = {
+        "$GPGGA,002153.000,3342.6618,N,11751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000*5E\r\n",
+        "$GPGGA,002153.000,3342.6618,N,11751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000*5F\r\n",
+        "$GPGGA,002153.000,3342.6618,N,11751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000\r\n",
+        "GPGGA,002153.000,3342.6618,N,11751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000*5E\r\n",
+        "$GPGGA,002153.000,3342.6618,N,11751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000,0000,0000,0000*5E\r\n"
+    };
+    static const int s_validateExpected[] = { -1, NMEA_BAD_CHECKSUM, NMEA_BAD_TRUNCATED, NMEA_BAD_FRAMING, NMEA_BAD_OVERLONG };
+    static char s_validateCapture[512];
+    size_t captureLen = 0;
+    for (size_t i = 0; i < sizeof(s_validateLines) / sizeof(s_validateLines[0]); i++) {
+        size_t lineLen = strlen(s_validateLines[i]);
+        if (nmea_validate_line(s_validateLines[i], lineLen) != s_validateExpected[i]) {
+            printf("ERROR: Line %u is NOT validated as expected!\n", (unsigned) i);
+        }
+        memcpy(s_validateCapture + captureLen, s_validateLines[i], lineLen);
+        captureLen += lineLen;
+    }
+    nmea_BadLine_t badLines[NMEA_BAD_REASON_COUNT];
+    nmea_ValidateReport_t report = { 0 };
+    report.badLines = badLines;
+    report.badCapacity = NMEA_BAD_REASON_COUNT;
+    nmea_validate_buffer(s_validateCapture, captureLen, 0, true, &report);
+    printf("\n\nIntegrity scan of the good sentence and one bad line per reason.\n\n");
+    nmea_validate_print(&report);
+    if (report.good != 1 || report.badCount != NMEA_BAD_REASON_COUNT || report.bad[NMEA_BAD_CHECKSUM] != 1
+        || report.bad[NMEA_BAD_TRUNCATED] != 1 || report.bad[NMEA_BAD_FRAMING] != 1 || report.bad[NMEA_BAD_OVERLONG] != 1) {
+        printf("ERROR: Capture scan does NOT find every bad line!\n");
+    }
+#ifdef __linux__
+    //The same capture from a memory-mapped file
+    FILE *captureFile = fopen("/tmp/gga_validate.nmea", "wb");
+    if (captureFile != NULL) {
+        fwrite(s_validateCapture, 1, captureLen, captureFile);
+        fclose(captureFile);
+        nmea_ValidateReport_t fileReport = { 0 };
+        if (nmea_validate_file("/tmp/gga_validate.nmea", &fileReport) != 0 || fileReport.lines != report.lines
+            || memcmp(fileReport.bad, report.bad, sizeof(report.bad)) != 0) {
+            printf("ERROR: File scan does NOT match the buffer scan!\n");
+        }
+        remove("/tmp/gga_validate.nmea");
+    }
+#endif
+
+    //One parse shared by two consumers through the fix record pool, the record goes back with the second release
+    nmea_pool_init(NMEA_POOL_DROP, 0);
+    nmea_Fix_t *fix = nmea_pool_parse(encoded, strlen(encoded), 2);
+    if (fix != NULL) {
+        printf("\n\nThe pooled fix is shared without copying, satellites: %d, HDOP: %.1f\n\n",
+               nmea_fix_result(fix)->data.gpsData_satTracked, nmea_fix_result(fix)->data.gpsData_hdop);
+        nmea_fix_release(fix);
+        nmea_fix_release(fix);
+    }
+    nmea_pool_print();
+
+    //The same fix fed three times to the windows of receiver 0, the third fix closes the first 1 s window
+    nmea_window_init();
+    nmea_window_add(0, 0, &result);
+    nmea_window_add(0, 500, &result);
+    nmea_window_add(0, 1200, &result);
+    printf("\n\nWindowed aggregates of receiver 0 (the long window is not closed yet).\n\n");
+    nmea_window_print(0);
+
+    //Fusion of three simulated receivers (10 Hz, up to 300 ms skew, 2% lost reports, 250 ms deadline), host only as the
+    //streams are too large for the main task of the ESP32
+#ifdef __linux__
+    printf("\n\nFusion of three skewed receiver streams into the best fix per epoch.\n\n");
+    nmea_fusion_benchmark(3, 10000, 100000, 300000, 20, 250000);
+#endif
+
+    //Only RTK fixes (quality 4 or 5) pass, the quality is decoded first and the rest of the sentence is skipped
+    nmea_Filter_t filter;
+    nmea_filter_init(&filter);
+    nmea_filter_quality(&filter, 4, 5);
+    nmea_filter_decimate(&filter, 1000);
+    printf("\n\nThe sentence through an RTK-only filter: %s\n\n",
+           (nmea_filter_parse(&filter, nmea, strlen(nmea), &result) == NMEA_FILTER_ACCEPTED) ? "accepted" : "rejected");
+    nmea_filter_print(&filter);
+
+    //Relay mode: GGA sentences are checked and forwarded unchanged, compared with a full parse and re-encode (host only,
+    //the capture buffers do not fit the heap of the ESP32 next to the rest of the demo)
+#ifdef __linux__
+    printf("\n\nValidated pass-through forwarding against parsing and encoding again.\n\n");
+    nmea_forward_benchmark(400);
+#endif
+
+    //Base station: only the fields which changed since the previous sentence of the receiver are decoded again
+    static nmea_Delta_t s_delta;
+    uint16_t changed;
+    nmea_delta_init(&s_delta);
+    nmea_delta_parse(&s_delta, nmea, strlen(nmea), &result, NULL);
+    nmea_delta_parse(&s_delta, nmea, strlen(nmea), &result, &changed);
+    printf("\n\nFields changed by the same sentence again: 0x%04X\n\n", (unsigned) changed);
+#ifdef __linux__
+    nmea_delta_benchmark(2000);
+#endif
+
+    //Multipath jumps pass every check of the parser, the track of the receiver rejects them and smooths the position
+    static nmea_Track_t s_track;
+    nmea_TrackOutput_t tracked;
+    nmea_track_init(&s_track, NULL);
+    nmea_track_add(&s_track, &result, &tracked);
+    printf("\n\nFirst fix of the track: %s, horizontal standard deviation %.1f m\n\n",
+           (tracked.status == NMEA_TRACK_STARTED) ? "started" : "not started", tracked.sigmaMm / 1000.0);
+#ifdef __linux__
+    nmea_track_benchmark(12000, 20);
+#endif
+
+    //Deep sleep: the state of the receiver is saved before the sleep and restored after the wake
+#ifdef __linux__
+    printf("\n\nWarm start of a receiver from a snapshot of its state.\n\n");
+    nmea_snapshot_benchmark(1000);
+#endif
+
+    //Fixes kept on flash across resets, written in page batches, the head is found again with a binary search
+#ifdef __linux__
+    printf("\n\nAppend-only fix log on emulated flash.\n\n");
+    nmea_flashlog_benchmark("/tmp/gga_flashlog.bin", 960, 200000);
+#else
+    static nmea_FlashLog_t s_flashLog;
+    nmea_FlashIo_t flashIo;
+    if (nmea_flashlog_partition(CONFIG_GGA_FLASHLOG_PARTITION, &flashIo) == 0 && nmea_flashlog_open(&s_flashLog, &flashIo) == 0) {
+        nmea_PackedFix_t packed;
+        nmea_pack_fix(&result, &packed);
+        nmea_flashlog_append(&s_flashLog, &packed);
+        nmea_flashlog_sync(&s_flashLog);
+        printf("\n\nFix appended to the log in the %s partition.\n\n", CONFIG_GGA_FLASHLOG_PARTITION);
+        nmea_flashlog_print(&s_flashLog);
+    }
+#endif
+
+    //Overload: a slow consumer only gets the latest sentence of the receiver, the older ones are coalesced
+    nmea_Queue_t *queue = nmea_queue_create(4, 1, NMEA_OVERLOAD_KEEP_LATEST, 0);
+    if (queue != NULL) {
+        nmea_QueueItem_t item;
+        for (int i = 0; i < 3; i++) {
+            nmea_queue_push(queue, 0, nmea, strlen(nmea), (uint32_t) i);
+        }
+        printf("\n\nKeep-latest overload policy, three sentences pushed and the one taken was sentence %lu.\n\n",
+               nmea_queue_pop(queue, &item) ? (unsigned long) item.timeUs : 0ul);
+        nmea_queue_print(queue);
+        nmea_queue_destroy(queue);
+    }
+#ifdef __linux__
+    //The same overload (a sentence every 5 us, 12 us per sentence in the consumer) with every policy, the sampling
+    //policy queues every 3rd sentence of a receiver
+    printf("\n\nQueue overload stress with every policy.\n\n");
+    for (int policy = 0; policy < NMEA_OVERLOAD_POLICY_COUNT; policy++) {
+        nmea_queue_stress((nmea_OverloadPolicy_t) policy, 3, 4, 20000, 5, 12);
+    }
+
+    //Framing and decoding as two threads (two cores on the ESP32) against one thread
+    printf("\n\nTwo-stage pipeline throughput against one thread.\n\n");
+    nmea_pipeline_benchmark(200000);
+
+    //Records for log collectors written without printf, compared with an snprintf formatter
+    printf("\n\nJSON, CSV and line protocol formatting throughput.\n\n");
+    nmea_emit_benchmark(200000);
+
+    //The header-only C++ decoder gives the same records as the C parser
+    printf("\n\nCross-check and timing of the C++ decoder against the C parser.\n\n");
+    nmea_cpp_decode_benchmark(200000);
+
+    //Every generated fix comes back unchanged from its encoded sentence
+    printf("\n\nEncode and parse round trip of generated fixes.\n\n");
+    nmea_encode_benchmark(200000);
+
+    //Capture compression modelled on the GGA fields against zlib, restored byte for byte
+    printf("\n\nCapture compression ratio and speed against zlib.\n\n");
+    nmea_compress_benchmark(200000, 4);
+
+    //Captures of several receivers across midnight merged into one time-ordered stream
+    printf("\n\nExternal merge of receiver captures by UTC time.\n\n");
+    nmea_merge_benchmark(8, 20000);
+
+    //Capture replayed into many virtual receivers at 10x its real time
+    printf("\n\nReal-time replay of a capture into virtual receivers.\n\n");
+    nmea_replay_benchmark(1000, 300, 10.0);
+
+    //Serial-to-Ethernet bridges: UDP datagrams read in recvmmsg batches and TCP streams on the same reactor
+    printf("\n\nBatched UDP/TCP network ingest from localhost senders.\n\n");
+    nmea_ingest_net_benchmark(200000, 4);
+
+    //Local receivers: sentences written into pipes and pseudo terminals, from 1 to 256 receivers on one reactor
+    printf("\n\nIngest scaling with the number of FIFO and pty receivers.\n\n");
+    nmea_ingest_fd_benchmark(256, 400000);
+
+    //Shared-memory fan-out at 20000 fixes/s and unpaced, one subscriber process is too slow and must be lapped
+    printf("\n\nShared-memory publish/subscribe with lap checks.\n\n");
+    nmea_shm_benchmark(100000, 20000, 3);
+#endif
+
+    //Worst-case execution time of the bounded parser with adversarial inputs, the report is too large for the stack
+    static nmea_WcetReport_t wcetReport;
+    printf("\n\nCycle counts of nmea_gga_parse_bounded for 1000 rounds of adversarial inputs.\n\n");
+    nmea_wcet_run(&wcetReport, 1000, 1);
+    nmea_wcet_print(&wcetReport);
+
+#ifdef CONFIG_GGA_PARSER_GETTERS
     free(drs); //free the allocated memory
+#endif
 }
\ No newline at end of file
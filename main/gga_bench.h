@@ -0,0 +1,59 @@
+/**
+ * @brief Time and random number helpers of the benchmarks, the stress tests and the timed stages of the component.
+ * -Header only, the functions are static inline so every module gets its own copy without a link dependency.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __linux__
+#include <time.h>
+#else
+#include "esp_timer.h"
+#endif
+
+/**
+ * @brief nmea_wall_us function gives the monotonic wall time in microseconds
+ * @param void
+ * @return uint64_t is the time
+ */
+static inline uint64_t nmea_wall_us(void)
+{
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000u + (uint64_t) ts.tv_nsec / 1000u;
+#else
+    return (uint64_t) esp_timer_get_time();
+#endif
+}
+
+#ifdef __linux__
+/**
+ * @brief nmea_wall_ns function gives the CLOCK_MONOTONIC time in nanoseconds
+ * @param void
+ * @return uint64_t is the time
+ */
+static inline uint64_t nmea_wall_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+#endif
+
+/**
+ * @brief nmea_bench_random function is a xorshift32 generator
+ * @param state is the generator state (not 0)
+ * @return uint32_t is the next random number
+ */
+static inline uint32_t nmea_bench_random(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
@@ -0,0 +1,1322 @@
+#include <string.h>
+#include "gga_compress.h"
+#include "gga_validate.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <zlib.h>
+#include "gga_encode.h"
+#include "gga_bench.h"
+#endif
+
+#define BLOCK_MODELLED 0                //block type: bit stream, literal lines byte aligned in it
+#define BLOCK_STORED 1                  //block type: raw bytes
+#define MAX_TEXT_LEN 15                 //Longest text field kept in a modelled line
+#define MAX_INT_LEN 31                  //Longest integer part of a number
+#define MAX_FRAC_LEN 15                 //Longest fraction of a number
+#define MAX_MANTISSA_DIGITS 18          //Digits of a number, it always fits in int64_t
+#define MAX_ZERO_RUN 64                 //Longest Exp-Golomb prefix of a valid stream
+#define MAX_ORDER 24                    //Largest Exp-Golomb order of a residual
+#define HISTORY_SLOTS 8                 //Recent literal lines kept as references (HISTORY_SLOT_BITS bits)
+#define HISTORY_SLOT_BITS 3
+#define HISTORY_KEY_LEN 6               //A reference starts with the same charachters e.g., "$GPRMC"
+
+/**
+ * @brief Line endings, coded in 2 bits
+ */
+typedef enum {
+    ENDING_NONE = 0,
+    ENDING_LF,
+    ENDING_CRLF,
+    ENDING_COUNT
+} lineEnding_t;
+
+/**
+ * @brief Kind of a field, coded in 2 bits
+ */
+typedef enum {
+    KIND_EMPTY = 0,
+    KIND_NUMBER,
+    KIND_TEXT
+} fieldKind_t;
+
+/**
+ * @brief One field of a GGA line in the form it is coded
+ */
+typedef struct {
+    uint8_t kind;                       //fieldKind_t
+    uint8_t intLen;                     //number: digits in front of the decimal point
+    uint8_t hasDot;                     //number: the decimal point is written
+    uint8_t fracLen;                    //number: digits after the decimal point
+    uint8_t negZero;                    //number: "-0" which the signed value cannot hold
+    uint8_t textLen;                    //text: length
+    char text[MAX_TEXT_LEN];            //text: charachters
+    int64_t value;                      //number: signed digits (time: 1/10^fracLen seconds of the day)
+} fieldToken_t;
+
+/**
+ * @brief Column state of one field, the same on both sides
+ */
+typedef struct {
+    fieldToken_t prev;                  //field of the previous line
+    int64_t lastValue;                  //last number of the column
+    int64_t lastDelta;                  //time column: last difference, used for the linear prediction
+    uint32_t k4;                        //average residual bit length * 4, gives the Exp-Golomb order
+} column_t;
+
+/**
+ * @brief Model state of a block
+ */
+typedef struct {
+    column_t column[NMEA_FIELD_COUNT];
+    char talker[2];
+    uint8_t ending;
+    char history[HISTORY_SLOTS][NMEA_MAX_SENTENCE_LEN];
+    uint8_t historyLen[HISTORY_SLOTS];
+    uint8_t historyNext;
+} model_t;
+
+/**
+ * @brief Bit stream writer, bits are written most significant first
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t pos;
+    uint64_t acc;
+    int bits;
+    bool overflow;
+} bitWriter_t;
+
+/**
+ * @brief Bit stream reader, reading past the end gives zeros and sets overrun
+ */
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    uint64_t acc;
+    int bits;
+    bool overrun;
+} bitReader_t;
+
+static const int64_t s_pow10[] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL, 1000000000LL,
+    10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL, 100000000000000LL, 1000000000000000LL
+};
+
+static const char s_hexDigits[] = "0123456789ABCDEF";
+
+/**
+ * @brief putBits function writes the low n bits of a value
+ * @param w is the writer
+ * @param value is the value
+ * @param n is the number of bits (at most 32)
+ * @return void
+ */
+static inline void putBits(bitWriter_t *w, uint64_t value, int n)
+{
+    w->acc = (w->acc << n) | (value & ((1ULL << n) - 1));
+    w->bits += n;
+    while (w->bits >= 8) {
+        w->bits -= 8;
+        if (w->pos < w->cap) w->buf[w->pos++] = (uint8_t) (w->acc >> w->bits);
+        else w->overflow = true;
+    }
+}
+
+/**
+ * @brief flushBits function writes the last partial byte
+ * @param w is the writer
+ * @return void
+ */
+static void flushBits(bitWriter_t *w)
+{
+    if (w->bits > 0) {
+        putBits(w, 0, 8 - w->bits);
+    }
+}
+
+/**
+ * @brief putBytes function writes bytes at the next byte boundary
+ * @param w is the writer
+ * @param data is the bytes
+ * @param len is the number of bytes
+ * @return void
+ */
+static void putBytes(bitWriter_t *w, const char *data, size_t len)
+{
+    flushBits(w);
+    if (len > w->cap - w->pos) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->pos, data, len);
+    w->pos += len;
+}
+
+/**
+ * @brief getBytes function skips to the next byte boundary and gives the position of the next len bytes
+ * @param r is the reader
+ * @param len is the number of bytes
+ * @return const uint8_t* is the position or NULL if there are not enough bytes
+ */
+static const uint8_t* getBytes(bitReader_t *r, size_t len)
+{
+    //Whole bytes which are still in the accumulator are given back
+    r->pos -= (size_t) (r->bits / 8);
+    r->bits = 0;
+    if (r->overrun || len > r->len - r->pos) {
+        r->overrun = true;
+        return NULL;
+    }
+    r->pos += len;
+    return r->buf + r->pos - len;
+}
+
+/**
+ * @brief getBits function reads n bits
+ * @param r is the reader
+ * @param n is the number of bits (at most 32)
+ * @return uint64_t is the value
+ */
+static inline uint64_t getBits(bitReader_t *r, int n)
+{
+    while (r->bits < n) {
+        uint8_t byte = 0;
+        if (r->pos < r->len) byte = r->buf[r->pos];
+        else r->overrun = true;
+        r->pos++;
+        r->acc = (r->acc << 8) | byte;
+        r->bits += 8;
+    }
+    r->bits -= n;
+    return (r->acc >> r->bits) & ((1ULL << n) - 1);
+}
+
+/**
+ * @brief bitLength function gives the number of significant bits of a value
+ * @param value is the value
+ * @return int is the number of bits (0 for 0)
+ */
+static inline int bitLength(uint64_t value)
+{
+    return (value == 0) ? 0 : 64 - __builtin_clzll(value);
+}
+
+/**
+ * @brief putExpGolomb function writes a value as an Exp-Golomb code of order k
+ * @param w is the writer
+ * @param value is the value
+ * @param k is the order
+ * @return void
+ */
+static void putExpGolomb(bitWriter_t *w, uint64_t value, int k)
+{
+    uint64_t high = (value >> k) + 1;
+    int n = bitLength(high);
+    for (int zeros = n - 1; zeros > 0; zeros -= 32) {
+        putBits(w, 0, zeros > 32 ? 32 : zeros);
+    }
+    if (n > 32) {
+        putBits(w, high >> 32, n - 32);
+        n = 32;
+    }
+    putBits(w, high, n);
+    if (k > 0) {
+        putBits(w, value, k);
+    }
+}
+
+/**
+ * @brief getExpGolomb function reads an Exp-Golomb code of order k
+ * @param r is the reader
+ * @param k is the order
+ * @return uint64_t is the value (the reader is marked overrun on a corrupted code)
+ */
+static uint64_t getExpGolomb(bitReader_t *r, int k)
+{
+    int zeros = 0;
+    while (getBits(r, 1) == 0) {
+        if (++zeros > MAX_ZERO_RUN || r->overrun) {
+            r->overrun = true;
+            return 0;
+        }
+    }
+    uint64_t high = 1;
+    if (zeros > 32) {
+        high = (high << (zeros - 32)) | getBits(r, zeros - 32);
+        zeros = 32;
+    }
+    high = (high << zeros) | getBits(r, zeros);
+    uint64_t value = ((high - 1) << k);
+    if (k > 0) {
+        value |= getBits(r, k);
+    }
+    return value;
+}
+
+/**
+ * @brief zigzag function maps a signed residual to an unsigned one (0, -1, 1, -2, ...)
+ * @param value is the residual
+ * @return uint64_t is the mapped value
+ */
+static inline uint64_t zigzag(int64_t value)
+{
+    return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+/**
+ * @brief wrapAdd function adds two numbers modulo 2^64, so a corrupt block can not overflow
+ * @param a is the first number
+ * @param b is the second number
+ * @return int64_t is the sum
+ */
+static inline int64_t wrapAdd(int64_t a, int64_t b)
+{
+    return (int64_t) ((uint64_t) a + (uint64_t) b);
+}
+
+/**
+ * @brief wrapSub function subtracts two numbers modulo 2^64, the inverse of wrapAdd
+ * @param a is the first number
+ * @param b is the number to subtract
+ * @return int64_t is the difference
+ */
+static inline int64_t wrapSub(int64_t a, int64_t b)
+{
+    return (int64_t) ((uint64_t) a - (uint64_t) b);
+}
+
+/**
+ * @brief unzigzag function is the inverse of zigzag
+ * @param value is the mapped value
+ * @return int64_t is the residual
+ */
+static inline int64_t unzigzag(uint64_t value)
+{
+    return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+/**
+ * @brief residualOrder function gives the Exp-Golomb order of the next residual of a column
+ * @param col is the column
+ * @return int is the order, one less than the average residual bit length
+ */
+static inline int residualOrder(const column_t *col)
+{
+    int k = (int) (col->k4 >> 2) - 1;
+    return (k < 0) ? 0 : (k > MAX_ORDER) ? MAX_ORDER : k;
+}
+
+/**
+ * @brief putResidual function writes the difference to the prediction with the adaptive order of the column
+ * @param w is the writer
+ * @param col is the column
+ * @param residual is the difference
+ * @return void
+ */
+static void putResidual(bitWriter_t *w, column_t *col, int64_t residual)
+{
+    uint64_t value = zigzag(residual);
+    putExpGolomb(w, value, residualOrder(col));
+    col->k4 += (uint32_t) bitLength(value) - (col->k4 >> 2);
+}
+
+/**
+ * @brief getResidual function reads a difference to the prediction, see putResidual
+ * @param r is the reader
+ * @param col is the column
+ * @return int64_t is the difference
+ */
+static int64_t getResidual(bitReader_t *r, column_t *col)
+{
+    uint64_t value = getExpGolomb(r, residualOrder(col));
+    col->k4 += (uint32_t) bitLength(value) - (col->k4 >> 2);
+    return unzigzag(value);
+}
+
+/**
+ * @brief isTimeFormat function tells if a number of the time column is hhmmss(.s) and is coded as seconds of the day
+ * @param t is the token
+ * @return bool is true for the time format
+ */
+static inline bool isTimeFormat(const fieldToken_t *t)
+{
+    return t->intLen == 6 && !t->negZero;
+}
+
+/**
+ * @brief tokenize function converts one field into a token
+ * @param str is the field
+ * @param len is the length of the field
+ * @param timeColumn is true for the time column
+ * @param t holds the token
+ * @return bool is true if the field can be reproduced from the token
+ */
+static bool tokenize(const char *str, size_t len, bool timeColumn, fieldToken_t *t)
+{
+    memset(t, 0, sizeof(*t));
+    if (len == 0) {
+        t->kind = KIND_EMPTY;
+        return true;
+    }
+    //Number i.e., -?digits(.digits)?
+    size_t i = 0;
+    bool negative = (str[0] == '-');
+    i += negative;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int intLen = 0;
+    int fracLen = 0;
+    while (i < len && str[i] >= '0' && str[i] <= '9') {
+        mantissa = mantissa * 10 + (uint64_t) (str[i++] - '0');
+        intLen++;
+    }
+    bool hasDot = (i < len && str[i] == '.');
+    i += hasDot;
+    while (i < len && str[i] >= '0' && str[i] <= '9') {
+        mantissa = mantissa * 10 + (uint64_t) (str[i++] - '0');
+        fracLen++;
+    }
+    digits = intLen + fracLen;
+    if (i == len && digits > 0 && digits <= MAX_MANTISSA_DIGITS && intLen <= MAX_INT_LEN && fracLen <= MAX_FRAC_LEN) {
+        t->kind = KIND_NUMBER;
+        t->intLen = (uint8_t) intLen;
+        t->hasDot = hasDot;
+        t->fracLen = (uint8_t) fracLen;
+        t->negZero = (negative && mantissa == 0);
+        t->value = negative ? (int64_t) (0 - mantissa) : (int64_t) mantissa;
+        if (timeColumn && isTimeFormat(t)) {
+            //hhmmss is turned into seconds of the day, only if it can be turned back
+            if (negative) {
+                return false;
+            }
+            int64_t scale = s_pow10[fracLen];
+            int64_t hhmmss = t->value / scale;
+            int64_t minutes = hhmmss / 100 % 100;
+            int64_t seconds = hhmmss % 100;
+            if (minutes >= 60 || seconds >= 60) {
+                return false;
+            }
+            t->value = ((hhmmss / 10000 * 60 + minutes) * 60 + seconds) * scale + t->value % scale;
+        }
+        return true;
+    }
+    if (len > MAX_TEXT_LEN) {
+        return false;
+    }
+    t->kind = KIND_TEXT;
+    t->textLen = (uint8_t) len;
+    memcpy(t->text, str, len);
+    return true;
+}
+
+/**
+ * @brief putNumber function writes a number token back as text
+ * @param p is the output position
+ * @param t is the token
+ * @param timeColumn is true for the time column
+ * @return char* is the new output position
+ */
+static char* putNumber(char *p, const fieldToken_t *t, bool timeColumn)
+{
+    uint64_t magnitude = (t->value < 0) ? 0 - (uint64_t) t->value : (uint64_t) t->value;
+    uint64_t scale = (uint64_t) s_pow10[t->fracLen];
+    uint64_t integer = magnitude / scale;
+    uint64_t frac = magnitude % scale;
+    if (timeColumn && isTimeFormat(t)) {
+        integer = integer / 3600 * 10000 + integer / 60 % 60 * 100 + integer % 60;
+    }
+    if (t->value < 0 || t->negZero) {
+        *p++ = '-';
+    }
+    for (int i = t->intLen - 1; i >= 0; i--) {
+        p[i] = (char) ('0' + integer % 10);
+        integer /= 10;
+    }
+    p += t->intLen;
+    if (t->hasDot) {
+        *p++ = '.';
+    }
+    for (int i = t->fracLen - 1; i >= 0; i--) {
+        p[i] = (char) ('0' + frac % 10);
+        frac /= 10;
+    }
+    return p + t->fracLen;
+}
+
+/**
+ * @brief sameFormat function tells if two number tokens are written the same way
+ * @param a is the first token
+ * @param b is the second token
+ * @return bool is true if the formats are the same
+ */
+static inline bool sameFormat(const fieldToken_t *a, const fieldToken_t *b)
+{
+    return a->kind == KIND_NUMBER && b->kind == KIND_NUMBER && a->intLen == b->intLen && a->hasDot == b->hasDot
+        && a->fracLen == b->fracLen && a->negZero == b->negZero;
+}
+
+/**
+ * @brief prediction function gives the predicted number of a column
+ * @param col is the column
+ * @param index is the field index
+ * @return int64_t is the prediction
+ */
+static inline int64_t prediction(const column_t *col, int index)
+{
+    return (index == NMEA_FIELD_TIME) ? wrapAdd(col->lastValue, col->lastDelta) : col->lastValue;
+}
+
+/**
+ * @brief updateColumn function stores the field of the current line in the column
+ * @param col is the column
+ * @param index is the field index
+ * @param t is the token
+ * @return void
+ */
+static inline void updateColumn(column_t *col, int index, const fieldToken_t *t)
+{
+    if (t->kind == KIND_NUMBER) {
+        if (index == NMEA_FIELD_TIME) {
+            col->lastDelta = wrapSub(t->value, col->lastValue);
+        }
+        col->lastValue = t->value;
+    }
+    col->prev = *t;
+}
+
+/**
+ * @brief splitLine function checks if a line is a GGA sentence which can be rebuilt from its fields
+ * @param line is the line without the line ending
+ * @param len is the length of the line
+ * @param token holds the fields
+ * @return bool is true if the line can be modelled
+ */
+static bool splitLine(const char *line, size_t len, fieldToken_t token[NMEA_FIELD_COUNT])
+{
+    //$ttGGA,<14 fields>*HH with the recomputed checksum in upper case
+    if (len < 10 || line[0] != '$' || line[1] < 'A' || line[1] > 'Z' || line[2] < 'A' || line[2] > 'Z'
+            || memcmp(line + 3, "GGA,", 4) != 0 || line[len - 3] != '*') {
+        return false;
+    }
+    uint8_t checksum = nmea_checksum(line + 1, len - 4);
+    if (line[len - 2] != s_hexDigits[checksum >> 4] || line[len - 1] != s_hexDigits[checksum & 0x0F]) {
+        return false;
+    }
+    const char *p = line + 7;
+    const char *star = line + len - 3;
+    for (int i = 0; i < NMEA_FIELD_COUNT; i++) {
+        const char *end = memchr(p, ',', (size_t) (star - p));
+        if (end == NULL) {
+            end = star;
+        }
+        if ((end == star) != (i == NMEA_FIELD_COUNT - 1)) {
+            return false;
+        }
+        if (!tokenize(p, (size_t) (end - p), i == NMEA_FIELD_TIME, &token[i])) {
+            return false;
+        }
+        p = end + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief putEnding function writes the line ending code
+ * @param w is the writer
+ * @param model is the model
+ * @param ending is the line ending
+ * @return void
+ */
+static inline void putEnding(bitWriter_t *w, model_t *model, uint8_t ending)
+{
+    if (ending == model->ending) {
+        putBits(w, 0, 1);
+    }
+    else {
+        putBits(w, 4 | ending, 3);
+        model->ending = ending;
+    }
+}
+
+/**
+ * @brief putField function writes one field
+ * @param w is the writer
+ * @param col is the column
+ * @param index is the field index
+ * @param t is the token
+ * @return void
+ */
+static void putField(bitWriter_t *w, column_t *col, int index, const fieldToken_t *t)
+{
+    const fieldToken_t *prev = &col->prev;
+    if (t->kind == KIND_NUMBER && sameFormat(t, prev)) {
+        int64_t residual = wrapSub(t->value, prediction(col, index));
+        //'0' same format and value as predicted, '10' same format and a residual
+        if (residual == 0) {
+            putBits(w, 0, 1);
+        }
+        else {
+            putBits(w, 2, 2);
+            putResidual(w, col, residual);
+        }
+    }
+    else if (t->kind == prev->kind && (t->kind == KIND_EMPTY
+            || (t->kind == KIND_TEXT && t->textLen == prev->textLen && memcmp(t->text, prev->text, t->textLen) == 0))) {
+        putBits(w, 0, 1);
+    }
+    else {
+        //'11' and the complete field
+        putBits(w, 3, 2);
+        putBits(w, t->kind, 2);
+        if (t->kind == KIND_NUMBER) {
+            putBits(w, t->intLen, 5);
+            putBits(w, t->hasDot, 1);
+            putBits(w, t->fracLen, 4);
+            putBits(w, t->negZero, 1);
+            putResidual(w, col, wrapSub(t->value, prediction(col, index)));
+        }
+        else if (t->kind == KIND_TEXT) {
+            putBits(w, t->textLen, 4);
+            for (int i = 0; i < t->textLen; i++) {
+                putBits(w, (uint8_t) t->text[i], 8);
+            }
+        }
+    }
+    updateColumn(col, index, t);
+}
+
+/**
+ * @brief findReference function finds the literal line of the history which starts like the line
+ * @param model is the model
+ * @param line is the line
+ * @param len is the length of the line
+ * @return int is the history slot or -1 if there is none (every key is in at most one slot)
+ */
+static int findReference(const model_t *model, const char *line, size_t len)
+{
+    if (len < HISTORY_KEY_LEN || len > NMEA_MAX_SENTENCE_LEN) {
+        return -1;
+    }
+    for (int i = 0; i < HISTORY_SLOTS; i++) {
+        if (model->historyLen[i] != 0 && memcmp(model->history[i], line, HISTORY_KEY_LEN) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief storeReference function keeps a literal line in the history
+ * @param model is the model
+ * @param slot is the slot of the reference which was used or -1 to take the next slot
+ * @param line is the line
+ * @param len is the length of the line
+ * @return void
+ */
+static void storeReference(model_t *model, int slot, const char *line, size_t len)
+{
+    if (len < HISTORY_KEY_LEN || len > NMEA_MAX_SENTENCE_LEN) {
+        return;
+    }
+    if (slot < 0) {
+        slot = model->historyNext;
+        model->historyNext = (uint8_t) ((model->historyNext + 1) % HISTORY_SLOTS);
+    }
+    memcpy(model->history[slot], line, len);
+    model->historyLen[slot] = (uint8_t) len;
+}
+
+/**
+ * @brief putLiteralLine function writes a line which is not modelled, as the difference to the previous line of the
+ * -same kind when there is one, otherwise byte aligned so it is copied as it is
+ * @param w is the writer
+ * @param model is the model
+ * @param line is the line
+ * @param len is the length of the line
+ * @return void
+ */
+static void putLiteralLine(bitWriter_t *w, model_t *model, const char *line, size_t len)
+{
+    int slot = findReference(model, line, len);
+    putBits(w, 1, 1);
+    putExpGolomb(w, len, 6);
+    if (slot < 0) {
+        putBits(w, 0, 1);
+        putBytes(w, line, len);
+    }
+    else {
+        //Runs of charachters equal to the reference at the same position and runs of new charachters
+        const char *ref = model->history[slot];
+        size_t refLen = model->historyLen[slot];
+        putBits(w, 1, 1);
+        putBits(w, (uint64_t) slot, HISTORY_SLOT_BITS);
+        size_t pos = 0;
+        while (pos < len) {
+            size_t copy = 0;
+            while (pos + copy < len && pos + copy < refLen && line[pos + copy] == ref[pos + copy]) {
+                copy++;
+            }
+            putExpGolomb(w, copy, 2);
+            pos += copy;
+            if (pos == len) {
+                break;
+            }
+            size_t lit = 1;
+            while (pos + lit < len && (pos + lit >= refLen || line[pos + lit] != ref[pos + lit])) {
+                lit++;
+            }
+            putExpGolomb(w, lit - 1, 1);
+            for (size_t i = 0; i < lit; i++) {
+                putBits(w, (uint8_t) line[pos + i], 8);
+            }
+            pos += lit;
+        }
+    }
+    storeReference(model, slot, line, len);
+}
+
+/**
+ * @brief getLiteralLine function reads a line which is not modelled, see putLiteralLine
+ * @param r is the reader
+ * @param model is the model
+ * @param line is the buffer for a line coded as a difference (NMEA_MAX_SENTENCE_LEN bytes)
+ * @param len holds the length of the line
+ * @return const char* is the line (in the buffer or in the stream) or NULL if the stream is corrupted
+ */
+static const char* getLiteralLine(bitReader_t *r, model_t *model, char *line, size_t *len)
+{
+    size_t lineLen = (size_t) getExpGolomb(r, 6);
+    const char *src = line;
+    int slot = -1;
+    if (getBits(r, 1) == 0) {
+        src = (const char *) getBytes(r, lineLen);
+        if (src == NULL) {
+            return NULL;
+        }
+    }
+    else {
+        slot = (int) getBits(r, HISTORY_SLOT_BITS);
+        const char *ref = model->history[slot];
+        size_t refLen = model->historyLen[slot];
+        if (refLen == 0 || lineLen > NMEA_MAX_SENTENCE_LEN) {
+            return NULL;
+        }
+        size_t pos = 0;
+        while (pos < lineLen) {
+            size_t copy = (size_t) getExpGolomb(r, 2);
+            if (copy > lineLen - pos || pos + copy > refLen) {
+                return NULL;
+            }
+            memcpy(line + pos, ref + pos, copy);
+            pos += copy;
+            if (pos == lineLen) {
+                break;
+            }
+            size_t lit = (size_t) getExpGolomb(r, 1) + 1;
+            if (lit > lineLen - pos) {
+                return NULL;
+            }
+            for (size_t i = 0; i < lit; i++) {
+                line[pos + i] = (char) getBits(r, 8);
+            }
+            pos += lit;
+        }
+        if (r->overrun) {
+            return NULL;
+        }
+    }
+    storeReference(model, slot, src, lineLen);
+    *len = lineLen;
+    return src;
+}
+
+/**
+ * @brief putHeader function writes the block header i.e., "NZB", type, raw length, payload length, line count and CRC-32
+ * @param out is the output
+ * @param type is the block type
+ * @param raw is the raw data of the block
+ * @param rawLen is the raw length
+ * @param payloadLen is the length of the data after the header
+ * @param lines is the number of lines
+ * @return void
+ */
+static void putHeader(uint8_t *out, uint8_t type, const char *raw, size_t rawLen, size_t payloadLen, uint32_t lines)
+{
+    uint32_t fields[4] = { (uint32_t) rawLen, (uint32_t) payloadLen, lines, nmea_crc32(0, raw, rawLen) };
+    out[0] = 'N';
+    out[1] = 'Z';
+    out[2] = 'B';
+    out[3] = type;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 4; b++) {
+            out[4 + i * 4 + b] = (uint8_t) (fields[i] >> (8 * b));
+        }
+    }
+}
+
+/**
+ * @brief compressBlock function compresses one block of lines
+ * @param in is the raw data of the block
+ * @param len is the length of the raw data (at most NMEA_COMPRESS_BLOCK_SIZE)
+ * @param out is the output buffer, at least len + NMEA_COMPRESS_HEADER_LEN bytes
+ * @return size_t is the number of bytes written
+ */
+static size_t compressBlock(const char *in, size_t len, uint8_t *out)
+{
+    static const model_t s_initialModel = { .ending = ENDING_CRLF };
+    model_t model = s_initialModel;
+    //The modelled block is given up as soon as it is not smaller than the raw data
+    bitWriter_t w = { out + NMEA_COMPRESS_HEADER_LEN, len, 0, 0, 0, false };
+    fieldToken_t token[NMEA_FIELD_COUNT];
+    uint32_t lines = 0;
+    const char *p = in;
+    const char *end = in + len;
+    while (p < end && !w.overflow) {
+        const char *nl = memchr(p, '\n', (size_t) (end - p));
+        const char *lineEnd = (nl != NULL) ? nl : end;
+        uint8_t ending = ENDING_NONE;
+        if (nl != NULL) {
+            ending = ENDING_LF;
+            if (lineEnd > p && lineEnd[-1] == '\r') {
+                ending = ENDING_CRLF;
+                lineEnd--;
+            }
+        }
+        size_t lineLen = (size_t) (lineEnd - p);
+        if (splitLine(p, lineLen, token)) {
+            putBits(&w, 0, 1);
+            if (p[1] == model.talker[0] && p[2] == model.talker[1]) {
+                putBits(&w, 0, 1);
+            }
+            else {
+                putBits(&w, 1, 1);
+                putBits(&w, (uint8_t) p[1], 8);
+                putBits(&w, (uint8_t) p[2], 8);
+                model.talker[0] = p[1];
+                model.talker[1] = p[2];
+            }
+            for (int i = 0; i < NMEA_FIELD_COUNT; i++) {
+                putField(&w, &model.column[i], i, &token[i]);
+            }
+        }
+        else {
+            putLiteralLine(&w, &model, p, lineLen);
+        }
+        putEnding(&w, &model, ending);
+        lines++;
+        p = (nl != NULL) ? nl + 1 : end;
+    }
+    flushBits(&w);
+    if (w.overflow || w.pos >= len) {
+        memcpy(out + NMEA_COMPRESS_HEADER_LEN, in, len);
+        putHeader(out, BLOCK_STORED, in, len, len, 0);
+        return NMEA_COMPRESS_HEADER_LEN + len;
+    }
+    putHeader(out, BLOCK_MODELLED, in, len, w.pos, lines);
+    return NMEA_COMPRESS_HEADER_LEN + w.pos;
+}
+
+/**
+ * @brief blockLength function chooses the raw length of the next block
+ * @param in is the raw data
+ * @param len is the length of the raw data
+ * @return size_t is the length, cut after a line ending when there is one in the second half of the block
+ */
+static size_t blockLength(const char *in, size_t len)
+{
+    if (len <= NMEA_COMPRESS_BLOCK_SIZE) {
+        return len;
+    }
+    for (size_t i = NMEA_COMPRESS_BLOCK_SIZE; i > NMEA_COMPRESS_BLOCK_SIZE / 2; i--) {
+        if (in[i - 1] == '\n') {
+            return i;
+        }
+    }
+    return NMEA_COMPRESS_BLOCK_SIZE;
+}
+
+/**
+ * @brief nmea_compress function compresses a capture into blocks
+ * @param in is the raw capture data
+ * @param len is the length of the data
+ * @param final is true if this is the end of the capture, otherwise data shorter than a block is left for the next call
+ * @param out is the output buffer
+ * @param cap is the size of the output buffer (NMEA_COMPRESS_BOUND(len) is always enough)
+ * @param consumed holds the number of raw bytes compressed, the rest has to be given again with the next data
+ * @return size_t is the number of bytes written or 0 if the output buffer is too small
+ */
+size_t nmea_compress(const char *in, size_t len, bool final, uint8_t *out, size_t cap, size_t *consumed)
+{
+    size_t used = 0;
+    size_t done = 0;
+    while (done < len && (final || len - done > NMEA_COMPRESS_BLOCK_SIZE)) {
+        size_t blockLen = blockLength(in + done, len - done);
+        if (cap - used < blockLen + NMEA_COMPRESS_HEADER_LEN) {
+            *consumed = 0;
+            return 0;
+        }
+        used += compressBlock(in + done, blockLen, out + used);
+        done += blockLen;
+    }
+    *consumed = done;
+    return used;
+}
+
+/**
+ * @brief Block header fields
+ */
+typedef struct {
+    uint8_t type;
+    size_t rawLen;
+    size_t payloadLen;
+    uint32_t lines;
+    uint32_t crc;                       //CRC-32 of the raw data
+} blockHeader_t;
+
+/**
+ * @brief readHeader function reads and checks a block header
+ * @param in is the compressed data
+ * @param len is the length of the compressed data
+ * @param h holds the header
+ * @return int is 1 for a complete block, 0 if the block is incomplete, -1 if the header is corrupted
+ */
+static int readHeader(const uint8_t *in, size_t len, blockHeader_t *h)
+{
+    if (len < NMEA_COMPRESS_HEADER_LEN) {
+        return 0;
+    }
+    if (in[0] != 'N' || in[1] != 'Z' || in[2] != 'B' || in[3] > BLOCK_STORED) {
+        return -1;
+    }
+    uint32_t fields[4];
+    for (int i = 0; i < 4; i++) {
+        fields[i] = (uint32_t) in[4 + i * 4] | (uint32_t) in[5 + i * 4] << 8 | (uint32_t) in[6 + i * 4] << 16 | (uint32_t) in[7 + i * 4] << 24;
+    }
+    h->type = in[3];
+    h->rawLen = fields[0];
+    h->payloadLen = fields[1];
+    h->lines = fields[2];
+    h->crc = fields[3];
+    if (h->rawLen > NMEA_COMPRESS_BLOCK_SIZE || h->payloadLen > h->rawLen || (h->type == BLOCK_STORED && h->payloadLen != h->rawLen)) {
+        return -1;
+    }
+    return (len - NMEA_COMPRESS_HEADER_LEN >= h->payloadLen) ? 1 : 0;
+}
+
+/**
+ * @brief getField function reads one field, see putField
+ * @param r is the reader
+ * @param col is the column
+ * @param index is the field index
+ * @param t holds the token
+ * @return bool is false if the stream is corrupted
+ */
+static bool getField(bitReader_t *r, column_t *col, int index, fieldToken_t *t)
+{
+    *t = col->prev;
+    if (getBits(r, 1) == 0) {
+        if (t->kind == KIND_NUMBER) {
+            t->value = prediction(col, index);
+        }
+    }
+    else if (getBits(r, 1) == 0) {
+        if (t->kind != KIND_NUMBER) {
+            return false;
+        }
+        t->value = wrapAdd(prediction(col, index), getResidual(r, col));
+    }
+    else {
+        memset(t, 0, sizeof(*t));
+        t->kind = (uint8_t) getBits(r, 2);
+        if (t->kind == KIND_NUMBER) {
+            t->intLen = (uint8_t) getBits(r, 5);
+            t->hasDot = (uint8_t) getBits(r, 1);
+            t->fracLen = (uint8_t) getBits(r, 4);
+            t->negZero = (uint8_t) getBits(r, 1);
+            t->value = wrapAdd(prediction(col, index), getResidual(r, col));
+        }
+        else if (t->kind == KIND_TEXT) {
+            t->textLen = (uint8_t) getBits(r, 4);
+            for (int i = 0; i < t->textLen; i++) {
+                t->text[i] = (char) getBits(r, 8);
+            }
+        }
+        else if (t->kind != KIND_EMPTY) {
+            return false;
+        }
+    }
+    if (t->kind == KIND_NUMBER && (t->fracLen > MAX_FRAC_LEN || t->intLen + t->fracLen > MAX_MANTISSA_DIGITS)) {
+        return false;
+    }
+    updateColumn(col, index, t);
+    return true;
+}
+
+/**
+ * @brief decodeBlock function decodes the lines of a modelled block
+ * @param h is the block header
+ * @param data is the data after the header
+ * @param out is the output buffer, at least h->rawLen bytes
+ * @return bool is false if the block is corrupted
+ */
+static bool decodeBlock(const blockHeader_t *h, const uint8_t *data, char *out)
+{
+    static const model_t s_initialModel = { .ending = ENDING_CRLF };
+    model_t model = s_initialModel;
+    bitReader_t r = { data, h->payloadLen, 0, 0, 0, false };
+    //Longest modelled line: "$ttGGA," 14 fields of at most "-" + digits + "." and ",", "hh" after the last ','
+    char line[7 + NMEA_FIELD_COUNT * (MAX_MANTISSA_DIGITS + 3) + 2];
+    fieldToken_t t;
+    char *p = out;
+    char *end = out + h->rawLen;
+    for (uint32_t n = 0; n < h->lines; n++) {
+        size_t lineLen;
+        const char *src;
+        if (getBits(&r, 1) == 0) {
+            if (getBits(&r, 1) == 1) {
+                model.talker[0] = (char) getBits(&r, 8);
+                model.talker[1] = (char) getBits(&r, 8);
+            }
+            char *q = line;
+            *q++ = '$';
+            *q++ = model.talker[0];
+            *q++ = model.talker[1];
+            memcpy(q, "GGA,", 4);
+            q += 4;
+            for (int i = 0; i < NMEA_FIELD_COUNT; i++) {
+                if (!getField(&r, &model.column[i], i, &t)) {
+                    return false;
+                }
+                if (t.kind == KIND_NUMBER) {
+                    q = putNumber(q, &t, i == NMEA_FIELD_TIME);
+                }
+                else if (t.kind == KIND_TEXT) {
+                    memcpy(q, t.text, t.textLen);
+                    q += t.textLen;
+                }
+                *q++ = ',';
+            }
+            //The last ',' is the '*' and the checksum is recomputed
+            q[-1] = '*';
+            uint8_t checksum = nmea_checksum(line + 1, (size_t) (q - line - 2));
+            *q++ = s_hexDigits[checksum >> 4];
+            *q++ = s_hexDigits[checksum & 0x0F];
+            lineLen = (size_t) (q - line);
+            src = line;
+        }
+        else {
+            src = getLiteralLine(&r, &model, line, &lineLen);
+            if (src == NULL) {
+                return false;
+            }
+        }
+        if (getBits(&r, 1) == 1) {
+            model.ending = (uint8_t) getBits(&r, 2);
+            if (model.ending >= ENDING_COUNT) {
+                return false;
+            }
+        }
+        size_t endingLen = (model.ending == ENDING_CRLF) ? 2 : (model.ending == ENDING_LF) ? 1 : 0;
+        if (r.overrun || lineLen + endingLen > (size_t) (end - p)) {
+            return false;
+        }
+        memcpy(p, src, lineLen);
+        p += lineLen;
+        if (model.ending == ENDING_CRLF) *p++ = '\r';
+        if (model.ending != ENDING_NONE) *p++ = '\n';
+    }
+    return p == end;
+}
+
+/**
+ * @brief decompressBlock function decompresses one block and checks the CRC-32 of the raw data
+ * @param h is the block header
+ * @param data is the data after the header
+ * @param out is the output buffer
+ * @param cap is the size of the output buffer
+ * @return bool is false if the block is corrupted or does not fit
+ */
+static bool decompressBlock(const blockHeader_t *h, const uint8_t *data, char *out, size_t cap)
+{
+    if (h->rawLen > cap) {
+        return false;
+    }
+    if (h->type == BLOCK_STORED) {
+        memcpy(out, data, h->rawLen);
+    }
+    else if (!decodeBlock(h, data, out)) {
+        return false;
+    }
+    //A flipped bit can still decode to lines of the right length, only the CRC finds it
+    return nmea_crc32(0, out, h->rawLen) == h->crc;
+}
+
+/**
+ * @brief nmea_decompress function decompresses whole blocks
+ * @param in is the compressed data
+ * @param len is the length of the compressed data
+ * @param out is the output buffer
+ * @param cap is the size of the output buffer
+ * @param consumed holds the number of compressed bytes used, an incomplete block at the end is left for the next call
+ * @return size_t is the number of bytes written, (size_t) -1 if the data is corrupted or the output buffer is too small
+ */
+size_t nmea_decompress(const uint8_t *in, size_t len, char *out, size_t cap, size_t *consumed)
+{
+    size_t done = 0;
+    size_t written = 0;
+    blockHeader_t h;
+    int status;
+    while ((status = readHeader(in + done, len - done, &h)) == 1) {
+        if (!decompressBlock(&h, in + done + NMEA_COMPRESS_HEADER_LEN, out + written, cap - written)) {
+            *consumed = done;
+            return (size_t) -1;
+        }
+        done += NMEA_COMPRESS_HEADER_LEN + h.payloadLen;
+        written += h.rawLen;
+    }
+    *consumed = done;
+    return (status < 0) ? (size_t) -1 : written;
+}
+
+/**
+ * @brief nmea_compressed_raw_len function reads the block headers to find the decompressed size
+ * @param in is the compressed data
+ * @param len is the length of the compressed data
+ * @param blocks holds the number of blocks (can be NULL)
+ * @return size_t is the decompressed size or (size_t) -1 if the headers are corrupted
+ */
+size_t nmea_compressed_raw_len(const uint8_t *in, size_t len, size_t *blocks)
+{
+    size_t done = 0;
+    size_t raw = 0;
+    size_t count = 0;
+    blockHeader_t h;
+    while (done < len) {
+        if (readHeader(in + done, len - done, &h) != 1) {
+            return (size_t) -1;
+        }
+        done += NMEA_COMPRESS_HEADER_LEN + h.payloadLen;
+        raw += h.rawLen;
+        count++;
+    }
+    if (blocks != NULL) {
+        *blocks = count;
+    }
+    return raw;
+}
+
+#ifdef __linux__
+/**
+ * @brief Work of one decompression thread, every thread takes every step-th block
+ */
+typedef struct {
+    const uint8_t *in;
+    size_t len;
+    const size_t *inOffset;
+    const size_t *outOffset;
+    size_t blocks;
+    char *out;
+    size_t first;
+    size_t step;
+    bool started;
+    bool ok;
+} decompressJob_t;
+
+/**
+ * @brief decompressThread function decompresses the blocks of one job
+ * @param arg is the job
+ * @return void* is NULL
+ */
+static void* decompressThread(void *arg)
+{
+    decompressJob_t *job = arg;
+    blockHeader_t h;
+    for (size_t i = job->first; i < job->blocks && job->ok; i += job->step) {
+        const uint8_t *block = job->in + job->inOffset[i];
+        readHeader(block, job->len - job->inOffset[i], &h);
+        job->ok = decompressBlock(&h, block + NMEA_COMPRESS_HEADER_LEN, job->out + job->outOffset[i], h.rawLen);
+    }
+    return NULL;
+}
+
+/**
+ * @brief nmea_decompress_parallel function decompresses all the blocks with several threads
+ * @param in is the compressed data
+ * @param len is the length of the compressed data
+ * @param out is the output buffer (nmea_compressed_raw_len bytes)
+ * @param cap is the size of the output buffer
+ * @param threads is the number of threads
+ * @return size_t is the number of bytes written or (size_t) -1 on error
+ */
+size_t nmea_decompress_parallel(const uint8_t *in, size_t len, char *out, size_t cap, int threads)
+{
+    size_t blocks = 0;
+    size_t raw = nmea_compressed_raw_len(in, len, &blocks);
+    if (raw == (size_t) -1 || raw > cap) {
+        return (size_t) -1;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    size_t *offsets = malloc(2 * (blocks + 1) * sizeof(size_t));
+    decompressJob_t *jobs = calloc((size_t) threads, sizeof(decompressJob_t));
+    pthread_t *tids = calloc((size_t) threads, sizeof(pthread_t));
+    if (offsets == NULL || jobs == NULL || tids == NULL) {
+        free(offsets);
+        free(jobs);
+        free(tids);
+        return (size_t) -1;
+    }
+    //The block positions on both sides are known from the headers alone
+    size_t *inOffset = offsets;
+    size_t *outOffset = offsets + blocks + 1;
+    size_t done = 0;
+    size_t written = 0;
+    blockHeader_t h;
+    for (size_t i = 0; i < blocks; i++) {
+        readHeader(in + done, len - done, &h);
+        inOffset[i] = done;
+        outOffset[i] = written;
+        done += NMEA_COMPRESS_HEADER_LEN + h.payloadLen;
+        written += h.rawLen;
+    }
+    for (int t = 0; t < threads; t++) {
+        jobs[t] = (decompressJob_t) { in, len, inOffset, outOffset, blocks, out, (size_t) t, (size_t) threads, false, true };
+    }
+    //Job 0 and the jobs whose thread cannot be started are done by the calling thread
+    for (int t = 1; t < threads; t++) {
+        jobs[t].started = (pthread_create(&tids[t], NULL, decompressThread, &jobs[t]) == 0);
+    }
+    bool ok = true;
+    for (int t = 0; t < threads; t++) {
+        if (jobs[t].started) {
+            pthread_join(tids[t], NULL);
+        }
+        else {
+            decompressThread(&jobs[t]);
+        }
+        ok = ok && jobs[t].ok;
+    }
+    free(offsets);
+    free(jobs);
+    free(tids);
+    return ok ? raw : (size_t) -1;
+}
+
+/**
+ * @brief benchRate function gives a rate in MB/s of raw data
+ * @param bytes is the number of raw bytes
+ * @param us is the time in microseconds
+ * @return double is the rate
+ */
+static inline double benchRate(size_t bytes, uint64_t us)
+{
+    return (us != 0) ? (double) bytes / (double) us : 0.0;
+}
+
+/**
+ * @brief nmea_compress_benchmark function compresses a generated capture, checks that serial and parallel
+ * -decompression give it back byte for byte and prints the ratio and the speed next to zlib (levels 1, 6 and 9)
+ * @param sentences is the number of GGA sentences in the capture (a GSA sentence follows every GGA)
+ * @param threads is the number of threads of the parallel decompression
+ * @return void
+ */
+void nmea_compress_benchmark(uint32_t sentences, int threads)
+{
+    static const char s_gsa[] = "GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1";
+    size_t cap = (size_t) sentences * (ENCODE_MAX_SENTENCE_LEN + sizeof(s_gsa) + 8);
+    char *capture = malloc(cap);
+    char *restored = malloc(cap);
+    uLongf zlibCap = compressBound((uLong) cap);
+    size_t outCap = NMEA_COMPRESS_BOUND(cap) > zlibCap ? NMEA_COMPRESS_BOUND(cap) : zlibCap;
+    uint8_t *packed = malloc(outCap);
+    if (capture == NULL || restored == NULL || packed == NULL) {
+        printf("ERROR: No memory for the compression benchmark!\n");
+        free(capture);
+        free(restored);
+        free(packed);
+        return;
+    }
+    //10 Hz rover: the position moves a little every epoch, HDOP and satellites change now and then, every 500th
+    //line is noise from the serial link
+    char gsa[sizeof(s_gsa) + 8];
+    int gsaLen = snprintf(gsa, sizeof(gsa), "$%s*%02X\r\n", s_gsa, nmea_checksum(s_gsa, sizeof(s_gsa) - 1));
+    uint32_t rng = 0x2545F491u;
+    size_t len = 0;
+    nmea_PackedFix_t fix = { 0 };
+    fix.latitude = 20056618;
+    fix.longitude = -70313858;
+    fix.altitude = 2700;
+    fix.geoSep = -3420;
+    fix.qIndicator = 1;
+    fix.satTracked = 9;
+    fix.hdop = 120;
+    fix.emptyMask = (1u << NMEA_FIELD_TDGPS) | (1u << NMEA_FIELD_DRSID);
+    for (uint32_t i = 0; i < sentences; i++) {
+        uint32_t r = nmea_bench_random(&rng);
+        fix.timeMs = (i * 100u) % 86400000u;
+        fix.latitude += (int32_t) (r % 41) - 20;
+        fix.longitude += (int32_t) (r / 64 % 41) - 20;
+        fix.altitude += (int32_t) (r / 4096 % 11) - 5;
+        if (r % 64 == 0) {
+            fix.satTracked = (uint8_t) (7 + r / 256 % 6);
+            fix.hdop = (uint16_t) (80 + r / 1024 % 100);
+        }
+        char *line = capture + len;
+        len += nmea_encode_packed(&fix, line, ENCODE_MAX_SENTENCE_LEN);
+        if (r % 500 == 1) {
+            line[10 + r / 512 % 40] = (char) ('!' + r / 8 % 90);
+        }
+        memcpy(capture + len, gsa, (size_t) gsaLen);
+        len += (size_t) gsaLen;
+    }
+    printf("COMPRESS BENCHMARK: %lu lines, %lu bytes\n", (unsigned long) sentences * 2, (unsigned long) len);
+    //Model compressor, serial and parallel decompression
+    size_t consumed = 0;
+    uint64_t start = nmea_wall_us();
+    size_t packedLen = nmea_compress(capture, len, true, packed, outCap, &consumed);
+    uint64_t compressUs = nmea_wall_us() - start;
+    start = nmea_wall_us();
+    size_t used = 0;
+    size_t raw = nmea_decompress(packed, packedLen, restored, cap, &used);
+    uint64_t decompressUs = nmea_wall_us() - start;
+    bool ok = (consumed == len && raw == len && memcmp(capture, restored, len) == 0);
+    memset(restored, 0, len);
+    start = nmea_wall_us();
+    raw = nmea_decompress_parallel(packed, packedLen, restored, cap, threads);
+    uint64_t parallelUs = nmea_wall_us() - start;
+    ok = ok && raw == len && memcmp(capture, restored, len) == 0;
+    printf("COMPRESS NMEA MODEL-----------------> ratio %.2f, compress %.1f MB/s, decompress %.1f MB/s (%d threads %.1f MB/s)\n",
+           packedLen ? (double) len / (double) packedLen : 0.0, benchRate(len, compressUs), benchRate(len, decompressUs),
+           threads, benchRate(len, parallelUs));
+    if (!ok) {
+        printf("ERROR: Compressed capture NOT restored byte for byte!\n");
+    }
+    //zlib on the same capture
+    static const int s_levels[] = { 1, 6, 9 };
+    for (size_t i = 0; i < sizeof(s_levels) / sizeof(s_levels[0]); i++) {
+        uLongf zlibLen = (uLongf) outCap;
+        start = nmea_wall_us();
+        int rc = compress2(packed, &zlibLen, (const Bytef*) capture, (uLong) len, s_levels[i]);
+        compressUs = nmea_wall_us() - start;
+        uLongf restoredLen = (uLongf) cap;
+        start = nmea_wall_us();
+        rc = (rc == Z_OK) ? uncompress((Bytef*) restored, &restoredLen, packed, zlibLen) : rc;
+        decompressUs = nmea_wall_us() - start;
+        if (rc != Z_OK || restoredLen != len || memcmp(capture, restored, len) != 0) {
+            printf("ERROR: zlib level %d round trip failed!\n", s_levels[i]);
+            continue;
+        }
+        printf("COMPRESS ZLIB LEVEL %d---------------> ratio %.2f, compress %.1f MB/s, decompress %.1f MB/s\n", s_levels[i],
+               zlibLen ? (double) len / (double) zlibLen : 0.0, benchRate(len, compressUs), benchRate(len, decompressUs));
+    }
+    free(capture);
+    free(restored);
+    free(packed);
+}
+#endif
@@ -0,0 +1,82 @@
+/**
+ * @brief Lossless compressor of raw NMEA captures which models the GGA field structure.
+ * -The capture is cut into independent blocks of whole lines. A GGA line is split into its 14 fields, every field is a
+ * -column with its own previous value: numbers are coded as the difference to the prediction (time is converted to
+ * -seconds of the day and predicted linearly), repeated text such as 'M' and the talker ID costs one bit, the number
+ * -format (leading zeros, decimals) is kept so the line is reproduced byte for byte, and the checksum is recomputed
+ * -instead of stored. Lines which cannot be reproduced from their fields (other sentences, bad checksums, noise) are
+ * -kept as literals, and a block is stored raw when modelling does not make it smaller.
+ * -Blocks do not depend on each other so they can be decompressed in parallel.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NMEA_COMPRESS_BLOCK_SIZE 65536  //Maximum raw bytes in one block
+#define NMEA_COMPRESS_HEADER_LEN 20     //Length of the block header
+//Output size which always holds the compressed data of len raw bytes
+#define NMEA_COMPRESS_BOUND(len) ((len) + ((len) / (NMEA_COMPRESS_BLOCK_SIZE / 2) + 1) * NMEA_COMPRESS_HEADER_LEN)
+
+/**
+ * @brief nmea_compress function compresses a capture into blocks
+ * @param in is the raw capture data
+ * @param len is the length of the data
+ * @param final is true if this is the end of the capture, otherwise data shorter than a block is left for the next call
+ * @param out is the output buffer
+ * @param cap is the size of the output buffer (NMEA_COMPRESS_BOUND(len) is always enough)
+ * @param consumed holds the number of raw bytes compressed, the rest has to be given again with the next data
+ * @return size_t is the number of bytes written or 0 if the output buffer is too small
+ */
+size_t nmea_compress(const char* , size_t , bool , uint8_t* , size_t , size_t* );
+
+/**
+ * @brief nmea_decompress function decompresses whole blocks
+ * @param in is the compressed data
+ * @param len is the length of the compressed data
+ * @param out is the output buffer
+ * @param cap is the size of the output buffer
+ * @param consumed holds the number of compressed bytes used, an incomplete block at the end is left for the next call
+ * @return size_t is the number of bytes written, (size_t) -1 if the data is corrupted or the output buffer is too small
+ */
+size_t nmea_decompress(const uint8_t* , size_t , char* , size_t , size_t* );
+
+/**
+ * @brief nmea_compressed_raw_len function reads the block headers to find the decompressed size
+ * @param in is the compressed data
+ * @param len is the length of the compressed data
+ * @param blocks holds the number of blocks (can be NULL)
+ * @return size_t is the decompressed size or (size_t) -1 if the headers are corrupted
+ */
+size_t nmea_compressed_raw_len(const uint8_t* , size_t , size_t* );
+
+#ifdef __linux__
+/**
+ * @brief nmea_decompress_parallel function decompresses all the blocks with several threads
+ * @param in is the compressed data
+ * @param len is the length of the compressed data
+ * @param out is the output buffer (nmea_compressed_raw_len bytes)
+ * @param cap is the size of the output buffer
+ * @param threads is the number of threads
+ * @return size_t is the number of bytes written or (size_t) -1 on error
+ */
+size_t nmea_decompress_parallel(const uint8_t* , size_t , char* , size_t , int );
+
+/**
+ * @brief nmea_compress_benchmark function compresses a generated capture, checks that serial and parallel
+ * -decompression give it back byte for byte and prints the ratio and the speed next to zlib (levels 1, 6 and 9)
+ * @param sentences is the number of GGA sentences in the capture (a GSA sentence follows every GGA)
+ * @param threads is the number of threads of the parallel decompression
+ * @return void
+ */
+void nmea_compress_benchmark(uint32_t , int );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gga_delta.h"
+#include "gga_encode.h"
+#include "gga_bench.h"
+
+/**
+ * @brief Copies the decoded value and the isEmpty/isFalse status of one field between two parse results
+ */
+#define COPY_FIELD(dst, src, member, status) do {                           \
+    (dst)->data.member = (src)->data.member;                                \
+    (dst)->isEmpty.isEmpty_##status = (src)->isEmpty.isEmpty_##status;      \
+    (dst)->isFalse.isFalse_##status = (src)->isFalse.isFalse_##status;      \
+} while (0)
+
+/**
+ * @brief copyField function copies one decoded field with its status into the cached result
+ * @param dst is the cached result
+ * @param src is the result with the newly decoded field
+ * @param field is the field (nmea_Field_t)
+ * @return void
+ */
+static void copyField(nmea_ParseResult_t *dst, const nmea_ParseResult_t *src, int field)
+{
+    switch (field) {
+    case NMEA_FIELD_TIME:
+        COPY_FIELD(dst, src, gpsData_time, time);
+        break;
+    case NMEA_FIELD_LATITUDE:
+        COPY_FIELD(dst, src, gpsData_position.LATITUDE.latDeg, latitude);
+        dst->data.gpsData_position.LATITUDE.latMin = src->data.gpsData_position.LATITUDE.latMin;
+        break;
+    case NMEA_FIELD_LATITUDE_IND:
+        COPY_FIELD(dst, src, gpsData_position.LATITUDE.latInd[0], latitudeInd);
+        break;
+    case NMEA_FIELD_LONGITUDE:
+        COPY_FIELD(dst, src, gpsData_position.LONGITUDE.longDeg, longitude);
+        dst->data.gpsData_position.LONGITUDE.longMin = src->data.gpsData_position.LONGITUDE.longMin;
+        break;
+    case NMEA_FIELD_LONGITUDE_IND:
+        COPY_FIELD(dst, src, gpsData_position.LONGITUDE.longInd[0], longitudeInd);
+        break;
+    case NMEA_FIELD_QIND:
+        COPY_FIELD(dst, src, gpsData_qIndicator, qInd);
+        break;
+    case NMEA_FIELD_SATELLITE:
+        COPY_FIELD(dst, src, gpsData_satTracked, satellite);
+        break;
+    case NMEA_FIELD_HDOP:
+        COPY_FIELD(dst, src, gpsData_hdop, hdop);
+        break;
+    case NMEA_FIELD_ALTITUDE:
+        COPY_FIELD(dst, src, gpsData_position.ALTITUDE.alt, altitude);
+        break;
+    case NMEA_FIELD_ALTITUDE_IND:
+        COPY_FIELD(dst, src, gpsData_position.ALTITUDE.altInd[0], altitudeInd);
+        break;
+    case NMEA_FIELD_GEOSEP:
+        COPY_FIELD(dst, src, gpsData_gS.gpsData_geoSep, geoSep);
+        break;
+    case NMEA_FIELD_GEOSEP_IND:
+        COPY_FIELD(dst, src, gpsData_gS.gpsData_geoSepInd[0], geoSepInd);
+        break;
+    case NMEA_FIELD_TDGPS:
+        COPY_FIELD(dst, src, gpsData_tDgps, tDgps);
+        break;
+    case NMEA_FIELD_DRSID:
+        memcpy(dst->data.gpsData_drsID, src->data.gpsData_drsID, DRS_ID_ARR_LEN);
+        dst->isEmpty.isEmpty_drsID = src->isEmpty.isEmpty_drsID;
+        dst->isFalse.isFalse_drsID = src->isFalse.isFalse_drsID;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief nmea_delta_init function clears the cache and the statistics
+ * @param delta is the delta state
+ * @return void
+ */
+void nmea_delta_init(nmea_Delta_t *delta)
+{
+    memset(delta, 0, sizeof(*delta));
+    nmea_gga_reset(&delta->result);
+}
+
+/**
+ * @brief nmea_delta_parse function parses a sentence of the receiver and decodes only the fields which changed since
+ * -its previous valid sentence
+ * @param delta is the delta state of the receiver (one task at a time)
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param result holds the parse result
+ * @param changed holds the bit of every field which changed (can be NULL)
+ * @return bool is true if the sentence is a GGA sentence with a valid checksum
+ */
+bool nmea_delta_parse(nmea_Delta_t *delta, const char *SENTENCE, size_t len, nmea_ParseResult_t *result, uint16_t *changed)
+{
+    nmea_FieldSlice_t field[NMEA_FIELD_COUNT];
+    delta->stats.sentences++;
+    if (!nmea_gga_split(SENTENCE, len, field)) {
+        //A corrupted sentence between two good ones does not throw the cache away
+        delta->stats.invalid++;
+        nmea_gga_reset(result);
+        result->isFalse.isFalse_gga = true;
+        if (changed != NULL) {
+            *changed = 0;
+        }
+        return false;
+    }
+    //Slices which differ from the cached text, length first
+    uint16_t mask = 0;
+    for (int i = 0; i < NMEA_FIELD_COUNT; i++) {
+        size_t fieldLen = field[i].len;
+        if (delta->hasPrevious && fieldLen == delta->len[i] && memcmp(field[i].ptr, delta->text[i], fieldLen) == 0) {
+            continue;
+        }
+        mask |= (uint16_t) (1u << i);
+        delta->stats.changes[i]++;
+        if (fieldLen <= DELTA_FIELD_CAPACITY) {
+            memcpy(delta->text[i], field[i].ptr, fieldLen);
+            delta->len[i] = (uint8_t) fieldLen;
+        }
+        else {
+            delta->len[i] = UINT8_MAX;
+        }
+    }
+    //Only the changed fields are decoded, into a fresh result so they start from the default values
+    if (mask == NMEA_ALL_FIELDS) {
+        nmea_gga_reset(&delta->result);
+        nmea_gga_decode(field, mask, &delta->result);
+    }
+    else if (mask != 0) {
+        nmea_ParseResult_t fresh;
+        nmea_gga_reset(&fresh);
+        nmea_gga_decode(field, mask, &fresh);
+        for (int i = 0; i < NMEA_FIELD_COUNT; i++) {
+            if (mask & (1u << i)) {
+                copyField(&delta->result, &fresh, i);
+            }
+        }
+    }
+    int decoded = __builtin_popcount(mask);
+    delta->stats.fieldsDecoded += (uint64_t) decoded;
+    delta->stats.fieldsReused += (uint64_t) (NMEA_FIELD_COUNT - decoded);
+    delta->hasPrevious = true;
+    *result = delta->result;
+    if (changed != NULL) {
+        *changed = mask;
+    }
+    return true;
+}
+
+/**
+ * @brief nmea_delta_print function prints the delta parsing statistics to console
+ * @param delta is the delta state
+ * @return void
+ */
+void nmea_delta_print(const nmea_Delta_t *delta)
+{
+    static const char *const s_names[NMEA_FIELD_COUNT] = {
+        "TIME", "LAT", "LAT IND", "LON", "LON IND", "QIND", "SAT", "HDOP", "ALT", "ALT IND", "GEOSEP", "GEOSEP IND",
+        "TDGPS", "DRS ID"
+    };
+    const nmea_DeltaStats_t *stats = &delta->stats;
+    uint64_t fields = stats->fieldsDecoded + stats->fieldsReused;
+    printf("DELTA SENTENCES/INVALID-------------> %llu/%llu\n", (unsigned long long) stats->sentences,
+           (unsigned long long) stats->invalid);
+    printf("DELTA FIELDS DECODED/REUSED---------> %llu/%llu (%.1f%% reused)\n", (unsigned long long) stats->fieldsDecoded,
+           (unsigned long long) stats->fieldsReused, (fields != 0) ? 100.0 * (double) stats->fieldsReused / (double) fields : 0.0);
+    printf("DELTA CHANGES PER FIELD-------------> ");
+    for (int i = 0; i < NMEA_FIELD_COUNT; i++) {
+        printf("%s%s %llu", (i != 0) ? ", " : "", s_names[i], (unsigned long long) stats->changes[i]);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief nmea_delta_benchmark function compares delta parsing with full parsing on the capture of a base station
+ * @param sentences is the number of sentences in the capture
+ * @return void
+ */
+void nmea_delta_benchmark(uint32_t sentences)
+{
+    static nmea_Delta_t s_delta;
+    size_t size = (size_t) sentences * ENCODE_MAX_SENTENCE_LEN;
+    char *capture = malloc(size);
+    nmea_PackedFix_t *expected = malloc((size_t) sentences * sizeof(nmea_PackedFix_t));
+    if (capture == NULL || expected == NULL) {
+        printf("ERROR: No memory for the delta benchmark!\n");
+        free(capture);
+        free(expected);
+        return;
+    }
+    //10 Hz base station: the position digits jitter now and then, the satellites and the HDOP change slowly
+    uint32_t rng = 0x2545F491u;
+    size_t len = 0;
+    nmea_PackedFix_t fix = { 0 };
+    fix.latitude = 20056618;
+    fix.longitude = -70313858;
+    fix.altitude = 2700;
+    fix.geoSep = -3420;
+    fix.qIndicator = 2;
+    fix.satTracked = 10;
+    fix.hdop = 90;
+    fix.drsID = 120;
+    fix.tDgps = 150;
+    for (uint32_t i = 0; i < sentences; i++) {
+        uint32_t r = nmea_bench_random(&rng);
+        fix.timeMs = (i * 100u) % 86400000u;
+        if (r % 16 == 0) {
+            fix.latitude = 20056618 + (int32_t) (r >> 28);
+        }
+        if (r % 16 == 1) {
+            fix.longitude = -70313858 - (int32_t) (r >> 28);
+        }
+        if (r % 32 == 2) {
+            fix.altitude = 2700 + (int32_t) (r >> 29);
+        }
+        if (r % 256 == 3) {
+            fix.satTracked = (uint8_t) (9 + (r >> 30));
+            fix.hdop = (uint16_t) (80 + (r >> 28));
+        }
+        len += nmea_encode_packed(&fix, capture + len, size - len);
+    }
+    //Full parse of every field
+    nmea_ParseResult_t result;
+    uint32_t parsed = 0;
+    uint64_t start = nmea_wall_us();
+    for (const char *p = capture, *nl; p < capture + len && (nl = memchr(p, '\n', (size_t) (capture + len - p))) != NULL; p = nl + 1) {
+        if (nmea_gga_parse_r(p, (size_t) (nl + 1 - p), &result)) {
+            nmea_pack_fix(&result, &expected[parsed++]);
+        }
+    }
+    uint64_t fullUs = nmea_wall_us() - start;
+    //Delta parse, the changed mask is summed so the loop is not optimized away
+    nmea_delta_init(&s_delta);
+    uint64_t changedFields = 0;
+    uint32_t mismatches = 0;
+    uint32_t index = 0;
+    uint16_t changed;
+    start = nmea_wall_us();
+    for (const char *p = capture, *nl; p < capture + len && (nl = memchr(p, '\n', (size_t) (capture + len - p))) != NULL; p = nl + 1) {
+        if (nmea_delta_parse(&s_delta, p, (size_t) (nl + 1 - p), &result, &changed)) {
+            changedFields += (uint64_t) __builtin_popcount(changed);
+            index++;
+        }
+    }
+    uint64_t deltaUs = nmea_wall_us() - start;
+    //Same fixes as the full parse, checked outside of the timed loop
+    nmea_delta_init(&s_delta);
+    index = 0;
+    for (const char *p = capture, *nl; p < capture + len && (nl = memchr(p, '\n', (size_t) (capture + len - p))) != NULL; p = nl + 1) {
+        nmea_PackedFix_t packed;
+        if (nmea_delta_parse(&s_delta, p, (size_t) (nl + 1 - p), &result, NULL)) {
+            nmea_pack_fix(&result, &packed);
+            mismatches += (index >= parsed || memcmp(&packed, &expected[index], sizeof(packed)) != 0);
+            index++;
+        }
+    }
+    printf("DELTA BENCHMARK: %lu sentences of a base station, %lu bytes\n", (unsigned long) sentences, (unsigned long) len);
+    nmea_delta_print(&s_delta);
+    printf("DELTA FULL PARSE--------------------> %.0f sentences/s (%llu us)\n",
+           (fullUs != 0) ? (double) parsed * 1e6 / (double) fullUs : 0.0, (unsigned long long) fullUs);
+    printf("DELTA INCREMENTAL PARSE-------------> %.0f sentences/s (%llu us, %.2f fields changed per sentence)\n",
+           (deltaUs != 0) ? (double) index * 1e6 / (double) deltaUs : 0.0, (unsigned long long) deltaUs,
+           (index != 0) ? (double) changedFields / (double) index : 0.0);
+    if (mismatches != 0 || index != parsed) {
+        printf("ERROR: Delta parsing gave %lu different fixes!\n", (unsigned long) mismatches);
+    }
+    free(capture);
+    free(expected);
+}
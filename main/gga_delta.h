@@ -0,0 +1,80 @@
+/**
+ * @brief Incremental (delta) parsing of the GGA sentences of one receiver.
+ * -Consecutive sentences of a base station or of a slow vehicle differ only in the time and in a few trailing digits.
+ * -The state keeps the text of every data field of the previous valid sentence with its decoded value and status.
+ * -After the prefix and checksum check every field slice is compared with the cached text: only the changed fields are
+ * -validated and converted again, the others keep the cached value and status. The bitmask of the changed fields is
+ * -given to the caller, so the consumers can skip their own work for the unchanged ones too.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DELTA_FIELD_CAPACITY 16         //Cached charachters per field, longer fields are decoded every time
+
+/**
+ * @brief Delta parsing statistics
+ */
+typedef struct {
+    uint64_t sentences;
+    uint64_t invalid;                   //no GGA sentence or wrong checksum, the cache is kept
+    uint64_t fieldsDecoded;             //fields validated and converted
+    uint64_t fieldsReused;              //fields taken from the cache
+    uint64_t changes[NMEA_FIELD_COUNT]; //sentences in which the field changed (nmea_Field_t)
+} nmea_DeltaStats_t;
+
+/**
+ * @brief Delta state of one receiver, initialize with nmea_delta_init
+ */
+typedef struct {
+    bool hasPrevious;                   //a valid sentence is cached
+    uint8_t len[NMEA_FIELD_COUNT];      //length of the cached text, UINT8_MAX if the field was too long to be cached
+    char text[NMEA_FIELD_COUNT][DELTA_FIELD_CAPACITY];
+    nmea_ParseResult_t result;          //decoded fields of the previous valid sentence
+    nmea_DeltaStats_t stats;
+} nmea_Delta_t;
+
+/**
+ * @brief nmea_delta_init function clears the cache and the statistics
+ * @param delta is the delta state
+ * @return void
+ */
+void nmea_delta_init(nmea_Delta_t* );
+
+/**
+ * @brief nmea_delta_parse function parses a sentence of the receiver and decodes only the fields which changed since
+ * -its previous valid sentence, the result is the same as the one of nmea_gga_parse_r
+ * @param delta is the delta state of the receiver (one task at a time)
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param result holds the parse result
+ * @param changed holds the bit of every field which changed (nmea_Field_t), NMEA_ALL_FIELDS for the first sentence
+ * -and 0 for an invalid one (can be NULL)
+ * @return bool is true if the sentence is a GGA sentence with a valid checksum
+ */
+bool nmea_delta_parse(nmea_Delta_t* , const char* , size_t , nmea_ParseResult_t* , uint16_t* );
+
+/**
+ * @brief nmea_delta_print function prints the delta parsing statistics to console
+ * @param delta is the delta state
+ * @return void
+ */
+void nmea_delta_print(const nmea_Delta_t* );
+
+/**
+ * @brief nmea_delta_benchmark function compares delta parsing with full parsing on the capture of a base station
+ * -and checks that both give the same fixes
+ * @param sentences is the number of sentences in the capture
+ * @return void
+ */
+void nmea_delta_benchmark(uint32_t );
+
+#ifdef __cplusplus
+}
+#endif
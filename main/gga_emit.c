@@ -0,0 +1,458 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gga_emit.h"
+#include "gga_bench.h"
+
+#define BENCH_BUFFER_LEN 16384          //Output buffer of the benchmark, flushed (dropped) when full like a socket write
+
+/**
+ * @brief State of a field in the record
+ */
+typedef enum {
+    FIELD_OK = 0,
+    FIELD_EMPTY,
+    FIELD_INVALID
+} fieldState_t;
+
+/**
+ * @brief putStr function copies a string literal into the output
+ * @param p is the output position
+ * @param str is the string
+ * @param len is the length of the string
+ * @return char* is the new output position
+ */
+static inline char* putStr(char *p, const char *str, size_t len)
+{
+    memcpy(p, str, len);
+    return p + len;
+}
+
+#define PUT_LITERAL(p, lit) putStr((p), (lit), sizeof(lit) - 1)
+
+/**
+ * @brief putUint function writes an unsigned integer in decimal
+ * @param p is the output position
+ * @param value is the value
+ * @return char* is the new output position
+ */
+static char* putUint(char *p, uint64_t value)
+{
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+/**
+ * @brief putFixed function writes a fixed-point value i.e., scaled / 10^decimals
+ * @param p is the output position
+ * @param scaled is the scaled integer value
+ * @param decimals is the number of decimals (1 to 9)
+ * @return char* is the new output position
+ */
+static char* putFixed(char *p, int64_t scaled, int decimals)
+{
+    static const uint32_t s_pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    uint64_t magnitude = (scaled < 0) ? (uint64_t) -scaled : (uint64_t) scaled;
+    if (scaled < 0) {
+        *p++ = '-';
+    }
+    p = putUint(p, magnitude / s_pow10[decimals]);
+    *p++ = '.';
+    uint32_t frac = (uint32_t) (magnitude % s_pow10[decimals]);
+    for (int i = decimals - 1; i >= 0; i--) {
+        p[i] = (char) ('0' + frac % 10);
+        frac /= 10;
+    }
+    return p + decimals;
+}
+
+/**
+ * @brief putTime function writes the time of the day as hh:mm:ss.sss
+ * @param p is the output position
+ * @param timeMs is the time of the day in milliseconds
+ * @return char* is the new output position
+ */
+static char* putTime(char *p, uint32_t timeMs)
+{
+    uint32_t hour = timeMs / 3600000u;
+    uint32_t minutes = timeMs / 60000u % 60u;
+    uint32_t ms = timeMs % 60000u;
+    p[0] = (char) ('0' + hour / 10 % 10);
+    p[1] = (char) ('0' + hour % 10);
+    p[2] = ':';
+    p[3] = (char) ('0' + minutes / 10);
+    p[4] = (char) ('0' + minutes % 10);
+    p[5] = ':';
+    p[6] = (char) ('0' + ms / 10000);
+    p[7] = (char) ('0' + ms / 1000 % 10);
+    p[8] = '.';
+    p[9] = (char) ('0' + ms / 100 % 10);
+    p[10] = (char) ('0' + ms / 10 % 10);
+    p[11] = (char) ('0' + ms % 10);
+    return p + 12;
+}
+
+/**
+ * @brief putDegrees function writes a coordinate given in 1/10000 of a minute as decimal degrees (7 decimals)
+ * @param p is the output position
+ * @param value is the coordinate
+ * @return char* is the new output position
+ */
+static char* putDegrees(char *p, int32_t value)
+{
+    uint32_t magnitude = (value < 0) ? (uint32_t) -value : (uint32_t) value;
+    //1/10000 minute = 1/600000 degree, the 7 decimals are rem * 10^7 / 600000 = rem * 100 / 6 (rounded)
+    int64_t scaled = (int64_t) (magnitude / 600000u) * 10000000 + ((int64_t) (magnitude % 600000u) * 100 + 3) / 6;
+    return putFixed(p, (value < 0) ? -scaled : scaled, 7);
+}
+
+/**
+ * @brief fieldState function gives the state of one or two (value + indicator) fields
+ * @param fix is the packed fix
+ * @param mask is the bit mask of the fields
+ * @return fieldState_t is the state
+ */
+static inline fieldState_t fieldState(const nmea_PackedFix_t *fix, uint16_t mask)
+{
+    if (fix->falseMask & mask) return FIELD_INVALID;
+    if (fix->emptyMask & mask) return FIELD_EMPTY;
+    return FIELD_OK;
+}
+
+#define BIT(field) ((uint16_t) (1u << (field)))
+
+/**
+ * @brief Fields of a record in output order, same order for every format
+ */
+typedef enum {
+    OUT_TIME = 0,
+    OUT_LAT,
+    OUT_LON,
+    OUT_QUALITY,
+    OUT_SATELLITES,
+    OUT_HDOP,
+    OUT_ALTITUDE,
+    OUT_GEOSEP,
+    OUT_DGPS_AGE,
+    OUT_DRS_ID,
+    OUT_COUNT
+} outField_t;
+
+static const char *const s_names[OUT_COUNT] = {
+    "time", "lat", "lon", "quality", "satellites", "hdop", "altitude", "geoid_sep", "dgps_age", "drs_id"
+};
+
+static const uint16_t s_masks[OUT_COUNT] = {
+    BIT(NMEA_FIELD_TIME),
+    BIT(NMEA_FIELD_LATITUDE) | BIT(NMEA_FIELD_LATITUDE_IND),
+    BIT(NMEA_FIELD_LONGITUDE) | BIT(NMEA_FIELD_LONGITUDE_IND),
+    BIT(NMEA_FIELD_QIND),
+    BIT(NMEA_FIELD_SATELLITE),
+    BIT(NMEA_FIELD_HDOP),
+    BIT(NMEA_FIELD_ALTITUDE),
+    BIT(NMEA_FIELD_GEOSEP),
+    BIT(NMEA_FIELD_TDGPS),
+    BIT(NMEA_FIELD_DRSID)
+};
+
+/**
+ * @brief putValue function writes the value of one output field
+ * @param p is the output position
+ * @param fix is the packed fix
+ * @param field is the output field
+ * @param quoteTime is true when the time has to be a quoted string (JSON, line protocol)
+ * @return char* is the new output position
+ */
+static char* putValue(char *p, const nmea_PackedFix_t *fix, outField_t field, bool quoteTime)
+{
+    switch (field) {
+    case OUT_TIME:
+        if (quoteTime) *p++ = '"';
+        p = putTime(p, fix->timeMs);
+        if (quoteTime) *p++ = '"';
+        return p;
+    case OUT_LAT:        return putDegrees(p, fix->latitude);
+    case OUT_LON:        return putDegrees(p, fix->longitude);
+    case OUT_QUALITY:    return putUint(p, fix->qIndicator);
+    case OUT_SATELLITES: return putUint(p, fix->satTracked);
+    case OUT_HDOP:       return putFixed(p, fix->hdop, 2);
+    case OUT_ALTITUDE:   return putFixed(p, fix->altitude, 2);
+    case OUT_GEOSEP:     return putFixed(p, fix->geoSep, 2);
+    case OUT_DGPS_AGE:   return putFixed(p, fix->tDgps, 2);
+    case OUT_DRS_ID:     return putUint(p, fix->drsID);
+    default:             return p;
+    }
+}
+
+/**
+ * @brief emitRecord function writes one record, the output must have room for EMIT_MAX_RECORD_LEN bytes
+ * @param format is the output format
+ * @param fix is the packed fix
+ * @param out is the output buffer
+ * @return size_t is the number of bytes written
+ */
+static size_t emitRecord(nmea_EmitFormat_t format, const nmea_PackedFix_t *fix, char *out)
+{
+    char *p = out;
+    bool first = true;
+    if (format == NMEA_EMIT_JSON) {
+        *p++ = '{';
+    }
+    else if (format == NMEA_EMIT_LINE_PROTOCOL) {
+        p = PUT_LITERAL(p, "gga ");
+    }
+    for (int i = 0; i < OUT_COUNT; i++) {
+        fieldState_t state = fieldState(fix, s_masks[i]);
+        size_t nameLen = strlen(s_names[i]);
+        switch (format) {
+        case NMEA_EMIT_JSON:
+            if (!first) *p++ = ',';
+            *p++ = '"';
+            p = putStr(p, s_names[i], nameLen);
+            p = PUT_LITERAL(p, "\":");
+            if (state == FIELD_EMPTY) p = PUT_LITERAL(p, "null");
+            else if (state == FIELD_INVALID) p = PUT_LITERAL(p, "\"invalid\"");
+            else p = putValue(p, fix, (outField_t) i, true);
+            break;
+        case NMEA_EMIT_CSV:
+            if (!first) *p++ = ',';
+            if (state == FIELD_INVALID) p = PUT_LITERAL(p, "invalid");
+            else if (state == FIELD_OK) p = putValue(p, fix, (outField_t) i, false);
+            break;
+        case NMEA_EMIT_LINE_PROTOCOL:
+            if (state != FIELD_OK) continue;
+            if (!first) *p++ = ',';
+            p = putStr(p, s_names[i], nameLen);
+            *p++ = '=';
+            p = putValue(p, fix, (outField_t) i, true);
+            //Integer fields need the 'i' suffix, otherwise they are stored as floats
+            if (i == OUT_QUALITY || i == OUT_SATELLITES || i == OUT_DRS_ID) *p++ = 'i';
+            break;
+        }
+        first = false;
+    }
+    switch (format) {
+    case NMEA_EMIT_JSON:
+        p = PUT_LITERAL(p, ",\"empty\":");
+        p = putUint(p, fix->emptyMask);
+        p = PUT_LITERAL(p, ",\"invalid\":");
+        p = putUint(p, fix->falseMask);
+        *p++ = '}';
+        break;
+    case NMEA_EMIT_CSV:
+        *p++ = ',';
+        p = putUint(p, fix->emptyMask);
+        *p++ = ',';
+        p = putUint(p, fix->falseMask);
+        break;
+    case NMEA_EMIT_LINE_PROTOCOL:
+        if (!first) *p++ = ',';
+        p = PUT_LITERAL(p, "empty=");
+        p = putUint(p, fix->emptyMask);
+        p = PUT_LITERAL(p, "i,invalid=");
+        p = putUint(p, fix->falseMask);
+        *p++ = 'i';
+        break;
+    }
+    *p++ = '\n';
+    return (size_t) (p - out);
+}
+
+/**
+ * @brief nmea_emit_packed function writes one packed fix followed by '\n' into the buffer
+ * @param format is the output format
+ * @param fix is the packed fix
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written (no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_emit_packed(nmea_EmitFormat_t format, const nmea_PackedFix_t *fix, char *buffer, size_t size)
+{
+    if (size >= EMIT_MAX_RECORD_LEN) {
+        return emitRecord(format, fix, buffer);
+    }
+    //Small buffers go through a scratch record, the length is only known after formatting
+    char scratch[EMIT_MAX_RECORD_LEN];
+    size_t len = emitRecord(format, fix, scratch);
+    if (len > size) {
+        return 0;
+    }
+    memcpy(buffer, scratch, len);
+    return len;
+}
+
+/**
+ * @brief nmea_emit_fix function writes one parse result followed by '\n' into the buffer
+ * @param format is the output format
+ * @param result is the parse result
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written (no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_emit_fix(nmea_EmitFormat_t format, const nmea_ParseResult_t *result, char *buffer, size_t size)
+{
+    nmea_PackedFix_t fix;
+    nmea_pack_fix(result, &fix);
+    return nmea_emit_packed(format, &fix, buffer, size);
+}
+
+/**
+ * @brief nmea_emit_batch function writes as many packed fixes as fit into the buffer
+ * @param format is the output format
+ * @param fixes is the array of packed fixes
+ * @param count is the number of fixes in the array
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @param emitted holds the number of fixes written (can be NULL)
+ * @return size_t is the number of bytes written
+ */
+size_t nmea_emit_batch(nmea_EmitFormat_t format, const nmea_PackedFix_t *fixes, size_t count, char *buffer, size_t size, size_t *emitted)
+{
+    size_t used = 0;
+    size_t i = 0;
+    //Direct writes while a whole record surely fits, then the checked path for the tail of the buffer
+    for (; i < count && size - used >= EMIT_MAX_RECORD_LEN; i++) {
+        used += emitRecord(format, &fixes[i], buffer + used);
+    }
+    for (; i < count; i++) {
+        size_t len = nmea_emit_packed(format, &fixes[i], buffer + used, size - used);
+        if (len == 0) {
+            break;
+        }
+        used += len;
+    }
+    if (emitted != NULL) {
+        *emitted = i;
+    }
+    return used;
+}
+
+/**
+ * @brief nmea_emit_csv_header function writes the CSV header line into the buffer
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written or 0 if the buffer is too small
+ */
+size_t nmea_emit_csv_header(char *buffer, size_t size)
+{
+    static const char s_header[] = "time,lat,lon,quality,satellites,hdop,altitude,geoid_sep,dgps_age,drs_id,empty,invalid\n";
+    if (size < sizeof(s_header) - 1) {
+        return 0;
+    }
+    memcpy(buffer, s_header, sizeof(s_header) - 1);
+    return sizeof(s_header) - 1;
+}
+
+/**
+ * @brief printfCsv function is the snprintf formatter the benchmark compares with, it writes the same CSV record as
+ * -nmea_emit_packed for a fix without empty or incorrect fields
+ * @param fix is the packed fix
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written
+ */
+static size_t printfCsv(const nmea_PackedFix_t *fix, char *buffer, size_t size)
+{
+    uint32_t lat = (fix->latitude < 0) ? (uint32_t) -fix->latitude : (uint32_t) fix->latitude;
+    uint32_t lon = (fix->longitude < 0) ? (uint32_t) -fix->longitude : (uint32_t) fix->longitude;
+    uint32_t alt = (fix->altitude < 0) ? (uint32_t) -fix->altitude : (uint32_t) fix->altitude;
+    uint32_t sep = (fix->geoSep < 0) ? (uint32_t) -fix->geoSep : (uint32_t) fix->geoSep;
+    int len = snprintf(buffer, size, "%02lu:%02lu:%02lu.%03lu,%s%lu.%07lu,%s%lu.%07lu,%u,%u,%u.%02u,%s%lu.%02lu,%s%lu.%02lu,%lu.%02lu,%u,%u,%u\n",
+                       (unsigned long) (fix->timeMs / 3600000u), (unsigned long) (fix->timeMs / 60000u % 60u),
+                       (unsigned long) (fix->timeMs / 1000u % 60u), (unsigned long) (fix->timeMs % 1000u),
+                       (fix->latitude < 0) ? "-" : "", (unsigned long) (lat / 600000u), (unsigned long) ((lat % 600000u * 100u + 3) / 6),
+                       (fix->longitude < 0) ? "-" : "", (unsigned long) (lon / 600000u), (unsigned long) ((lon % 600000u * 100u + 3) / 6),
+                       fix->qIndicator, fix->satTracked, fix->hdop / 100u, fix->hdop % 100u,
+                       (fix->altitude < 0) ? "-" : "", (unsigned long) (alt / 100u), (unsigned long) (alt % 100u),
+                       (fix->geoSep < 0) ? "-" : "", (unsigned long) (sep / 100u), (unsigned long) (sep % 100u),
+                       (unsigned long) (fix->tDgps / 100u), (unsigned long) (fix->tDgps % 100u), fix->drsID,
+                       fix->emptyMask, fix->falseMask);
+    return (len > 0 && (size_t) len < size) ? (size_t) len : 0;
+}
+
+/**
+ * @brief nmea_emit_benchmark function formats generated fixes with nmea_emit_batch in every format and with an
+ * -snprintf formatter writing the same CSV, checks that both CSV outputs are equal and prints the throughput in MB/s
+ * @param fixes is the number of fixes
+ * @return void
+ */
+void nmea_emit_benchmark(uint32_t fixes)
+{
+    static const char *const s_formats[] = { "JSON", "CSV", "LINE PROTOCOL" };
+    nmea_PackedFix_t *fix = malloc((size_t) fixes * sizeof(nmea_PackedFix_t));
+    char *buffer = malloc(BENCH_BUFFER_LEN);
+    char *check = malloc(BENCH_BUFFER_LEN);
+    if (fix == NULL || buffer == NULL || check == NULL || fixes == 0) {
+        printf("ERROR: No memory for the emit benchmark!\n");
+        free(fix);
+        free(buffer);
+        free(check);
+        return;
+    }
+    //Moving rover at 10 Hz, RTK float/fixed with DGPS corrections, so every field has a value
+    uint32_t rng = 0x2545F491u;
+    for (uint32_t i = 0; i < fixes; i++) {
+        fix[i] = (nmea_PackedFix_t) { 0 };
+        fix[i].timeMs = (i * 100u) % 86400000u;
+        fix[i].latitude = 20056618 + (int32_t) (nmea_bench_random(&rng) % 65536);
+        fix[i].longitude = -70313858 - (int32_t) (nmea_bench_random(&rng) % 65536);
+        fix[i].altitude = 2700 + (int32_t) (nmea_bench_random(&rng) % 4000) - 2000;
+        fix[i].geoSep = -3420;
+        fix[i].tDgps = nmea_bench_random(&rng) % 500;
+        fix[i].hdop = (uint16_t) (60 + nmea_bench_random(&rng) % 200);
+        fix[i].drsID = 120;
+        fix[i].qIndicator = (uint8_t) (4 + nmea_bench_random(&rng) % 2);
+        fix[i].satTracked = (uint8_t) (4 + nmea_bench_random(&rng) % 9);
+    }
+    printf("EMIT BENCHMARK: %lu fixes, %d byte buffer\n", (unsigned long) fixes, BENCH_BUFFER_LEN);
+    for (int format = NMEA_EMIT_JSON; format <= NMEA_EMIT_LINE_PROTOCOL; format++) {
+        uint64_t bytes = 0;
+        uint64_t start = nmea_wall_us();
+        for (size_t done = 0, emitted = 0; done < fixes; done += emitted) {
+            bytes += nmea_emit_batch((nmea_EmitFormat_t) format, &fix[done], fixes - done, buffer, BENCH_BUFFER_LEN, &emitted);
+        }
+        uint64_t us = nmea_wall_us() - start;
+        //Label padded with dashes to the column of the other lines
+        printf("EMIT %s%.*s> %.1f MB/s, %.0f fixes/s (%llu bytes, %llu us)\n", s_formats[format],
+               (int) (31 - strlen(s_formats[format])), "-------------------------------",
+               (us != 0) ? (double) bytes / (double) us : 0.0, (us != 0) ? (double) fixes * 1e6 / (double) us : 0.0,
+               (unsigned long long) bytes, (unsigned long long) us);
+    }
+    //The same CSV with snprintf, one record at a time into the same buffer
+    uint64_t bytes = 0;
+    uint64_t start = nmea_wall_us();
+    for (uint32_t i = 0, used = 0; i < fixes; i++) {
+        if (BENCH_BUFFER_LEN - used < EMIT_MAX_RECORD_LEN) {
+            bytes += used;
+            used = 0;
+        }
+        used += (uint32_t) printfCsv(&fix[i], buffer + used, BENCH_BUFFER_LEN - used);
+        if (i + 1 == fixes) {
+            bytes += used;
+        }
+    }
+    uint64_t us = nmea_wall_us() - start;
+    printf("EMIT CSV WITH SNPRINTF--------------> %.1f MB/s, %.0f fixes/s (%llu bytes, %llu us)\n",
+           (us != 0) ? (double) bytes / (double) us : 0.0, (us != 0) ? (double) fixes * 1e6 / (double) us : 0.0,
+           (unsigned long long) bytes, (unsigned long long) us);
+    //Both formatters give the same records, checked outside of the timed loops
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < fixes; i++) {
+        size_t len = nmea_emit_packed(NMEA_EMIT_CSV, &fix[i], buffer, EMIT_MAX_RECORD_LEN);
+        mismatches += (len == 0 || printfCsv(&fix[i], check, EMIT_MAX_RECORD_LEN) != len || memcmp(buffer, check, len) != 0);
+    }
+    if (mismatches != 0) {
+        printf("ERROR: %lu CSV records differ from snprintf!\n", (unsigned long) mismatches);
+    }
+    free(fix);
+    free(buffer);
+    free(check);
+}
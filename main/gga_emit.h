@@ -0,0 +1,79 @@
+/**
+ * @brief Serializers of parsed fixes into caller buffers as JSON, CSV or InfluxDB line protocol.
+ * -The numbers are written with integer/fixed-point digit routines (no printf, no locale, no allocation).
+ * -Empty fields are written as null (JSON) or an empty cell (CSV), incorrect fields as "invalid" (JSON and CSV).
+ * -Line protocol has no null value so empty and incorrect fields are left out, the "empty" and "invalid" integer
+ * -fields always carry the nmea_Field_t bit masks.
+ * -The latitude/longitude are signed decimal degrees, they are empty or incorrect when the indicator is.
+*/
+
+#pragma once
+
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EMIT_MAX_RECORD_LEN 320         //Buffer size which always holds one record in any format
+
+/**
+ * @brief Output formats
+ */
+typedef enum {
+    NMEA_EMIT_JSON = 0,                 //one JSON object per line
+    NMEA_EMIT_CSV,                      //one CSV row per line, see nmea_emit_csv_header
+    NMEA_EMIT_LINE_PROTOCOL             //InfluxDB line protocol, measurement "gga"
+} nmea_EmitFormat_t;
+
+/**
+ * @brief nmea_emit_fix function writes one parse result followed by '\n' into the buffer
+ * @param format is the output format
+ * @param result is the parse result
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written (no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_emit_fix(nmea_EmitFormat_t , const nmea_ParseResult_t* , char* , size_t );
+
+/**
+ * @brief nmea_emit_packed function writes one packed fix followed by '\n' into the buffer
+ * @param format is the output format
+ * @param fix is the packed fix
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written (no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_emit_packed(nmea_EmitFormat_t , const nmea_PackedFix_t* , char* , size_t );
+
+/**
+ * @brief nmea_emit_batch function writes as many packed fixes as fit into the buffer
+ * @param format is the output format
+ * @param fixes is the array of packed fixes
+ * @param count is the number of fixes in the array
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @param emitted holds the number of fixes written (can be NULL)
+ * @return size_t is the number of bytes written
+ */
+size_t nmea_emit_batch(nmea_EmitFormat_t , const nmea_PackedFix_t* , size_t , char* , size_t , size_t* );
+
+/**
+ * @brief nmea_emit_csv_header function writes the CSV header line into the buffer
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written or 0 if the buffer is too small
+ */
+size_t nmea_emit_csv_header(char* , size_t );
+
+/**
+ * @brief nmea_emit_benchmark function formats generated fixes with nmea_emit_batch in every format and with an
+ * -snprintf formatter writing the same CSV, checks that both CSV outputs are equal and prints the throughput in MB/s
+ * @param fixes is the number of fixes
+ * @return void
+ */
+void nmea_emit_benchmark(uint32_t );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gga_encode.h"
+#include "gga_bench.h"
+
+/**
+ * @brief Output position and the checksum of everything written after '$'
+ */
+typedef struct {
+    char *p;
+    uint8_t checksum;
+} encoder_t;
+
+static const char s_digitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char s_hexDigits[] = "0123456789ABCDEF";
+
+#define BIT(field) ((uint16_t) (1u << (field)))
+
+/**
+ * @brief putChar function writes one charachter
+ * @param w is the encoder
+ * @param c is the charachter
+ * @return void
+ */
+static inline void putChar(encoder_t *w, char c)
+{
+    *w->p++ = c;
+    w->checksum ^= (uint8_t) c;
+}
+
+/**
+ * @brief putDigits function writes an unsigned integer in decimal with leading zeros up to minDigits
+ * @param w is the encoder
+ * @param value is the value
+ * @param minDigits is the minimum number of digits
+ * @return void
+ */
+static inline void putDigits(encoder_t *w, uint32_t value, int minDigits)
+{
+    int count = 1;
+    for (uint32_t v = value; v >= 10; v /= 10) {
+        count++;
+    }
+    if (count < minDigits) {
+        count = minDigits;
+    }
+    //Written backwards from the end, two digits at a time
+    char *end = w->p + count;
+    char *p = end;
+    uint8_t checksum = w->checksum;
+    for (; count >= 2; count -= 2) {
+        const char *pair = &s_digitPairs[(value % 100) * 2];
+        value /= 100;
+        p -= 2;
+        p[0] = pair[0];
+        p[1] = pair[1];
+        checksum ^= (uint8_t) (pair[0] ^ pair[1]);
+    }
+    if (count == 1) {
+        *--p = (char) ('0' + value % 10);
+        checksum ^= (uint8_t) *p;
+    }
+    w->p = end;
+    w->checksum = checksum;
+}
+
+/**
+ * @brief putFixed function writes a fixed-point value with 2 decimals i.e., scaled / 100
+ * @param w is the encoder
+ * @param scaled is the value in 1/100
+ * @return void
+ */
+static inline void putFixed(encoder_t *w, int64_t scaled)
+{
+    uint64_t magnitude = (scaled < 0) ? (uint64_t) -scaled : (uint64_t) scaled;
+    if (scaled < 0) {
+        putChar(w, '-');
+    }
+    putDigits(w, (uint32_t) (magnitude / 100), 1);
+    putChar(w, '.');
+    putDigits(w, (uint32_t) (magnitude % 100), 2);
+}
+
+/**
+ * @brief putCoordinate function writes a coordinate given in 1/10000 of a minute as (d)ddmm.mmmm and its indicator
+ * @param w is the encoder
+ * @param value is the coordinate (negative for S/W)
+ * @param degDigits is the number of degree digits (2 for latitude, 3 for longitude)
+ * @param valueOk is true if the coordinate is written (otherwise it is an empty field)
+ * @param indOk is true if the indicator is written (otherwise it is an empty field)
+ * @param ind is the positive/negative indicator pair e.g., "NS"
+ * @return void
+ */
+static void putCoordinate(encoder_t *w, int32_t value, int degDigits, bool valueOk, bool indOk, const char *ind)
+{
+    uint32_t magnitude = (value < 0) ? (uint32_t) -value : (uint32_t) value;
+    if (valueOk) {
+        uint32_t minutes = magnitude % 600000u;
+        putDigits(w, magnitude / 600000u, degDigits);
+        putDigits(w, minutes / 10000u, 2);
+        putChar(w, '.');
+        putDigits(w, minutes % 10000u, 4);
+    }
+    putChar(w, ',');
+    if (indOk) {
+        putChar(w, ind[value < 0]);
+    }
+    putChar(w, ',');
+}
+
+/**
+ * @brief encodeSentence function writes one sentence, the output must have room for ENCODE_MAX_SENTENCE_LEN bytes
+ * @param fix is the packed fix
+ * @param out is the output buffer
+ * @return size_t is the number of bytes written
+ */
+static size_t encodeSentence(const nmea_PackedFix_t *fix, char *out)
+{
+    uint16_t bad = fix->emptyMask | fix->falseMask;
+    //"GPGGA," is the same for every sentence, its checksum is a constant
+    memcpy(out, "$GPGGA,", 7);
+    encoder_t w = { out + 7, 'G' ^ 'P' ^ 'G' ^ 'G' ^ 'A' ^ ',' };
+    if (!(bad & BIT(NMEA_FIELD_TIME))) {
+        uint32_t seconds = fix->timeMs / 1000u;
+        putDigits(&w, seconds / 3600u, 2);
+        putDigits(&w, seconds / 60u % 60u, 2);
+        putDigits(&w, seconds % 60u, 2);
+        putChar(&w, '.');
+        putDigits(&w, fix->timeMs % 1000u, 3);
+    }
+    putChar(&w, ',');
+    putCoordinate(&w, fix->latitude, 2, !(bad & BIT(NMEA_FIELD_LATITUDE)), !(bad & BIT(NMEA_FIELD_LATITUDE_IND)), "NS");
+    putCoordinate(&w, fix->longitude, 3, !(bad & BIT(NMEA_FIELD_LONGITUDE)), !(bad & BIT(NMEA_FIELD_LONGITUDE_IND)), "EW");
+    if (!(bad & BIT(NMEA_FIELD_QIND))) putDigits(&w, fix->qIndicator, 1);
+    putChar(&w, ',');
+    if (!(bad & BIT(NMEA_FIELD_SATELLITE))) putDigits(&w, fix->satTracked, 1);
+    putChar(&w, ',');
+    if (!(bad & BIT(NMEA_FIELD_HDOP))) putFixed(&w, fix->hdop);
+    putChar(&w, ',');
+    if (!(bad & BIT(NMEA_FIELD_ALTITUDE))) putFixed(&w, fix->altitude);
+    putChar(&w, ',');
+    if (!(bad & BIT(NMEA_FIELD_ALTITUDE_IND))) putChar(&w, 'M');
+    putChar(&w, ',');
+    if (!(bad & BIT(NMEA_FIELD_GEOSEP))) putFixed(&w, fix->geoSep);
+    putChar(&w, ',');
+    if (!(bad & BIT(NMEA_FIELD_GEOSEP_IND))) putChar(&w, 'M');
+    putChar(&w, ',');
+    if (!(bad & BIT(NMEA_FIELD_TDGPS))) putFixed(&w, fix->tDgps);
+    putChar(&w, ',');
+    if (!(bad & BIT(NMEA_FIELD_DRSID))) putDigits(&w, fix->drsID, DRS_ID_ARR_LEN - 1);
+    char *p = w.p;
+    p[0] = '*';
+    p[1] = s_hexDigits[w.checksum >> 4];
+    p[2] = s_hexDigits[w.checksum & 0x0F];
+    p[3] = '\r';
+    p[4] = '\n';
+    return (size_t) (p + 5 - out);
+}
+
+/**
+ * @brief nmea_encode_packed function writes one packed fix as a GGA sentence into the buffer
+ * @param fix is the packed fix
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written ("\r\n" included, no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_encode_packed(const nmea_PackedFix_t *fix, char *buffer, size_t size)
+{
+    if (size >= ENCODE_MAX_SENTENCE_LEN) {
+        return encodeSentence(fix, buffer);
+    }
+    //Small buffers go through a scratch sentence, the length is only known after formatting
+    char scratch[ENCODE_MAX_SENTENCE_LEN];
+    size_t len = encodeSentence(fix, scratch);
+    if (len > size) {
+        return 0;
+    }
+    memcpy(buffer, scratch, len);
+    return len;
+}
+
+/**
+ * @brief nmea_encode_fix function writes one parse result as a GGA sentence into the buffer
+ * @param result is the parse result (the isEmpty/isFalse status decides which fields are empty)
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written ("\r\n" included, no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_encode_fix(const nmea_ParseResult_t *result, char *buffer, size_t size)
+{
+    nmea_PackedFix_t fix;
+    nmea_pack_fix(result, &fix);
+    return nmea_encode_packed(&fix, buffer, size);
+}
+
+/**
+ * @brief nmea_encode_parsed function writes the data returned by Parse_gps_data as a GGA sentence into the buffer
+ * @param data is the parsed data
+ * @param isEmpty is the empty status of the fields (NULL if the fields which hold their default value are empty)
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written ("\r\n" included, no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_encode_parsed(const nmea_Parsed_t *data, const gpsData_isEmpty_t *isEmpty, char *buffer, size_t size)
+{
+    static const nmea_Parsed_t s_default = DEFAULT_PARSED_DATA;
+    static const gpsData_isFalse_t s_falseStatus = { false };
+    const gpsData_Position_t *pos = &data->gpsData_position;
+    nmea_ParseResult_t result;
+    result.data = *data;
+    result.isFalse = s_falseStatus;
+    if (isEmpty != NULL) {
+        result.isEmpty = *isEmpty;
+    }
+    else {
+        gpsData_isEmpty_t *e = &result.isEmpty;
+        e->isEmpty_time = data->gpsData_time.hour == s_default.gpsData_time.hour;
+        e->isEmpty_latitude = pos->LATITUDE.latMin == s_default.gpsData_position.LATITUDE.latMin;
+        e->isEmpty_latitudeInd = false;
+        e->isEmpty_longitude = pos->LONGITUDE.longMin == s_default.gpsData_position.LONGITUDE.longMin;
+        e->isEmpty_longitudeInd = false;
+        e->isEmpty_qInd = data->gpsData_qIndicator == s_default.gpsData_qIndicator;
+        e->isEmpty_satellite = data->gpsData_satTracked == s_default.gpsData_satTracked;
+        e->isEmpty_hdop = data->gpsData_hdop == s_default.gpsData_hdop;
+        e->isEmpty_altitude = pos->ALTITUDE.alt == s_default.gpsData_position.ALTITUDE.alt;
+        e->isEmpty_altitudeInd = false;
+        e->isEmpty_geoSep = data->gpsData_gS.gpsData_geoSep == s_default.gpsData_gS.gpsData_geoSep;
+        e->isEmpty_geoSepInd = false;
+        e->isEmpty_tDgps = data->gpsData_tDgps == s_default.gpsData_tDgps;
+        e->isEmpty_drsID = data->gpsData_drsID[0] == s_default.gpsData_drsID[0];
+    }
+    //Indicators which are still the default '#' are not known
+    result.isFalse.isFalse_latitudeInd = pos->LATITUDE.latInd[0] != 'N' && pos->LATITUDE.latInd[0] != 'S';
+    result.isFalse.isFalse_longitudeInd = pos->LONGITUDE.longInd[0] != 'E' && pos->LONGITUDE.longInd[0] != 'W';
+    result.isFalse.isFalse_altitudeInd = pos->ALTITUDE.altInd[0] != 'M';
+    result.isFalse.isFalse_geoSepInd = data->gpsData_gS.gpsData_geoSepInd[0] != 'M';
+    return nmea_encode_fix(&result, buffer, size);
+}
+
+/**
+ * @brief nmea_encode_benchmark function encodes generated fixes (every value range, some empty fields), parses the
+ * -sentences again with nmea_gga_parse_r + nmea_pack_fix and nmea_gga_parse_fixed, counts the records which differ
+ * -from the generated ones and prints the encode throughput
+ * @param fixes is the number of fixes
+ * @return void
+ */
+void nmea_encode_benchmark(uint32_t fixes)
+{
+    nmea_PackedFix_t *fix = malloc((size_t) fixes * sizeof(nmea_PackedFix_t));
+    char *capture = malloc((size_t) fixes * ENCODE_MAX_SENTENCE_LEN);
+    if (fix == NULL || capture == NULL) {
+        printf("ERROR: No memory for the encode benchmark!\n");
+        free(fix);
+        free(capture);
+        return;
+    }
+    //The generated record is the one the parser gives back: empty fields are 0 and a coordinate without its
+    //indicator has no sign
+    uint32_t rng = 0x2545F491u;
+    for (uint32_t i = 0; i < fixes; i++) {
+        nmea_PackedFix_t *f = &fix[i];
+        memset(f, 0, sizeof(*f));
+        f->timeMs = nmea_bench_random(&rng) % 86400000u;
+        f->latitude = (int32_t) (nmea_bench_random(&rng) % 54000001u) - 27000000;
+        f->longitude = (int32_t) (nmea_bench_random(&rng) % 108000001u) - 54000000;
+        f->altitude = (int32_t) (nmea_bench_random(&rng) % 2000000u) - 100000;
+        f->geoSep = (int32_t) (nmea_bench_random(&rng) % 20000u) - 10000;
+        f->tDgps = nmea_bench_random(&rng) % 100000u;
+        f->hdop = (uint16_t) (1 + nmea_bench_random(&rng) % 9999u);
+        f->drsID = (uint16_t) (nmea_bench_random(&rng) % 1024u);
+        f->qIndicator = (uint8_t) (nmea_bench_random(&rng) % (MAX_QI_VAL + 1));
+        f->satTracked = (uint8_t) (nmea_bench_random(&rng) % (MAX_SAT_VAL + 1));
+        if (nmea_bench_random(&rng) % 4 == 0) {
+            f->emptyMask = (uint16_t) (nmea_bench_random(&rng) & ((1u << NMEA_FIELD_COUNT) - 1));
+        }
+        uint16_t e = f->emptyMask;
+        if (e & BIT(NMEA_FIELD_TIME)) f->timeMs = 0;
+        if (e & BIT(NMEA_FIELD_LATITUDE)) f->latitude = 0;
+        if (e & BIT(NMEA_FIELD_LATITUDE_IND) && f->latitude < 0) f->latitude = -f->latitude;
+        if (e & BIT(NMEA_FIELD_LONGITUDE)) f->longitude = 0;
+        if (e & BIT(NMEA_FIELD_LONGITUDE_IND) && f->longitude < 0) f->longitude = -f->longitude;
+        if (e & BIT(NMEA_FIELD_QIND)) f->qIndicator = 0;
+        if (e & BIT(NMEA_FIELD_SATELLITE)) f->satTracked = 0;
+        if (e & BIT(NMEA_FIELD_HDOP)) f->hdop = 0;
+        if (e & BIT(NMEA_FIELD_ALTITUDE)) f->altitude = 0;
+        if (e & BIT(NMEA_FIELD_GEOSEP)) f->geoSep = 0;
+        if (e & BIT(NMEA_FIELD_TDGPS)) f->tDgps = 0;
+        if (e & BIT(NMEA_FIELD_DRSID)) f->drsID = 0;
+    }
+    //Encode into one capture, timed
+    size_t len = 0;
+    uint64_t start = nmea_wall_us();
+    for (uint32_t i = 0; i < fixes; i++) {
+        len += encodeSentence(&fix[i], capture + len);
+    }
+    uint64_t encodeUs = nmea_wall_us() - start;
+    //Round trip through both parsers, outside of the timed loop
+    uint32_t index = 0;
+    uint32_t floatMismatches = 0;
+    uint32_t fixedMismatches = 0;
+    nmea_ParseResult_t result;
+    nmea_PackedFix_t packed;
+    for (const char *p = capture, *nl; p < capture + len && (nl = memchr(p, '\n', (size_t) (capture + len - p))) != NULL; p = nl + 1, index++) {
+        size_t lineLen = (size_t) (nl + 1 - p);
+        bool ok = nmea_gga_parse_r(p, lineLen, &result);
+        if (ok) {
+            nmea_pack_fix(&result, &packed);
+        }
+        floatMismatches += (!ok || index >= fixes || memcmp(&packed, &fix[index], sizeof(packed)) != 0);
+        ok = nmea_gga_parse_fixed(p, lineLen, &packed);
+        fixedMismatches += (!ok || index >= fixes || memcmp(&packed, &fix[index], sizeof(packed)) != 0);
+    }
+    printf("ENCODE BENCHMARK: %lu fixes, %lu bytes\n", (unsigned long) fixes, (unsigned long) len);
+    printf("ENCODE THROUGHPUT-------------------> %.0f sentences/s, %.1f MB/s (%llu us)\n",
+           (encodeUs != 0) ? (double) fixes * 1e6 / (double) encodeUs : 0.0,
+           (encodeUs != 0) ? (double) len / (double) encodeUs : 0.0, (unsigned long long) encodeUs);
+    printf("ENCODE ROUND TRIP MISMATCHES--------> %lu (parse + pack), %lu (fixed-point parse)\n",
+           (unsigned long) floatMismatches, (unsigned long) fixedMismatches);
+    if (index != fixes || floatMismatches != 0 || fixedMismatches != 0) {
+        printf("ERROR: Encoded fixes NOT reproduced by the parser!\n");
+    }
+    free(fix);
+    free(capture);
+}
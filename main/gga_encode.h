@@ -0,0 +1,58 @@
+/**
+ * @brief Loopback encoder of parsed fixes into GGA sentences.
+ * -A parse result or a packed fix is written into a caller buffer as "$GPGGA,...*hh\r\n". The digits are written with
+ * -integer routines and the checksum is accumulated while the charachters are written (no printf, no second pass).
+ * -Empty and incorrect fields are written as empty fields. Time has 3 decimals, latitude/longitude 4 decimals of a
+ * -minute, the other decimal fields 2 decimals so a packed fix is reproduced exactly by parsing the sentence again.
+*/
+
+#pragma once
+
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ENCODE_MAX_SENTENCE_LEN 128     //Buffer size which always holds one encoded sentence
+
+/**
+ * @brief nmea_encode_packed function writes one packed fix as a GGA sentence into the buffer
+ * @param fix is the packed fix
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written ("\r\n" included, no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_encode_packed(const nmea_PackedFix_t* , char* , size_t );
+
+/**
+ * @brief nmea_encode_fix function writes one parse result as a GGA sentence into the buffer
+ * @param result is the parse result (the isEmpty/isFalse status decides which fields are empty)
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written ("\r\n" included, no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_encode_fix(const nmea_ParseResult_t* , char* , size_t );
+
+/**
+ * @brief nmea_encode_parsed function writes the data returned by Parse_gps_data as a GGA sentence into the buffer
+ * @param data is the parsed data
+ * @param isEmpty is the empty status of the fields (NULL if the fields which hold their default value are empty)
+ * @param buffer is the output buffer
+ * @param size is the size of the output buffer
+ * @return size_t is the number of bytes written ("\r\n" included, no null charachter) or 0 if the buffer is too small
+ */
+size_t nmea_encode_parsed(const nmea_Parsed_t* , const gpsData_isEmpty_t* , char* , size_t );
+
+/**
+ * @brief nmea_encode_benchmark function encodes generated fixes (every value range, some empty fields), parses the
+ * -sentences again with nmea_gga_parse_r + nmea_pack_fix and nmea_gga_parse_fixed, counts the records which differ
+ * -from the generated ones and prints the encode throughput
+ * @param fixes is the number of fixes
+ * @return void
+ */
+void nmea_encode_benchmark(uint32_t );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <string.h>
+#include "gga_filter.h"
+
+#define TIME_BIT (1u << NMEA_FIELD_TIME)
+
+/**
+ * @brief updateFieldMask function collects the fields which the enabled predicates need
+ * @param filter is the filter
+ * @return void
+ */
+static void updateFieldMask(nmea_Filter_t *filter)
+{
+    uint16_t mask = 0;
+    if (filter->enabled & (1u << NMEA_FILTER_TIME_RANGE | 1u << NMEA_FILTER_DECIMATE)) mask |= TIME_BIT;
+    if (filter->enabled & (1u << NMEA_FILTER_QUALITY)) mask |= 1u << NMEA_FIELD_QIND;
+    if (filter->enabled & (1u << NMEA_FILTER_SATELLITES)) mask |= 1u << NMEA_FIELD_SATELLITE;
+    if (filter->enabled & (1u << NMEA_FILTER_HDOP)) mask |= 1u << NMEA_FIELD_HDOP;
+    filter->fieldMask = mask;
+}
+
+/**
+ * @brief timeOfDayMs function converts the decoded UTC time into ms of the day (rounded like nmea_pack_fix)
+ * @param time is the decoded time
+ * @return uint32_t is the time of the day in ms
+ */
+static uint32_t timeOfDayMs(const gpsData_Time_t *time)
+{
+    return (uint32_t) ((time->hour * 60 + time->minutes) * 60000) + (uint32_t) (time->seconds * 1000.0 + 0.5);
+}
+
+/**
+ * @brief firstFailed function evaluates the enabled predicates in order (decimation state is not changed)
+ * @param filter is the filter
+ * @param result is the parse result with the predicate fields decoded
+ * @return int is the first failed predicate or -1 if every predicate passed
+ */
+static int firstFailed(const nmea_Filter_t *filter, const nmea_ParseResult_t *result)
+{
+    const nmea_Parsed_t *data = &result->data;
+    bool timeOk = !result->isEmpty.isEmpty_time && !result->isFalse.isFalse_time;
+    uint32_t timeMs = timeOk ? timeOfDayMs(&data->gpsData_time) : 0;
+    if (filter->enabled & (1u << NMEA_FILTER_TIME_RANGE)) {
+        bool inside = (filter->fromMs <= filter->toMs) ? (timeMs >= filter->fromMs && timeMs < filter->toMs)
+                                                       : (timeMs >= filter->fromMs || timeMs < filter->toMs);
+        if (!timeOk || !inside) return NMEA_FILTER_TIME_RANGE;
+    }
+    if (filter->enabled & (1u << NMEA_FILTER_QUALITY)) {
+        if (result->isEmpty.isEmpty_qInd || result->isFalse.isFalse_qInd
+                || data->gpsData_qIndicator < filter->minQuality || data->gpsData_qIndicator > filter->maxQuality) {
+            return NMEA_FILTER_QUALITY;
+        }
+    }
+    if (filter->enabled & (1u << NMEA_FILTER_SATELLITES)) {
+        if (result->isEmpty.isEmpty_satellite || result->isFalse.isFalse_satellite
+                || data->gpsData_satTracked < filter->minSatellites) {
+            return NMEA_FILTER_SATELLITES;
+        }
+    }
+    if (filter->enabled & (1u << NMEA_FILTER_HDOP)) {
+        if (result->isEmpty.isEmpty_hdop || result->isFalse.isFalse_hdop || data->gpsData_hdop > filter->maxHdop) {
+            return NMEA_FILTER_HDOP;
+        }
+    }
+    if (filter->enabled & (1u << NMEA_FILTER_DECIMATE)) {
+        if (!timeOk || (filter->hasLast && timeMs / filter->intervalMs == filter->lastInterval)) {
+            return NMEA_FILTER_DECIMATE;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief nmea_filter_init function removes every predicate and resets the statistics
+ * @param filter is the filter
+ * @return void
+ */
+void nmea_filter_init(nmea_Filter_t *filter)
+{
+    memset(filter, 0, sizeof(*filter));
+}
+
+/**
+ * @brief nmea_filter_time_range function accepts only fixes inside a part of the day
+ * @param filter is the filter
+ * @param fromMs is the start of the range (UTC time of the day in ms, included)
+ * @param toMs is the end of the range (excluded), the range wraps around midnight if it is before fromMs
+ * @return void
+ */
+void nmea_filter_time_range(nmea_Filter_t *filter, uint32_t fromMs, uint32_t toMs)
+{
+    filter->fromMs = fromMs;
+    filter->toMs = toMs;
+    filter->enabled |= 1u << NMEA_FILTER_TIME_RANGE;
+    updateFieldMask(filter);
+}
+
+/**
+ * @brief nmea_filter_quality function accepts only fixes with a quality indicator inside a range e.g., 4 to 5 for RTK
+ * @param filter is the filter
+ * @param minQuality is the lowest accepted quality indicator
+ * @param maxQuality is the highest accepted quality indicator
+ * @return void
+ */
+void nmea_filter_quality(nmea_Filter_t *filter, uint8_t minQuality, uint8_t maxQuality)
+{
+    filter->minQuality = minQuality;
+    filter->maxQuality = maxQuality;
+    filter->enabled |= 1u << NMEA_FILTER_QUALITY;
+    updateFieldMask(filter);
+}
+
+/**
+ * @brief nmea_filter_satellites function accepts only fixes with enough satellites tracked
+ * @param filter is the filter
+ * @param minSatellites is the lowest accepted number of satellites
+ * @return void
+ */
+void nmea_filter_satellites(nmea_Filter_t *filter, uint8_t minSatellites)
+{
+    filter->minSatellites = minSatellites;
+    filter->enabled |= 1u << NMEA_FILTER_SATELLITES;
+    updateFieldMask(filter);
+}
+
+/**
+ * @brief nmea_filter_hdop function accepts only fixes with a low enough HDOP
+ * @param filter is the filter
+ * @param maxHdop is the highest accepted HDOP
+ * @return void
+ */
+void nmea_filter_hdop(nmea_Filter_t *filter, float maxHdop)
+{
+    filter->maxHdop = maxHdop;
+    filter->enabled |= 1u << NMEA_FILTER_HDOP;
+    updateFieldMask(filter);
+}
+
+/**
+ * @brief nmea_filter_decimate function accepts only the first fix of every interval of the UTC time
+ * @param filter is the filter
+ * @param intervalMs is the interval in ms (0 disables the predicate)
+ * @return void
+ */
+void nmea_filter_decimate(nmea_Filter_t *filter, uint32_t intervalMs)
+{
+    filter->intervalMs = intervalMs;
+    filter->hasLast = false;
+    if (intervalMs != 0) {
+        filter->enabled |= 1u << NMEA_FILTER_DECIMATE;
+    }
+    else {
+        filter->enabled &= (uint8_t) ~(1u << NMEA_FILTER_DECIMATE);
+    }
+    updateFieldMask(filter);
+}
+
+/**
+ * @brief nmea_filter_parse function parses a sentence through the filter
+ * @param filter is the filter
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param result holds the parse result (rejected: only the predicate fields, the others keep the default values)
+ * @return nmea_FilterStatus_t is the status of the sentence
+ */
+nmea_FilterStatus_t nmea_filter_parse(nmea_Filter_t *filter, const char *SENTENCE, size_t len, nmea_ParseResult_t *result)
+{
+    nmea_FieldSlice_t field[NMEA_FIELD_COUNT];
+    filter->stats.sentences++;
+    nmea_gga_reset(result);
+    if (!nmea_gga_split(SENTENCE, len, field)) {
+        result->isFalse.isFalse_gga = true;
+        filter->stats.invalid++;
+        return NMEA_FILTER_INVALID;
+    }
+    //Predicate fields first, the remaining fields only if the sentence is kept
+    nmea_gga_decode(field, filter->fieldMask, result);
+    int failed = firstFailed(filter, result);
+    if (failed >= 0) {
+        filter->stats.rejected[failed]++;
+        for (int i = 0; i < NMEA_FIELD_COUNT; i++) {
+            if (filter->fieldMask & (1u << i)) {
+                filter->stats.fieldsDecoded++;
+            }
+            else {
+                filter->stats.fieldsSkipped++;
+                filter->stats.bytesSkipped += field[i].len;
+            }
+        }
+        return NMEA_FILTER_REJECTED;
+    }
+    nmea_gga_decode(field, NMEA_ALL_FIELDS & (uint16_t) ~filter->fieldMask, result);
+    if (filter->enabled & (1u << NMEA_FILTER_DECIMATE)) {
+        filter->hasLast = true;
+        filter->lastInterval = timeOfDayMs(&result->data.gpsData_time) / filter->intervalMs;
+    }
+    filter->stats.accepted++;
+    filter->stats.fieldsDecoded += NMEA_FIELD_COUNT;
+    return NMEA_FILTER_ACCEPTED;
+}
+
+/**
+ * @brief nmea_filter_print function prints the filter statistics to console
+ * @param filter is the filter
+ * @return void
+ */
+void nmea_filter_print(const nmea_Filter_t *filter)
+{
+    static const char *const s_labels[NMEA_FILTER_PREDICATE_COUNT] = {
+        "FILTER REJECTED BY TIME RANGE-------> ",
+        "FILTER REJECTED BY QUALITY----------> ",
+        "FILTER REJECTED BY SATELLITES-------> ",
+        "FILTER REJECTED BY HDOP-------------> ",
+        "FILTER REJECTED BY DECIMATION-------> "
+    };
+    const nmea_FilterStats_t *stats = &filter->stats;
+    uint64_t fields = stats->fieldsDecoded + stats->fieldsSkipped;
+    printf("FILTER SENTENCES/ACCEPTED/INVALID---> %llu/%llu/%llu\n", (unsigned long long) stats->sentences,
+           (unsigned long long) stats->accepted, (unsigned long long) stats->invalid);
+    for (int i = 0; i < NMEA_FILTER_PREDICATE_COUNT; i++) {
+        if (filter->enabled & (1u << i)) {
+            printf("%s%llu\n", s_labels[i], (unsigned long long) stats->rejected[i]);
+        }
+    }
+    printf("FILTER FIELDS DECODED/SKIPPED-------> %llu/%llu (%.1f%% skipped)\n", (unsigned long long) stats->fieldsDecoded,
+           (unsigned long long) stats->fieldsSkipped, (fields != 0) ? 100.0 * (double) stats->fieldsSkipped / (double) fields : 0.0);
+    printf("FILTER CHARACHTERS NOT DECODED------> %llu\n", (unsigned long long) stats->bytesSkipped);
+}
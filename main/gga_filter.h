@@ -0,0 +1,140 @@
+/**
+ * @brief Predicate pushdown for the GGA parser: sentences are dropped before they are fully decoded.
+ * -A filter holds simple predicates on the UTC time (a range of the day and one fix per interval), the quality
+ * -indicator, the satellites tracked and the HDOP. After the prefix and checksum check only the fields of the enabled
+ * -predicates are decoded; a rejected sentence skips the remaining fields, an accepted one decodes them as usual.
+ * -A predicate fails when its field is empty or incorrect. The filter counts the decode work which was avoided.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Predicates of a filter, in the order of evaluation
+ */
+typedef enum {
+    NMEA_FILTER_TIME_RANGE = 0,         //UTC time of the day inside [fromMs, toMs), wraps around midnight if fromMs > toMs
+    NMEA_FILTER_QUALITY,                //quality indicator inside [minQuality, maxQuality]
+    NMEA_FILTER_SATELLITES,             //at least minSatellites tracked
+    NMEA_FILTER_HDOP,                   //HDOP of at most maxHdop
+    NMEA_FILTER_DECIMATE,               //first accepted fix of every intervalMs of the UTC time
+    NMEA_FILTER_PREDICATE_COUNT
+} nmea_FilterPredicate_t;
+
+/**
+ * @brief Result of nmea_filter_parse
+ */
+typedef enum {
+    NMEA_FILTER_ACCEPTED = 0,           //every predicate passed, every field is decoded
+    NMEA_FILTER_REJECTED,               //a predicate failed, only the predicate fields are decoded
+    NMEA_FILTER_INVALID                 //no GGA sentence or wrong checksum
+} nmea_FilterStatus_t;
+
+/**
+ * @brief Filter statistics
+ */
+typedef struct {
+    uint64_t sentences;
+    uint64_t accepted;
+    uint64_t invalid;
+    uint64_t rejected[NMEA_FILTER_PREDICATE_COUNT];  //rejected sentences by the first failed predicate
+    uint64_t fieldsDecoded;
+    uint64_t fieldsSkipped;             //fields of rejected sentences which were never decoded
+    uint64_t bytesSkipped;              //charachters of the skipped fields
+} nmea_FilterStats_t;
+
+/**
+ * @brief Filter state, initialize with nmea_filter_init and register predicates with the nmea_filter_ functions
+ */
+typedef struct {
+    uint8_t enabled;                    //bit of every enabled predicate (nmea_FilterPredicate_t)
+    uint16_t fieldMask;                 //fields decoded before the predicates are evaluated
+    uint32_t fromMs;
+    uint32_t toMs;
+    uint8_t minQuality;
+    uint8_t maxQuality;
+    uint8_t minSatellites;
+    float maxHdop;
+    uint32_t intervalMs;
+    bool hasLast;                       //decimation: an interval was accepted before
+    uint32_t lastInterval;
+    nmea_FilterStats_t stats;
+} nmea_Filter_t;
+
+/**
+ * @brief nmea_filter_init function removes every predicate and resets the statistics
+ * @param filter is the filter
+ * @return void
+ */
+void nmea_filter_init(nmea_Filter_t* );
+
+/**
+ * @brief nmea_filter_time_range function accepts only fixes inside a part of the day
+ * @param filter is the filter
+ * @param fromMs is the start of the range (UTC time of the day in ms, included)
+ * @param toMs is the end of the range (excluded), the range wraps around midnight if it is before fromMs
+ * @return void
+ */
+void nmea_filter_time_range(nmea_Filter_t* , uint32_t , uint32_t );
+
+/**
+ * @brief nmea_filter_quality function accepts only fixes with a quality indicator inside a range e.g., 4 to 5 for RTK
+ * @param filter is the filter
+ * @param minQuality is the lowest accepted quality indicator
+ * @param maxQuality is the highest accepted quality indicator
+ * @return void
+ */
+void nmea_filter_quality(nmea_Filter_t* , uint8_t , uint8_t );
+
+/**
+ * @brief nmea_filter_satellites function accepts only fixes with enough satellites tracked
+ * @param filter is the filter
+ * @param minSatellites is the lowest accepted number of satellites
+ * @return void
+ */
+void nmea_filter_satellites(nmea_Filter_t* , uint8_t );
+
+/**
+ * @brief nmea_filter_hdop function accepts only fixes with a low enough HDOP
+ * @param filter is the filter
+ * @param maxHdop is the highest accepted HDOP
+ * @return void
+ */
+void nmea_filter_hdop(nmea_Filter_t* , float );
+
+/**
+ * @brief nmea_filter_decimate function accepts only the first fix of every interval of the UTC time e.g., 1000 ms
+ * -for one fix per second from a 10 Hz stream. It is evaluated last, so the fix is the first one which passes the
+ * -other predicates.
+ * @param filter is the filter
+ * @param intervalMs is the interval in ms (0 disables the predicate)
+ * @return void
+ */
+void nmea_filter_decimate(nmea_Filter_t* , uint32_t );
+
+/**
+ * @brief nmea_filter_parse function parses a sentence through the filter, one task at a time per filter
+ * @param filter is the filter
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param result holds the parse result (rejected: only the predicate fields, the others keep the default values)
+ * @return nmea_FilterStatus_t is the status of the sentence
+ */
+nmea_FilterStatus_t nmea_filter_parse(nmea_Filter_t* , const char* , size_t , nmea_ParseResult_t* );
+
+/**
+ * @brief nmea_filter_print function prints the filter statistics to console
+ * @param filter is the filter
+ * @return void
+ */
+void nmea_filter_print(const nmea_Filter_t* );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,851 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gga_flashlog.h"
+#include "gga_validate.h"
+#include "gga_bench.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include "esp_partition.h"
+#endif
+
+#define LOG_PAGE_MAGIC 0x474F4C47u      //"GLOG" in little endian
+#define LOG_RECORD_FIX 1                //Record type of a packed fix
+#define LOG_PAGES_PER_SECTOR (FLASHLOG_SECTOR_SIZE / CONFIG_GGA_FLASHLOG_PAGE_SIZE)
+
+/**
+ * @brief Page header, followed by the records, the rest of the page stays erased
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;                       //position of the page since the log was started
+    uint16_t count;                     //records of the page
+    uint16_t reserved;
+    uint32_t crc;                       //CRC-32 of the members before
+} logPage_t;
+
+/**
+ * @brief Record header, followed by the payload
+ */
+typedef struct {
+    uint32_t crc;                       //CRC-32 of the size, the type and the payload
+    uint16_t size;                      //size of the payload
+    uint16_t type;                      //LOG_RECORD_FIX
+} logRecord_t;
+
+_Static_assert(sizeof(logPage_t) == FLASHLOG_PAGE_HEADER_SIZE, "page header must be FLASHLOG_PAGE_HEADER_SIZE bytes");
+_Static_assert(sizeof(logRecord_t) + sizeof(nmea_PackedFix_t) == FLASHLOG_RECORD_SIZE, "record must be FLASHLOG_RECORD_SIZE bytes");
+_Static_assert(CONFIG_GGA_FLASHLOG_PAGE_SIZE >= 256 && CONFIG_GGA_FLASHLOG_PAGE_SIZE <= FLASHLOG_SECTOR_SIZE &&
+               (CONFIG_GGA_FLASHLOG_PAGE_SIZE & (CONFIG_GGA_FLASHLOG_PAGE_SIZE - 1)) == 0,
+               "page size must be a power of 2 from 256 to the sector size");
+
+/**
+ * @brief pageCrc function gives the CRC-32 of a page header
+ * @param page is the page header
+ * @return uint32_t is the CRC-32
+ */
+static uint32_t pageCrc(const logPage_t *page)
+{
+    return nmea_crc32(0, page, offsetof(logPage_t, crc));
+}
+
+/**
+ * @brief recordCrc function gives the CRC-32 of a record
+ * @param record is the record header
+ * @param payload is the payload
+ * @return uint32_t is the CRC-32
+ */
+static uint32_t recordCrc(const logRecord_t *record, const void *payload)
+{
+    uint32_t crc = nmea_crc32(0, &record->size, sizeof(logRecord_t) - offsetof(logRecord_t, size));
+    return nmea_crc32(crc, payload, record->size);
+}
+
+/**
+ * @brief readHeader function reads the header of a page
+ * @param log is the fix log
+ * @param page is the page
+ * @param header holds the header
+ * @return bool is true if the header is valid
+ */
+static bool readHeader(const nmea_FlashLog_t *log, uint32_t page, logPage_t *header)
+{
+    if (log->io.read(log->io.ctx, page * CONFIG_GGA_FLASHLOG_PAGE_SIZE, header, sizeof(*header)) != 0) {
+        return false;
+    }
+    return header->magic == LOG_PAGE_MAGIC && header->crc == pageCrc(header) &&
+           header->count <= FLASHLOG_RECORDS_PER_PAGE;
+}
+
+/**
+ * @brief isCurrent function reads the header of a page and checks its sequence number
+ * @param log is the fix log
+ * @param page is the page
+ * @param seq is the sequence number the page has if it was written in the current lap
+ * @return bool is true if the page is valid and has the sequence number
+ */
+static bool isCurrent(nmea_FlashLog_t *log, uint32_t page, uint32_t seq)
+{
+    logPage_t header;
+    log->stats.recoveryReads++;
+    return readHeader(log, page, &header) && header.seq == seq;
+}
+
+/**
+ * @brief firstValid function finds the first page of a sector with a valid header, the pages before it failed to be
+ * -written
+ * @param log is the fix log
+ * @param sector is the sector
+ * @param header holds the header of the page
+ * @return int is the page within the sector or -1 if the sector has no valid page
+ */
+static int firstValid(nmea_FlashLog_t *log, uint32_t sector, logPage_t *header)
+{
+    for (uint32_t i = 0; i < LOG_PAGES_PER_SECTOR; i++) {
+        log->stats.recoveryReads++;
+        if (readHeader(log, sector * LOG_PAGES_PER_SECTOR + i, header)) {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief isCurrentSector function checks that a sector was written in the current lap: its first valid page has the
+ * -sequence number of its position
+ * @param log is the fix log
+ * @param sector is the sector
+ * @param seq is the sequence number of the first page of the sector in the current lap
+ * @param first holds the first valid page within the sector
+ * @return bool is true if the sector was written in the current lap
+ */
+static bool isCurrentSector(nmea_FlashLog_t *log, uint32_t sector, uint32_t seq, uint32_t *first)
+{
+    logPage_t header;
+    int page = firstValid(log, sector, &header);
+    if (page < 0 || header.seq != seq + (uint32_t) page) {
+        return false;
+    }
+    *first = (uint32_t) page;
+    return true;
+}
+
+/**
+ * @brief isErased function checks that a page is erased
+ * @param log is the fix log
+ * @param page is the page
+ * @return bool is true if every byte of the page is 0xFF
+ */
+static bool isErased(const nmea_FlashLog_t *log, uint32_t page)
+{
+    uint32_t buf[64];
+    for (uint32_t offset = 0; offset < CONFIG_GGA_FLASHLOG_PAGE_SIZE; offset += sizeof(buf)) {
+        if (log->io.read(log->io.ctx, page * CONFIG_GGA_FLASHLOG_PAGE_SIZE + offset, buf, sizeof(buf)) != 0) {
+            return false;
+        }
+        for (size_t i = 0; i < sizeof(buf) / sizeof(buf[0]); i++) {
+            if (buf[i] != 0xFFFFFFFFu) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief skipSector function gives up the rest of the sector of the head page, the next page starts a sector.
+ * -The sequence numbers keep counting the positions, so the skipped pages do not break the binary search.
+ * @param log is the fix log
+ * @return void
+ */
+static void skipSector(nmea_FlashLog_t *log)
+{
+    uint32_t rest = LOG_PAGES_PER_SECTOR - 1 - log->headPage % LOG_PAGES_PER_SECTOR;
+    log->headPage += rest;
+    log->headSeq += rest;
+    log->stats.pagesSkipped += rest;
+}
+
+/**
+ * @brief resetPage function empties the RAM page
+ * @param log is the fix log
+ * @return void
+ */
+static void resetPage(nmea_FlashLog_t *log)
+{
+    memset(log->page, 0xFF, sizeof(log->page));
+    log->count = 0;
+}
+
+/**
+ * @brief nmea_flashlog_open function finds the head of the log with a binary search over the page sequence numbers
+ * @param log is the fix log
+ * @param io is the flash access
+ * @return int is 0 on success or -1 if the flash is too small or cannot be read
+ */
+int nmea_flashlog_open(nmea_FlashLog_t *log, const nmea_FlashIo_t *io)
+{
+    memset(log, 0, sizeof(*log));
+    resetPage(log);
+    if (io->size % FLASHLOG_SECTOR_SIZE != 0 || io->size < 2 * FLASHLOG_SECTOR_SIZE) {
+        printf("ERROR: Fix log of %u bytes NOT usable!\n", (unsigned) io->size);
+        return -1;
+    }
+    log->io = *io;
+    log->pages = io->size / CONFIG_GGA_FLASHLOG_PAGE_SIZE;
+    uint32_t sectors = io->size / FLASHLOG_SECTOR_SIZE;
+    uint64_t start = nmea_wall_us();
+
+    //Reference is the first valid page of sector 0, or of sector 1 when sector 0 was being erased or written at the
+    //power cut
+    logPage_t header;
+    uint32_t ref = 0;
+    int refPage = firstValid(log, 0, &header);
+    if (refPage < 0) {
+        ref = 1;
+        refPage = firstValid(log, 1, &header);
+        if (refPage < 0) {
+            log->stats.recoveryUs = nmea_wall_us() - start;
+            return 0;
+        }
+    }
+    uint32_t seq0 = header.seq - (uint32_t) refPage;
+
+    //Last sector written in the current lap: its first valid page has the sequence number of its position (the pages
+    //before it failed to be written)
+    uint32_t lo = ref, hi = sectors;
+    uint32_t first = (uint32_t) refPage;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t midFirst;
+        if (isCurrentSector(log, mid, seq0 + (mid - ref) * LOG_PAGES_PER_SECTOR, &midFirst)) {
+            lo = mid;
+            first = midFirst;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    //Last page written in that sector from its first valid page, the pages after it are erased or were torn
+    uint32_t base = lo * LOG_PAGES_PER_SECTOR;
+    uint32_t seqBase = seq0 + (lo - ref) * LOG_PAGES_PER_SECTOR;
+    uint32_t plo = first, phi = LOG_PAGES_PER_SECTOR;
+    while (phi - plo > 1) {
+        uint32_t mid = plo + (phi - plo) / 2;
+        if (isCurrent(log, base + mid, seqBase + mid)) {
+            plo = mid;
+        }
+        else {
+            phi = mid;
+        }
+    }
+    log->hasHead = true;
+    log->headPage = base + plo;
+    log->headSeq = seqBase + plo;
+    log->headSectorUsed = true;
+
+    //The next page is written without an erase unless it starts a sector, a torn page cannot be written again
+    uint32_t next = log->headPage + 1;
+    if (next % LOG_PAGES_PER_SECTOR != 0 && !isErased(log, next)) {
+        skipSector(log);
+    }
+    log->headPage %= log->pages;
+    log->stats.recoveryUs = nmea_wall_us() - start;
+    return 0;
+}
+
+/**
+ * @brief writePage function erases the sector if the page starts one and writes the RAM page into the next page
+ * @param log is the fix log
+ * @return int is 0 on success or -1 on failure (the fixes of the RAM page are lost)
+ */
+static int writePage(nmea_FlashLog_t *log)
+{
+    uint32_t page = log->hasHead ? (log->headPage + 1) % log->pages : 0;
+    uint32_t seq = log->hasHead ? log->headSeq + 1 : 0;
+    uint32_t offset = page * CONFIG_GGA_FLASHLOG_PAGE_SIZE;
+    logPage_t header = { .magic = LOG_PAGE_MAGIC, .seq = seq, .count = log->count, .reserved = 0xFFFF };
+    header.crc = pageCrc(&header);
+    memcpy(log->page, &header, sizeof(header));
+
+    int ret = 0;
+    if (page % LOG_PAGES_PER_SECTOR == 0) {
+        log->headSectorUsed = false;
+        log->stats.sectorsErased++;
+        ret = log->io.erase(log->io.ctx, offset, FLASHLOG_SECTOR_SIZE);
+    }
+    if (ret == 0) {
+        ret = log->io.write(log->io.ctx, offset, log->page, CONFIG_GGA_FLASHLOG_PAGE_SIZE);
+    }
+    log->hasHead = true;
+    log->headPage = page;
+    log->headSeq = seq;
+    if (ret == 0) {
+        log->headSectorUsed = true;
+        log->stats.pagesWritten++;
+    }
+    else {
+        //The page may be half written, the log continues in the next sector. Until a page of the sector is written
+        //it continues in the next page instead, so the first valid page of every written sector has the sequence
+        //number of its position and the binary search of nmea_flashlog_open stays monotonic
+        log->stats.writeErrors++;
+        log->stats.recordsLost += log->count;
+        if (log->headSectorUsed) {
+            skipSector(log);
+        }
+        else {
+            log->stats.pagesSkipped++;
+        }
+        ret = -1;
+    }
+    resetPage(log);
+    return ret;
+}
+
+/**
+ * @brief nmea_flashlog_append function adds a fix to the RAM page, the page is written when it is full
+ * @param log is the fix log
+ * @param fix is the packed fix
+ * @return int is 0 on success or -1 if the full page could not be written (its fixes are lost)
+ */
+int nmea_flashlog_append(nmea_FlashLog_t *log, const nmea_PackedFix_t *fix)
+{
+    uint8_t *dst = log->page + FLASHLOG_PAGE_HEADER_SIZE + log->count * FLASHLOG_RECORD_SIZE;
+    logRecord_t record = { .size = sizeof(*fix), .type = LOG_RECORD_FIX };
+    record.crc = recordCrc(&record, fix);
+    memcpy(dst, &record, sizeof(record));
+    memcpy(dst + sizeof(record), fix, sizeof(*fix));
+    log->stats.appended++;
+    if (++log->count < FLASHLOG_RECORDS_PER_PAGE) {
+        return 0;
+    }
+    return writePage(log);
+}
+
+/**
+ * @brief nmea_flashlog_sync function writes the fixes of the RAM page now e.g., before deep sleep, the rest of the
+ * -page stays unused
+ * @param log is the fix log
+ * @return int is 0 on success or -1 on a write failure
+ */
+int nmea_flashlog_sync(nmea_FlashLog_t *log)
+{
+    return (log->count > 0) ? writePage(log) : 0;
+}
+
+/**
+ * @brief readRecord function reads and checks a record of a page
+ * @param log is the fix log
+ * @param page is the page
+ * @param index is the record of the page
+ * @param fix holds the fix
+ * @return bool is true if the record is a valid fix
+ */
+static bool readRecord(nmea_FlashLog_t *log, uint32_t page, uint32_t index, nmea_PackedFix_t *fix)
+{
+    uint8_t buf[FLASHLOG_RECORD_SIZE];
+    uint32_t offset = page * CONFIG_GGA_FLASHLOG_PAGE_SIZE + FLASHLOG_PAGE_HEADER_SIZE + index * FLASHLOG_RECORD_SIZE;
+    logRecord_t record;
+    if (log->io.read(log->io.ctx, offset, buf, sizeof(buf)) != 0) {
+        return false;
+    }
+    memcpy(&record, buf, sizeof(record));
+    if (record.type != LOG_RECORD_FIX || record.size != sizeof(*fix) || record.crc != recordCrc(&record, buf + sizeof(record))) {
+        log->stats.badRecords++;
+        return false;
+    }
+    memcpy(fix, buf + sizeof(record), sizeof(*fix));
+    return true;
+}
+
+/**
+ * @brief nmea_flashlog_last function gives the newest logged fix (the RAM page included)
+ * @param log is the fix log
+ * @param fix holds the fix
+ * @return bool is true if the log holds a fix
+ */
+bool nmea_flashlog_last(nmea_FlashLog_t *log, nmea_PackedFix_t *fix)
+{
+    if (log->count > 0) {
+        memcpy(fix, log->page + FLASHLOG_PAGE_HEADER_SIZE + (log->count - 1) * FLASHLOG_RECORD_SIZE + sizeof(logRecord_t), sizeof(*fix));
+        return true;
+    }
+    //Newest valid record of the newest pages, a skipped sector holds no page
+    logPage_t header;
+    for (uint32_t back = 0; log->hasHead && back <= LOG_PAGES_PER_SECTOR; back++) {
+        uint32_t page = (log->headPage + log->pages - back) % log->pages;
+        if (!readHeader(log, page, &header) || header.seq != log->headSeq - back) {
+            continue;
+        }
+        for (uint32_t i = header.count; i > 0; i--) {
+            if (readRecord(log, page, i - 1, fix)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief nmea_flashlog_read function gives every logged fix to the callback, from the oldest to the newest
+ * @param log is the fix log
+ * @param callback is called for every fix
+ * @param arg is given to the callback
+ * @return uint64_t is the number of fixes
+ */
+uint64_t nmea_flashlog_read(nmea_FlashLog_t *log, nmea_FlashLogCallback_t callback, void *arg)
+{
+    uint64_t fixes = 0;
+    nmea_PackedFix_t fix;
+    logPage_t header;
+    if (log->hasHead) {
+        //The oldest pages are in the sector after the head, a page belongs to the log if its sequence number fits
+        uint32_t first = (log->headPage / LOG_PAGES_PER_SECTOR + 1) * LOG_PAGES_PER_SECTOR % log->pages;
+        for (uint32_t n = 0; n < log->pages; n++) {
+            uint32_t page = (first + n) % log->pages;
+            uint32_t distance = (log->headPage + log->pages - page) % log->pages;
+            if (!readHeader(log, page, &header) || header.seq != log->headSeq - distance) {
+                continue;
+            }
+            for (uint32_t i = 0; i < header.count; i++) {
+                if (readRecord(log, page, i, &fix)) {
+                    callback(arg, &fix);
+                    fixes++;
+                }
+            }
+        }
+    }
+    for (uint32_t i = 0; i < log->count; i++) {
+        memcpy(&fix, log->page + FLASHLOG_PAGE_HEADER_SIZE + i * FLASHLOG_RECORD_SIZE + sizeof(logRecord_t), sizeof(fix));
+        callback(arg, &fix);
+        fixes++;
+    }
+    return fixes;
+}
+
+/**
+ * @brief nmea_flashlog_print function prints the fix log statistics to console
+ * @param log is the fix log
+ * @return void
+ */
+void nmea_flashlog_print(const nmea_FlashLog_t *log)
+{
+    const nmea_FlashLogStats_t *s = &log->stats;
+    printf("FLASHLOG PAGES----------------------> %lu of %u bytes, %u fixes per page\n",
+           (unsigned long) log->pages, CONFIG_GGA_FLASHLOG_PAGE_SIZE, (unsigned) FLASHLOG_RECORDS_PER_PAGE);
+    if (log->hasHead) {
+        printf("FLASHLOG HEAD-----------------------> page %lu, sequence %lu, %u fixes in RAM\n",
+               (unsigned long) log->headPage, (unsigned long) log->headSeq, log->count);
+    }
+    else {
+        printf("FLASHLOG HEAD-----------------------> empty, %u fixes in RAM\n", log->count);
+    }
+    printf("FLASHLOG APPENDED-------------------> %llu\n", (unsigned long long) s->appended);
+    printf("FLASHLOG PAGES WRITTEN--------------> %llu\n", (unsigned long long) s->pagesWritten);
+    printf("FLASHLOG SECTORS ERASED-------------> %llu\n", (unsigned long long) s->sectorsErased);
+    printf("FLASHLOG WRITE ERRORS---------------> %llu (%llu fixes lost, %llu pages skipped)\n",
+           (unsigned long long) s->writeErrors, (unsigned long long) s->recordsLost, (unsigned long long) s->pagesSkipped);
+    printf("FLASHLOG BAD RECORDS----------------> %llu\n", (unsigned long long) s->badRecords);
+    printf("FLASHLOG RECOVERY-------------------> %llu us, %lu page reads\n",
+           (unsigned long long) s->recoveryUs, (unsigned long) s->recoveryReads);
+}
+
+#ifdef __linux__
+#define FLASHEMU_PROGRAM_US 700         //Modelled program time of a 256 byte flash page
+#define FLASHEMU_ERASE_US 45000         //Modelled erase time of a sector
+
+/**
+ * @brief emuRead function reads the emulated flash
+ * @param ctx is the emulator
+ * @param offset is the flash offset
+ * @param buf holds the bytes
+ * @param len is the length
+ * @return int is 0 on success or -1 on failure
+ */
+static int emuRead(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    nmea_FlashEmu_t *emu = ctx;
+    emu->reads++;
+    if ((uint64_t) offset + len > emu->size) {
+        return -1;
+    }
+    return (pread(emu->fd, buf, len, offset) == (ssize_t) len) ? 0 : -1;
+}
+
+/**
+ * @brief emuWrite function programs the emulated flash, the bits can only be cleared (new = old AND data)
+ * @param ctx is the emulator
+ * @param offset is the flash offset
+ * @param data is the bytes
+ * @param len is the length
+ * @return int is 0 on success or -1 on failure (also the torn write of tearAtWrite and the write of failAtWrite)
+ */
+static int emuWrite(void *ctx, uint32_t offset, const void *data, size_t len)
+{
+    nmea_FlashEmu_t *emu = ctx;
+    uint8_t buf[FLASHLOG_SECTOR_SIZE];
+    const uint8_t *src = data;
+    if ((uint64_t) offset + len > emu->size || len > sizeof(buf) || pread(emu->fd, buf, len, offset) != (ssize_t) len) {
+        return -1;
+    }
+    bool torn = (++emu->writes == emu->tearAtWrite);
+    if (emu->writes == emu->failAtWrite) {
+        return -1;
+    }
+    size_t n = torn ? len / 2 : len;
+    bool bitError = false;
+    for (size_t i = 0; i < n; i++) {
+        bitError |= (src[i] & ~buf[i]) != 0;
+        buf[i] &= src[i];
+    }
+    emu->bitErrors += bitError;
+    emu->bytesWritten += n;
+    emu->busyUs += (n + 255) / 256 * FLASHEMU_PROGRAM_US;
+    if (pwrite(emu->fd, buf, n, offset) != (ssize_t) n) {
+        return -1;
+    }
+    return torn ? -1 : 0;
+}
+
+/**
+ * @brief emuErase function erases sectors of the emulated flash to 0xFF
+ * @param ctx is the emulator
+ * @param offset is the flash offset (sector aligned)
+ * @param len is the length (whole sectors)
+ * @return int is 0 on success or -1 on failure
+ */
+static int emuErase(void *ctx, uint32_t offset, size_t len)
+{
+    nmea_FlashEmu_t *emu = ctx;
+    uint8_t buf[FLASHLOG_SECTOR_SIZE];
+    if (offset % FLASHLOG_SECTOR_SIZE != 0 || len % FLASHLOG_SECTOR_SIZE != 0 || (uint64_t) offset + len > emu->size) {
+        return -1;
+    }
+    memset(buf, 0xFF, sizeof(buf));
+    for (size_t done = 0; done < len; done += FLASHLOG_SECTOR_SIZE) {
+        if (pwrite(emu->fd, buf, sizeof(buf), offset + done) != (ssize_t) sizeof(buf)) {
+            return -1;
+        }
+        emu->erases[(offset + done) / FLASHLOG_SECTOR_SIZE]++;
+        emu->sectorErases++;
+        emu->busyUs += FLASHEMU_ERASE_US;
+    }
+    return 0;
+}
+
+/**
+ * @brief nmea_flashemu_open function opens or creates an emulated flash file (created erased)
+ * @param emu is the emulator
+ * @param path is the file
+ * @param size is the flash size in bytes (multiple of FLASHLOG_SECTOR_SIZE)
+ * @param io holds the flash access of the emulator
+ * @return int is 0 on success or -1 on failure
+ */
+int nmea_flashemu_open(nmea_FlashEmu_t *emu, const char *path, uint32_t size, nmea_FlashIo_t *io)
+{
+    memset(emu, 0, sizeof(*emu));
+    struct stat st;
+    emu->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (emu->fd < 0 || size % FLASHLOG_SECTOR_SIZE != 0 || fstat(emu->fd, &st) != 0) {
+        printf("ERROR: Flash file %s NOT opened!\n", path);
+        if (emu->fd >= 0) {
+            close(emu->fd);
+        }
+        return -1;
+    }
+    emu->size = size;
+    emu->erases = calloc(size / FLASHLOG_SECTOR_SIZE, sizeof(uint32_t));
+    if (emu->erases == NULL) {
+        close(emu->fd);
+        return -1;
+    }
+    //A new file (or a file of another size) starts erased
+    if (st.st_size != (off_t) size) {
+        int ret = ftruncate(emu->fd, size);
+        for (uint32_t offset = 0; ret == 0 && offset < size; offset += FLASHLOG_SECTOR_SIZE) {
+            ret = emuErase(emu, offset, FLASHLOG_SECTOR_SIZE);
+        }
+        if (ret != 0) {
+            printf("ERROR: Flash file %s NOT initialised!\n", path);
+            nmea_flashemu_close(emu);
+            return -1;
+        }
+        memset(emu->erases, 0, size / FLASHLOG_SECTOR_SIZE * sizeof(uint32_t));
+        emu->sectorErases = 0;
+        emu->busyUs = 0;
+    }
+    io->read = emuRead;
+    io->write = emuWrite;
+    io->erase = emuErase;
+    io->ctx = emu;
+    io->size = size;
+    return 0;
+}
+
+/**
+ * @brief nmea_flashemu_close function closes an emulated flash file
+ * @param emu is the emulator
+ * @return void
+ */
+void nmea_flashemu_close(nmea_FlashEmu_t *emu)
+{
+    if (emu->fd >= 0) {
+        close(emu->fd);
+    }
+    free(emu->erases);
+    emu->fd = -1;
+    emu->erases = NULL;
+}
+
+/**
+ * @brief Read-back check of the benchmark: the fixes carry their append number in tDgps
+ */
+typedef struct {
+    uint64_t fixes;
+    uint64_t unordered;                 //fixes whose number is not larger than the one before
+    uint32_t first;
+    uint32_t last;
+} benchCheck_t;
+
+/**
+ * @brief benchCheckFix function checks the order of the fixes given by nmea_flashlog_read
+ * @param arg is the read-back check
+ * @param fix is the fix
+ * @return void
+ */
+static void benchCheckFix(void *arg, const nmea_PackedFix_t *fix)
+{
+    benchCheck_t *check = arg;
+    if (check->fixes == 0) {
+        check->first = fix->tDgps;
+    }
+    else if (fix->tDgps <= check->last) {
+        check->unordered++;
+    }
+    check->last = fix->tDgps;
+    check->fixes++;
+}
+
+/**
+ * @brief benchFix function gives the generated fix with an append number
+ * @param n is the append number
+ * @return nmea_PackedFix_t is the fix
+ */
+static nmea_PackedFix_t benchFix(uint32_t n)
+{
+    nmea_PackedFix_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.timeMs = (n * 1000u) % 86400000u;
+    fix.latitude = 2893000 + (int32_t) (n % 600);
+    fix.longitude = 4680000 - (int32_t) (n % 900);
+    fix.altitude = 21500 + (int32_t) (n % 50);
+    fix.geoSep = 4150;
+    fix.tDgps = n;
+    fix.hdop = 90;
+    fix.qIndicator = 1;
+    fix.satTracked = 9;
+    return fix;
+}
+
+/**
+ * @brief benchReopen function reopens the log as after a restart and gives the append number of the newest fix
+ * @param io is the flash access
+ * @param log is the reopened log
+ * @return uint32_t is the append number or 0 if the log cannot be opened or is empty
+ */
+static uint32_t benchReopen(const nmea_FlashIo_t *io, nmea_FlashLog_t *log)
+{
+    nmea_PackedFix_t fix;
+    if (nmea_flashlog_open(log, io) != 0 || !nmea_flashlog_last(log, &fix)) {
+        return 0;
+    }
+    return fix.tDgps;
+}
+
+/**
+ * @brief nmea_flashlog_benchmark function appends generated fixes to a log in an emulated flash file and prints the
+ * -append throughput, the flash wear and the recovery time after a restart and after a torn write
+ * @param path is the emulated flash file (replaced)
+ * @param sizeKb is the size of the log in kB
+ * @param fixes is the number of fixes
+ * @return void
+ */
+void nmea_flashlog_benchmark(const char *path, uint32_t sizeKb, uint32_t fixes)
+{
+    static nmea_FlashLog_t s_log, s_reopened;
+    nmea_FlashEmu_t emu;
+    nmea_FlashIo_t io;
+    uint32_t size = sizeKb * 1024u / FLASHLOG_SECTOR_SIZE * FLASHLOG_SECTOR_SIZE;
+    unlink(path);
+    if (fixes == 0 || nmea_flashemu_open(&emu, path, size, &io) != 0 || nmea_flashlog_open(&s_log, &io) != 0) {
+        printf("ERROR: Fix log benchmark NOT started!\n");
+        return;
+    }
+    printf("FLASHLOG BENCHMARK------------------> %lu kB flash, %lu fixes, %u byte pages of %u fixes\n",
+           (unsigned long) (size / 1024u), (unsigned long) fixes, CONFIG_GGA_FLASHLOG_PAGE_SIZE,
+           (unsigned) FLASHLOG_RECORDS_PER_PAGE);
+
+    //Append throughput, every page write and sector erase goes to the file
+    uint64_t start = nmea_wall_us();
+    for (uint32_t n = 1; n <= fixes; n++) {
+        nmea_PackedFix_t fix = benchFix(n);
+        nmea_flashlog_append(&s_log, &fix);
+    }
+    nmea_flashlog_sync(&s_log);
+    uint64_t appendUs = nmea_wall_us() - start;
+    uint32_t maxErases = 0;
+    for (uint32_t i = 0; i < size / FLASHLOG_SECTOR_SIZE; i++) {
+        maxErases = (emu.erases[i] > maxErases) ? emu.erases[i] : maxErases;
+    }
+    printf("FLASHLOG APPEND---------------------> %.0f fixes/s (%.2f us per fix, file-backed)\n",
+           appendUs ? fixes * 1e6 / appendUs : 0.0, (double) appendUs / fixes);
+    printf("FLASHLOG PAGES/ERASES---------------> %llu pages, %llu sector erases, %lu max per sector\n",
+           (unsigned long long) s_log.stats.pagesWritten, (unsigned long long) emu.sectorErases,
+           (unsigned long) maxErases);
+    printf("FLASHLOG MODELLED FLASH BUSY--------> %.1f s (%.0f us per fix)\n", emu.busyUs / 1e6,
+           (double) emu.busyUs / fixes);
+    printf("FLASHLOG BITS PROGRAMMED 0->1-------> %llu (must be 0)\n", (unsigned long long) emu.bitErrors);
+
+    //Recovery after a restart: binary search against a scan of every page header
+    uint64_t reads = emu.reads;
+    bool ok = benchReopen(&io, &s_reopened) == fixes;
+    uint64_t recoveryReads = emu.reads - reads;
+    ok = ok && s_reopened.headPage == s_log.headPage && s_reopened.headSeq == s_log.headSeq;
+    printf("FLASHLOG RECOVERY-------------------> %s, %llu us, %lu header reads (%llu reads with the last fix)\n",
+           ok ? "OK" : "WRONG HEAD", (unsigned long long) s_reopened.stats.recoveryUs,
+           (unsigned long) s_reopened.stats.recoveryReads, (unsigned long long) recoveryReads);
+    logPage_t header;
+    start = nmea_wall_us();
+    uint32_t valid = 0;
+    for (uint32_t page = 0; page < s_log.pages; page++) {
+        valid += readHeader(&s_log, page, &header);
+    }
+    printf("FLASHLOG FULL SCAN------------------> %llu us, %lu header reads (%lu valid pages)\n",
+           (unsigned long long) (nmea_wall_us() - start), (unsigned long) s_log.pages, (unsigned long) valid);
+
+    benchCheck_t check = { 0 };
+    start = nmea_wall_us();
+    nmea_flashlog_read(&s_reopened, benchCheckFix, &check);
+    printf("FLASHLOG READ BACK------------------> %llu fixes %lu..%lu, %llu out of order, %llu bad (%llu us)\n",
+           (unsigned long long) check.fixes, (unsigned long) check.first, (unsigned long) check.last,
+           (unsigned long long) check.unordered, (unsigned long long) s_reopened.stats.badRecords,
+           (unsigned long long) (nmea_wall_us() - start));
+
+    //Power cut in the middle of a page write: the torn page is skipped and the log continues in the next sector
+    uint32_t n = fixes;
+    emu.tearAtWrite = emu.writes + 3;
+    while (emu.writes < emu.tearAtWrite) {
+        nmea_PackedFix_t fix = benchFix(++n);
+        nmea_flashlog_append(&s_reopened, &fix);
+    }
+    //The first half of the torn page was programmed, its complete records are kept
+    uint32_t kept = benchReopen(&io, &s_log) - (n - FLASHLOG_RECORDS_PER_PAGE);
+    bool tornOk = kept < FLASHLOG_RECORDS_PER_PAGE;
+    for (uint32_t i = 0; i < 5 * FLASHLOG_RECORDS_PER_PAGE; i++) {
+        nmea_PackedFix_t fix = benchFix(++n);
+        nmea_flashlog_append(&s_log, &fix);
+    }
+    nmea_flashlog_sync(&s_log);
+    tornOk = tornOk && benchReopen(&io, &s_reopened) == n;
+    memset(&check, 0, sizeof(check));
+    nmea_flashlog_read(&s_reopened, benchCheckFix, &check);
+    tornOk = tornOk && check.unordered == 0 && check.last == n && emu.bitErrors == 0;
+    printf("FLASHLOG TORN WRITE-----------------> %s, %lu of %u fixes of the torn page kept, %llu us recovery\n",
+           tornOk ? "OK" : "FAILED", (unsigned long) kept, (unsigned) FLASHLOG_RECORDS_PER_PAGE,
+           (unsigned long long) s_log.stats.recoveryUs);
+
+    //Failed write of the first page of a sector while logging goes on: nothing of the page is programmed, the log
+    //continues in the same sector and the head must be found behind the failed page
+    while ((s_reopened.headPage + 1) % LOG_PAGES_PER_SECTOR != 0 || s_reopened.count != 0) {
+        nmea_PackedFix_t fix = benchFix(++n);
+        nmea_flashlog_append(&s_reopened, &fix);
+    }
+    emu.failAtWrite = emu.writes + 1;
+    uint32_t lost = n + 1;
+    for (uint32_t i = 0; i < 3 * FLASHLOG_RECORDS_PER_PAGE; i++) {
+        nmea_PackedFix_t fix = benchFix(++n);
+        nmea_flashlog_append(&s_reopened, &fix);
+    }
+    uint32_t failedPage = (s_reopened.headPage + s_reopened.pages - 2) % s_reopened.pages;
+    bool failOk = benchReopen(&io, &s_log) == n && s_log.headPage == s_reopened.headPage &&
+                  s_log.headSeq == s_reopened.headSeq && failedPage % LOG_PAGES_PER_SECTOR == 0;
+    //The next append goes on from the head found, the fixes before the failed page stay readable
+    for (uint32_t i = 0; i < FLASHLOG_RECORDS_PER_PAGE; i++) {
+        nmea_PackedFix_t fix = benchFix(++n);
+        nmea_flashlog_append(&s_log, &fix);
+    }
+    memset(&check, 0, sizeof(check));
+    nmea_flashlog_read(&s_log, benchCheckFix, &check);
+    failOk = failOk && benchReopen(&io, &s_reopened) == n && check.unordered == 0 && check.last == n && emu.bitErrors == 0;
+    printf("FLASHLOG FAILED SECTOR START--------> %s, page %lu failed (fixes %lu..%lu lost), head page %lu\n",
+           failOk ? "OK" : "FAILED", (unsigned long) failedPage, (unsigned long) lost,
+           (unsigned long) (lost + FLASHLOG_RECORDS_PER_PAGE - 1), (unsigned long) s_reopened.headPage);
+    nmea_flashemu_close(&emu);
+    unlink(path);
+}
+#else
+/**
+ * @brief partRead function reads a data partition
+ * @param ctx is the partition
+ * @param offset is the partition offset
+ * @param buf holds the bytes
+ * @param len is the length
+ * @return int is 0 on success or -1 on failure
+ */
+static int partRead(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    return (esp_partition_read(ctx, offset, buf, len) == ESP_OK) ? 0 : -1;
+}
+
+/**
+ * @brief partWrite function programs a data partition
+ * @param ctx is the partition
+ * @param offset is the partition offset
+ * @param data is the bytes
+ * @param len is the length
+ * @return int is 0 on success or -1 on failure
+ */
+static int partWrite(void *ctx, uint32_t offset, const void *data, size_t len)
+{
+    return (esp_partition_write(ctx, offset, data, len) == ESP_OK) ? 0 : -1;
+}
+
+/**
+ * @brief partErase function erases sectors of a data partition
+ * @param ctx is the partition
+ * @param offset is the partition offset (sector aligned)
+ * @param len is the length (whole sectors)
+ * @return int is 0 on success or -1 on failure
+ */
+static int partErase(void *ctx, uint32_t offset, size_t len)
+{
+    return (esp_partition_erase_range(ctx, offset, len) == ESP_OK) ? 0 : -1;
+}
+
+/**
+ * @brief nmea_flashlog_partition function gives the flash access of a data partition
+ * @param label is the partition label e.g., CONFIG_GGA_FLASHLOG_PARTITION
+ * @param io holds the flash access
+ * @return int is 0 on success or -1 if the partition does not exist
+ */
+int nmea_flashlog_partition(const char *label, nmea_FlashIo_t *io)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (part == NULL) {
+        printf("ERROR: Partition %s NOT found!\n", label);
+        return -1;
+    }
+    io->read = partRead;
+    io->write = partWrite;
+    io->erase = partErase;
+    io->ctx = (void*) part;
+    io->size = part->size / FLASHLOG_SECTOR_SIZE * FLASHLOG_SECTOR_SIZE;
+    return 0;
+}
+#endif
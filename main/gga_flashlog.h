@@ -0,0 +1,192 @@
+/**
+ * @brief Append-only circular log of packed fixes on raw flash.
+ * -The log is a ring of pages (CONFIG_GGA_FLASHLOG_PAGE_SIZE bytes) inside the 4 kB erase sectors of a flash
+ * -partition. The fixes are collected in a RAM page and written as one page-aligned batch when the page is full or on
+ * -nmea_flashlog_sync, so a page is programmed once and a sector is erased once per lap, just before its first page
+ * -is written again (the oldest fixes are overwritten). Every page has a header with its sequence number and a CRC-32,
+ * -every record has a header with its size, its type and a CRC-32 of the fix. The sequence number of a page is the
+ * -number of its position since the log was started, so on boot the head is found with a binary search over the first
+ * -valid pages of the sectors and then over the pages of the head sector, about log2(pages) header reads instead of a
+ * -full scan. A page torn by a power cut is never written again: the log continues in the next sector. A failed write
+ * -of the first page of a sector continues in the next page of the same sector, so every written sector has a valid page.
+ * -The flash is reached through nmea_FlashIo_t, on the ESP32 a data partition, on the host a file-backed emulator
+ * -with the NOR rules (erase sets every bit, programming only clears bits) and a model of the program/erase times.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Defaults when the sdkconfig options are not available (host builds outside of ESP-IDF)
+#ifndef CONFIG_GGA_FLASHLOG_PAGE_SIZE
+#define CONFIG_GGA_FLASHLOG_PAGE_SIZE 512
+#endif
+#ifndef CONFIG_GGA_FLASHLOG_PARTITION
+#define CONFIG_GGA_FLASHLOG_PARTITION "gpslog"
+#endif
+
+#define FLASHLOG_SECTOR_SIZE 4096       //Erase unit of the flash
+#define FLASHLOG_PAGE_HEADER_SIZE 16    //Magic, sequence number, record count and CRC-32
+#define FLASHLOG_RECORD_SIZE (8 + sizeof(nmea_PackedFix_t))     //CRC-32, size, type and the fix
+#define FLASHLOG_RECORDS_PER_PAGE ((CONFIG_GGA_FLASHLOG_PAGE_SIZE - FLASHLOG_PAGE_HEADER_SIZE) / FLASHLOG_RECORD_SIZE)
+
+/**
+ * @brief Flash access, every function returns 0 on success
+ */
+typedef struct {
+    int (*read)(void* , uint32_t , void* , size_t );            //ctx, offset, buffer, length
+    int (*write)(void* , uint32_t , const void* , size_t );     //ctx, offset, data, length (erased flash only)
+    int (*erase)(void* , uint32_t , size_t );                   //ctx, offset, length (whole sectors)
+    void *ctx;
+    uint32_t size;                      //bytes, a multiple of FLASHLOG_SECTOR_SIZE (at least 2 sectors)
+} nmea_FlashIo_t;
+
+/**
+ * @brief Fix log statistics
+ */
+typedef struct {
+    uint64_t appended;                  //fixes given to nmea_flashlog_append
+    uint64_t pagesWritten;
+    uint64_t sectorsErased;
+    uint64_t recordsLost;               //fixes of pages which could not be written
+    uint64_t pagesSkipped;              //pages left unused after a torn or failed write
+    uint64_t writeErrors;
+    uint64_t badRecords;                //records with a wrong CRC found by nmea_flashlog_read
+    uint32_t recoveryReads;             //page header reads of nmea_flashlog_open
+    uint64_t recoveryUs;                //time of nmea_flashlog_open
+} nmea_FlashLogStats_t;
+
+/**
+ * @brief Fix log, open with nmea_flashlog_open
+ */
+typedef struct {
+    nmea_FlashIo_t io;
+    uint32_t pages;                     //pages of the log
+    bool hasHead;                       //a page has been written
+    uint32_t headPage;                  //last written page
+    uint32_t headSeq;                   //its sequence number
+    bool headSectorUsed;                //a page of the head sector has been written
+    uint16_t count;                     //fixes in the RAM page
+    uint8_t page[CONFIG_GGA_FLASHLOG_PAGE_SIZE];
+    nmea_FlashLogStats_t stats;
+} nmea_FlashLog_t;
+
+/**
+ * @brief Callback of nmea_flashlog_read, given every logged fix from the oldest to the newest
+ */
+typedef void (*nmea_FlashLogCallback_t)(void* , const nmea_PackedFix_t* );
+
+/**
+ * @brief nmea_flashlog_open function finds the head of the log with a binary search over the page sequence numbers
+ * @param log is the fix log
+ * @param io is the flash access
+ * @return int is 0 on success or -1 if the flash is too small or cannot be read
+ */
+int nmea_flashlog_open(nmea_FlashLog_t* , const nmea_FlashIo_t* );
+
+/**
+ * @brief nmea_flashlog_append function adds a fix to the RAM page, the page is written when it is full
+ * @param log is the fix log
+ * @param fix is the packed fix
+ * @return int is 0 on success or -1 if the full page could not be written (its fixes are lost)
+ */
+int nmea_flashlog_append(nmea_FlashLog_t* , const nmea_PackedFix_t* );
+
+/**
+ * @brief nmea_flashlog_sync function writes the fixes of the RAM page now e.g., before deep sleep, the rest of the
+ * -page stays unused
+ * @param log is the fix log
+ * @return int is 0 on success or -1 on a write failure
+ */
+int nmea_flashlog_sync(nmea_FlashLog_t* );
+
+/**
+ * @brief nmea_flashlog_last function gives the newest logged fix (the RAM page included)
+ * @param log is the fix log
+ * @param fix holds the fix
+ * @return bool is true if the log holds a fix
+ */
+bool nmea_flashlog_last(nmea_FlashLog_t* , nmea_PackedFix_t* );
+
+/**
+ * @brief nmea_flashlog_read function gives every logged fix to the callback, from the oldest to the newest
+ * @param log is the fix log
+ * @param callback is called for every fix
+ * @param arg is given to the callback
+ * @return uint64_t is the number of fixes
+ */
+uint64_t nmea_flashlog_read(nmea_FlashLog_t* , nmea_FlashLogCallback_t , void* );
+
+/**
+ * @brief nmea_flashlog_print function prints the fix log statistics to console
+ * @param log is the fix log
+ * @return void
+ */
+void nmea_flashlog_print(const nmea_FlashLog_t* );
+
+#ifdef __linux__
+/**
+ * @brief File-backed NOR flash emulator
+ */
+typedef struct {
+    int fd;
+    uint32_t size;
+    uint32_t *erases;                   //erase count of every sector
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t sectorErases;
+    uint64_t bytesWritten;
+    uint64_t bitErrors;                 //writes which needed a 0 bit to become 1 (not erased), must stay 0
+    uint64_t busyUs;                    //modelled program and erase time
+    uint64_t tearAtWrite;               //the write with this number is cut in half and fails (0 never)
+    uint64_t failAtWrite;               //the write with this number programs nothing and fails (0 never)
+} nmea_FlashEmu_t;
+
+/**
+ * @brief nmea_flashemu_open function opens or creates an emulated flash file (created erased)
+ * @param emu is the emulator
+ * @param path is the file
+ * @param size is the flash size in bytes (multiple of FLASHLOG_SECTOR_SIZE)
+ * @param io holds the flash access of the emulator
+ * @return int is 0 on success or -1 on failure
+ */
+int nmea_flashemu_open(nmea_FlashEmu_t* , const char* , uint32_t , nmea_FlashIo_t* );
+
+/**
+ * @brief nmea_flashemu_close function closes an emulated flash file
+ * @param emu is the emulator
+ * @return void
+ */
+void nmea_flashemu_close(nmea_FlashEmu_t* );
+
+/**
+ * @brief nmea_flashlog_benchmark function appends generated fixes to a log in an emulated flash file and prints the
+ * -append throughput, the flash wear and the recovery time after a restart and after a torn write
+ * @param path is the emulated flash file (replaced)
+ * @param sizeKb is the size of the log in kB
+ * @param fixes is the number of fixes
+ * @return void
+ */
+void nmea_flashlog_benchmark(const char* , uint32_t , uint32_t );
+#else
+/**
+ * @brief nmea_flashlog_partition function gives the flash access of a data partition
+ * @param label is the partition label e.g., CONFIG_GGA_FLASHLOG_PARTITION
+ * @param io holds the flash access
+ * @return int is 0 on success or -1 if the partition does not exist
+ */
+int nmea_flashlog_partition(const char* , nmea_FlashIo_t* );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,401 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gga_forward.h"
+#include "gga_encode.h"
+#include "gga_bench.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#define TOKEN 1000000u                  //One sentence in the token bucket
+
+_Static_assert(CONFIG_GGA_FORWARD_BATCH >= 1, "CONFIG_GGA_FORWARD_BATCH must be at least 1");
+
+/**
+ * @brief flush function gives the queued gather list to the sink
+ * @param forwarder is the forwarder
+ * @return void
+ */
+static void flush(nmea_Forwarder_t *forwarder)
+{
+    if (forwarder->vecCount == 0) {
+        return;
+    }
+    forwarder->stats.batches++;
+    forwarder->stats.vectors += (uint64_t) forwarder->vecCount;
+    if (!forwarder->sink(forwarder->sinkArg, forwarder->vec, forwarder->vecCount)) {
+        forwarder->stats.sinkErrors++;
+        forwarder->stats.sinkLost += forwarder->batchSentences;
+    }
+    forwarder->vecCount = 0;
+    forwarder->batchSentences = 0;
+}
+
+/**
+ * @brief queue function adds a line to the gather list, merged with the previous entry if it follows it directly
+ * @param forwarder is the forwarder
+ * @param line is the line
+ * @param len is the length of the line with its line ending
+ * @return void
+ */
+static void queue(nmea_Forwarder_t *forwarder, const char *line, size_t len)
+{
+    nmea_ForwardVec_t *last = (forwarder->vecCount > 0) ? &forwarder->vec[forwarder->vecCount - 1] : NULL;
+    if (last != NULL && (const char*) last->iov_base + last->iov_len == line) {
+        last->iov_len += len;
+    }
+    else {
+        if (forwarder->vecCount == CONFIG_GGA_FORWARD_BATCH) {
+            flush(forwarder);
+        }
+        forwarder->vec[forwarder->vecCount].iov_base = (void*) line;
+        forwarder->vec[forwarder->vecCount].iov_len = len;
+        forwarder->vecCount++;
+    }
+    forwarder->batchSentences++;
+    forwarder->stats.forwarded++;
+    forwarder->stats.bytesForwarded += len;
+}
+
+/**
+ * @brief typeAllowed function checks the address field of a good line against the type filter
+ * @param forwarder is the forwarder
+ * @param line is the line (starts with '$' or '!')
+ * @param len is the length of the line without the line ending
+ * @return bool is true if the sentence type is listed
+ */
+static bool typeAllowed(const nmea_Forwarder_t *forwarder, const char *line, size_t len)
+{
+    //The address field is the 5 charachters after '$', the type is the last 3 of them
+    if (len < 6) {
+        return false;
+    }
+    for (int i = 0; i < forwarder->typeCount; i++) {
+        const char *address = (forwarder->typeLen[i] == 5) ? line + 1 : line + 3;
+        if (memcmp(address, forwarder->types[i], forwarder->typeLen[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief handleLine function validates one line and queues it when it passes the type filter and the rate limit
+ * @param forwarder is the forwarder
+ * @param line is the line
+ * @param len is the length of the line with its '\n'
+ * @return void
+ */
+static void handleLine(nmea_Forwarder_t *forwarder, const char *line, size_t len)
+{
+    size_t textLen = len;
+    while (textLen > 0 && (line[textLen - 1] == '\n' || line[textLen - 1] == '\r')) {
+        textLen--;
+    }
+    if (textLen == 0) {
+        return;
+    }
+    forwarder->stats.lines++;
+    int reason = nmea_validate_line(line, textLen);
+    if (reason >= 0) {
+        forwarder->stats.bad[reason]++;
+        return;
+    }
+    if (forwarder->typeCount > 0 && !typeAllowed(forwarder, line, textLen)) {
+        forwarder->stats.otherType++;
+        return;
+    }
+    if (forwarder->ratePerSec != 0) {
+        if (forwarder->tokensMicro < TOKEN) {
+            forwarder->stats.rateLimited++;
+            return;
+        }
+        forwarder->tokensMicro -= TOKEN;
+    }
+    queue(forwarder, line, len);
+}
+
+/**
+ * @brief refill function adds the tokens of the time since the previous chunk
+ * @param forwarder is the forwarder
+ * @param nowUs is the monotonic time in microseconds
+ * @return void
+ */
+static void refill(nmea_Forwarder_t *forwarder, uint64_t nowUs)
+{
+    if (forwarder->ratePerSec == 0) {
+        return;
+    }
+    if (forwarder->hasTime && nowUs > forwarder->lastUs) {
+        uint64_t elapsed = nowUs - forwarder->lastUs;
+        //Long pauses only fill the bucket, the product could overflow
+        uint64_t add = (elapsed >= forwarder->burstMicro) ? forwarder->burstMicro : elapsed * forwarder->ratePerSec;
+        forwarder->tokensMicro = (forwarder->tokensMicro + add > forwarder->burstMicro) ? forwarder->burstMicro
+                               : forwarder->tokensMicro + add;
+    }
+    forwarder->lastUs = nowUs;
+    forwarder->hasTime = true;
+}
+
+/**
+ * @brief nmea_forward_init function resets the forwarder, every sentence type is forwarded without a rate limit
+ * @param forwarder is the forwarder
+ * @param sink is the output sink
+ * @param arg is given to the sink
+ * @return void
+ */
+void nmea_forward_init(nmea_Forwarder_t *forwarder, nmea_ForwardSink_t sink, void *arg)
+{
+    memset(forwarder, 0, sizeof(*forwarder));
+    forwarder->sink = sink;
+    forwarder->sinkArg = arg;
+}
+
+/**
+ * @brief nmea_forward_allow function adds a sentence type to the type filter
+ * @param forwarder is the forwarder
+ * @param type is the sentence type ("GGA" for every talker) or the address field ("GPGGA")
+ * @return bool is false if the type is not 3 or 5 charachters or the list is full
+ */
+bool nmea_forward_allow(nmea_Forwarder_t *forwarder, const char *type)
+{
+    size_t len = strlen(type);
+    if ((len != 3 && len != 5) || forwarder->typeCount == NMEA_FORWARD_MAX_TYPES) {
+        printf("ERROR: Sentence type can not be added to the forwarding filter!\n");
+        return false;
+    }
+    memcpy(forwarder->types[forwarder->typeCount], type, len + 1);
+    forwarder->typeLen[forwarder->typeCount] = (uint8_t) len;
+    forwarder->typeCount++;
+    return true;
+}
+
+/**
+ * @brief nmea_forward_rate function limits the forwarded sentences with a token bucket
+ * @param forwarder is the forwarder
+ * @param perSecond is the sustained rate in sentences per second (0 disables the rate limit)
+ * @param burst is the number of sentences which can be forwarded at once (at least 1)
+ * @return void
+ */
+void nmea_forward_rate(nmea_Forwarder_t *forwarder, uint32_t perSecond, uint32_t burst)
+{
+    forwarder->ratePerSec = perSecond;
+    forwarder->burstMicro = (uint64_t) ((burst != 0) ? burst : 1) * TOKEN;
+    forwarder->tokensMicro = forwarder->burstMicro;
+    forwarder->hasTime = false;
+}
+
+/**
+ * @brief nmea_forward_feed function forwards the complete lines of the next chunk of the stream
+ * @param forwarder is the forwarder
+ * @param data is the chunk
+ * @param len is the length of the chunk
+ * @param nowUs is the monotonic time in microseconds (used by the rate limit)
+ * @return size_t is the number of sentences forwarded in this call
+ */
+size_t nmea_forward_feed(nmea_Forwarder_t *forwarder, const char *data, size_t len, uint64_t nowUs)
+{
+    uint64_t before = forwarder->stats.forwarded;
+    const char *p = data;
+    const char *end = data + len;
+    const char *nl;
+    refill(forwarder, nowUs);
+    forwarder->stats.bytes += len;
+    //The line split across the previous chunk is completed in the pending buffer
+    if (forwarder->pendingLen > 0 || forwarder->discarding) {
+        nl = memchr(p, '\n', len);
+        size_t take = (nl != NULL) ? (size_t) (nl + 1 - p) : len;
+        if (!forwarder->discarding && forwarder->pendingLen + take <= NMEA_MAX_SENTENCE_LEN) {
+            memcpy(forwarder->pending + forwarder->pendingLen, p, take);
+            forwarder->pendingLen += take;
+            forwarder->stats.copiedBytes += take;
+        }
+        else {
+            forwarder->discarding = true;
+            forwarder->pendingLen = 0;
+        }
+        if (nl == NULL) {
+            return 0;
+        }
+        if (forwarder->discarding) {
+            forwarder->stats.lines++;
+            forwarder->stats.bad[NMEA_BAD_OVERLONG]++;
+            forwarder->discarding = false;
+        }
+        else {
+            handleLine(forwarder, forwarder->pending, forwarder->pendingLen);
+        }
+        p = nl + 1;
+    }
+    while (p < end && (nl = memchr(p, '\n', (size_t) (end - p))) != NULL) {
+        handleLine(forwarder, p, (size_t) (nl + 1 - p));
+        p = nl + 1;
+    }
+    //The gather list may point into the pending buffer, so it is sent before the buffer is reused
+    flush(forwarder);
+    forwarder->pendingLen = 0;
+    size_t rest = (size_t) (end - p);
+    if (rest > NMEA_MAX_SENTENCE_LEN) {
+        forwarder->discarding = true;
+    }
+    else if (rest > 0) {
+        memcpy(forwarder->pending, p, rest);
+        forwarder->pendingLen = rest;
+        forwarder->stats.copiedBytes += rest;
+    }
+    return (size_t) (forwarder->stats.forwarded - before);
+}
+
+#ifdef __linux__
+/**
+ * @brief nmea_forward_fd_sink function is a sink which writes the gather list to a descriptor with writev
+ * @param arg is the pointer to the descriptor (int)
+ * @param vec is the gather list
+ * @param count is the number of entries
+ * @return bool is false if the descriptor failed before every byte was written
+ */
+bool nmea_forward_fd_sink(void *arg, const nmea_ForwardVec_t *vec, int count)
+{
+    int fd = *(const int*) arg;
+    struct iovec rest[CONFIG_GGA_FORWARD_BATCH];
+    int n = (count < CONFIG_GGA_FORWARD_BATCH) ? count : CONFIG_GGA_FORWARD_BATCH;
+    memcpy(rest, vec, (size_t) n * sizeof(*rest));
+    struct iovec *v = rest;
+    //A partial write continues with the entries that are left
+    while (n > 0) {
+        ssize_t written = writev(fd, v, n);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        while (n > 0 && (size_t) written >= v->iov_len) {
+            written -= (ssize_t) v->iov_len;
+            v++;
+            n--;
+        }
+        if (n > 0) {
+            v->iov_base = (char*) v->iov_base + written;
+            v->iov_len -= (size_t) written;
+        }
+    }
+    return true;
+}
+#endif
+
+/**
+ * @brief nmea_forward_print function prints the forwarding statistics to console
+ * @param forwarder is the forwarder
+ * @return void
+ */
+void nmea_forward_print(const nmea_Forwarder_t *forwarder)
+{
+    const nmea_ForwardStats_t *stats = &forwarder->stats;
+    printf("FORWARD LINES/FORWARDED-------------> %llu/%llu (%llu bytes)\n", (unsigned long long) stats->lines,
+           (unsigned long long) stats->forwarded, (unsigned long long) stats->bytesForwarded);
+    printf("FORWARD BAD CHECKSUM/TRUNCATED------> %llu/%llu\n", (unsigned long long) stats->bad[NMEA_BAD_CHECKSUM],
+           (unsigned long long) stats->bad[NMEA_BAD_TRUNCATED]);
+    printf("FORWARD BAD FRAMING/OVERLONG--------> %llu/%llu\n", (unsigned long long) stats->bad[NMEA_BAD_FRAMING],
+           (unsigned long long) stats->bad[NMEA_BAD_OVERLONG]);
+    printf("FORWARD OTHER TYPE/RATE LIMITED-----> %llu/%llu\n", (unsigned long long) stats->otherType,
+           (unsigned long long) stats->rateLimited);
+    printf("FORWARD SINK CALLS/ENTRIES----------> %llu/%llu\n", (unsigned long long) stats->batches,
+           (unsigned long long) stats->vectors);
+    printf("FORWARD SINK ERRORS/LOST------------> %llu/%llu\n", (unsigned long long) stats->sinkErrors,
+           (unsigned long long) stats->sinkLost);
+    printf("FORWARD BYTES COPIED----------------> %llu of %llu\n", (unsigned long long) stats->copiedBytes,
+           (unsigned long long) stats->bytes);
+}
+
+/**
+ * @brief benchSink function is a sink which only counts the bytes
+ * @param arg is the pointer to the byte counter
+ * @param vec is the gather list
+ * @param count is the number of entries
+ * @return bool is always true
+ */
+static bool benchSink(void *arg, const nmea_ForwardVec_t *vec, int count)
+{
+    for (int i = 0; i < count; i++) {
+        *(uint64_t*) arg += vec[i].iov_len;
+    }
+    return true;
+}
+
+/**
+ * @brief nmea_forward_benchmark function compares validated forwarding with full parsing and encoding of a capture
+ * @param sentences is the number of sentences in the capture
+ * @return void
+ */
+void nmea_forward_benchmark(uint32_t sentences)
+{
+    static const char s_rmc[] = "GPRMC,002153.000,A,3342.6618,N,11751.3858,W,0.02,31.66,280511,,,A";
+    static nmea_Forwarder_t s_forwarder;
+    size_t size = (size_t) sentences * ENCODE_MAX_SENTENCE_LEN;
+    char *capture = malloc(size);
+    if (capture == NULL) {
+        printf("ERROR: No memory for the forwarding benchmark!\n");
+        return;
+    }
+    //3 of 4 sentences are GGA, every 64th line is corrupted
+    uint32_t rng = 0x2545F491u;
+    size_t len = 0;
+    nmea_PackedFix_t fix = { 0 };
+    fix.altitude = 2700;
+    fix.geoSep = -3420;
+    fix.qIndicator = 1;
+    fix.emptyMask = 1u << NMEA_FIELD_TDGPS;
+    for (uint32_t i = 0; i < sentences; i++) {
+        char *line = capture + len;
+        if (i % 4 == 3) {
+            len += (size_t) sprintf(line, "$%s*%02X\r\n", s_rmc, nmea_checksum(s_rmc, sizeof(s_rmc) - 1));
+        }
+        else {
+            fix.timeMs = i * 100u;
+            fix.latitude = 20056618 + (int32_t) (nmea_bench_random(&rng) % 4096);
+            fix.longitude = -70313858 - (int32_t) (nmea_bench_random(&rng) % 4096);
+            fix.satTracked = (uint8_t) (4 + nmea_bench_random(&rng) % 9);
+            fix.hdop = (uint16_t) (60 + nmea_bench_random(&rng) % 200);
+            len += nmea_encode_packed(&fix, line, ENCODE_MAX_SENTENCE_LEN);
+        }
+        if (nmea_bench_random(&rng) % 64 == 0) {
+            line[8] ^= 0x01;
+        }
+    }
+    //Validated pass-through of the GGA sentences, fed in 1 kB chunks like a socket or UART read
+    uint64_t sunk = 0;
+    nmea_forward_init(&s_forwarder, benchSink, &sunk);
+    nmea_forward_allow(&s_forwarder, "GGA");
+    uint64_t start = nmea_wall_us();
+    for (size_t off = 0; off < len; off += 1024) {
+        nmea_forward_feed(&s_forwarder, capture + off, (len - off < 1024) ? len - off : 1024, 0);
+    }
+    uint64_t forwardUs = nmea_wall_us() - start;
+    //Full parse and encode of the same sentences
+    nmea_ParseResult_t result;
+    char encoded[ENCODE_MAX_SENTENCE_LEN];
+    uint64_t reencoded = 0;
+    uint64_t encodedBytes = 0;
+    start = nmea_wall_us();
+    for (const char *p = capture, *nl; p < capture + len && (nl = memchr(p, '\n', (size_t) (capture + len - p))) != NULL; p = nl + 1) {
+        if (nmea_gga_parse_r(p, (size_t) (nl + 1 - p), &result)) {
+            encodedBytes += nmea_encode_fix(&result, encoded, sizeof(encoded));
+            reencoded++;
+        }
+    }
+    uint64_t parseUs = nmea_wall_us() - start;
+    printf("FORWARD BENCHMARK: %lu sentences, %lu bytes\n", (unsigned long) sentences, (unsigned long) len);
+    nmea_forward_print(&s_forwarder);
+    printf("FORWARD PASS-THROUGH----------------> %.0f sentences/s (%llu forwarded, %llu us)\n",
+           (forwardUs != 0) ? (double) sentences * 1e6 / (double) forwardUs : 0.0,
+           (unsigned long long) s_forwarder.stats.forwarded, (unsigned long long) forwardUs);
+    printf("FORWARD PARSE + RE-ENCODE-----------> %.0f sentences/s (%llu re-encoded into %llu bytes, %llu us)\n",
+           (parseUs != 0) ? (double) sentences * 1e6 / (double) parseUs : 0.0,
+           (unsigned long long) reencoded, (unsigned long long) encodedBytes, (unsigned long long) parseUs);
+    if (sunk != s_forwarder.stats.bytesForwarded) {
+        printf("ERROR: Forwarding benchmark lost bytes!\n");
+    }
+    free(capture);
+}
@@ -0,0 +1,160 @@
+/**
+ * @brief Validated pass-through forwarding of NMEA sentences without field decoding.
+ * -The stream is framed into lines and every line is checked with the rules of nmea_validate_line (framing, length
+ * -and "*hh" checksum), no field is decoded. The good lines can be limited to some sentence types and to a rate, then
+ * -their original bytes ("\r\n" included) are given to a sink as a gather list (writev style) which points into the
+ * -caller's chunk. Lines which follow each other in the chunk are merged into one entry. Only a line split across two
+ * -chunks is copied (at most NMEA_MAX_SENTENCE_LEN bytes).
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+#include "gga_validate.h"
+
+#ifdef __linux__
+#include <sys/uio.h>
+#endif
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Defaults when the sdkconfig options are not available (host builds outside of ESP-IDF)
+#ifndef CONFIG_GGA_FORWARD_BATCH
+#define CONFIG_GGA_FORWARD_BATCH 16
+#endif
+
+#define NMEA_FORWARD_MAX_TYPES 8        //Sentence types of the type filter
+
+/**
+ * @brief One entry of the gather list (struct iovec on linux so the sink can call writev directly)
+ */
+#ifdef __linux__
+typedef struct iovec nmea_ForwardVec_t;
+#else
+typedef struct {
+    void *iov_base;
+    size_t iov_len;
+} nmea_ForwardVec_t;
+#endif
+
+/**
+ * @brief Output sink, given the gather list of one batch (the entries are only valid during the call)
+ * -and returns false if the bytes could not be written
+ */
+typedef bool (*nmea_ForwardSink_t)(void* , const nmea_ForwardVec_t* , int );
+
+/**
+ * @brief Forwarding statistics
+ */
+typedef struct {
+    uint64_t bytes;                     //bytes fed
+    uint64_t lines;                     //non empty lines
+    uint64_t forwarded;                 //sentences given to the sink
+    uint64_t bytesForwarded;
+    uint64_t bad[NMEA_BAD_REASON_COUNT];//dropped lines per reason
+    uint64_t otherType;                 //good lines dropped by the type filter
+    uint64_t rateLimited;               //good lines dropped by the rate limit
+    uint64_t batches;                   //sink calls
+    uint64_t vectors;                   //gather list entries given to the sink
+    uint64_t sinkErrors;                //sink calls which returned false
+    uint64_t sinkLost;                  //sentences of the failed sink calls
+    uint64_t copiedBytes;               //bytes of the lines split across chunks
+} nmea_ForwardStats_t;
+
+/**
+ * @brief Forwarder state, initialize with nmea_forward_init
+ */
+typedef struct {
+    nmea_ForwardSink_t sink;
+    void *sinkArg;
+    char types[NMEA_FORWARD_MAX_TYPES][6];
+    uint8_t typeLen[NMEA_FORWARD_MAX_TYPES];
+    int typeCount;                      //0 forwards every sentence type
+    uint32_t ratePerSec;                //0 disables the rate limit
+    uint64_t burstMicro;                //token bucket in 1/1000000 of a sentence
+    uint64_t tokensMicro;
+    uint64_t lastUs;
+    bool hasTime;
+    char pending[NMEA_MAX_SENTENCE_LEN];//start of a line split across chunks
+    size_t pendingLen;
+    bool discarding;                    //the split line is already too long, dropped up to its '\n'
+    nmea_ForwardVec_t vec[CONFIG_GGA_FORWARD_BATCH];
+    int vecCount;
+    uint32_t batchSentences;
+    nmea_ForwardStats_t stats;
+} nmea_Forwarder_t;
+
+/**
+ * @brief nmea_forward_init function resets the forwarder, every sentence type is forwarded without a rate limit
+ * @param forwarder is the forwarder
+ * @param sink is the output sink
+ * @param arg is given to the sink
+ * @return void
+ */
+void nmea_forward_init(nmea_Forwarder_t* , nmea_ForwardSink_t , void* );
+
+/**
+ * @brief nmea_forward_allow function adds a sentence type to the type filter, once a type is added only the listed
+ * -types are forwarded
+ * @param forwarder is the forwarder
+ * @param type is the sentence type ("GGA" for every talker) or the address field ("GPGGA")
+ * @return bool is false if the type is not 3 or 5 charachters or the list is full
+ */
+bool nmea_forward_allow(nmea_Forwarder_t* , const char* );
+
+/**
+ * @brief nmea_forward_rate function limits the forwarded sentences with a token bucket
+ * @param forwarder is the forwarder
+ * @param perSecond is the sustained rate in sentences per second (0 disables the rate limit)
+ * @param burst is the number of sentences which can be forwarded at once (at least 1)
+ * @return void
+ */
+void nmea_forward_rate(nmea_Forwarder_t* , uint32_t , uint32_t );
+
+/**
+ * @brief nmea_forward_feed function forwards the complete lines of the next chunk of the stream, the sink is called
+ * -before the function returns so the chunk can be reused afterwards
+ * @param forwarder is the forwarder
+ * @param data is the chunk
+ * @param len is the length of the chunk
+ * @param nowUs is the monotonic time in microseconds (used by the rate limit)
+ * @return size_t is the number of sentences forwarded in this call
+ */
+size_t nmea_forward_feed(nmea_Forwarder_t* , const char* , size_t , uint64_t );
+
+#ifdef __linux__
+/**
+ * @brief nmea_forward_fd_sink function is a sink which writes the gather list to a descriptor with writev
+ * @param arg is the pointer to the descriptor (int)
+ * @param vec is the gather list
+ * @param count is the number of entries
+ * @return bool is false if the descriptor failed before every byte was written
+ */
+bool nmea_forward_fd_sink(void* , const nmea_ForwardVec_t* , int );
+#endif
+
+/**
+ * @brief nmea_forward_print function prints the forwarding statistics to console
+ * @param forwarder is the forwarder
+ * @return void
+ */
+void nmea_forward_print(const nmea_Forwarder_t* );
+
+/**
+ * @brief nmea_forward_benchmark function compares validated forwarding with full parsing and encoding of the same
+ * -capture (GGA sentences mixed with other types and some corrupted lines) and prints sentences per second
+ * @param sentences is the number of sentences in the capture
+ * @return void
+ */
+void nmea_forward_benchmark(uint32_t );
+
+#ifdef __cplusplus
+}
+#endif
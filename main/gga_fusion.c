@@ -0,0 +1,457 @@
+#include <stdio.h>
+#include <string.h>
+#include "gga_fusion.h"
+#include "gga_bench.h"
+
+#define DAY_MS 86400000u                //Epochs wrap around at midnight
+#define HALF_CIRCLE (180 * 60 * 10000)  //180 degrees in 1/10000 of a minute
+#define BIT(field) ((uint16_t) (1u << (field)))
+#define POSITION_BITS (BIT(NMEA_FIELD_LATITUDE) | BIT(NMEA_FIELD_LATITUDE_IND) | BIT(NMEA_FIELD_LONGITUDE) | BIT(NMEA_FIELD_LONGITUDE_IND))
+
+_Static_assert(CONFIG_GGA_FUSION_RECEIVERS >= 1 && CONFIG_GGA_FUSION_RECEIVERS <= 8, "CONFIG_GGA_FUSION_RECEIVERS must be 1 to 8");
+
+//Rank of the quality indicators: RTK fixed, float RTK, DGPS/PPS, GPS, dead reckoning/manual, invalid/simulation
+static const uint8_t s_qualityRank[MAX_QI_VAL + 1] = { 0, 2, 3, 3, 5, 4, 1, 1, 0 };
+
+/**
+ * @brief epochAfter function compares two epochs on the 24 hour circle
+ * @param a is the first epoch
+ * @param b is the second epoch
+ * @return bool is true if a is later than b (by less than 12 hours)
+ */
+static inline bool epochAfter(uint32_t a, uint32_t b)
+{
+    uint32_t diff = (a + DAY_MS - b) % DAY_MS;
+    return diff != 0 && diff < DAY_MS / 2;
+}
+
+/**
+ * @brief rankOf function gives the rank of a fix, fixes without a position are the worst
+ * @param fix is the packed fix
+ * @return int is the rank (0 no position, 1 no quality indicator, 2 to 7 by quality indicator)
+ */
+static int rankOf(const nmea_PackedFix_t *fix)
+{
+    uint16_t bad = fix->emptyMask | fix->falseMask;
+    if (bad & POSITION_BITS) {
+        return 0;
+    }
+    if ((bad & BIT(NMEA_FIELD_QIND)) || fix->qIndicator > MAX_QI_VAL) {
+        return 1;
+    }
+    return 2 + s_qualityRank[fix->qIndicator];
+}
+
+/**
+ * @brief isBetter function compares two fixes by rank, HDOP and satellites tracked
+ * @param a is the first fix
+ * @param b is the second fix
+ * @return bool is true if a is better than b
+ */
+static bool isBetter(const nmea_PackedFix_t *a, const nmea_PackedFix_t *b)
+{
+    int rankA = rankOf(a);
+    int rankB = rankOf(b);
+    if (rankA != rankB) {
+        return rankA > rankB;
+    }
+    uint16_t badA = a->emptyMask | a->falseMask;
+    uint16_t badB = b->emptyMask | b->falseMask;
+    uint32_t hdopA = (badA & BIT(NMEA_FIELD_HDOP)) ? UINT32_MAX : a->hdop;
+    uint32_t hdopB = (badB & BIT(NMEA_FIELD_HDOP)) ? UINT32_MAX : b->hdop;
+    if (hdopA != hdopB) {
+        return hdopA < hdopB;
+    }
+    int satA = (badA & BIT(NMEA_FIELD_SATELLITE)) ? -1 : a->satTracked;
+    int satB = (badB & BIT(NMEA_FIELD_SATELLITE)) ? -1 : b->satTracked;
+    return satA > satB;
+}
+
+/**
+ * @brief mergePosition function merges the positions of the fixes with the rank of the best fix (1/HDOP^2 weights)
+ * @param slot is the epoch
+ * @param receivers is the number of receivers
+ * @param best is the best receiver
+ * @param out holds the output fix
+ * @return uint8_t is the bit of every receiver whose position went into the output
+ */
+static uint8_t mergePosition(const nmea_FusionEpoch_t *slot, int receivers, int best, nmea_FusedFix_t *out)
+{
+    const nmea_PackedFix_t *ref = &slot->fix[best];
+    int rank = rankOf(ref);
+    uint8_t used = (uint8_t) (1u << best);
+    if (rank == 0 || ((ref->emptyMask | ref->falseMask) & BIT(NMEA_FIELD_HDOP))) {
+        return used;
+    }
+    double sumW = 0.0, lat = 0.0, lon = 0.0, altW = 0.0, alt = 0.0;
+    for (int r = 0; r < receivers; r++) {
+        const nmea_PackedFix_t *f = &slot->fix[r];
+        uint16_t bad = f->emptyMask | f->falseMask;
+        if (!(slot->reported & (1u << r)) || rankOf(f) != rank || (bad & BIT(NMEA_FIELD_HDOP))) {
+            continue;
+        }
+        double hdop = (f->hdop > 0) ? f->hdop : 1.0;
+        double w = 1.0 / (hdop * hdop);
+        //Longitudes are merged relative to the best fix so the antimeridian does not split them
+        int64_t dLon = (int64_t) f->longitude - ref->longitude;
+        dLon = (dLon > HALF_CIRCLE) ? dLon - 2 * HALF_CIRCLE : (dLon < -HALF_CIRCLE) ? dLon + 2 * HALF_CIRCLE : dLon;
+        sumW += w;
+        lat += w * f->latitude;
+        lon += w * (double) dLon;
+        if (!(bad & BIT(NMEA_FIELD_ALTITUDE))) {
+            altW += w;
+            alt += w * f->altitude;
+        }
+        used |= (uint8_t) (1u << r);
+    }
+    int64_t mergedLon = ref->longitude + (int64_t) (lon / sumW + (lon >= 0 ? 0.5 : -0.5));
+    mergedLon = (mergedLon > HALF_CIRCLE) ? mergedLon - 2 * HALF_CIRCLE : (mergedLon <= -HALF_CIRCLE) ? mergedLon + 2 * HALF_CIRCLE : mergedLon;
+    double mergedLat = lat / sumW;
+    out->fix.latitude = (int32_t) (mergedLat + (mergedLat >= 0 ? 0.5 : -0.5));
+    out->fix.longitude = (int32_t) mergedLon;
+    if (altW > 0.0 && !((ref->emptyMask | ref->falseMask) & BIT(NMEA_FIELD_ALTITUDE))) {
+        double mergedAlt = alt / altW;
+        out->fix.altitude = (int32_t) (mergedAlt + (mergedAlt >= 0 ? 0.5 : -0.5));
+    }
+    return used;
+}
+
+/**
+ * @brief emitEpoch function gives the fused fix of an epoch to the output and frees its slot
+ * @param fusion is the fusion state
+ * @param slot is the epoch
+ * @param nowUs is the time
+ * @param complete is true if every receiver had reported or moved on
+ * @return void
+ */
+static void emitEpoch(nmea_Fusion_t *fusion, nmea_FusionEpoch_t *slot, uint64_t nowUs, bool complete)
+{
+    nmea_FusedFix_t out;
+    int best = -1;
+    for (int r = 0; r < fusion->receivers; r++) {
+        if ((slot->reported & (1u << r)) && (best < 0 || isBetter(&slot->fix[r], &slot->fix[best]))) {
+            best = r;
+        }
+    }
+    out.fix = slot->fix[best];
+    out.fix.timeMs = slot->epochMs;
+    out.reported = slot->reported;
+    out.used = (uint8_t) (1u << best);
+    if (fusion->mode == NMEA_FUSION_MERGE) {
+        out.used = mergePosition(slot, fusion->receivers, best, &out);
+    }
+    out.byDeadline = !complete;
+    out.latencyUs = (uint32_t) (nowUs - slot->firstUs);
+    fusion->stats.emitted++;
+    fusion->stats.latencySumUs += out.latencyUs;
+    if (out.latencyUs > fusion->stats.latencyMaxUs) {
+        fusion->stats.latencyMaxUs = out.latencyUs;
+    }
+    fusion->hasEmitted = true;
+    fusion->lastEmittedMs = slot->epochMs;
+    slot->used = false;
+    if (fusion->output != NULL) {
+        fusion->output(fusion->outputArg, &out);
+    }
+}
+
+/**
+ * @brief oldestEpoch function finds the oldest waiting epoch
+ * @param fusion is the fusion state
+ * @return nmea_FusionEpoch_t* is the epoch or NULL if no epoch is waiting
+ */
+static nmea_FusionEpoch_t* oldestEpoch(nmea_Fusion_t *fusion)
+{
+    nmea_FusionEpoch_t *oldest = NULL;
+    for (int i = 0; i < CONFIG_GGA_FUSION_EPOCHS; i++) {
+        nmea_FusionEpoch_t *slot = &fusion->epoch[i];
+        if (slot->used && (oldest == NULL || epochAfter(oldest->epochMs, slot->epochMs))) {
+            oldest = slot;
+        }
+    }
+    return oldest;
+}
+
+/**
+ * @brief isComplete function checks if no more fixes can arrive for an epoch
+ * @param fusion is the fusion state
+ * @param slot is the epoch
+ * @return bool is true if every receiver has reported the epoch or a newer one
+ */
+static bool isComplete(const nmea_Fusion_t *fusion, const nmea_FusionEpoch_t *slot)
+{
+    for (int r = 0; r < fusion->receivers; r++) {
+        bool movedOn = (fusion->seen & (1u << r)) && epochAfter(fusion->latestMs[r], slot->epochMs);
+        if (!(slot->reported & (1u << r)) && !movedOn) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief drain function emits the waiting epochs in order while they are complete or past their deadline
+ * @param fusion is the fusion state
+ * @param nowUs is the time
+ * @param force is true to emit every waiting epoch
+ * @return void
+ */
+static void drain(nmea_Fusion_t *fusion, uint64_t nowUs, bool force)
+{
+    nmea_FusionEpoch_t *slot;
+    while ((slot = oldestEpoch(fusion)) != NULL) {
+        if (isComplete(fusion, slot)) {
+            fusion->stats.complete++;
+            emitEpoch(fusion, slot, nowUs, true);
+        }
+        else if (force || nowUs - slot->firstUs >= fusion->deadlineUs) {
+            fusion->stats.deadline++;
+            emitEpoch(fusion, slot, nowUs, false);
+        }
+        else {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief nmea_fusion_init function resets the fusion state
+ * @param fusion is the fusion state
+ * @param receivers is the number of receivers (1 to CONFIG_GGA_FUSION_RECEIVERS)
+ * @param mode is the selection of the output fix
+ * @param deadlineUs is the longest wait after the first report of an epoch
+ * @param output is the output callback
+ * @param arg is given to the output callback
+ * @return void
+ */
+void nmea_fusion_init(nmea_Fusion_t *fusion, int receivers, nmea_FusionMode_t mode, uint32_t deadlineUs, nmea_FusionOutput_t output, void *arg)
+{
+    memset(fusion, 0, sizeof(nmea_Fusion_t));
+    fusion->receivers = (receivers < 1) ? 1 : (receivers > CONFIG_GGA_FUSION_RECEIVERS) ? CONFIG_GGA_FUSION_RECEIVERS : receivers;
+    fusion->mode = mode;
+    fusion->deadlineUs = deadlineUs;
+    fusion->output = output;
+    fusion->outputArg = arg;
+}
+
+/**
+ * @brief nmea_fusion_add_packed function is nmea_fusion_add for a packed fix
+ * @param fusion is the fusion state
+ * @param receiver is the receiver (0 to receivers - 1)
+ * @param fix is the packed fix
+ * @param nowUs is the monotonic time in microseconds
+ * @return nmea_FusionStatus_t is the status of the fix
+ */
+nmea_FusionStatus_t nmea_fusion_add_packed(nmea_Fusion_t *fusion, int receiver, const nmea_PackedFix_t *fix, uint64_t nowUs)
+{
+    fusion->stats.fixes++;
+    if (receiver < 0 || receiver >= fusion->receivers || ((fix->emptyMask | fix->falseMask) & BIT(NMEA_FIELD_TIME))) {
+        fusion->stats.invalid++;
+        return NMEA_FUSION_INVALID;
+    }
+    uint32_t epochMs = fix->timeMs % DAY_MS;
+    if (fusion->hasEmitted && !epochAfter(epochMs, fusion->lastEmittedMs)) {
+        fusion->stats.late++;
+        return NMEA_FUSION_LATE;
+    }
+    nmea_FusionEpoch_t *slot = NULL;
+    nmea_FusionEpoch_t *empty = NULL;
+    for (int i = 0; i < CONFIG_GGA_FUSION_EPOCHS; i++) {
+        if (fusion->epoch[i].used && fusion->epoch[i].epochMs == epochMs) {
+            slot = &fusion->epoch[i];
+            break;
+        }
+        if (!fusion->epoch[i].used && empty == NULL) {
+            empty = &fusion->epoch[i];
+        }
+    }
+    if (slot != NULL && (slot->reported & (1u << receiver))) {
+        fusion->stats.duplicates++;
+        return NMEA_FUSION_DUPLICATE;
+    }
+    if (slot == NULL) {
+        if (empty == NULL) {
+            //The reorder window is full, the oldest epoch is emitted unless the new one is even older
+            nmea_FusionEpoch_t *oldest = oldestEpoch(fusion);
+            if (epochAfter(oldest->epochMs, epochMs)) {
+                fusion->stats.late++;
+                return NMEA_FUSION_LATE;
+            }
+            fusion->stats.overflow++;
+            emitEpoch(fusion, oldest, nowUs, false);
+            empty = oldest;
+        }
+        slot = empty;
+        slot->used = true;
+        slot->reported = 0;
+        slot->epochMs = epochMs;
+        slot->firstUs = nowUs;
+    }
+    slot->fix[receiver] = *fix;
+    slot->reported |= (uint8_t) (1u << receiver);
+    if (!(fusion->seen & (1u << receiver)) || epochAfter(epochMs, fusion->latestMs[receiver])) {
+        fusion->latestMs[receiver] = epochMs;
+        fusion->seen |= (uint8_t) (1u << receiver);
+    }
+    drain(fusion, nowUs, false);
+    return NMEA_FUSION_ACCEPTED;
+}
+
+/**
+ * @brief nmea_fusion_add function adds the fix of a receiver and emits the epochs which are complete
+ * @param fusion is the fusion state
+ * @param receiver is the receiver (0 to receivers - 1)
+ * @param fix is the parse result
+ * @param nowUs is the monotonic time in microseconds
+ * @return nmea_FusionStatus_t is the status of the fix
+ */
+nmea_FusionStatus_t nmea_fusion_add(nmea_Fusion_t *fusion, int receiver, const nmea_ParseResult_t *fix, uint64_t nowUs)
+{
+    nmea_PackedFix_t packed;
+    nmea_pack_fix(fix, &packed);
+    return nmea_fusion_add_packed(fusion, receiver, &packed, nowUs);
+}
+
+/**
+ * @brief nmea_fusion_poll function emits the epochs whose deadline has expired, call it periodically
+ * @param fusion is the fusion state
+ * @param nowUs is the monotonic time in microseconds
+ * @return void
+ */
+void nmea_fusion_poll(nmea_Fusion_t *fusion, uint64_t nowUs)
+{
+    drain(fusion, nowUs, false);
+}
+
+/**
+ * @brief nmea_fusion_flush function emits every waiting epoch e.g., at the end of a stream
+ * @param fusion is the fusion state
+ * @param nowUs is the monotonic time in microseconds
+ * @return void
+ */
+void nmea_fusion_flush(nmea_Fusion_t *fusion, uint64_t nowUs)
+{
+    drain(fusion, nowUs, true);
+}
+
+/**
+ * @brief nmea_fusion_print function prints the fusion statistics to console
+ * @param fusion is the fusion state
+ * @return void
+ */
+void nmea_fusion_print(const nmea_Fusion_t *fusion)
+{
+    const nmea_FusionStats_t *s = &fusion->stats;
+    printf("FUSION FIXES------------------------> %llu\n", (unsigned long long) s->fixes);
+    printf("FUSION EPOCHS EMITTED---------------> %llu\n", (unsigned long long) s->emitted);
+    printf("FUSION COMPLETE/DEADLINE/OVERFLOW---> %llu/%llu/%llu\n", (unsigned long long) s->complete,
+           (unsigned long long) s->deadline, (unsigned long long) s->overflow);
+    printf("FUSION LATE/DUPLICATE/INVALID-------> %llu/%llu/%llu\n", (unsigned long long) s->late,
+           (unsigned long long) s->duplicates, (unsigned long long) s->invalid);
+    printf("FUSION LATENCY (AVG/MAX us)---------> %llu/%lu\n",
+           (unsigned long long) (s->emitted != 0 ? s->latencySumUs / s->emitted : 0), (unsigned long) s->latencyMaxUs);
+}
+
+/**
+ * @brief Output check of the benchmark
+ */
+typedef struct {
+    uint64_t outputs;
+    uint64_t orderErrors;
+    bool hasLast;
+    uint32_t lastMs;
+} benchOutput_t;
+
+/**
+ * @brief benchOutput function counts the outputs of the benchmark and checks their order
+ * @param arg is the output check
+ * @param fused is the fused fix
+ * @return void
+ */
+static void benchOutput(void *arg, const nmea_FusedFix_t *fused)
+{
+    benchOutput_t *check = arg;
+    if (check->hasLast && !epochAfter(fused->fix.timeMs, check->lastMs)) {
+        check->orderErrors++;
+    }
+    check->hasLast = true;
+    check->lastMs = fused->fix.timeMs;
+    check->outputs++;
+}
+
+/**
+ * @brief nmea_fusion_benchmark function fuses simulated skewed streams and prints the throughput and the latency.
+ * -Every receiver has its own constant skew and a jitter, some reports are lost and some are sent twice.
+ * @param receivers is the number of receivers
+ * @param epochs is the number of epochs
+ * @param periodUs is the time between two epochs
+ * @param maxSkewUs is the largest skew of a receiver
+ * @param lossPermille is the share of lost reports in 1/1000
+ * @param deadlineUs is the deadline of the fusion
+ * @return void
+ */
+void nmea_fusion_benchmark(int receivers, uint32_t epochs, uint32_t periodUs, uint32_t maxSkewUs, uint32_t lossPermille, uint32_t deadlineUs)
+{
+    static nmea_Fusion_t s_fusion;
+    benchOutput_t check = { 0 };
+    uint32_t rng = 0x9E3779B9u;
+    uint32_t skew[CONFIG_GGA_FUSION_RECEIVERS];
+    uint32_t next[CONFIG_GGA_FUSION_RECEIVERS];     //next epoch of every receiver
+    uint64_t arrival[CONFIG_GGA_FUSION_RECEIVERS];  //simulated arrival time of that epoch
+    bool repeat[CONFIG_GGA_FUSION_RECEIVERS];       //the epoch is sent a second time
+    periodUs = (periodUs < 1000) ? 1000 : periodUs;
+    nmea_fusion_init(&s_fusion, receivers, NMEA_FUSION_MERGE, deadlineUs, benchOutput, &check);
+    receivers = s_fusion.receivers;
+    //The epochs start 10 s before midnight so the rollover is part of the run
+    uint32_t startMs = DAY_MS - 10000u;
+    nmea_PackedFix_t fix = { 0 };
+    fix.latitude = 20056618;
+    fix.longitude = -70313858;
+    fix.altitude = 2700;
+    fix.satTracked = 10;
+    fix.qIndicator = 1;
+    for (int r = 0; r < receivers; r++) {
+        skew[r] = (maxSkewUs != 0) ? nmea_bench_random(&rng) % (maxSkewUs + 1) : 0;
+        next[r] = 0;
+        arrival[r] = skew[r] + nmea_bench_random(&rng) % (periodUs / 4 + 1);
+        repeat[r] = false;
+    }
+    uint64_t start = nmea_wall_us();
+    uint64_t nowUs = 0;
+    for (;;) {
+        //The receiver with the earliest arrival sends next (every stream is in order)
+        int r = -1;
+        for (int i = 0; i < receivers; i++) {
+            if (next[i] < epochs && (r < 0 || arrival[i] < arrival[r])) {
+                r = i;
+            }
+        }
+        if (r < 0) {
+            break;
+        }
+        nowUs = arrival[r];
+        nmea_fusion_poll(&s_fusion, nowUs);
+        if (repeat[r] || nmea_bench_random(&rng) % 1000 >= lossPermille) {
+            fix.timeMs = (startMs + next[r] * (periodUs / 1000u)) % DAY_MS;
+            fix.hdop = (uint16_t) (80 + nmea_bench_random(&rng) % 200);
+            fix.latitude = 20056618 + (int32_t) (nmea_bench_random(&rng) % 64);
+            nmea_fusion_add_packed(&s_fusion, r, &fix, nowUs);
+        }
+        if (!repeat[r] && nmea_bench_random(&rng) % 1000 < lossPermille) {
+            repeat[r] = true;
+            arrival[r] += 1;
+            continue;
+        }
+        repeat[r] = false;
+        next[r]++;
+        arrival[r] = (uint64_t) next[r] * periodUs + skew[r] + nmea_bench_random(&rng) % (periodUs / 4 + 1);
+    }
+    nmea_fusion_flush(&s_fusion, nowUs + deadlineUs);
+    uint64_t elapsed = nmea_wall_us() - start;
+    printf("FUSION BENCHMARK: %d receivers, %lu epochs, skew up to %lu us, %lu/1000 lost\n", receivers,
+           (unsigned long) epochs, (unsigned long) maxSkewUs, (unsigned long) lossPermille);
+    nmea_fusion_print(&s_fusion);
+    printf("FUSION OUTPUT ORDER ERRORS----------> %llu\n", (unsigned long long) check.orderErrors);
+    printf("FUSION THROUGHPUT-------------------> %.0f fixes/s (%llu us)\n",
+           (elapsed != 0) ? (double) s_fusion.stats.fixes * 1e6 / (double) elapsed : 0.0, (unsigned long long) elapsed);
+}
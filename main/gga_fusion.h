@@ -0,0 +1,180 @@
+/**
+ * @brief Fusion of redundant receivers into one stream with the best fix per epoch.
+ * -The fixes are keyed by their UTC time of the day (the epoch) and kept in a small reorder window of
+ * -CONFIG_GGA_FUSION_EPOCHS epochs. An epoch is emitted as soon as every receiver has either reported it or reported
+ * -a newer epoch (the streams of the receivers are in order), or when its deadline expires. The best fix is selected by
+ * -the quality indicator, then HDOP, then satellites tracked, or the positions of the fixes with the best quality are
+ * -merged with 1/HDOP^2 weights. Epochs are emitted in order, fixes of an emitted epoch are late and a second fix of a
+ * -receiver for the same epoch is a duplicate, both are counted and dropped. The epochs wrap around at midnight.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Defaults when the sdkconfig options are not available (host builds outside of ESP-IDF)
+#ifndef CONFIG_GGA_FUSION_RECEIVERS
+#define CONFIG_GGA_FUSION_RECEIVERS 3
+#endif
+#ifndef CONFIG_GGA_FUSION_EPOCHS
+#define CONFIG_GGA_FUSION_EPOCHS 8
+#endif
+
+/**
+ * @brief Selection of the output fix
+ */
+typedef enum {
+    NMEA_FUSION_SELECT = 0,             //the best fix of the epoch
+    NMEA_FUSION_MERGE                   //the best fix with the position merged from every fix of the same quality
+} nmea_FusionMode_t;
+
+/**
+ * @brief Result of nmea_fusion_add
+ */
+typedef enum {
+    NMEA_FUSION_ACCEPTED = 0,           //the fix is waiting in its epoch (or its epoch was emitted at once)
+    NMEA_FUSION_LATE,                   //the epoch was already emitted
+    NMEA_FUSION_DUPLICATE,              //the receiver has already reported the epoch
+    NMEA_FUSION_INVALID                 //no correct time or the receiver is out of range
+} nmea_FusionStatus_t;
+
+/**
+ * @brief Output of one epoch
+ */
+typedef struct {
+    nmea_PackedFix_t fix;               //selected or merged fix, timeMs is the epoch
+    uint8_t reported;                   //bit of every receiver which reported the epoch
+    uint8_t used;                       //bit of every receiver whose fix went into the output
+    bool byDeadline;                    //emitted because the deadline expired (or the reorder window was full)
+    uint32_t latencyUs;                 //from the first report of the epoch to its output
+} nmea_FusedFix_t;
+
+/**
+ * @brief Output callback, called from nmea_fusion_add, nmea_fusion_poll and nmea_fusion_flush
+ */
+typedef void (*nmea_FusionOutput_t)(void* , const nmea_FusedFix_t* );
+
+/**
+ * @brief Fusion statistics
+ */
+typedef struct {
+    uint64_t fixes;                     //fixes given to nmea_fusion_add
+    uint64_t emitted;                   //epochs emitted
+    uint64_t complete;                  //epochs emitted because every receiver had reported or moved on
+    uint64_t deadline;                  //epochs emitted because the deadline expired
+    uint64_t overflow;                  //epochs emitted early because the reorder window was full
+    uint64_t late;
+    uint64_t duplicates;
+    uint64_t invalid;
+    uint64_t latencySumUs;
+    uint32_t latencyMaxUs;
+} nmea_FusionStats_t;
+
+/**
+ * @brief One epoch in the reorder window
+ */
+typedef struct {
+    bool used;
+    uint8_t reported;
+    uint32_t epochMs;
+    uint64_t firstUs;                   //time of the first report
+    nmea_PackedFix_t fix[CONFIG_GGA_FUSION_RECEIVERS];
+} nmea_FusionEpoch_t;
+
+/**
+ * @brief Fusion state, initialize with nmea_fusion_init
+ */
+typedef struct {
+    int receivers;
+    nmea_FusionMode_t mode;
+    uint32_t deadlineUs;
+    nmea_FusionOutput_t output;
+    void *outputArg;
+    bool hasEmitted;
+    uint32_t lastEmittedMs;             //latest emitted epoch
+    uint8_t seen;                       //bit of every receiver with a latest epoch
+    uint32_t latestMs[CONFIG_GGA_FUSION_RECEIVERS];
+    nmea_FusionEpoch_t epoch[CONFIG_GGA_FUSION_EPOCHS];
+    nmea_FusionStats_t stats;
+} nmea_Fusion_t;
+
+/**
+ * @brief nmea_fusion_init function resets the fusion state
+ * @param fusion is the fusion state
+ * @param receivers is the number of receivers (1 to CONFIG_GGA_FUSION_RECEIVERS)
+ * @param mode is the selection of the output fix
+ * @param deadlineUs is the longest wait after the first report of an epoch
+ * @param output is the output callback
+ * @param arg is given to the output callback
+ * @return void
+ */
+void nmea_fusion_init(nmea_Fusion_t* , int , nmea_FusionMode_t , uint32_t , nmea_FusionOutput_t , void* );
+
+/**
+ * @brief nmea_fusion_add function adds the fix of a receiver and emits the epochs which are complete
+ * @param fusion is the fusion state
+ * @param receiver is the receiver (0 to receivers - 1)
+ * @param fix is the parse result
+ * @param nowUs is the monotonic time in microseconds
+ * @return nmea_FusionStatus_t is the status of the fix
+ */
+nmea_FusionStatus_t nmea_fusion_add(nmea_Fusion_t* , int , const nmea_ParseResult_t* , uint64_t );
+
+/**
+ * @brief nmea_fusion_add_packed function is nmea_fusion_add for a packed fix
+ * @param fusion is the fusion state
+ * @param receiver is the receiver (0 to receivers - 1)
+ * @param fix is the packed fix
+ * @param nowUs is the monotonic time in microseconds
+ * @return nmea_FusionStatus_t is the status of the fix
+ */
+nmea_FusionStatus_t nmea_fusion_add_packed(nmea_Fusion_t* , int , const nmea_PackedFix_t* , uint64_t );
+
+/**
+ * @brief nmea_fusion_poll function emits the epochs whose deadline has expired, call it periodically
+ * @param fusion is the fusion state
+ * @param nowUs is the monotonic time in microseconds
+ * @return void
+ */
+void nmea_fusion_poll(nmea_Fusion_t* , uint64_t );
+
+/**
+ * @brief nmea_fusion_flush function emits every waiting epoch e.g., at the end of a stream
+ * @param fusion is the fusion state
+ * @param nowUs is the monotonic time in microseconds
+ * @return void
+ */
+void nmea_fusion_flush(nmea_Fusion_t* , uint64_t );
+
+/**
+ * @brief nmea_fusion_print function prints the fusion statistics to console
+ * @param fusion is the fusion state
+ * @return void
+ */
+void nmea_fusion_print(const nmea_Fusion_t* );
+
+/**
+ * @brief nmea_fusion_benchmark function fuses simulated skewed streams and prints the throughput and the latency.
+ * -Every receiver has its own constant skew and a jitter, some reports are lost and some are sent twice.
+ * @param receivers is the number of receivers
+ * @param epochs is the number of epochs
+ * @param periodUs is the time between two epochs
+ * @param maxSkewUs is the largest skew of a receiver
+ * @param lossPermille is the share of lost reports in 1/1000
+ * @param deadlineUs is the deadline of the fusion
+ * @return void
+ */
+void nmea_fusion_benchmark(int , uint32_t , uint32_t , uint32_t , uint32_t , uint32_t );
+
+#ifdef __cplusplus
+}
+#endif
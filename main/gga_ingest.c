@@ -0,0 +1,1407 @@
+#define _GNU_SOURCE                     //recvmmsg, sendmmsg, accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "gga_ingest.h"
+#include "gga_bench.h"
+
+#define STOP_EVENT_TAG UINT32_MAX       //epoll tag of the eventfd used to stop the reactor
+#define RESUME_EVENT_TAG (UINT32_MAX - 1)       //epoll tag of the eventfd of the workers which resumes stalled streams
+#define LISTENER_EVENT_TAG 0x80000000u  //epoll tag of a listener is LISTENER_EVENT_TAG | listener index
+#define MAX_EPOLL_EVENTS 64             //Maximum number of events handled per epoll_wait call
+#define UDP_SOCKET_BUF (4 * 1024 * 1024)        //Receive buffer of a UDP socket (capped by net.core.rmem_max)
+
+/**
+ * @brief Sender address, the key of the receiver of a network sender
+ */
+typedef struct {
+    uint8_t family;                     //AF_INET or AF_INET6, 0 marks a free table entry
+    bool tcp;                           //TCP and UDP senders never share a receiver
+    uint16_t port;                      //source port of the datagrams or of the connection
+    uint8_t addr[16];
+    int id;                             //receiver id
+} ingestSender_t;
+
+/**
+ * @brief UDP socket or TCP listener
+ */
+typedef struct {
+    int fd;
+    bool udp;
+    uint16_t port;                      //bound port
+} ingestListener_t;
+
+/**
+ * @brief Receiver slot. The ring is written by the reactor and read by the worker owning the receiver.
+ */
+typedef struct {
+    int fd;
+    atomic_size_t head;                 //written by the reactor
+    atomic_size_t tail;                 //written by the worker
+    atomic_bool queued;                 //the receiver is waiting in its worker queue
+    atomic_uint_fast64_t bytesRead;
+    atomic_uint_fast64_t bytesDropped;
+    atomic_uint_fast64_t datagrams;
+    atomic_uint_fast64_t connections;
+    atomic_bool closed;
+    ingestSender_t sender;              //address of a network sender (family 0 for a descriptor receiver)
+    bool touched;                       //reactor owned, the receiver got data in the current datagram batch
+    bool stream;                        //reactor owned, a TCP connection: a full ring stops the reads (flow control)
+    atomic_bool stalled;                //the reactor stopped reading the stream because the ring was full
+    atomic_bool resume;                 //the worker made room in the ring of a stalled stream
+    char ring[INGEST_RX_BUF_LEN];
+    //Worker owned line assembly
+    char line[INGEST_LINE_LEN];
+    size_t lineLen;
+    bool overlong;
+    atomic_size_t streamStart;          //ring position of the first byte of the newest connection, the line restarts there
+    nmea_IngestStats_t work;
+    //Published snapshot
+    pthread_mutex_t lock;
+    nmea_ParseResult_t latest;
+    nmea_IngestStats_t stats;
+    bool hasFix;
+} ingestReceiver_t;
+
+/**
+ * @brief Worker thread with its queue of receivers that have new data
+ */
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int *queue;
+    int head;
+    int count;
+    bool stop;
+    atomic_uint_fast64_t fixes;         //valid fixes parsed by this worker
+    nmea_Ingest_t *ingest;
+} ingestWorker_t;
+
+struct nmea_Ingest {
+    int epollFd;
+    int stopFd;
+    int resumeFd;
+    int workers;
+    int maxReceivers;
+    atomic_int receivers;               //published after the slot is initialised, read without addLock
+    int udpBatch;
+    bool started;
+    pthread_mutex_t addLock;            //receiver slots, sender table and listeners
+    pthread_t reactor;
+    ingestReceiver_t *rx;
+    ingestWorker_t *worker;
+    int listeners;
+    ingestListener_t listener[INGEST_MAX_LISTENERS];
+    ingestSender_t *senders;            //open addressing table, at least twice the receiver slots
+    size_t senderMask;
+    //recvmmsg batch, reactor owned
+    struct mmsghdr *msgs;
+    struct iovec *iov;
+    struct sockaddr_storage *from;
+    char *datagram;
+    int *touched;
+    atomic_uint_fast64_t recvCalls;
+    atomic_uint_fast64_t datagrams;
+    atomic_uint_fast64_t truncated;
+    atomic_uint_fast64_t accepted;
+    atomic_uint_fast64_t noSlot;
+};
+
+/**
+ * @brief scheduleReceiver function puts the receiver in the queue of its worker unless it is already waiting there
+ * @param ingest is the handle
+ * @param id is the receiver id
+ * @return void
+ */
+static void scheduleReceiver(nmea_Ingest_t *ingest, int id)
+{
+    if (atomic_exchange(&ingest->rx[id].queued, true)) {
+        return;
+    }
+    //Receiver affinity, a receiver always goes to the same worker so its sentences are parsed in order
+    ingestWorker_t *w = &ingest->worker[id % ingest->workers];
+    pthread_mutex_lock(&w->lock);
+    w->queue[(w->head + w->count) % ingest->maxReceivers] = id;
+    w->count++;
+    pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+}
+
+/**
+ * @brief closeReceiver function removes a receiver from the reactor after end of file or a read error
+ * @param ingest is the handle
+ * @param rx is the receiver
+ * @return void
+ */
+static void closeReceiver(nmea_Ingest_t *ingest, ingestReceiver_t *rx)
+{
+    epoll_ctl(ingest->epollFd, EPOLL_CTL_DEL, rx->fd, NULL);
+    close(rx->fd);
+    rx->fd = -1;
+    atomic_store(&rx->closed, true);
+}
+
+/**
+ * @brief readReceiver function reads everything available on the receiver descriptor into its ring (edge triggered)
+ * @param ingest is the handle
+ * @param id is the receiver id
+ * @return void
+ */
+static void readReceiver(nmea_Ingest_t *ingest, int id)
+{
+    ingestReceiver_t *rx = &ingest->rx[id];
+    char scratch[512];
+    bool newData = false;
+    while (rx->fd >= 0) {
+        size_t head = atomic_load_explicit(&rx->head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&rx->tail, memory_order_acquire);
+        size_t space = INGEST_RX_BUF_LEN - (head - tail);
+        size_t offset = head & (INGEST_RX_BUF_LEN - 1);
+        size_t chunk = (space < INGEST_RX_BUF_LEN - offset) ? space : INGEST_RX_BUF_LEN - offset;
+        //A stream waits for the worker, the data stays in the socket and TCP slows the sender down
+        if (chunk == 0 && rx->stream) {
+            atomic_store(&rx->stalled, true);
+            if (atomic_load(&rx->tail) == tail || !atomic_exchange(&rx->stalled, false)) {
+                break;
+            }
+            continue;
+        }
+        //When the ring is full the data still has to be drained from the descriptor, it is counted as dropped
+        char *dst = (chunk > 0) ? rx->ring + offset : scratch;
+        size_t want = (chunk > 0) ? chunk : sizeof(scratch);
+        ssize_t n = read(rx->fd, dst, want);
+        if (n > 0) {
+            atomic_fetch_add_explicit(&rx->bytesRead, (uint64_t) n, memory_order_relaxed);
+            if (chunk > 0) {
+                atomic_store(&rx->head, head + (size_t) n);
+                newData = true;
+            }
+            else {
+                atomic_fetch_add_explicit(&rx->bytesDropped, (uint64_t) n, memory_order_relaxed);
+            }
+        }
+        else if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        else {
+            //End of file or read error
+            closeReceiver(ingest, rx);
+        }
+    }
+    if (newData) {
+        scheduleReceiver(ingest, id);
+    }
+}
+
+/**
+ * @brief registerReceiver function takes the next receiver slot, addLock must be held
+ * @param ingest is the handle
+ * @param fd is the receiver descriptor (-1 for a network sender)
+ * @param sender is the address of a network sender (NULL for a descriptor receiver)
+ * @return int is the receiver id or -1 if there are no free slots
+ */
+static int registerReceiver(nmea_Ingest_t *ingest, int fd, const ingestSender_t *sender)
+{
+    if (ingest->receivers >= ingest->maxReceivers) {
+        return -1;
+    }
+    int id = ingest->receivers;
+    ingestReceiver_t *rx = &ingest->rx[id];
+    rx->fd = fd;
+    if (sender != NULL) {
+        rx->sender = *sender;
+        rx->sender.id = id;
+    }
+    pthread_mutex_init(&rx->lock, NULL);
+    ingest->receivers++;
+    return id;
+}
+
+/**
+ * @brief senderKey function gives the table key of a sender address
+ * @param addr is the address
+ * @param len is the length of the address
+ * @param tcp is true for the peer of a TCP connection, false for the source of a datagram
+ * @param key holds the key
+ * @return bool is true for IPv4 and IPv6 addresses
+ */
+static bool senderKey(const struct sockaddr *addr, socklen_t len, bool tcp, ingestSender_t *key)
+{
+    memset(key, 0, sizeof(*key));
+    key->tcp = tcp;
+    if (addr->sa_family == AF_INET && len >= sizeof(struct sockaddr_in)) {
+        const struct sockaddr_in *in = (const struct sockaddr_in*) addr;
+        memcpy(key->addr, &in->sin_addr, sizeof(in->sin_addr));
+        key->port = ntohs(in->sin_port);
+    }
+    else if (addr->sa_family == AF_INET6 && len >= sizeof(struct sockaddr_in6)) {
+        const struct sockaddr_in6 *in6 = (const struct sockaddr_in6*) addr;
+        memcpy(key->addr, &in6->sin6_addr, sizeof(in6->sin6_addr));
+        key->port = ntohs(in6->sin6_port);
+    }
+    else {
+        return false;
+    }
+    key->family = (uint8_t) addr->sa_family;
+    return true;
+}
+
+/**
+ * @brief senderId function finds the receiver of a sender or gives it the next free slot, addLock must be held
+ * @param ingest is the handle
+ * @param key is the sender key
+ * @return int is the receiver id or -1 if there are no free slots
+ */
+static int senderId(nmea_Ingest_t *ingest, const ingestSender_t *key)
+{
+    //FNV-1a of the family, the transport, the port and the address
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ key->family) * 16777619u;
+    hash = (hash ^ key->tcp) * 16777619u;
+    hash = (hash ^ key->port) * 16777619u;
+    for (size_t i = 0; i < sizeof(key->addr); i++) {
+        hash = (hash ^ key->addr[i]) * 16777619u;
+    }
+    size_t i = hash & ingest->senderMask;
+    while (ingest->senders[i].family != 0) {
+        ingestSender_t *entry = &ingest->senders[i];
+        if (entry->family == key->family && entry->tcp == key->tcp && entry->port == key->port && memcmp(entry->addr, key->addr, sizeof(key->addr)) == 0) {
+            return entry->id;
+        }
+        i = (i + 1) & ingest->senderMask;
+    }
+    int id = registerReceiver(ingest, -1, key);
+    if (id >= 0) {
+        ingest->senders[i] = *key;
+        ingest->senders[i].id = id;
+    }
+    return id;
+}
+
+/**
+ * @brief pushDatagram function copies a datagram into the ring of its receiver, it is dropped whole if it does not fit
+ * @param ingest is the handle
+ * @param id is the receiver id
+ * @param data is the datagram
+ * @param len is the length of the datagram
+ * @return bool is true if the receiver got its first data of the batch
+ */
+static bool pushDatagram(nmea_Ingest_t *ingest, int id, const char *data, size_t len)
+{
+    ingestReceiver_t *rx = &ingest->rx[id];
+    size_t head = atomic_load_explicit(&rx->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&rx->tail, memory_order_acquire);
+    atomic_fetch_add_explicit(&rx->datagrams, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&rx->bytesRead, (uint64_t) len, memory_order_relaxed);
+    if (INGEST_RX_BUF_LEN - (head - tail) < len) {
+        atomic_fetch_add_explicit(&rx->bytesDropped, (uint64_t) len, memory_order_relaxed);
+        return false;
+    }
+    size_t offset = head & (INGEST_RX_BUF_LEN - 1);
+    size_t part = (len < INGEST_RX_BUF_LEN - offset) ? len : INGEST_RX_BUF_LEN - offset;
+    memcpy(rx->ring + offset, data, part);
+    memcpy(rx->ring, data + part, len - part);
+    atomic_store(&rx->head, head + len);
+    bool firstData = !rx->touched;
+    rx->touched = true;
+    return firstData;
+}
+
+/**
+ * @brief readDatagrams function receives the datagrams of a UDP socket in recvmmsg batches (edge triggered), every
+ * -receiver of a batch is scheduled once after it
+ * @param ingest is the handle
+ * @param listener is the UDP socket
+ * @return void
+ */
+static void readDatagrams(nmea_Ingest_t *ingest, ingestListener_t *listener)
+{
+    for (;;) {
+        for (int i = 0; i < ingest->udpBatch; i++) {
+            ingest->msgs[i].msg_hdr.msg_namelen = sizeof(ingest->from[i]);
+        }
+        int n = recvmmsg(listener->fd, ingest->msgs, (unsigned) ingest->udpBatch, MSG_DONTWAIT, NULL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        atomic_fetch_add_explicit(&ingest->recvCalls, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&ingest->datagrams, (uint64_t) n, memory_order_relaxed);
+        int touched = 0;
+        ingestSender_t key;
+        //One lock for the sender lookups of the whole batch
+        pthread_mutex_lock(&ingest->addLock);
+        for (int i = 0; i < n; i++) {
+            struct msghdr *hdr = &ingest->msgs[i].msg_hdr;
+            if (hdr->msg_flags & MSG_TRUNC) {
+                atomic_fetch_add_explicit(&ingest->truncated, 1, memory_order_relaxed);
+                continue;
+            }
+            int id = senderKey(hdr->msg_name, hdr->msg_namelen, false, &key) ? senderId(ingest, &key) : -1;
+            if (id < 0) {
+                atomic_fetch_add_explicit(&ingest->noSlot, 1, memory_order_relaxed);
+            }
+            else if (pushDatagram(ingest, id, ingest->iov[i].iov_base, ingest->msgs[i].msg_len)) {
+                ingest->touched[touched++] = id;
+            }
+        }
+        pthread_mutex_unlock(&ingest->addLock);
+        for (int i = 0; i < touched; i++) {
+            ingest->rx[ingest->touched[i]].touched = false;
+            scheduleReceiver(ingest, ingest->touched[i]);
+        }
+        //A short batch drained the socket, new datagrams raise a new edge
+        if (n < ingest->udpBatch) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief acceptConnections function accepts the pending connections of a TCP listener (edge triggered), a bridge
+ * -reconnecting from the same address and port gets its receiver back and its old connection is closed
+ * @param ingest is the handle
+ * @param listener is the TCP listener
+ * @return void
+ */
+static void acceptConnections(nmea_Ingest_t *ingest, ingestListener_t *listener)
+{
+    for (;;) {
+        struct sockaddr_storage peer;
+        socklen_t len = sizeof(peer);
+        int fd = accept4(listener->fd, (struct sockaddr*) &peer, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+        atomic_fetch_add_explicit(&ingest->accepted, 1, memory_order_relaxed);
+        ingestSender_t key;
+        pthread_mutex_lock(&ingest->addLock);
+        int id = senderKey((struct sockaddr*) &peer, len, true, &key) ? senderId(ingest, &key) : -1;
+        pthread_mutex_unlock(&ingest->addLock);
+        if (id < 0) {
+            atomic_fetch_add_explicit(&ingest->noSlot, 1, memory_order_relaxed);
+            close(fd);
+            continue;
+        }
+        ingestReceiver_t *rx = &ingest->rx[id];
+        if (rx->fd >= 0) {
+            closeReceiver(ingest, rx);
+        }
+        rx->fd = fd;
+        rx->stream = true;
+        //The partial line of the old connection is dropped when the worker reaches the new data
+        atomic_store(&rx->streamStart, atomic_load_explicit(&rx->head, memory_order_relaxed));
+        atomic_store(&rx->stalled, false);
+        atomic_store(&rx->closed, false);
+        atomic_fetch_add_explicit(&rx->connections, 1, memory_order_relaxed);
+        //The data which arrived before the registration is reported by epoll_ctl
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP | EPOLLET, .data.u32 = (uint32_t) id };
+        if (epoll_ctl(ingest->epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            closeReceiver(ingest, rx);
+        }
+    }
+}
+
+/**
+ * @brief reactorTask function waits for readable receivers and copies their data into the receiver rings
+ * @param arg is the ingest handle
+ * @return void* is always NULL
+ */
+static void* reactorTask(void *arg)
+{
+    nmea_Ingest_t *ingest = arg;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    for (;;) {
+        int n = epoll_wait(ingest->epollFd, events, MAX_EPOLL_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            printf("ERROR: epoll_wait failed (%s)!\n", strerror(errno));
+            return NULL;
+        }
+        for (int i = 0; i < n; i++) {
+            uint32_t tag = events[i].data.u32;
+            if (tag == STOP_EVENT_TAG) {
+                return NULL;
+            }
+            if (tag == RESUME_EVENT_TAG) {
+                uint64_t count;
+                if (read(ingest->resumeFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                    printf("ERROR: Reactor resume event NOT read!\n");
+                }
+                for (int id = 0; id < ingest->receivers; id++) {
+                    if (atomic_exchange(&ingest->rx[id].resume, false)) {
+                        readReceiver(ingest, id);
+                    }
+                }
+                continue;
+            }
+            if (tag & LISTENER_EVENT_TAG) {
+                ingestListener_t *listener = &ingest->listener[tag & ~LISTENER_EVENT_TAG];
+                if (listener->udp) {
+                    readDatagrams(ingest, listener);
+                }
+                else {
+                    acceptConnections(ingest, listener);
+                }
+                continue;
+            }
+            readReceiver(ingest, (int) tag);
+        }
+    }
+}
+
+/**
+ * @brief drainReceiver function splits the new data of a receiver into lines and parses them
+ * @param ingest is the handle
+ * @param rx is the receiver
+ * @param w is the worker
+ * @return void
+ */
+static void drainReceiver(nmea_Ingest_t *ingest, ingestReceiver_t *rx, ingestWorker_t *w)
+{
+    nmea_ParseResult_t parsed;
+    nmea_ParseResult_t last;
+    bool newFix = false;
+    size_t tail = atomic_load_explicit(&rx->tail, memory_order_relaxed);
+    size_t head = atomic_load(&rx->head);
+    //Loaded after the head: a connection attached before that data arrived is seen
+    size_t streamStart = atomic_load(&rx->streamStart);
+    uint64_t fixes = rx->work.validFixes;
+    while (tail != head) {
+        if (tail == streamStart) {
+            rx->lineLen = 0;
+            rx->overlong = false;
+        }
+        char c = rx->ring[tail & (INGEST_RX_BUF_LEN - 1)];
+        tail++;
+        if (c != '\n') {
+            if (rx->lineLen < INGEST_LINE_LEN) {
+                rx->line[rx->lineLen++] = c;
+            }
+            else {
+                rx->overlong = true;
+            }
+            continue;
+        }
+        if (rx->overlong) {
+            rx->work.overlongLines++;
+        }
+        else if (rx->lineLen > 1 || (rx->lineLen == 1 && rx->line[0] != '\r')) {
+            rx->work.sentences++;
+            if (nmea_gga_parse_r(rx->line, rx->lineLen, &parsed)) {
+                rx->work.validFixes++;
+                last = parsed;
+                newFix = true;
+            }
+            else {
+                rx->work.invalidSentences++;
+            }
+        }
+        rx->lineLen = 0;
+        rx->overlong = false;
+    }
+    atomic_store(&rx->tail, tail);
+    atomic_fetch_add_explicit(&w->fixes, rx->work.validFixes - fixes, memory_order_relaxed);
+    //The ring has room again, the reactor reads the stalled stream
+    if (atomic_exchange(&rx->stalled, false)) {
+        uint64_t one = 1;
+        atomic_store(&rx->resume, true);
+        if (write(ingest->resumeFd, &one, sizeof(one)) < 0) {
+            printf("ERROR: Reactor resume event NOT sent!\n");
+        }
+    }
+    //Only the latest fix of the batch is published, this keeps the lock traffic independent of the data rate
+    pthread_mutex_lock(&rx->lock);
+    if (newFix) {
+        rx->work.lastFixNs = nmea_wall_ns();
+        rx->latest = last;
+        rx->hasFix = true;
+    }
+    rx->stats = rx->work;
+    pthread_mutex_unlock(&rx->lock);
+}
+
+/**
+ * @brief workerTask function parses the receivers scheduled on this worker
+ * @param arg is the worker
+ * @return void* is always NULL
+ */
+static void* workerTask(void *arg)
+{
+    ingestWorker_t *w = arg;
+    nmea_Ingest_t *ingest = w->ingest;
+    for (;;) {
+        pthread_mutex_lock(&w->lock);
+        while (w->count == 0 && !w->stop) {
+            pthread_cond_wait(&w->cond, &w->lock);
+        }
+        if (w->count == 0) {
+            pthread_mutex_unlock(&w->lock);
+            return NULL;
+        }
+        int id = w->queue[w->head];
+        w->head = (w->head + 1) % ingest->maxReceivers;
+        w->count--;
+        pthread_mutex_unlock(&w->lock);
+        //Cleared before draining so data arriving during the drain schedules the receiver again
+        atomic_store(&ingest->rx[id].queued, false);
+        drainReceiver(ingest, &ingest->rx[id], w);
+    }
+}
+
+/**
+ * @brief nmea_ingest_create function allocates the reactor, the receiver slots and the worker pool
+ * @param config is the configuration, NULL selects the defaults
+ * @return nmea_Ingest_t* is the handle or NULL on failure
+ */
+nmea_Ingest_t* nmea_ingest_create(const nmea_IngestConfig_t *config)
+{
+    nmea_Ingest_t *ingest = calloc(1, sizeof(*ingest));
+    if (ingest == NULL) {
+        printf("ERROR: Memory NOT allocated!\n");
+        return NULL;
+    }
+    ingest->workers = (config != NULL && config->workers > 0) ? config->workers : INGEST_DEFAULT_WORKERS;
+    ingest->maxReceivers = (config != NULL && config->maxReceivers > 0) ? config->maxReceivers : INGEST_DEFAULT_RECEIVERS;
+    ingest->udpBatch = (config != NULL && config->udpBatch > 0) ? config->udpBatch : INGEST_DEFAULT_UDP_BATCH;
+    size_t senderSlots = 2;
+    while (senderSlots < 2 * (size_t) ingest->maxReceivers) {
+        senderSlots <<= 1;
+    }
+    ingest->senderMask = senderSlots - 1;
+    ingest->rx = calloc((size_t) ingest->maxReceivers, sizeof(ingestReceiver_t));
+    ingest->worker = calloc((size_t) ingest->workers, sizeof(ingestWorker_t));
+    ingest->senders = calloc(senderSlots, sizeof(ingestSender_t));
+    ingest->msgs = calloc((size_t) ingest->udpBatch, sizeof(struct mmsghdr));
+    ingest->iov = calloc((size_t) ingest->udpBatch, sizeof(struct iovec));
+    ingest->from = calloc((size_t) ingest->udpBatch, sizeof(struct sockaddr_storage));
+    ingest->datagram = malloc((size_t) ingest->udpBatch * INGEST_DATAGRAM_LEN);
+    ingest->touched = calloc((size_t) ingest->udpBatch, sizeof(int));
+    ingest->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    ingest->stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ingest->resumeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ingest->rx == NULL || ingest->worker == NULL || ingest->senders == NULL || ingest->msgs == NULL ||
+        ingest->iov == NULL || ingest->from == NULL || ingest->datagram == NULL || ingest->touched == NULL ||
+        ingest->epollFd < 0 || ingest->stopFd < 0 || ingest->resumeFd < 0) {
+        printf("ERROR: Ingest resources NOT allocated!\n");
+        if (ingest->epollFd >= 0) close(ingest->epollFd);
+        if (ingest->stopFd >= 0) close(ingest->stopFd);
+        if (ingest->resumeFd >= 0) close(ingest->resumeFd);
+        free(ingest->rx);
+        free(ingest->worker);
+        free(ingest->senders);
+        free(ingest->msgs);
+        free(ingest->iov);
+        free(ingest->from);
+        free(ingest->datagram);
+        free(ingest->touched);
+        free(ingest);
+        return NULL;
+    }
+    for (int i = 0; i < ingest->udpBatch; i++) {
+        ingest->iov[i].iov_base = ingest->datagram + (size_t) i * INGEST_DATAGRAM_LEN;
+        ingest->iov[i].iov_len = INGEST_DATAGRAM_LEN;
+        ingest->msgs[i].msg_hdr.msg_name = &ingest->from[i];
+        ingest->msgs[i].msg_hdr.msg_iov = &ingest->iov[i];
+        ingest->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = STOP_EVENT_TAG };
+    epoll_ctl(ingest->epollFd, EPOLL_CTL_ADD, ingest->stopFd, &ev);
+    ev.data.u32 = RESUME_EVENT_TAG;
+    epoll_ctl(ingest->epollFd, EPOLL_CTL_ADD, ingest->resumeFd, &ev);
+    pthread_mutex_init(&ingest->addLock, NULL);
+    for (int i = 0; i < ingest->workers; i++) {
+        ingestWorker_t *w = &ingest->worker[i];
+        w->ingest = ingest;
+        w->queue = calloc((size_t) ingest->maxReceivers, sizeof(int));
+        pthread_mutex_init(&w->lock, NULL);
+        pthread_cond_init(&w->cond, NULL);
+        if (w->queue == NULL) {
+            printf("ERROR: Memory NOT allocated!\n");
+            nmea_ingest_destroy(ingest);
+            return NULL;
+        }
+    }
+    return ingest;
+}
+
+/**
+ * @brief nmea_ingest_add function registers a receiver descriptor, it can be called before or after nmea_ingest_start
+ * @param ingest is the handle
+ * @param fd is the receiver file descriptor
+ * @return int is the receiver id (0, 1, 2...) or -1 if there are no free slots or the descriptor cannot be registered
+ */
+int nmea_ingest_add(nmea_Ingest_t *ingest, int fd)
+{
+    pthread_mutex_lock(&ingest->addLock);
+    int id = registerReceiver(ingest, fd, NULL);
+    if (id < 0) {
+        pthread_mutex_unlock(&ingest->addLock);
+        printf("ERROR: No free receiver slot!\n");
+        return -1;
+    }
+    ingestReceiver_t *rx = &ingest->rx[id];
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP | EPOLLET, .data.u32 = (uint32_t) id };
+    if (epoll_ctl(ingest->epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        ingest->receivers--;
+        pthread_mutex_destroy(&rx->lock);
+        pthread_mutex_unlock(&ingest->addLock);
+        printf("ERROR: Receiver descriptor cannot be registered (%s)!\n", strerror(errno));
+        return -1;
+    }
+    pthread_mutex_unlock(&ingest->addLock);
+    return id;
+}
+
+/**
+ * @brief openListener function opens a UDP socket or a TCP listener and registers it with the reactor
+ * @param ingest is the handle
+ * @param address is the local IPv4 or IPv6 address
+ * @param port is the local port (0 selects a free one)
+ * @param udp selects a UDP socket or a TCP listener
+ * @return int is the bound port or -1 on failure
+ */
+static int openListener(nmea_Ingest_t *ingest, const char *address, uint16_t port, bool udp)
+{
+    struct sockaddr_storage addr;
+    struct sockaddr_in *in = (struct sockaddr_in*) &addr;
+    struct sockaddr_in6 *in6 = (struct sockaddr_in6*) &addr;
+    socklen_t len;
+    memset(&addr, 0, sizeof(addr));
+    if (inet_pton(AF_INET, address, &in->sin_addr) == 1) {
+        in->sin_family = AF_INET;
+        in->sin_port = htons(port);
+        len = sizeof(*in);
+    }
+    else if (inet_pton(AF_INET6, address, &in6->sin6_addr) == 1) {
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(port);
+        len = sizeof(*in6);
+    }
+    else {
+        printf("ERROR: Address %s NOT valid!\n", address);
+        return -1;
+    }
+    int one = 1;
+    int bufSize = UDP_SOCKET_BUF;
+    int fd = socket(addr.ss_family, (udp ? SOCK_DGRAM : SOCK_STREAM) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd >= 0) {
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (udp) {
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+        }
+    }
+    if (fd < 0 || bind(fd, (struct sockaddr*) &addr, len) < 0 || (!udp && listen(fd, SOMAXCONN) < 0) ||
+        getsockname(fd, (struct sockaddr*) &addr, &len) < 0) {
+        printf("ERROR: %s socket on %s port %u NOT opened (%s)!\n", udp ? "UDP" : "TCP", address, port, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    uint16_t bound = ntohs((addr.ss_family == AF_INET) ? in->sin_port : in6->sin6_port);
+    pthread_mutex_lock(&ingest->addLock);
+    int index = ingest->listeners;
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLET, .data.u32 = LISTENER_EVENT_TAG | (uint32_t) index };
+    if (index < INGEST_MAX_LISTENERS) {
+        ingest->listener[index] = (ingestListener_t) { .fd = fd, .udp = udp, .port = bound };
+    }
+    if (index >= INGEST_MAX_LISTENERS || epoll_ctl(ingest->epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        pthread_mutex_unlock(&ingest->addLock);
+        printf("ERROR: %s socket on %s port %u NOT registered!\n", udp ? "UDP" : "TCP", address, bound);
+        close(fd);
+        return -1;
+    }
+    ingest->listeners++;
+    pthread_mutex_unlock(&ingest->addLock);
+    return bound;
+}
+
+/**
+ * @brief nmea_ingest_listen_udp function opens a UDP socket for the datagrams of the bridges, it can be called before
+ * -or after nmea_ingest_start
+ * @param ingest is the handle
+ * @param address is the local IPv4 or IPv6 address e.g., "0.0.0.0" or "127.0.0.1"
+ * @param port is the local port (0 selects a free one)
+ * @return int is the bound port or -1 on failure
+ */
+int nmea_ingest_listen_udp(nmea_Ingest_t *ingest, const char *address, uint16_t port)
+{
+    return openListener(ingest, address, port, true);
+}
+
+/**
+ * @brief nmea_ingest_listen_tcp function opens a TCP listener for the streams of the bridges, it can be called before
+ * -or after nmea_ingest_start
+ * @param ingest is the handle
+ * @param address is the local IPv4 or IPv6 address
+ * @param port is the local port (0 selects a free one)
+ * @return int is the bound port or -1 on failure
+ */
+int nmea_ingest_listen_tcp(nmea_Ingest_t *ingest, const char *address, uint16_t port)
+{
+    return openListener(ingest, address, port, false);
+}
+
+/**
+ * @brief nmea_ingest_add_sender function gives a network sender its receiver before it sends anything, so the ids
+ * -do not depend on the order of the first packets
+ * @param ingest is the handle
+ * @param addr is the source address and port of the datagrams or of the connection
+ * @param len is the length of the address
+ * @param tcp selects a TCP connection, false a UDP sender
+ * @return int is the receiver id or -1 if there are no free slots or the address family is not IPv4 or IPv6
+ */
+int nmea_ingest_add_sender(nmea_Ingest_t *ingest, const struct sockaddr *addr, socklen_t len, bool tcp)
+{
+    ingestSender_t key;
+    if (!senderKey(addr, len, tcp, &key)) {
+        printf("ERROR: Sender address family NOT supported!\n");
+        return -1;
+    }
+    pthread_mutex_lock(&ingest->addLock);
+    int id = senderId(ingest, &key);
+    pthread_mutex_unlock(&ingest->addLock);
+    if (id < 0) {
+        printf("ERROR: No free receiver slot!\n");
+    }
+    return id;
+}
+
+/**
+ * @brief nmea_ingest_start function starts the reactor thread and the worker threads
+ * @param ingest is the handle
+ * @return int is 0 on success or -1 on failure
+ */
+int nmea_ingest_start(nmea_Ingest_t *ingest)
+{
+    if (ingest->started) {
+        return 0;
+    }
+    for (int i = 0; i < ingest->workers; i++) {
+        if (pthread_create(&ingest->worker[i].thread, NULL, workerTask, &ingest->worker[i]) != 0) {
+            printf("ERROR: Worker thread NOT created!\n");
+            return -1;
+        }
+    }
+    if (pthread_create(&ingest->reactor, NULL, reactorTask, ingest) != 0) {
+        printf("ERROR: Reactor thread NOT created!\n");
+        return -1;
+    }
+    ingest->started = true;
+    return 0;
+}
+
+/**
+ * @brief nmea_ingest_latest function gives the latest fix and the statistics of a receiver
+ * @param ingest is the handle
+ * @param receiverId is the id returned by nmea_ingest_add
+ * @param fix holds the latest fix (can be NULL)
+ * @param stats holds the statistics (can be NULL)
+ * @return bool is true if the receiver has produced at least one valid fix
+ */
+bool nmea_ingest_latest(nmea_Ingest_t *ingest, int receiverId, nmea_ParseResult_t *fix, nmea_IngestStats_t *stats)
+{
+    if (receiverId < 0 || receiverId >= ingest->receivers) {
+        return false;
+    }
+    ingestReceiver_t *rx = &ingest->rx[receiverId];
+    pthread_mutex_lock(&rx->lock);
+    bool hasFix = rx->hasFix;
+    if (fix != NULL && hasFix) {
+        *fix = rx->latest;
+    }
+    if (stats != NULL) {
+        *stats = rx->stats;
+    }
+    pthread_mutex_unlock(&rx->lock);
+    if (stats != NULL) {
+        stats->bytesRead = atomic_load_explicit(&rx->bytesRead, memory_order_relaxed);
+        stats->bytesDropped = atomic_load_explicit(&rx->bytesDropped, memory_order_relaxed);
+        stats->datagrams = atomic_load_explicit(&rx->datagrams, memory_order_relaxed);
+        stats->connections = atomic_load_explicit(&rx->connections, memory_order_relaxed);
+        stats->closed = atomic_load(&rx->closed);
+    }
+    return hasFix;
+}
+
+/**
+ * @brief nmea_ingest_net_stats function gives the network statistics of the ingest
+ * @param ingest is the handle
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_ingest_net_stats(nmea_Ingest_t *ingest, nmea_IngestNetStats_t *stats)
+{
+    stats->recvCalls = atomic_load_explicit(&ingest->recvCalls, memory_order_relaxed);
+    stats->datagrams = atomic_load_explicit(&ingest->datagrams, memory_order_relaxed);
+    stats->truncated = atomic_load_explicit(&ingest->truncated, memory_order_relaxed);
+    stats->accepted = atomic_load_explicit(&ingest->accepted, memory_order_relaxed);
+    stats->noSlot = atomic_load_explicit(&ingest->noSlot, memory_order_relaxed);
+}
+
+/**
+ * @brief nmea_ingest_print function prints the latest fix and the statistics of every receiver to console
+ * @param ingest is the handle
+ * @return void
+ */
+void nmea_ingest_print(nmea_Ingest_t *ingest)
+{
+    nmea_ParseResult_t fix;
+    nmea_IngestStats_t stats;
+    for (int i = 0; i < ingest->receivers; i++) {
+        bool hasFix = nmea_ingest_latest(ingest, i, &fix, &stats);
+        printf("RECEIVER-%d%s: bytes %llu (dropped %llu), sentences %llu, fixes %llu, invalid %llu, overlong %llu\n", i,
+               stats.closed ? " (closed)" : "", (unsigned long long) stats.bytesRead, (unsigned long long) stats.bytesDropped,
+               (unsigned long long) stats.sentences, (unsigned long long) stats.validFixes,
+               (unsigned long long) stats.invalidSentences, (unsigned long long) stats.overlongLines);
+        const ingestSender_t *sender = &ingest->rx[i].sender;
+        if (sender->family != 0) {
+            char addr[INET6_ADDRSTRLEN];
+            inet_ntop(sender->family, sender->addr, addr, sizeof(addr));
+            printf("    SENDER--------------------------> %s %s port %u, datagrams %llu, connections %llu\n",
+                   sender->tcp ? "TCP" : "UDP", addr, sender->port, (unsigned long long) stats.datagrams, (unsigned long long) stats.connections);
+        }
+        if (hasFix) {
+            printf("    LATEST FIX----------------------> %d:%d:%.3f %d° %.4f' (%s) %d° %.4f' (%s) Q%d SAT%d\n",
+                   fix.data.gpsData_time.hour, fix.data.gpsData_time.minutes, fix.data.gpsData_time.seconds,
+                   fix.data.gpsData_position.LATITUDE.latDeg, fix.data.gpsData_position.LATITUDE.latMin, fix.data.gpsData_position.LATITUDE.latInd,
+                   fix.data.gpsData_position.LONGITUDE.longDeg, fix.data.gpsData_position.LONGITUDE.longMin, fix.data.gpsData_position.LONGITUDE.longInd,
+                   fix.data.gpsData_qIndicator, fix.data.gpsData_satTracked);
+        }
+    }
+}
+
+/**
+ * @brief nmea_ingest_destroy function stops the threads, closes all the receiver descriptors and frees the handle
+ * @param ingest is the handle
+ * @return void
+ */
+void nmea_ingest_destroy(nmea_Ingest_t *ingest)
+{
+    if (ingest == NULL) {
+        return;
+    }
+    if (ingest->started) {
+        uint64_t one = 1;
+        if (write(ingest->stopFd, &one, sizeof(one)) < 0) {
+            printf("ERROR: Reactor stop event NOT sent!\n");
+        }
+        pthread_join(ingest->reactor, NULL);
+        for (int i = 0; i < ingest->workers; i++) {
+            pthread_mutex_lock(&ingest->worker[i].lock);
+            ingest->worker[i].stop = true;
+            pthread_cond_signal(&ingest->worker[i].cond);
+            pthread_mutex_unlock(&ingest->worker[i].lock);
+            pthread_join(ingest->worker[i].thread, NULL);
+        }
+    }
+    for (int i = 0; i < ingest->receivers; i++) {
+        if (ingest->rx[i].fd >= 0) {
+            close(ingest->rx[i].fd);
+        }
+        pthread_mutex_destroy(&ingest->rx[i].lock);
+    }
+    for (int i = 0; i < ingest->workers; i++) {
+        pthread_mutex_destroy(&ingest->worker[i].lock);
+        pthread_cond_destroy(&ingest->worker[i].cond);
+        free(ingest->worker[i].queue);
+    }
+    for (int i = 0; i < ingest->listeners; i++) {
+        close(ingest->listener[i].fd);
+    }
+    pthread_mutex_destroy(&ingest->addLock);
+    close(ingest->epollFd);
+    close(ingest->stopFd);
+    close(ingest->resumeFd);
+    free(ingest->rx);
+    free(ingest->worker);
+    free(ingest->senders);
+    free(ingest->msgs);
+    free(ingest->iov);
+    free(ingest->from);
+    free(ingest->datagram);
+    free(ingest->touched);
+    free(ingest);
+}
+
+#define BENCH_SENTENCE "$GPGGA,002153.000,3342.6618,N,11751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000*5E\r\n"
+#define BENCH_SEND_BATCH 32             //Datagrams per sendmmsg call of a benchmark sender
+#define BENCH_WINDOW 48                 //Datagrams of a benchmark sender in flight (sent and not parsed yet)
+#define BENCH_LOST_NS 20000000u         //Datagrams in flight this long without progress are taken as lost
+#define BENCH_MAX_PROBES 2000           //Latency probes per run
+#define BENCH_TCP_LINES 64              //Sentences per write of a TCP benchmark connection
+#define BENCH_MAX_WORKERS 16            //Workers with a rate in the benchmark output
+#define BENCH_FD_LINES 32               //Sentences per write of a descriptor benchmark writer
+#define BENCH_FD_WINDOW 64              //Sentences of a descriptor receiver in flight (fits the receiver buffer)
+
+/**
+ * @brief Benchmark sender, a connected UDP socket or a TCP connection
+ */
+typedef struct {
+    pthread_t thread;
+    int fd;
+    bool udp;
+    uint32_t count;                     //datagrams (UDP) or sentences (TCP)
+    nmea_Ingest_t *ingest;
+    int id;                             //receiver of a UDP sender
+    atomic_int *running;
+} benchSender_t;
+
+/**
+ * @brief benchSenderTask function sends the GGA sentence as fast as the ingest parses it, UDP with a window of
+ * -datagrams in flight (UDP has no flow control, a sender which outruns the ingest measures the socket drops), TCP
+ * -as fast as the socket takes it
+ * @param arg is the sender
+ * @return void* is always NULL
+ */
+static void* benchSenderTask(void *arg)
+{
+    benchSender_t *sender = arg;
+    static const char s_sentence[] = BENCH_SENTENCE;
+    if (sender->udp) {
+        struct iovec iov = { .iov_base = (void*) s_sentence, .iov_len = sizeof(s_sentence) - 1 };
+        struct mmsghdr msgs[BENCH_SEND_BATCH];
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < BENCH_SEND_BATCH; i++) {
+            msgs[i].msg_hdr.msg_iov = &iov;
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        nmea_IngestStats_t stats;
+        uint64_t parsed = 0, lost = 0, waitNs = 0;
+        for (uint32_t sent = 0; sent < sender->count; ) {
+            nmea_ingest_latest(sender->ingest, sender->id, NULL, &stats);
+            if (stats.validFixes != parsed) {
+                parsed = stats.validFixes;
+                waitNs = 0;
+            }
+            uint64_t inFlight = sent - parsed - lost;
+            if (inFlight >= BENCH_WINDOW) {
+                uint64_t now = nmea_wall_ns();
+                if (waitNs == 0) {
+                    waitNs = now;
+                }
+                else if (now - waitNs > BENCH_LOST_NS) {
+                    lost += inFlight;
+                    waitNs = 0;
+                }
+                sched_yield();
+                continue;
+            }
+            uint32_t n = (sender->count - sent < BENCH_WINDOW - inFlight) ? sender->count - sent : (uint32_t) (BENCH_WINDOW - inFlight);
+            n = (n < BENCH_SEND_BATCH) ? n : BENCH_SEND_BATCH;
+            int ret = sendmmsg(sender->fd, msgs, n, 0);
+            if (ret > 0) {
+                sent += (uint32_t) ret;
+            }
+            else if (errno != EINTR && errno != ENOBUFS && errno != EAGAIN && errno != ECONNREFUSED) {
+                break;
+            }
+        }
+    }
+    else {
+        char block[BENCH_TCP_LINES * (sizeof(s_sentence) - 1)];
+        for (int i = 0; i < BENCH_TCP_LINES; i++) {
+            memcpy(block + i * (sizeof(s_sentence) - 1), s_sentence, sizeof(s_sentence) - 1);
+        }
+        //The last write is cut to the sentences left, so exactly count sentences are sent
+        for (uint32_t sent = 0; sent < sender->count; sent += BENCH_TCP_LINES) {
+            uint32_t lines = (sender->count - sent < BENCH_TCP_LINES) ? sender->count - sent : BENCH_TCP_LINES;
+            size_t len = lines * (sizeof(s_sentence) - 1), done = 0;
+            while (done < len) {
+                ssize_t n = send(sender->fd, block + done, len - done, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                done += (size_t) n;
+            }
+            if (done < len) {
+                break;
+            }
+        }
+    }
+    atomic_fetch_sub(sender->running, 1);
+    return NULL;
+}
+
+/**
+ * @brief benchSocket function gives a socket connected to a localhost port
+ * @param port is the port
+ * @param udp selects UDP or TCP
+ * @return int is the socket or -1 on failure
+ */
+static int benchSocket(uint16_t port, bool udp)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port) };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = socket(AF_INET, (udp ? SOCK_DGRAM : SOCK_STREAM) | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief benchSenderId function registers the local address of a UDP socket as a sender
+ * @param ingest is the handle
+ * @param fd is the socket
+ * @return int is the receiver id or -1 on failure
+ */
+static int benchSenderId(nmea_Ingest_t *ingest, int fd)
+{
+    struct sockaddr_storage local;
+    socklen_t len = sizeof(local);
+    if (fd < 0 || getsockname(fd, (struct sockaddr*) &local, &len) != 0) {
+        return -1;
+    }
+    return nmea_ingest_add_sender(ingest, (struct sockaddr*) &local, len, false);
+}
+
+/**
+ * @brief benchTotals function adds up the valid fixes of every receiver
+ * @param ingest is the handle
+ * @return uint64_t is the number of valid fixes
+ */
+static uint64_t benchTotals(nmea_Ingest_t *ingest)
+{
+    nmea_IngestStats_t stats;
+    uint64_t fixes = 0;
+    for (int i = 0; i < ingest->receivers; i++) {
+        nmea_ingest_latest(ingest, i, NULL, &stats);
+        fixes += stats.validFixes;
+    }
+    return fixes;
+}
+
+/**
+ * @brief benchCompare function orders latencies for qsort
+ * @param a is the first latency
+ * @param b is the second latency
+ * @return int is the order
+ */
+static int benchCompare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief benchRun function runs the senders against a new ingest and prints the rate, for UDP also the latency of
+ * -probe datagrams sent while the senders run
+ * @param udp selects UDP datagrams or TCP connections
+ * @param udpBatch is the recvmmsg batch
+ * @param workers is the number of workers
+ * @param count is the number of datagrams or sentences of all senders
+ * @param senders is the number of senders
+ * @return void
+ */
+static void benchRun(bool udp, int udpBatch, int workers, uint32_t count, int senders)
+{
+    static uint64_t s_latency[BENCH_MAX_PROBES];
+    nmea_IngestConfig_t config = { .workers = workers, .maxReceivers = senders + 1, .udpBatch = udpBatch };
+    nmea_Ingest_t *ingest = nmea_ingest_create(&config);
+    benchSender_t *sender = calloc((size_t) senders, sizeof(benchSender_t));
+    int port = -1;
+    if (ingest != NULL) {
+        port = udp ? nmea_ingest_listen_udp(ingest, "127.0.0.1", 0) : nmea_ingest_listen_tcp(ingest, "127.0.0.1", 0);
+    }
+    if (sender == NULL || port < 0 || nmea_ingest_start(ingest) != 0) {
+        printf("ERROR: Network ingest benchmark NOT started!\n");
+        free(sender);
+        nmea_ingest_destroy(ingest);
+        return;
+    }
+    //The probe socket is registered first so its receiver id is known before it sends
+    int probeFd = udp ? benchSocket((uint16_t) port, true) : -1;
+    int probeId = benchSenderId(ingest, probeFd);
+    atomic_int running = 0;
+    int started = 0;
+    for (int i = 0; i < senders; i++) {
+        sender[i] = (benchSender_t) { .fd = benchSocket((uint16_t) port, udp), .udp = udp,
+                                      .count = count / (uint32_t) senders, .ingest = ingest, .running = &running };
+        sender[i].id = udp ? benchSenderId(ingest, sender[i].fd) : -1;
+        if (sender[i].fd < 0 || (udp && sender[i].id < 0)) {
+            continue;
+        }
+        atomic_fetch_add(&running, 1);
+        if (pthread_create(&sender[i].thread, NULL, benchSenderTask, &sender[i]) != 0) {
+            atomic_fetch_sub(&running, 1);
+            close(sender[i].fd);
+            sender[i].fd = -1;
+            continue;
+        }
+        started++;
+    }
+    uint64_t start = nmea_wall_ns();
+    uint64_t workerStart[BENCH_MAX_WORKERS];
+    for (int i = 0; i < workers && i < BENCH_MAX_WORKERS; i++) {
+        workerStart[i] = atomic_load(&ingest->worker[i].fixes);
+    }
+
+    //Probes: one datagram at a time, the latency ends when the worker publishes its fix (lastFixNs), the probe sleeps
+    //while it waits so it does not take the CPU of the ingest
+    int probes = 0;
+    nmea_IngestStats_t stats;
+    while (probeId >= 0 && atomic_load(&running) > 0 && probes < BENCH_MAX_PROBES) {
+        nmea_ingest_latest(ingest, probeId, NULL, &stats);
+        uint64_t before = stats.validFixes;
+        uint64_t sentNs = nmea_wall_ns();
+        if (write(probeFd, BENCH_SENTENCE, sizeof(BENCH_SENTENCE) - 1) < 0) {
+            break;
+        }
+        struct timespec pause = { 0, 20000 };
+        do {
+            nanosleep(&pause, NULL);
+            nmea_ingest_latest(ingest, probeId, NULL, &stats);
+        } while (stats.validFixes == before && nmea_wall_ns() - sentNs < 100000000u);
+        if (stats.validFixes != before) {
+            s_latency[probes++] = stats.lastFixNs - sentNs;
+        }
+        pause.tv_nsec = 200000;
+        nanosleep(&pause, NULL);
+    }
+    for (int i = 0; i < senders; i++) {
+        if (sender[i].fd >= 0) {
+            pthread_join(sender[i].thread, NULL);
+            if (!udp) {
+                shutdown(sender[i].fd, SHUT_WR);
+            }
+        }
+    }
+
+    //Done when the fixes stop growing for 50 ms, the end is the time of the last growth
+    uint64_t fixes = benchTotals(ingest), end = nmea_wall_ns(), stableNs = end;
+    while (nmea_wall_ns() - stableNs < 50000000u) {
+        struct timespec pause = { 0, 1000000 };
+        nanosleep(&pause, NULL);
+        uint64_t now = benchTotals(ingest);
+        if (now != fixes) {
+            fixes = now;
+            end = stableNs = nmea_wall_ns();
+        }
+    }
+    fixes -= (uint64_t) probes;
+    double seconds = (end > start) ? (end - start) / 1e9 : 1e-9;
+    uint64_t expected = (uint64_t) started * (count / (uint32_t) senders);
+    nmea_IngestNetStats_t net;
+    nmea_ingest_net_stats(ingest, &net);
+    if (udp) {
+        qsort(s_latency, (size_t) probes, sizeof(s_latency[0]), benchCompare);
+        printf("INGEST UDP RUN----------------------> recvmmsg batch %d, %d worker(s), %d senders\n", udpBatch, workers,
+               started);
+        printf("INGEST DATAGRAMS/S------------------> %.0f, %.1f per recvmmsg, %.2f%% lost\n", fixes / seconds,
+               net.recvCalls ? (double) net.datagrams / net.recvCalls : 0.0,
+               expected ? 100.0 * (double) (expected - (fixes < expected ? fixes : expected)) / expected : 0.0);
+        printf("INGEST PROBE LATENCY P50/P99 (us)---> %.1f/%.1f (%d probes)\n",
+               probes ? s_latency[probes / 2] / 1e3 : 0.0, probes ? s_latency[probes * 99 / 100] / 1e3 : 0.0, probes);
+    }
+    else {
+        printf("INGEST TCP RUN----------------------> %d connections, %d worker(s), %llu accepted\n", started, workers,
+               (unsigned long long) net.accepted);
+        printf("INGEST SENTENCES/S------------------> %.0f, %llu of %llu parsed\n", fixes / seconds,
+               (unsigned long long) fixes, (unsigned long long) expected);
+    }
+    //Measured per worker, the probes included
+    printf("INGEST FIXES/S PER WORKER-----------> ");
+    for (int i = 0; i < workers && i < BENCH_MAX_WORKERS; i++) {
+        printf("%s%.0f", (i > 0) ? ", " : "", (atomic_load(&ingest->worker[i].fixes) - workerStart[i]) / seconds);
+    }
+    printf("\n");
+    if (probeFd >= 0) {
+        close(probeFd);
+    }
+    for (int i = 0; i < senders; i++) {
+        if (sender[i].fd >= 0) {
+            close(sender[i].fd);
+        }
+    }
+    free(sender);
+    nmea_ingest_destroy(ingest);
+}
+
+/**
+ * @brief benchOpenPty function opens a pseudo terminal in raw mode, the ingest reads the terminal side like a serial
+ * -receiver and the benchmark writes into the master side like the receiver hardware
+ * @param master holds the master descriptor
+ * @return int is the terminal descriptor or -1 on failure
+ */
+static int benchOpenPty(int *master)
+{
+    *master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (*master < 0 || grantpt(*master) != 0 || unlockpt(*master) != 0) {
+        if (*master >= 0) close(*master);
+        return -1;
+    }
+    int fd = open(ptsname(*master), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    struct termios tio;
+    if (fd < 0 || tcgetattr(fd, &tio) != 0) {
+        if (fd >= 0) close(fd);
+        close(*master);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+    return fd;
+}
+
+/**
+ * @brief benchDescriptors function writes sentences into N receiver descriptors (pipes or pseudo terminals) of a
+ * -new ingest and prints the sentence rate, every receiver is kept at most BENCH_FD_WINDOW sentences ahead of its
+ * -parsed fixes so the receiver buffers never overflow
+ * @param pty selects pseudo terminals, otherwise pipes (FIFOs)
+ * @param receivers is the number of receiver descriptors
+ * @param sentences is the number of sentences of all receivers
+ * @return void
+ */
+static void benchDescriptors(bool pty, int receivers, uint32_t sentences)
+{
+    static const char s_sentence[] = BENCH_SENTENCE;
+    char block[BENCH_FD_LINES * (sizeof(s_sentence) - 1)];
+    for (int i = 0; i < BENCH_FD_LINES; i++) {
+        memcpy(block + i * (sizeof(s_sentence) - 1), s_sentence, sizeof(s_sentence) - 1);
+    }
+    nmea_IngestConfig_t config = { .workers = INGEST_DEFAULT_WORKERS, .maxReceivers = receivers };
+    nmea_Ingest_t *ingest = nmea_ingest_create(&config);
+    int *writer = malloc((size_t) receivers * sizeof(int));
+    uint32_t *sent = calloc((size_t) receivers, sizeof(uint32_t));
+    int opened = 0;
+    while (ingest != NULL && writer != NULL && sent != NULL && opened < receivers) {
+        int fds[2];
+        if (pty) {
+            fds[0] = benchOpenPty(&fds[1]);
+        }
+        else if (pipe2(fds, O_CLOEXEC) != 0) {
+            fds[0] = -1;
+        }
+        if (fds[0] < 0) {
+            break;
+        }
+        if (nmea_ingest_add(ingest, fds[0]) < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            break;
+        }
+        writer[opened++] = fds[1];
+    }
+    const char *kind = pty ? "PTY" : "FIFO";
+    if (opened < receivers || nmea_ingest_start(ingest) != 0) {
+        printf("ERROR: %d of %d %s receivers opened, descriptor benchmark NOT started!\n", opened, receivers, kind);
+        for (int i = 0; i < opened; i++) close(writer[i]);
+        free(writer);
+        free(sent);
+        nmea_ingest_destroy(ingest);
+        return;
+    }
+    //Round robin over the receivers with room in their window, the ingest gets the CPU when none has room
+    uint32_t perReceiver = sentences / (uint32_t) receivers / BENCH_FD_LINES * BENCH_FD_LINES;
+    nmea_IngestStats_t stats;
+    uint64_t start = nmea_wall_ns();
+    for (int done = 0; done < receivers; ) {
+        bool wrote = false;
+        done = 0;
+        for (int i = 0; i < receivers; i++) {
+            if (sent[i] >= perReceiver) {
+                done++;
+                continue;
+            }
+            nmea_ingest_latest(ingest, i, NULL, &stats);
+            if (sent[i] - stats.validFixes + BENCH_FD_LINES > BENCH_FD_WINDOW) {
+                continue;
+            }
+            if (write(writer[i], block, sizeof(block)) != (ssize_t) sizeof(block)) {
+                sent[i] = perReceiver;
+                continue;
+            }
+            sent[i] += BENCH_FD_LINES;
+            wrote = true;
+        }
+        if (!wrote) {
+            sched_yield();
+        }
+    }
+    //Done when every receiver has parsed all of its sentences or nothing moved for 50 ms
+    uint64_t fixes = 0, dropped = 0, stableNs = nmea_wall_ns(), end = stableNs;
+    while (fixes < (uint64_t) perReceiver * (uint64_t) receivers && nmea_wall_ns() - stableNs < 50000000u) {
+        uint64_t now = 0;
+        dropped = 0;
+        for (int i = 0; i < receivers; i++) {
+            nmea_ingest_latest(ingest, i, NULL, &stats);
+            now += stats.validFixes;
+            dropped += stats.bytesDropped;
+        }
+        if (now != fixes) {
+            fixes = now;
+            end = stableNs = nmea_wall_ns();
+        }
+        else {
+            sched_yield();
+        }
+    }
+    double seconds = (end > start) ? (end - start) / 1e9 : 1e-9;
+    char label[40];
+    int len = snprintf(label, sizeof(label), "INGEST %d %s RECEIVERS", receivers, kind);
+    printf("%s%.*s> %.0f sentences/s, %.1f MB/s, %llu of %llu parsed, %llu bytes dropped\n", label,
+           (len < 36) ? 36 - len : 0, "------------------------------------", fixes / seconds,
+           fixes * (sizeof(s_sentence) - 1) / seconds / 1e6, (unsigned long long) fixes,
+           (unsigned long long) perReceiver * (unsigned long long) receivers, (unsigned long long) dropped);
+    for (int i = 0; i < receivers; i++) {
+        close(writer[i]);
+    }
+    free(writer);
+    free(sent);
+    nmea_ingest_destroy(ingest);
+}
+
+/**
+ * @brief nmea_ingest_fd_benchmark function writes GGA sentences into pipes (FIFOs) and pseudo terminals registered
+ * -with nmea_ingest_add and prints the sentence rate for 1, 4, 16... receivers up to the given number
+ * @param maxReceivers is the largest number of receiver descriptors
+ * @param sentences is the number of sentences of every run
+ * @return void
+ */
+void nmea_ingest_fd_benchmark(int maxReceivers, uint32_t sentences)
+{
+    for (int pty = 0; pty < 2; pty++) {
+        for (int n = 1; n <= maxReceivers; n = (n * 4 <= maxReceivers || n == maxReceivers) ? n * 4 : maxReceivers) {
+            benchDescriptors(pty != 0, n, sentences);
+        }
+    }
+}
+
+/**
+ * @brief nmea_ingest_net_benchmark function sends GGA datagrams from localhost senders into an ingest and prints the
+ * -datagrams per second, the fixes per second of every worker and the latency of probe sentences under load, for
+ * -single datagram reads and recvmmsg batches and for 1, 2 and 4 workers, then the sentence rate of TCP connections
+ * @param datagrams is the number of datagrams of every run
+ * @param senders is the number of sender sockets
+ * @return void
+ */
+void nmea_ingest_net_benchmark(uint32_t datagrams, int senders)
+{
+    if (datagrams == 0 || senders <= 0) {
+        return;
+    }
+    benchRun(true, 1, 2, datagrams, senders);
+    benchRun(true, INGEST_DEFAULT_UDP_BATCH, 1, datagrams, senders);
+    benchRun(true, INGEST_DEFAULT_UDP_BATCH, 2, datagrams, senders);
+    benchRun(true, INGEST_DEFAULT_UDP_BATCH, 4, datagrams, senders);
+    benchRun(false, INGEST_DEFAULT_UDP_BATCH, 2, datagrams * 4, senders);
+}
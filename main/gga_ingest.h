@@ -0,0 +1,181 @@
+/**
+ * @brief Multi-receiver ingest for the host gateway (Linux only).
+ * -Many receiver file descriptors (ttys, ptys, FIFOs) are registered with one epoll reactor which reads them with
+ * -non-blocking I/O into per-receiver buffers. The GGA sentences are parsed on a small fixed pool of worker threads,
+ * -every receiver is always handled by the same worker so the order of its fixes is preserved.
+ * -Serial-to-Ethernet bridges are received on UDP sockets and TCP listeners of the same reactor. A UDP socket is read
+ * -with recvmmsg, a batch of datagrams per system call, and every receiver touched by the batch is handed to its worker
+ * -once, which parses all of its new sentences at once. The sender address selects the receiver: the source address
+ * -and port of a datagram, the peer address and port of a TCP connection, UDP and TCP senders never share one (a bridge
+ * -reconnecting from the same port keeps its receiver, the new connection replaces the old one). Unknown senders get
+ * -the next free receiver slot, or a fixed id when they were registered with nmea_ingest_add_sender first. A full receiver buffer drops a datagram whole, a TCP
+ * -connection is not read until the worker has made room, so TCP flow control slows the bridge down.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define INGEST_DEFAULT_WORKERS 2        //Default size of the worker pool
+#define INGEST_DEFAULT_RECEIVERS 64     //Default maximum number of receivers
+#define INGEST_RX_BUF_LEN 8192          //Per-receiver buffer between the reactor and the worker (power of 2)
+#define INGEST_LINE_LEN 128             //Maximum length of one sentence (NMEA maximum is 82)
+#define INGEST_MAX_LISTENERS 8          //UDP sockets and TCP listeners per ingest
+#define INGEST_DEFAULT_UDP_BATCH 64     //Default number of datagrams per recvmmsg call
+#define INGEST_DATAGRAM_LEN 2048        //Largest datagram, longer ones are truncated and dropped
+
+/**
+ * @brief Ingest configuration
+ */
+typedef struct {
+    int workers;                        //number of parsing threads (0 selects INGEST_DEFAULT_WORKERS)
+    int maxReceivers;                   //number of receiver slots (0 selects INGEST_DEFAULT_RECEIVERS)
+    int udpBatch;                       //datagrams per recvmmsg call (0 selects INGEST_DEFAULT_UDP_BATCH)
+} nmea_IngestConfig_t;
+
+/**
+ * @brief Per-receiver statistics
+ */
+typedef struct {
+    uint64_t bytesRead;                 //bytes read from the descriptor
+    uint64_t bytesDropped;              //bytes dropped because the receiver buffer was full
+    uint64_t sentences;                 //complete lines seen
+    uint64_t validFixes;                //GGA sentences with a valid checksum
+    uint64_t invalidSentences;          //lines which are not GGA or failed the checksum
+    uint64_t overlongLines;             //lines longer than INGEST_LINE_LEN
+    uint64_t lastFixNs;                 //CLOCK_MONOTONIC time of the latest valid fix
+    uint64_t datagrams;                 //UDP datagrams of the sender
+    uint64_t connections;               //TCP connections of the sender
+    bool closed;                        //the descriptor reached end of file or failed
+} nmea_IngestStats_t;
+
+/**
+ * @brief Network statistics of the ingest
+ */
+typedef struct {
+    uint64_t recvCalls;                 //recvmmsg calls which gave datagrams
+    uint64_t datagrams;                 //datagrams received
+    uint64_t truncated;                 //datagrams longer than INGEST_DATAGRAM_LEN, dropped
+    uint64_t accepted;                  //TCP connections accepted
+    uint64_t noSlot;                    //datagrams and connections of new senders dropped without a free slot
+} nmea_IngestNetStats_t;
+
+/**
+ * @brief Opaque ingest handle
+ */
+typedef struct nmea_Ingest nmea_Ingest_t;
+
+/**
+ * @brief nmea_ingest_create function allocates the reactor, the receiver slots and the worker pool
+ * @param config is the configuration, NULL selects the defaults
+ * @return nmea_Ingest_t* is the handle or NULL on failure
+ */
+nmea_Ingest_t* nmea_ingest_create(const nmea_IngestConfig_t* );
+
+/**
+ * @brief nmea_ingest_add function registers a receiver descriptor, it can be called before or after nmea_ingest_start
+ * -The descriptor is switched to non-blocking mode and is owned (closed) by the ingest from now on.
+ * @param ingest is the handle
+ * @param fd is the receiver file descriptor
+ * @return int is the receiver id (0, 1, 2...) or -1 if there are no free slots or the descriptor cannot be registered
+ */
+int nmea_ingest_add(nmea_Ingest_t* , int );
+
+/**
+ * @brief nmea_ingest_listen_udp function opens a UDP socket for the datagrams of the bridges, it can be called before
+ * -or after nmea_ingest_start
+ * @param ingest is the handle
+ * @param address is the local IPv4 or IPv6 address e.g., "0.0.0.0" or "127.0.0.1"
+ * @param port is the local port (0 selects a free one)
+ * @return int is the bound port or -1 on failure
+ */
+int nmea_ingest_listen_udp(nmea_Ingest_t* , const char* , uint16_t );
+
+/**
+ * @brief nmea_ingest_listen_tcp function opens a TCP listener for the streams of the bridges, it can be called before
+ * -or after nmea_ingest_start
+ * @param ingest is the handle
+ * @param address is the local IPv4 or IPv6 address
+ * @param port is the local port (0 selects a free one)
+ * @return int is the bound port or -1 on failure
+ */
+int nmea_ingest_listen_tcp(nmea_Ingest_t* , const char* , uint16_t );
+
+/**
+ * @brief nmea_ingest_add_sender function gives a network sender its receiver before it sends anything, so the ids
+ * -do not depend on the order of the first packets
+ * @param ingest is the handle
+ * @param addr is the source address and port of the datagrams or of the connection
+ * @param len is the length of the address
+ * @param tcp selects a TCP connection, false a UDP sender
+ * @return int is the receiver id or -1 if there are no free slots or the address family is not IPv4 or IPv6
+ */
+int nmea_ingest_add_sender(nmea_Ingest_t* , const struct sockaddr* , socklen_t , bool );
+
+/**
+ * @brief nmea_ingest_start function starts the reactor thread and the worker threads
+ * @param ingest is the handle
+ * @return int is 0 on success or -1 on failure
+ */
+int nmea_ingest_start(nmea_Ingest_t* );
+
+/**
+ * @brief nmea_ingest_latest function gives the latest fix and the statistics of a receiver
+ * @param ingest is the handle
+ * @param receiverId is the id returned by nmea_ingest_add
+ * @param fix holds the latest fix (can be NULL)
+ * @param stats holds the statistics (can be NULL)
+ * @return bool is true if the receiver has produced at least one valid fix
+ */
+bool nmea_ingest_latest(nmea_Ingest_t* , int , nmea_ParseResult_t* , nmea_IngestStats_t* );
+
+/**
+ * @brief nmea_ingest_net_stats function gives the network statistics of the ingest
+ * @param ingest is the handle
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_ingest_net_stats(nmea_Ingest_t* , nmea_IngestNetStats_t* );
+
+/**
+ * @brief nmea_ingest_print function prints the latest fix and the statistics of every receiver to console
+ * @param ingest is the handle
+ * @return void
+ */
+void nmea_ingest_print(nmea_Ingest_t* );
+
+/**
+ * @brief nmea_ingest_destroy function stops the threads, closes all the receiver descriptors and frees the handle
+ * @param ingest is the handle
+ * @return void
+ */
+void nmea_ingest_destroy(nmea_Ingest_t* );
+
+/**
+ * @brief nmea_ingest_fd_benchmark function writes GGA sentences into pipes (FIFOs) and pseudo terminals registered
+ * -with nmea_ingest_add and prints the sentence rate for 1, 4, 16... receivers up to the given number
+ * @param maxReceivers is the largest number of receiver descriptors
+ * @param sentences is the number of sentences of every run
+ * @return void
+ */
+void nmea_ingest_fd_benchmark(int , uint32_t );
+
+/**
+ * @brief nmea_ingest_net_benchmark function sends GGA datagrams from localhost senders into an ingest and prints the
+ * -datagrams per second, the fixes per second of every worker and the latency of probe sentences under load, for
+ * -single datagram reads and recvmmsg batches and for 1, 2 and 4 workers, then the sentence rate of TCP connections
+ * @param datagrams is the number of datagrams of every run
+ * @param senders is the number of sender sockets
+ * @return void
+ */
+void nmea_ingest_net_benchmark(uint32_t , int );
+
+#ifdef __cplusplus
+}
+#endif
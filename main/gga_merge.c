@@ -0,0 +1,870 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "gga_merge.h"
+#include "gga_scan.h"
+#include "gga_emit.h"
+#include "gga_encode.h"
+#include "gga_validate.h"
+#include "gga_bench.h"
+
+#define DAY_MS 86400000                 //UTC time of the day wraps around at midnight
+#define REF_SCAN_LIMIT (1u << 20)       //Bytes of the first input searched for the reference fix
+
+/**
+ * @brief Sorted run inside a spill file
+ */
+typedef struct {
+    int fd;
+    uint64_t offset;                    //byte offset of the first record
+    uint64_t count;                     //number of records
+} mergeRun_t;
+
+/**
+ * @brief List of runs, in the order of the records of every receiver
+ */
+typedef struct {
+    mergeRun_t *run;
+    size_t count;
+    size_t cap;
+} mergeRunList_t;
+
+/**
+ * @brief State shared by the run generation threads
+ */
+typedef struct {
+    const nmea_MergeConfig_t *config;
+    const char *tmpDir;
+    uint32_t runRecords;
+    uint32_t ioBuffer;
+    int64_t refMs;                      //time of the first fix of the first input, every capture starts near it
+    atomic_int nextInput;
+    pthread_mutex_t lock;               //protects runs and the statistics
+    mergeRunList_t runs;
+    nmea_MergeStats_t stats;
+    bool failed;
+} mergeJob_t;
+
+/**
+ * @brief Run generation thread
+ */
+typedef struct {
+    mergeJob_t *job;
+    pthread_t thread;
+    int spillFd;
+    uint64_t spillEnd;
+    nmea_MergeRecord_t *records;
+    nmea_MergeRecord_t *tmp;
+    size_t count;
+    char *readBuf;
+    nmea_Scanner_t scanner;
+    uint16_t receiver;                  //input being parsed
+    int64_t lastKey;                    //key of the previous fix of the input (the reference before the first fix)
+    bool hasFix;                        //the input has given a timed fix
+    nmea_MergeStats_t stats;
+    bool failed;
+} mergeWorker_t;
+
+/**
+ * @brief Buffered sequential reader of one run
+ */
+typedef struct {
+    mergeRun_t run;
+    uint64_t next;                      //records read from the file
+    nmea_MergeRecord_t *buf;
+    size_t cap;
+    size_t pos;
+    size_t len;
+    bool done;
+} mergeReader_t;
+
+/**
+ * @brief Buffered sequential writer of spill records or of the output
+ */
+typedef struct {
+    int fd;
+    nmea_MergeFormat_t format;
+    char *buf;
+    size_t cap;
+    size_t len;
+    uint64_t bytes;
+    bool failed;
+} mergeWriter_t;
+
+/**
+ * @brief keyOf function gives the sort key of a record (ms since midnight of the reference day)
+ * @param record is the record
+ * @return int64_t is the key
+ */
+static inline int64_t keyOf(const nmea_MergeRecord_t *record)
+{
+    return (int64_t) record->day * DAY_MS + record->fix.timeMs;
+}
+
+/**
+ * @brief recordLess function orders two records by time, then by receiver
+ * @param a is the first record
+ * @param b is the second record
+ * @return bool is true if a goes before b
+ */
+static inline bool recordLess(const nmea_MergeRecord_t *a, const nmea_MergeRecord_t *b)
+{
+    int64_t ka = keyOf(a);
+    int64_t kb = keyOf(b);
+    return ka < kb || (ka == kb && a->receiver < b->receiver);
+}
+
+/**
+ * @brief nextKey function places a time of the day next to the previous key of the capture (within half a day), this
+ * -follows the midnight rollovers in both directions
+ * @param lastKey is the previous key
+ * @param timeMs is the time of the day
+ * @return int64_t is the key
+ */
+static inline int64_t nextKey(int64_t lastKey, uint32_t timeMs)
+{
+    int64_t lastMs = ((lastKey % DAY_MS) + DAY_MS) % DAY_MS;
+    int64_t diff = ((int64_t) timeMs - lastMs + DAY_MS + DAY_MS / 2) % DAY_MS - DAY_MS / 2;
+    return lastKey + diff;
+}
+
+/**
+ * @brief dayOf function gives the day of a key (rounded down)
+ * @param key is the key
+ * @return int32_t is the day
+ */
+static inline int32_t dayOf(int64_t key)
+{
+    return (int32_t) ((key >= 0) ? key / DAY_MS : -((-key + DAY_MS - 1) / DAY_MS));
+}
+
+/**
+ * @brief writeAll function writes a buffer completely
+ * @param fd is the descriptor
+ * @param data is the buffer
+ * @param len is the length of the buffer
+ * @return bool is false on a write error
+ */
+static bool writeAll(int fd, const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= (size_t) n;
+    }
+    return true;
+}
+
+/**
+ * @brief openSpill function creates an unlinked temporary file, it is removed when it is closed
+ * @param dir is the temporary directory
+ * @return int is the descriptor or -1 on failure
+ */
+static int openSpill(const char *dir)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/gga_merge_XXXXXX", dir);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        printf("ERROR: Spill file NOT created in %s (%s)!\n", dir, strerror(errno));
+        return -1;
+    }
+    unlink(path);
+    return fd;
+}
+
+/**
+ * @brief addRun function appends a run to a list
+ * @param list is the list
+ * @param run is the run
+ * @return bool is false if the list could not grow
+ */
+static bool addRun(mergeRunList_t *list, const mergeRun_t *run)
+{
+    if (list->count == list->cap) {
+        size_t cap = (list->cap != 0) ? list->cap * 2 : 64;
+        mergeRun_t *grown = realloc(list->run, cap * sizeof(mergeRun_t));
+        if (grown == NULL) {
+            printf("ERROR: Memory NOT allocated!\n");
+            return false;
+        }
+        list->run = grown;
+        list->cap = cap;
+    }
+    list->run[list->count++] = *run;
+    return true;
+}
+
+/**
+ * @brief addStats function adds the counters of one statistics block to another
+ * @param to is the sum
+ * @param from is the added block
+ * @return void
+ */
+static void addStats(nmea_MergeStats_t *to, const nmea_MergeStats_t *from)
+{
+    to->bytesRead += from->bytesRead;
+    to->sentences += from->sentences;
+    to->discardedBytes += from->discardedBytes;
+    to->untimed += from->untimed;
+    to->rollovers += from->rollovers;
+    to->runs += from->runs;
+    to->spilledBytes += from->spilledBytes;
+}
+
+/**
+ * @brief sortRun function sorts the records with a stable bottom-up merge sort, sorted stretches (a capture is mostly
+ * -in order) are not merged again so sorted input costs one comparison per record and level
+ * @param a is the records
+ * @param tmp is a buffer of the same size
+ * @param n is the number of records
+ * @return void
+ */
+static void sortRun(nmea_MergeRecord_t *a, nmea_MergeRecord_t *tmp, size_t n)
+{
+    for (size_t width = 1; width < n; width *= 2) {
+        for (size_t lo = 0; lo + width < n; lo += 2 * width) {
+            size_t mid = lo + width;
+            size_t hi = (mid + width < n) ? mid + width : n;
+            if (!recordLess(&a[mid], &a[mid - 1])) {
+                continue;
+            }
+            size_t i = lo;
+            size_t j = mid;
+            size_t k = lo;
+            while (i < mid && j < hi) {
+                tmp[k++] = recordLess(&a[j], &a[i]) ? a[j++] : a[i++];
+            }
+            while (i < mid) tmp[k++] = a[i++];
+            while (j < hi) tmp[k++] = a[j++];
+            memcpy(&a[lo], &tmp[lo], (hi - lo) * sizeof(nmea_MergeRecord_t));
+        }
+    }
+}
+
+/**
+ * @brief spillRun function sorts the records of the worker and writes them as one run to its spill file
+ * @param worker is the worker
+ * @return void
+ */
+static void spillRun(mergeWorker_t *worker)
+{
+    if (worker->count == 0 || worker->failed) {
+        worker->count = 0;
+        return;
+    }
+    sortRun(worker->records, worker->tmp, worker->count);
+    size_t bytes = worker->count * sizeof(nmea_MergeRecord_t);
+    mergeRun_t run = { worker->spillFd, worker->spillEnd, worker->count };
+    if (!writeAll(worker->spillFd, (const char *) worker->records, bytes)) {
+        printf("ERROR: Spill file NOT written (%s)!\n", strerror(errno));
+        worker->failed = true;
+        return;
+    }
+    worker->spillEnd += bytes;
+    worker->stats.runs++;
+    worker->stats.spilledBytes += bytes;
+    worker->count = 0;
+    pthread_mutex_lock(&worker->job->lock);
+    if (!addRun(&worker->job->runs, &run)) {
+        worker->failed = true;
+    }
+    pthread_mutex_unlock(&worker->job->lock);
+}
+
+/**
+ * @brief collectFix function parses a sentence found by the scanner and adds its fix to the run (scanner callback)
+ * @param arg is the worker
+ * @param sentence is the sentence from '$' to "*hh"
+ * @param len is the length of the sentence
+ * @return void
+ */
+static void collectFix(void *arg, const char *sentence, size_t len)
+{
+    mergeWorker_t *worker = arg;
+    nmea_ParseResult_t result;
+    nmea_gga_parse_r(sentence, len, &result);
+    if (result.isEmpty.isEmpty_time || result.isFalse.isFalse_time) {
+        worker->stats.untimed++;
+        return;
+    }
+    nmea_MergeRecord_t *record = &worker->records[worker->count];
+    memset(record, 0, sizeof(*record));
+    nmea_pack_fix(&result, &record->fix);
+    int64_t key = nextKey(worker->lastKey, record->fix.timeMs);
+    record->day = dayOf(key);
+    record->receiver = worker->receiver;
+    //The packed time can round up to 24:00:00.000, the key moves it to the next day
+    record->fix.timeMs = (uint32_t) (key - (int64_t) record->day * DAY_MS);
+    if (worker->hasFix && dayOf(key) > dayOf(worker->lastKey)) {
+        worker->stats.rollovers++;
+    }
+    worker->lastKey = key;
+    worker->hasFix = true;
+    if (++worker->count == worker->job->runRecords) {
+        spillRun(worker);
+    }
+}
+
+/**
+ * @brief scanInput function parses one capture into the runs of the worker
+ * @param worker is the worker
+ * @param input is the index of the capture
+ * @return void
+ */
+static void scanInput(mergeWorker_t *worker, int input)
+{
+    mergeJob_t *job = worker->job;
+    const char *path = job->config->inputs[input];
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("ERROR: Capture %s NOT opened (%s)!\n", path, strerror(errno));
+        worker->failed = true;
+        return;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    nmea_scan_init(&worker->scanner);
+    worker->receiver = (uint16_t) input;
+    worker->lastKey = job->refMs;
+    worker->hasFix = false;
+    for (;;) {
+        ssize_t n = read(fd, worker->readBuf, job->ioBuffer);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            printf("ERROR: Capture %s NOT read (%s)!\n", path, strerror(errno));
+            worker->failed = true;
+            break;
+        }
+        if (n == 0 || worker->failed) {
+            break;
+        }
+        worker->stats.bytesRead += (uint64_t) n;
+        nmea_scan_feed(&worker->scanner, worker->readBuf, (size_t) n, collectFix, worker);
+    }
+    close(fd);
+    worker->stats.sentences += worker->scanner.sentences;
+    for (int i = 0; i < NMEA_DISCARD_REASON_COUNT; i++) {
+        worker->stats.discardedBytes += worker->scanner.discardedBytes[i];
+    }
+    //Bytes of a candidate still pending at the end of the capture
+    worker->stats.discardedBytes += worker->scanner.pendingLen;
+}
+
+/**
+ * @brief runThread function parses the captures handed out by the job counter, the records of all of them share the
+ * -runs of the thread
+ * @param arg is the worker
+ * @return void* is NULL
+ */
+static void* runThread(void *arg)
+{
+    mergeWorker_t *worker = arg;
+    mergeJob_t *job = worker->job;
+    int input;
+    while (!worker->failed && (input = atomic_fetch_add(&job->nextInput, 1)) < job->config->inputCount) {
+        scanInput(worker, input);
+    }
+    spillRun(worker);
+    pthread_mutex_lock(&job->lock);
+    addStats(&job->stats, &worker->stats);
+    job->failed |= worker->failed;
+    pthread_mutex_unlock(&job->lock);
+    return NULL;
+}
+
+/**
+ * @brief refCollect function keeps the first timed fix of the reference search (scanner callback)
+ * @param arg is the pointer to the reference time (-1 until found)
+ * @param sentence is the sentence from '$' to "*hh"
+ * @param len is the length of the sentence
+ * @return void
+ */
+static void refCollect(void *arg, const char *sentence, size_t len)
+{
+    int64_t *refMs = arg;
+    nmea_ParseResult_t result;
+    if (*refMs >= 0) {
+        return;
+    }
+    nmea_gga_parse_r(sentence, len, &result);
+    if (!result.isEmpty.isEmpty_time && !result.isFalse.isFalse_time) {
+        nmea_PackedFix_t fix;
+        nmea_pack_fix(&result, &fix);
+        *refMs = fix.timeMs % DAY_MS;
+    }
+}
+
+/**
+ * @brief findReference function finds the time of the first fix of the first inputs, it decides the day of the first
+ * -fix of every capture (the one within half a day of it)
+ * @param job is the job
+ * @param buf is a read buffer of job->ioBuffer bytes
+ * @return int64_t is the reference time (0 if no capture starts with a timed fix)
+ */
+static int64_t findReference(const mergeJob_t *job, char *buf)
+{
+    int64_t refMs = -1;
+    nmea_Scanner_t scanner;
+    for (int i = 0; i < job->config->inputCount && refMs < 0; i++) {
+        int fd = open(job->config->inputs[i], O_RDONLY);
+        if (fd < 0) {
+            continue;
+        }
+        nmea_scan_init(&scanner);
+        size_t total = 0;
+        ssize_t n;
+        while (refMs < 0 && total < REF_SCAN_LIMIT && (n = read(fd, buf, job->ioBuffer)) > 0) {
+            nmea_scan_feed(&scanner, buf, (size_t) n, refCollect, &refMs);
+            total += (size_t) n;
+        }
+        close(fd);
+    }
+    return (refMs >= 0) ? refMs : 0;
+}
+
+/**
+ * @brief writerFlush function writes the buffered bytes
+ * @param writer is the writer
+ * @return void
+ */
+static void writerFlush(mergeWriter_t *writer)
+{
+    if (writer->len != 0 && !writer->failed) {
+        if (!writeAll(writer->fd, writer->buf, writer->len)) {
+            printf("ERROR: Merge output NOT written (%s)!\n", strerror(errno));
+            writer->failed = true;
+        }
+        writer->bytes += writer->len;
+    }
+    writer->len = 0;
+}
+
+/**
+ * @brief writerPut function appends one record in the format of the writer
+ * @param writer is the writer
+ * @param record is the record
+ * @return void
+ */
+static void writerPut(mergeWriter_t *writer, const nmea_MergeRecord_t *record)
+{
+    if (writer->cap - writer->len < EMIT_MAX_RECORD_LEN + 24) {
+        writerFlush(writer);
+    }
+    char *out = writer->buf + writer->len;
+    if (writer->format == NMEA_MERGE_BINARY) {
+        memcpy(out, record, sizeof(*record));
+        writer->len += sizeof(*record);
+        return;
+    }
+    int prefix = snprintf(out, 24, "%u,%ld,", (unsigned) record->receiver, (long) record->day);
+    writer->len += (size_t) prefix;
+    writer->len += nmea_emit_packed(NMEA_EMIT_CSV, &record->fix, out + prefix, writer->cap - writer->len);
+}
+
+/**
+ * @brief readerFill function reads the next block of records of a run
+ * @param reader is the reader
+ * @return bool is false on a read error
+ */
+static bool readerFill(mergeReader_t *reader)
+{
+    uint64_t left = reader->run.count - reader->next;
+    size_t want = (left < reader->cap) ? (size_t) left : reader->cap;
+    size_t bytes = want * sizeof(nmea_MergeRecord_t);
+    off_t offset = (off_t) (reader->run.offset + reader->next * sizeof(nmea_MergeRecord_t));
+    size_t got = 0;
+    while (got < bytes) {
+        ssize_t n = pread(reader->run.fd, (char *) reader->buf + got, bytes - got, offset + (off_t) got);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            printf("ERROR: Spill file NOT read!\n");
+            return false;
+        }
+        got += (size_t) n;
+    }
+    reader->next += want;
+    reader->pos = 0;
+    reader->len = want;
+    reader->done = (want == 0);
+    return true;
+}
+
+/**
+ * @brief treeLess function orders two leaves of the loser tree, a finished run goes after every record and equal
+ * -records keep the order of the runs
+ * @param reader is the array of readers
+ * @param a is the first leaf
+ * @param b is the second leaf
+ * @return bool is true if a goes before b
+ */
+static inline bool treeLess(const mergeReader_t *reader, int a, int b)
+{
+    if (reader[a].done) return false;
+    if (reader[b].done) return true;
+    const nmea_MergeRecord_t *ra = &reader[a].buf[reader[a].pos];
+    const nmea_MergeRecord_t *rb = &reader[b].buf[reader[b].pos];
+    return recordLess(ra, rb) || (!recordLess(rb, ra) && a < b);
+}
+
+/**
+ * @brief buildTree function fills the loser tree below a node (leaves are the nodes k to 2k - 1)
+ * @param tree is the tree, tree[node] holds the loser of the node
+ * @param reader is the array of readers
+ * @param k is the number of leaves
+ * @param node is the node
+ * @return int is the winner of the node
+ */
+static int buildTree(int *tree, const mergeReader_t *reader, int k, int node)
+{
+    if (node >= k) {
+        return node - k;
+    }
+    int left = buildTree(tree, reader, k, 2 * node);
+    int right = buildTree(tree, reader, k, 2 * node + 1);
+    if (treeLess(reader, right, left)) {
+        tree[node] = left;
+        return right;
+    }
+    tree[node] = right;
+    return left;
+}
+
+/**
+ * @brief mergeRuns function merges some runs with a loser tree into a writer, every record costs log2(k) comparisons
+ * @param runs is the array of runs
+ * @param k is the number of runs
+ * @param reader is an array of k readers with buffers
+ * @param tree is an array of k nodes
+ * @param writer is the writer
+ * @return uint64_t is the number of records written (UINT64_MAX on a read error)
+ */
+static uint64_t mergeRuns(const mergeRun_t *runs, int k, mergeReader_t *reader, int *tree, mergeWriter_t *writer)
+{
+    for (int i = 0; i < k; i++) {
+        reader[i].run = runs[i];
+        reader[i].next = 0;
+        if (!readerFill(&reader[i])) {
+            return UINT64_MAX;
+        }
+    }
+    int winner = buildTree(tree, reader, k, 1);
+    uint64_t written = 0;
+    while (!reader[winner].done) {
+        mergeReader_t *r = &reader[winner];
+        writerPut(writer, &r->buf[r->pos]);
+        written++;
+        if (++r->pos == r->len && !readerFill(r)) {
+            return UINT64_MAX;
+        }
+        //Replay the path of the winner, the smaller of each loser and the climbing leaf continues upwards
+        for (int node = (winner + k) / 2; node >= 1; node /= 2) {
+            if (treeLess(reader, tree[node], winner)) {
+                int loser = winner;
+                winner = tree[node];
+                tree[node] = loser;
+            }
+        }
+    }
+    return written;
+}
+
+/**
+ * @brief nmea_merge_files function merges the fixes of the captures into one time-ordered output
+ * @param config is the configuration
+ * @param stats holds the statistics (can be NULL)
+ * @return bool is false if a file could not be read or written
+ */
+bool nmea_merge_files(const nmea_MergeConfig_t *config, nmea_MergeStats_t *stats)
+{
+    if (config->inputCount < 0 || config->inputCount > MERGE_MAX_INPUTS || config->output == NULL) {
+        printf("ERROR: Merge needs an output and at most %d inputs!\n", MERGE_MAX_INPUTS);
+        return false;
+    }
+    mergeJob_t job;
+    memset(&job, 0, sizeof(job));
+    job.config = config;
+    job.tmpDir = (config->tmpDir != NULL) ? config->tmpDir : "/tmp";
+    job.runRecords = (config->runRecords != 0) ? config->runRecords : MERGE_DEFAULT_RUN_RECORDS;
+    job.ioBuffer = (config->ioBuffer >= 4096) ? config->ioBuffer : MERGE_DEFAULT_IO_BUFFER;
+    int fanIn = (config->fanIn >= 2) ? config->fanIn : MERGE_DEFAULT_FAN_IN;
+    int threads = (config->threads > 0) ? config->threads : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > config->inputCount) threads = config->inputCount;
+    if (threads > MERGE_MAX_THREADS) threads = MERGE_MAX_THREADS;
+    if (threads < 1) threads = 1;
+    atomic_init(&job.nextInput, 0);
+    pthread_mutex_init(&job.lock, NULL);
+
+    int outFd = open(config->output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    mergeWorker_t *worker = calloc((size_t) threads, sizeof(mergeWorker_t));
+    char *refBuf = malloc(job.ioBuffer);
+    bool ok = (outFd >= 0 && worker != NULL && refBuf != NULL);
+    if (outFd < 0) {
+        printf("ERROR: Merge output %s NOT created (%s)!\n", config->output, strerror(errno));
+    }
+    else if (!ok) {
+        printf("ERROR: Memory NOT allocated!\n");
+    }
+
+    //Run generation: parse, key, sort and spill on every thread
+    uint64_t start = nmea_wall_us();
+    int started = 0;
+    if (ok) {
+        job.refMs = findReference(&job, refBuf);
+        for (; started < threads; started++) {
+            mergeWorker_t *w = &worker[started];
+            w->job = &job;
+            w->spillFd = openSpill(job.tmpDir);
+            w->records = malloc((size_t) job.runRecords * sizeof(nmea_MergeRecord_t));
+            w->tmp = malloc((size_t) job.runRecords * sizeof(nmea_MergeRecord_t));
+            w->readBuf = malloc(job.ioBuffer);
+            if (w->spillFd < 0 || w->records == NULL || w->tmp == NULL || w->readBuf == NULL
+                    || pthread_create(&w->thread, NULL, runThread, w) != 0) {
+                printf("ERROR: Run generation thread NOT created!\n");
+                free(w->records);
+                free(w->tmp);
+                free(w->readBuf);
+                if (w->spillFd >= 0) close(w->spillFd);
+                ok = false;
+                //Stops the started threads after their current capture
+                atomic_store(&job.nextInput, config->inputCount);
+                break;
+            }
+        }
+        for (int i = 0; i < started; i++) {
+            pthread_join(worker[i].thread, NULL);
+            free(worker[i].records);
+            free(worker[i].tmp);
+            free(worker[i].readBuf);
+        }
+        ok = ok && !job.failed;
+    }
+    job.stats.runUs = nmea_wall_us() - start;
+
+    //Merge passes: groups of fanIn runs in order, until the last pass writes the output
+    start = nmea_wall_us();
+    mergeReader_t *reader = calloc((size_t) fanIn, sizeof(mergeReader_t));
+    int *tree = calloc((size_t) fanIn, sizeof(int));
+    size_t readerCap = job.ioBuffer / sizeof(nmea_MergeRecord_t);
+    mergeWriter_t writer = { .fd = -1, .cap = job.ioBuffer };
+    writer.buf = malloc(writer.cap);
+    ok = ok && reader != NULL && tree != NULL && writer.buf != NULL;
+    for (int i = 0; ok && i < fanIn; i++) {
+        reader[i].cap = readerCap;
+        reader[i].buf = malloc(readerCap * sizeof(nmea_MergeRecord_t));
+        ok = (reader[i].buf != NULL);
+    }
+    int passFd = -1;
+    while (ok && job.runs.count > (size_t) fanIn) {
+        mergeRunList_t next = { 0 };
+        int fd = openSpill(job.tmpDir);
+        writer = (mergeWriter_t) { .fd = fd, .format = NMEA_MERGE_BINARY, .buf = writer.buf, .cap = writer.cap };
+        ok = (fd >= 0);
+        for (size_t first = 0; ok && first < job.runs.count; first += (size_t) fanIn) {
+            int k = (job.runs.count - first < (size_t) fanIn) ? (int) (job.runs.count - first) : fanIn;
+            mergeRun_t run = { fd, writer.bytes + writer.len, 0 };
+            run.count = mergeRuns(&job.runs.run[first], k, reader, tree, &writer);
+            ok = (run.count != UINT64_MAX) && addRun(&next, &run);
+        }
+        writerFlush(&writer);
+        ok = ok && !writer.failed;
+        job.stats.spilledBytes += writer.bytes;
+        job.stats.passes++;
+        //The runs of the previous pass are no longer needed, closing their files frees the disk space
+        if (passFd >= 0) close(passFd);
+        passFd = fd;
+        free(job.runs.run);
+        job.runs = next;
+    }
+    if (ok) {
+        writer = (mergeWriter_t) { .fd = outFd, .format = config->format, .buf = writer.buf, .cap = writer.cap };
+        if (config->format == NMEA_MERGE_CSV) {
+            writer.len = (size_t) snprintf(writer.buf, writer.cap, "receiver,day,");
+            writer.len += nmea_emit_csv_header(writer.buf + writer.len, writer.cap - writer.len);
+        }
+        uint64_t written = (job.runs.count != 0) ? mergeRuns(job.runs.run, (int) job.runs.count, reader, tree, &writer) : 0;
+        writerFlush(&writer);
+        ok = (written != UINT64_MAX) && !writer.failed;
+        job.stats.records = (written != UINT64_MAX) ? written : 0;
+        job.stats.bytesWritten = writer.bytes;
+        job.stats.passes++;
+    }
+    job.stats.mergeUs = nmea_wall_us() - start;
+
+    if (passFd >= 0) close(passFd);
+    for (int i = 0; i < started; i++) {
+        close(worker[i].spillFd);
+    }
+    for (int i = 0; reader != NULL && i < fanIn; i++) {
+        free(reader[i].buf);
+    }
+    free(reader);
+    free(tree);
+    free(writer.buf);
+    free(job.runs.run);
+    free(worker);
+    free(refBuf);
+    if (outFd >= 0) close(outFd);
+    pthread_mutex_destroy(&job.lock);
+    if (stats != NULL) {
+        *stats = job.stats;
+    }
+    return ok;
+}
+
+/**
+ * @brief nmea_merge_print function prints the merge statistics to console
+ * @param stats is the statistics
+ * @return void
+ */
+void nmea_merge_print(const nmea_MergeStats_t *stats)
+{
+    printf("MERGE BYTES READ--------------------> %llu\n", (unsigned long long) stats->bytesRead);
+    printf("MERGE SENTENCES/UNTIMED-------------> %llu/%llu\n", (unsigned long long) stats->sentences,
+           (unsigned long long) stats->untimed);
+    printf("MERGE DISCARDED BYTES---------------> %llu\n", (unsigned long long) stats->discardedBytes);
+    printf("MERGE MIDNIGHT ROLLOVERS------------> %llu\n", (unsigned long long) stats->rollovers);
+    printf("MERGE RUNS/PASSES-------------------> %llu/%lu\n", (unsigned long long) stats->runs,
+           (unsigned long) stats->passes);
+    printf("MERGE SPILLED BYTES-----------------> %llu\n", (unsigned long long) stats->spilledBytes);
+    printf("MERGE RECORDS/BYTES WRITTEN---------> %llu/%llu\n", (unsigned long long) stats->records,
+           (unsigned long long) stats->bytesWritten);
+    printf("MERGE RUN GENERATION/MERGE (us)-----> %llu/%llu\n", (unsigned long long) stats->runUs,
+           (unsigned long long) stats->mergeUs);
+}
+
+/**
+ * @brief nmea_merge_benchmark function writes the captures of some receivers around midnight (with noise and other
+ * -sentence types) into the temporary directory, merges them with a small memory budget so the runs are spilled and
+ * -merged in more passes, checks the order of the output and prints the statistics
+ * @param receivers is the number of captures
+ * @param fixes is the number of fixes per capture (10 Hz)
+ * @return void
+ */
+void nmea_merge_benchmark(int receivers, uint32_t fixes)
+{
+    static const char s_rmc[] = "GPRMC,235959.000,A,3342.6618,N,11751.3858,W,0.02,31.66,280511,,,A";
+    if (receivers < 1 || receivers > 64 || fixes == 0) {
+        printf("ERROR: Merge benchmark needs 1 to 64 receivers!\n");
+        return;
+    }
+    char (*path)[64] = calloc((size_t) receivers, sizeof(*path));
+    const char **inputs = calloc((size_t) receivers, sizeof(char *));
+    char *block = malloc(MERGE_DEFAULT_IO_BUFFER);
+    char rmc[sizeof(s_rmc) + 8];
+    int rmcLen = snprintf(rmc, sizeof(rmc), "$%s*%02X\r\n", s_rmc, nmea_checksum(s_rmc, sizeof(s_rmc) - 1));
+    if (path == NULL || inputs == NULL || block == NULL) {
+        printf("ERROR: Memory NOT allocated!\n");
+        free(path);
+        free(inputs);
+        free(block);
+        return;
+    }
+    //Every capture starts at its own time shortly before midnight and runs past it
+    uint32_t rng = 0x2545F491u;
+    uint64_t expected = 0;
+    nmea_PackedFix_t fix = { 0 };
+    fix.altitude = 2700;
+    fix.geoSep = -3420;
+    fix.qIndicator = 1;
+    fix.satTracked = 9;
+    fix.hdop = 120;
+    fix.emptyMask = 1u << NMEA_FIELD_TDGPS;
+    for (int r = 0; r < receivers; r++) {
+        snprintf(path[r], sizeof(path[r]), "/tmp/gga_merge_capture_%d.nmea", r);
+        inputs[r] = path[r];
+        int fd = open(path[r], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            printf("ERROR: Capture %s NOT created!\n", path[r]);
+            receivers = r;
+            break;
+        }
+        uint32_t startMs = DAY_MS - fixes * 50u - nmea_bench_random(&rng) % 5000u;
+        size_t len = 0;
+        for (uint32_t i = 0; i < fixes; i++) {
+            if (MERGE_DEFAULT_IO_BUFFER - len < 2 * ENCODE_MAX_SENTENCE_LEN + sizeof(rmc)) {
+                writeAll(fd, block, len);
+                len = 0;
+            }
+            fix.timeMs = (startMs + i * 100u) % DAY_MS;
+            fix.latitude = 20056618 + (int32_t) (nmea_bench_random(&rng) % 4096);
+            fix.longitude = -70313858 - (int32_t) (nmea_bench_random(&rng) % 4096);
+            char *line = block + len;
+            len += nmea_encode_packed(&fix, line, ENCODE_MAX_SENTENCE_LEN);
+            expected++;
+            if (nmea_bench_random(&rng) % 8 == 0) {
+                memcpy(block + len, rmc, (size_t) rmcLen);
+                len += (size_t) rmcLen;
+            }
+            //Every 64th sentence is corrupted and is lost
+            if (nmea_bench_random(&rng) % 64 == 0) {
+                line[10] ^= 0x01;
+                expected--;
+            }
+        }
+        writeAll(fd, block, len);
+        close(fd);
+    }
+    nmea_MergeConfig_t config = {
+        .inputs = inputs,
+        .inputCount = receivers,
+        .output = "/tmp/gga_merge_output.bin",
+        .format = NMEA_MERGE_BINARY,
+        .runRecords = 4096,
+        .ioBuffer = 65536,
+        .fanIn = 8
+    };
+    nmea_MergeStats_t stats;
+    bool ok = nmea_merge_files(&config, &stats);
+    printf("MERGE BENCHMARK: %d captures of %lu fixes\n", receivers, (unsigned long) fixes);
+    nmea_merge_print(&stats);
+    printf("MERGE THROUGHPUT--------------------> %.0f fixes/s\n",
+           (stats.runUs + stats.mergeUs != 0) ? (double) stats.records * 1e6 / (double) (stats.runUs + stats.mergeUs) : 0.0);
+    //Check the order of the output
+    uint64_t outOfOrder = 0;
+    uint64_t records = 0;
+    int fd = open(config.output, O_RDONLY);
+    if (fd >= 0) {
+        nmea_MergeRecord_t previous = { 0 };
+        size_t have = 0;
+        ssize_t n;
+        while ((n = read(fd, block + have, MERGE_DEFAULT_IO_BUFFER - have)) > 0) {
+            have += (size_t) n;
+            size_t used = 0;
+            for (; have - used >= sizeof(nmea_MergeRecord_t); used += sizeof(nmea_MergeRecord_t)) {
+                nmea_MergeRecord_t record;
+                memcpy(&record, block + used, sizeof(record));
+                if (records++ != 0 && recordLess(&record, &previous)) {
+                    outOfOrder++;
+                }
+                previous = record;
+            }
+            memmove(block, block + used, have - used);
+            have -= used;
+        }
+        close(fd);
+    }
+    if (!ok || records != expected || outOfOrder != 0) {
+        printf("ERROR: Merge benchmark output has %llu of %llu fixes, %llu out of order!\n", (unsigned long long) records,
+               (unsigned long long) expected, (unsigned long long) outOfOrder);
+    }
+    for (int r = 0; r < receivers; r++) {
+        unlink(path[r]);
+    }
+    unlink(config.output);
+    free(path);
+    free(inputs);
+    free(block);
+}
@@ -0,0 +1,104 @@
+/**
+ * @brief Time-ordered external merge of capture files into one parsed stream (Linux only).
+ * -Every input file is the capture of one receiver. A pool of threads frames the captures with the stream scanner
+ * -(gga_scan.h) and parses them with nmea_gga_parse_r. The fixes are keyed by their UTC time and the day count, which
+ * -follows the midnight rollovers of each capture, then sorted in runs which fit the memory budget and spilled to
+ * -unlinked temporary files as nmea_MergeRecord_t. The runs are k-way merged with a loser tree (in more passes when
+ * -there are more runs than the fan-in) into one globally time-ordered output of binary records or CSV rows.
+ * -Captures, spill files and output are read and written in large sequential blocks.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MERGE_DEFAULT_RUN_RECORDS 262144 //Default records sorted in memory per thread (44 bytes each, twice for the sort)
+#define MERGE_DEFAULT_IO_BUFFER 262144  //Default size of every read and write buffer in bytes
+#define MERGE_DEFAULT_FAN_IN 64         //Default number of runs merged at once
+#define MERGE_MAX_THREADS 32            //Maximum number of run generation threads
+#define MERGE_MAX_INPUTS 65535          //Maximum number of input files (receiver ids are 16 bit)
+
+/**
+ * @brief Output formats
+ */
+typedef enum {
+    NMEA_MERGE_BINARY = 0,              //nmea_MergeRecord_t records
+    NMEA_MERGE_CSV                      //"receiver,day," followed by the NMEA_EMIT_CSV columns, with a header line
+} nmea_MergeFormat_t;
+
+/**
+ * @brief Spilled and binary output record (44 bytes)
+ */
+typedef struct {
+    int32_t day;                        //days after the day of the first fix of the first input (midnight rollovers)
+    uint16_t receiver;                  //index of the input file
+    uint16_t reserved;
+    nmea_PackedFix_t fix;
+} nmea_MergeRecord_t;
+
+/**
+ * @brief Merge configuration, the 0/NULL members select the defaults
+ */
+typedef struct {
+    const char *const *inputs;          //capture files, one per receiver
+    int inputCount;
+    const char *output;                 //output file (created or truncated)
+    nmea_MergeFormat_t format;
+    const char *tmpDir;                 //directory of the spill files (NULL selects "/tmp")
+    int threads;                        //run generation threads (0 selects the online cores)
+    uint32_t runRecords;                //records sorted in memory per thread (0 selects MERGE_DEFAULT_RUN_RECORDS)
+    uint32_t ioBuffer;                  //bytes of every read and write buffer (0 selects MERGE_DEFAULT_IO_BUFFER)
+    int fanIn;                          //runs merged at once (0 selects MERGE_DEFAULT_FAN_IN)
+} nmea_MergeConfig_t;
+
+/**
+ * @brief Merge statistics
+ */
+typedef struct {
+    uint64_t bytesRead;                 //bytes of the captures
+    uint64_t sentences;                 //valid GGA sentences found by the scanner
+    uint64_t discardedBytes;            //capture bytes which are not part of a valid GGA sentence
+    uint64_t untimed;                   //fixes without a valid UTC time, they cannot be ordered and are left out
+    uint64_t records;                   //fixes written to the output
+    uint64_t rollovers;                 //midnight rollovers seen in the captures
+    uint64_t runs;                      //sorted runs spilled by the run generation
+    uint64_t spilledBytes;              //bytes written to the spill files (every pass)
+    uint64_t bytesWritten;              //bytes of the output
+    uint32_t passes;                    //merge passes, the last one writes the output
+    uint64_t runUs;                     //time of the run generation
+    uint64_t mergeUs;                   //time of the merge passes
+} nmea_MergeStats_t;
+
+/**
+ * @brief nmea_merge_files function merges the fixes of the captures into one time-ordered output
+ * @param config is the configuration
+ * @param stats holds the statistics (can be NULL)
+ * @return bool is false if a file could not be read or written
+ */
+bool nmea_merge_files(const nmea_MergeConfig_t* , nmea_MergeStats_t* );
+
+/**
+ * @brief nmea_merge_print function prints the merge statistics to console
+ * @param stats is the statistics
+ * @return void
+ */
+void nmea_merge_print(const nmea_MergeStats_t* );
+
+/**
+ * @brief nmea_merge_benchmark function writes the captures of some receivers around midnight (with noise and other
+ * -sentence types) into the temporary directory, merges them with a small memory budget so the runs are spilled and
+ * -merged in more passes, checks the order of the output and prints the statistics
+ * @param receivers is the number of captures
+ * @param fixes is the number of fixes per capture (10 Hz)
+ * @return void
+ */
+void nmea_merge_benchmark(int , uint32_t );
+
+#ifdef __cplusplus
+}
+#endif
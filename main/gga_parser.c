@@ -1,10 +1,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <assert.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "gga_parser.h"
+#include "gga_validate.h"
+
+#if defined(CONFIG_GGA_PARSER_IRAM) && !defined(__linux__)
+#include "esp_attr.h"
+#define PARSER_HOT IRAM_ATTR            //Hot parse functions in IRAM
+#define PARSER_HOT_DATA DRAM_ATTR       //Tables read by the hot functions in DRAM
+#else
+#define PARSER_HOT
+#define PARSER_HOT_DATA
+#endif
+
+#ifdef CONFIG_GGA_PARSER_PRINT
+#define PARSER_LOG(...) printf(__VA_ARGS__)
+#else
+#define PARSER_LOG(...) ((void) 0)
+#endif
 
 /**
  * @brief default_values of isEmpty status
@@ -49,14 +64,20 @@
 
 //Global declarations
 static nmea_Parsed_t s_parsedData      = DEFAULT_PARSED_DATA;
+static gpsData_isEmpty_t s_statusE     = DEFAULT_ISEMPTY_STATUS;
+static gpsData_isFalse_t s_statusF     = DEFAULT_ISFALSE_STATUS;
+#ifdef CONFIG_GGA_PARSER_PRINT
 static nmea_Parsed_t s_defaultCheck    = DEFAULT_PARSED_DATA;
+#endif
+#ifdef CONFIG_GGA_PARSER_GETTERS
 static gpsData_Time_t s_time           = DEFAULT_TIME;
 static gpsData_latitude_t s_latitude   = DEFAULT_LATITUDE;
 static gpsData_longitude_t s_longitude = DEFAULT_LONGITUDE;
 static gpsData_altitude_t s_altitude   = DEFAULT_ALTITUDE;
 static gpsData_GeoSep_t s_geosep       = DEFAULT_GEOSEP;
-static gpsData_isEmpty_t s_statusE     = DEFAULT_ISEMPTY_STATUS;
-static gpsData_isFalse_t s_statusF     = DEFAULT_ISFALSE_STATUS;
+#endif
+
+static int hexValue(char c);
 
 /**
  * @brief nmea_gga_validator function validates and check the input NMEA sentence by checking its integrity.
@@ -70,21 +91,26 @@ bool nmea_gga_validator(char *SENTENCE)
     }
     else {
         bool s_status = false;
-        char temp[strlen(SENTENCE) + 1];
-        char temp1[strlen(SENTENCE) + 1];
-        static int s_isValid = 0;
-        static int s_i = 0;
+        //Sentences longer than the static buffers are rejected before they are copied
+        if (strnlen(SENTENCE, CONFIG_GGA_PARSER_MAX_SENTENCE_LEN + 1) > CONFIG_GGA_PARSER_MAX_SENTENCE_LEN) {
+            PARSER_LOG("ERROR: Sentence is longer than %d charachters!\n", CONFIG_GGA_PARSER_MAX_SENTENCE_LEN);
+            return s_status;
+        }
+        char temp[CONFIG_GGA_PARSER_MAX_SENTENCE_LEN + 1];
+        char temp1[CONFIG_GGA_PARSER_MAX_SENTENCE_LEN + 1];
+        int isValid = 0;
+        int i = 0;
         static int s_hexValue;
         //Making a copy of the NMEA sentence to validate the data packet i.e., GGA
         strcpy(temp, SENTENCE);
         //Using the copy to store the string before the delimitor ',' into pointer to a charachter data_packet
         char *data_packet = strtok(temp, ",");
         //Validation of the sentence format by comparing the string pointed by data_packet with "$GPGGA"
-        if (!(strcmp(data_packet, "$GPGGA"))) {
-            printf("INFO: GGA packet confirmed.\n");
+        if (data_packet != NULL && !(strcmp(data_packet, "$GPGGA"))) {
+            PARSER_LOG("INFO: GGA packet confirmed.\n");
         }
         else {
-            printf("ERROR: Data packet is not GGA!\n");
+            PARSER_LOG("ERROR: Data packet is not GGA!\n");
             return s_status;
         }
         //Making a copy of the NMEA sentence to validate the integrity of the gps data
@@ -93,20 +119,23 @@ bool nmea_gga_validator(char *SENTENCE)
         strtok(temp1, "*");
         //storing checksum value at a location pointed by pointer to charachter checksum
         char *checksum = strtok(NULL, "\0");
-        //converting the checksum string into hexadecimal value for comparison purpose
-        sscanf(checksum, "%x", &s_hexValue);
+        //converting the leading hexadecimal charachters of the checksum string into its value for comparison purpose
+        s_hexValue = 0;
+        for (int j = 0; checksum != NULL && hexValue(checksum[j]) >= 0; j++) {
+            s_hexValue = (s_hexValue << 4) | hexValue(checksum[j]);
+        }
         //Ignoring the '$' charachter because it is not the part of the data integrity check
-        if (temp1[s_i] == '$') s_i++;
+        if (temp1[i] == '$') i++;
         //Calculating the bitwise XOR calculation algorithm from the NMEA-0183 documentation
-        while (temp1[s_i] != '*' && temp1[s_i] != '\0') {
+        while (temp1[i] != '*' && temp1[i] != '\0') {
         //XOR the next charachter with the XOR result of all the previous charachters
-        s_isValid ^= temp1[s_i];
+        isValid ^= temp1[i];
         //increment the index
-        s_i++;
+        i++;
         }
-        //Validity is checked by comparing the charachter represented by the accumulated XOR result 's_isValid' with
+        //Validity is checked by comparing the charachter represented by the accumulated XOR result 'isValid' with
         //the casted charachter representation of 's_hexValue'
-        if (s_isValid == (char) s_hexValue) {
+        if (isValid == (char) s_hexValue) {
             s_status = true;
         }
         else {
@@ -117,452 +146,712 @@ bool nmea_gga_validator(char *SENTENCE)
 }
 
 /**
- * @brief emptyFieldsHandler function introduces a special charachter (@) wherever there is an empty string.
- * @param The NMEA sentence is given to the function as the parameter through a pointer.
- * @return The return type is pointer to a charachter which gives the modified string with (@) in place of empty fields.
+ * @brief Charachter classes of the field validation table
  */
-char* emptyFieldsHandler(char* SENTENCE)
-{    
-    char *temp = malloc(strlen(SENTENCE) + MAX_DATA_FIELDS + 1); // Allocate memory for the modified string
-    
-    if (temp == NULL) {
-        printf("ERROR: Memory NOT allocated!\n");
-        assert(temp == NULL);
-    }
-    
-    strcpy(temp, SENTENCE);
-    int j = 0; // Index for the modified string
-    //Here in this loop a modified string is being created by inserting a special charachter to indicate empty strings.
-    for (int i = 0; i < strlen(SENTENCE); i++) {
-        temp[j++] = SENTENCE[i]; // Copy current character to temp
-        
-        if (SENTENCE[i] == ',' && (SENTENCE[i+1] == ',' || SENTENCE[i+1] == '*')) {
-            temp[j++] = '@'; // Insert '@' character
+#define CC_DIGIT 0x01                   //'0' to '9'
+#define CC_DOT 0x02                     //'.'
+#define CC_SIGN 0x04                    //'-'
+#define CC_NS 0x08                      //'N' or 'S'
+#define CC_EW 0x10                      //'E' or 'W'
+#define CC_UNIT 0x20                    //'M'
+
+/**
+ * @brief 256-entry charachter class lookup table, every other charachter has no class (0)
+ */
+static const uint8_t PARSER_HOT_DATA s_charClass[256] = {
+    ['0'] = CC_DIGIT, ['1'] = CC_DIGIT, ['2'] = CC_DIGIT, ['3'] = CC_DIGIT, ['4'] = CC_DIGIT,
+    ['5'] = CC_DIGIT, ['6'] = CC_DIGIT, ['7'] = CC_DIGIT, ['8'] = CC_DIGIT, ['9'] = CC_DIGIT,
+    ['.'] = CC_DOT, ['-'] = CC_SIGN, ['N'] = CC_NS, ['S'] = CC_NS, ['E'] = CC_EW, ['W'] = CC_EW, ['M'] = CC_UNIT
+};
+
+/**
+ * @brief Validation rule of one field
+ */
+typedef struct {
+    uint8_t allowed;                    //allowed charachter classes
+    uint8_t minLen;                     //minimum length
+    uint8_t maxLen;                     //maximum length
+    int8_t decPntPos;                   //required decimal point position, -1 if there is no fixed position
+    int64_t minVal;                     //range of the digits read as one integer (decimal point ignored)
+    int64_t maxVal;
+} fieldRule_t;
+
+#define NUM_FIELD_MAX_LEN (MAX_ARR_LEN_INDV_FIELDS - 1)  //Maximum length of the free length numeric fields
+#define NO_LIMIT_MIN (-999999999999999LL)
+#define NO_LIMIT_MAX 999999999999999LL
+
+/**
+ * @brief Validation table of the GGA data fields in the order of the sentence (nmea_Field_t)
+ */
+static const fieldRule_t PARSER_HOT_DATA s_rules[NMEA_FIELD_COUNT] = {
+    [NMEA_FIELD_TIME]          = { CC_DIGIT | CC_DOT, TIME_DEC_PNT_POS + 1, TIME_FIELD_LEN + 1, TIME_DEC_PNT_POS, 0, NO_LIMIT_MAX },
+    [NMEA_FIELD_LATITUDE]      = { CC_DIGIT | CC_DOT, LAT_DEC_PNT_POS + 1, LAT_FIELD_LEN + 1, LAT_DEC_PNT_POS, 0, NO_LIMIT_MAX },
+    [NMEA_FIELD_LATITUDE_IND]  = { CC_NS, 1, 1, -1, 0, 0 },
+    [NMEA_FIELD_LONGITUDE]     = { CC_DIGIT | CC_DOT, LON_DEC_PNT_POS + 1, LON_FIELD_LEN + 1, LON_DEC_PNT_POS, 0, NO_LIMIT_MAX },
+    [NMEA_FIELD_LONGITUDE_IND] = { CC_EW, 1, 1, -1, 0, 0 },
+    [NMEA_FIELD_QIND]          = { CC_DIGIT, QI_FIELD_LEN, QI_FIELD_LEN, -1, MIN_QI_VAL, MAX_QI_VAL },
+    [NMEA_FIELD_SATELLITE]     = { CC_DIGIT, 1, SAT_FIELD_LEN, -1, MIN_SAT_VAL, MAX_SAT_VAL },
+    [NMEA_FIELD_HDOP]          = { CC_DIGIT | CC_DOT, 1, NUM_FIELD_MAX_LEN, -1, 1, NO_LIMIT_MAX },
+    [NMEA_FIELD_ALTITUDE]      = { CC_DIGIT | CC_DOT | CC_SIGN, 1, NUM_FIELD_MAX_LEN, -1, NO_LIMIT_MIN, NO_LIMIT_MAX },
+    [NMEA_FIELD_ALTITUDE_IND]  = { CC_UNIT, 1, 1, -1, 0, 0 },
+    [NMEA_FIELD_GEOSEP]        = { CC_DIGIT | CC_DOT | CC_SIGN, 1, NUM_FIELD_MAX_LEN, -1, NO_LIMIT_MIN, NO_LIMIT_MAX },
+    [NMEA_FIELD_GEOSEP_IND]    = { CC_UNIT, 1, 1, -1, 0, 0 },
+    [NMEA_FIELD_TDGPS]         = { CC_DIGIT | CC_DOT, 1, NUM_FIELD_MAX_LEN, -1, 0, NO_LIMIT_MAX },
+    [NMEA_FIELD_DRSID]         = { CC_DIGIT, DRS_ID_ARR_LEN - 1, DRS_ID_ARR_LEN - 1, -1, 0, 1023 }
+};
+
+#ifdef CONFIG_GGA_PARSER_CONVERSION_SINGLE
+typedef float parseReal_t;              //The digits are scaled as integers, one single precision division gives the value
+static const float PARSER_HOT_DATA s_pow10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f, 1e11f, 1e12f, 1e13f, 1e14f, 1e15f};
+#else
+typedef double parseReal_t;
+static const double PARSER_HOT_DATA s_pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+#endif
+static const int64_t PARSER_HOT_DATA s_pow10i[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000LL,
+                                                   10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+                                                   100000000000000LL, 1000000000000000LL};
+
+/**
+ * @brief State of one field after the validation table
+ */
+typedef enum {
+    FIELD_OK = 0,
+    FIELD_EMPTY,
+    FIELD_FALSE
+} fieldState_t;
+
+/**
+ * @brief Digits of a correct field
+ */
+typedef struct {
+    int64_t mantissa;                   //digits read as one integer (decimal point ignored)
+    int decimals;                       //digits after the decimal point
+    bool negative;
+} fieldDigits_t;
+
+/**
+ * @brief hexValue function converts a hexadecimal charachter into its value
+ * @param c is the charachter to convert
+ * @return int is the value (0-15) or -1 if the charachter is not hexadecimal
+ */
+static int PARSER_HOT hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * @brief digitsValue function converts a run of decimal digits into an integer
+ * @param str is the pointer to the first digit
+ * @param len is the number of digits
+ * @return int is the value or -1 if a non digit charachter is found
+ */
+static int digitsValue(const char *str, size_t len)
+{
+    int value = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (str[i] < '0' || str[i] > '9') {
+            return -1;
         }
+        value = value * 10 + (str[i] - '0');
     }
-    temp[j] = '\0'; // Null charachter for end of the modified string
-    return temp;    // returning the pointer to the modified string, the memory allocated to this pointer will be freed in the calling function
+    return value;
 }
 
 /**
- * @brief Parse_gps_data function parses the validated string into readable information such as longitude, latitude, time etc.
- * @param NMEA_SENTENCE is given to the function as the input parameter.
- * @return The return type of the function is nmea_Parsed_t type which will provide the parsed data.
+ * @brief splitFields function checks the "$GPGGA," prefix and the checksum and splits the 14 data fields
+ * @param SENTENCE is the sentence (the trailing "\r\n" is optional)
+ * @param len is the length of the sentence
+ * @param field holds the slices of the data fields
+ * @return bool is true if the sentence is a GGA sentence with a valid checksum and 14 data fields
  */
-
-nmea_Parsed_t Parse_gps_data(char *SENTENCE)
+static bool PARSER_HOT splitFields(const char *SENTENCE, size_t len, nmea_FieldSlice_t field[NMEA_FIELD_COUNT])
 {
-    
-    //Validate the GGA string.
-    if (nmea_gga_validator(SENTENCE) == false) {
-        printf("ERROR: Data is not valid!\n");
-        static nmea_Parsed_t s_pData = DEFAULT_PARSED_DATA;
-        s_parsedData = s_pData;
-        return s_parsedData;
+    //Line endings are not the part of the sentence
+    while (len > 0 && (SENTENCE[len - 1] == '\n' || SENTENCE[len - 1] == '\r')) {
+        len--;
+    }
+    //The sentence must start with "$GPGGA," and must end with "*h" or "*hh"
+    const char *star = (len > 0) ? memchr(SENTENCE, '*', len) : NULL;
+    size_t hexLen = (star != NULL) ? (size_t) (SENTENCE + len - star - 1) : 0;
+    if (star == NULL || hexLen < 1 || hexLen > 2 || len < 7 || memcmp(SENTENCE, "$GPGGA,", 7) != 0) {
+        return false;
     }
-    //Handle empty fields.
-    char *data = emptyFieldsHandler(SENTENCE);
-    char temp[strlen(data) + 1];
-    char temp1[MAX_ARR_LEN_INDV_FIELDS];
-    //Making a copy of the NMEA sentence for parsing
-    strcpy(temp, data);
-    //Free the allocated memory as it is no longer needed.
-    free(data);
-    //Data splitting using "*" as a delimitor to seperate the checksum value
-    strcpy(temp, strtok(temp, "*"));
-    //Eliminating the packet format indicator '$GPGGA' from the string to parse the data
-    strtok(temp, ",");
-    //String (temp) with the unparsed GPS-data
-    strcpy(temp, strtok(NULL, "\0"));
-    //UTC-time raw string Parsing
-    strcpy(temp1, strtok(temp, ","));
-    static int s_temp = 0;
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_time = true;
+    //Checksum i.e., the bitwise XOR of all the charachters between '$' and '*'
+    int checksum = 0;
+    for (const char *p = SENTENCE + 1; p < star; p++) {
+        checksum ^= (unsigned char) *p;
     }
-    else {
-        s_temp = 0;
-        //Loop to make sure the formatting is correct.
-        for (int i = 0; i <= TIME_FIELD_LEN; i++ ) {
-            //Making sure only the allowed charchters are present in the string.
-            if ((temp1[i] >= '0' && temp1[i] <= '9') || temp1[i] == '.') {
-                s_temp++;
-            }
-            else {
-                break;
-            }
-        }
-        //Comparing the s_temp variable with the utc string length to ensure the string is of valid length i.e, 10.
-        if (s_temp == strlen(temp1) && temp1[TIME_DEC_PNT_POS] == '.') {
-            //parsing
-            char tempParse[TIME_FIELD_LEN];
-            s_parsedData.gpsData_time.hour = atoi(strncpy(tempParse, temp1, TIME_HOUR_STR_LEN));
-            s_parsedData.gpsData_time.minutes = atoi(strncpy(tempParse, temp1 + TIME_HOUR_STR_LEN, TIME_MIN_STR_LEN));
-            s_parsedData.gpsData_time.seconds = atof(strncpy(tempParse, temp1 + TIME_HOUR_STR_LEN + TIME_MIN_STR_LEN, TIME_SEC_STR_LEN));
-        }
-        else {
-            s_statusF.isFalse_time = true;
+    int expected = 0;
+    for (size_t i = 0; i < hexLen; i++) {
+        int nibble = hexValue(star[1 + i]);
+        if (nibble < 0) {
+            return false;
         }
+        expected = (expected << 4) | nibble;
     }
-    //Latitude raw string parsing and validation
-    strcpy(temp1, strtok(NULL, ","));
-    s_temp = 0;
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_latitude = true;
+    if (checksum != expected) {
+        return false;
     }
-    else {
-        s_temp = 0;
-        //Loop to make sure the formatting is correct.
-        for (int i = 0; i <= LAT_FIELD_LEN; i++ ) {
-            //Making sure only the allowed charchters are present in the string.
-            if ((temp1[i] >= '0' && temp1[i] <= '9') || temp1[i] == '.') {
-                s_temp++;
-            }
-            else {
-                break;
-            }
+    //Splitting the data fields, a GGA sentence must have exactly 14 of them
+    const char *p = SENTENCE + 7;
+    int count = 0;
+    while (count < NMEA_FIELD_COUNT) {
+        const char *end = memchr(p, ',', (size_t) (star - p));
+        if (end == NULL) end = star;
+        field[count].ptr = p;
+        field[count].len = (size_t) (end - p);
+        count++;
+        if (end == star) break;
+        p = end + 1;
+    }
+    return count == NMEA_FIELD_COUNT && field[count - 1].ptr + field[count - 1].len == star;
+}
+
+/**
+ * @brief checkField function checks one field against its rule of the validation table and collects its digits
+ * @param i is the field (nmea_Field_t)
+ * @param field is the slice of the field
+ * @param digits holds the digits of a correct field
+ * @return fieldState_t is the state of the field
+ */
+static fieldState_t PARSER_HOT checkField(int i, const nmea_FieldSlice_t *field, fieldDigits_t *digits)
+{
+    const fieldRule_t *rule = &s_rules[i];
+    const char *str = field->ptr;
+    size_t len = field->len;
+    if (len == 0) {
+        return FIELD_EMPTY;
+    }
+    if (len < rule->minLen || len > rule->maxLen) {
+        return FIELD_FALSE;
+    }
+    //One pass collects the classes, the digits as one integer and the decimal point/sign positions
+    uint8_t classes = 0;
+    int64_t mantissa = 0;
+    int dots = 0;
+    int decimals = 0;
+    int dotPos = -1;
+    int signs = 0;
+    int unknown = 0;
+    for (size_t j = 0; j < len; j++) {
+        uint8_t cc = s_charClass[(uint8_t) str[j]];
+        classes |= cc;
+        unknown += (cc == 0);
+        if (cc == CC_DIGIT) {
+            mantissa = mantissa * 10 + (str[j] - '0');
+            decimals += (dots != 0);
         }
-        //Comparing the s_temp variable with the latitude string length to ensure the string is of valid length i.e, 9.
-        if (s_temp == strlen(temp1) && temp1[LAT_DEC_PNT_POS] == '.') {
-            //parsing
-            char tempParse[LAT_FIELD_LEN] = "0";
-            s_parsedData.gpsData_position.LATITUDE.latDeg = atoi(strncpy(tempParse, temp1, LAT_DEG_LEN));
-            s_parsedData.gpsData_position.LATITUDE.latMin = atof(strncpy(tempParse, temp1 + LAT_DEG_LEN, strlen(temp1) - LAT_DEG_LEN));
+        dots += (cc == CC_DOT);
+        dotPos = (cc == CC_DOT) ? (int) j : dotPos;
+        signs += (cc == CC_SIGN);
+    }
+    bool ok = unknown == 0 && !(classes & ~rule->allowed) && dots <= 1 && (rule->decPntPos < 0 || dotPos == rule->decPntPos)
+            && (signs == 0 || (signs == 1 && str[0] == '-'));
+    if (rule->allowed & CC_DIGIT) {
+        ok = ok && (classes & CC_DIGIT) && mantissa >= rule->minVal && mantissa <= rule->maxVal;
+    }
+    if (!ok) {
+        return FIELD_FALSE;
+    }
+    digits->mantissa = mantissa;
+    digits->decimals = decimals;
+    digits->negative = (signs != 0);
+    return FIELD_OK;
+}
+
+/**
+ * @brief interpretFields function validates the data fields with the validation table and stores the correct ones.
+ * -The empty/incorrect status is only ever set (never cleared) and incorrect fields keep their previous value.
+ * @param field is the slices of the data fields
+ * @param fieldMask is the bit of every field to interpret (nmea_Field_t), the other fields are not read
+ * @param data is updated with the correct fields
+ * @param isEmpty is updated with the empty status
+ * @param isFalse is updated with the incorrect status
+ * @return void
+ */
+static void PARSER_HOT interpretFields(const nmea_FieldSlice_t field[NMEA_FIELD_COUNT], uint16_t fieldMask, nmea_Parsed_t *data, gpsData_isEmpty_t *isEmpty, gpsData_isFalse_t *isFalse)
+{
+    bool *const emptyStatus[NMEA_FIELD_COUNT] = {
+        &isEmpty->isEmpty_time, &isEmpty->isEmpty_latitude, &isEmpty->isEmpty_latitudeInd, &isEmpty->isEmpty_longitude,
+        &isEmpty->isEmpty_longitudeInd, &isEmpty->isEmpty_qInd, &isEmpty->isEmpty_satellite, &isEmpty->isEmpty_hdop,
+        &isEmpty->isEmpty_altitude, &isEmpty->isEmpty_altitudeInd, &isEmpty->isEmpty_geoSep, &isEmpty->isEmpty_geoSepInd,
+        &isEmpty->isEmpty_tDgps, &isEmpty->isEmpty_drsID
+    };
+    bool *const falseStatus[NMEA_FIELD_COUNT] = {
+        &isFalse->isFalse_time, &isFalse->isFalse_latitude, &isFalse->isFalse_latitudeInd, &isFalse->isFalse_longitude,
+        &isFalse->isFalse_longitudeInd, &isFalse->isFalse_qInd, &isFalse->isFalse_satellite, &isFalse->isFalse_hdop,
+        &isFalse->isFalse_altitude, &isFalse->isFalse_altitudeInd, &isFalse->isFalse_geoSep, &isFalse->isFalse_geoSepInd,
+        &isFalse->isFalse_tDgps, &isFalse->isFalse_drsID
+    };
+    for (int i = 0; i < NMEA_FIELD_COUNT; i++) {
+        if (!(fieldMask & (1u << i))) {
+            continue;
         }
-        else {
-            s_statusF.isFalse_latitude = true;
+        const char *str = field[i].ptr;
+        fieldDigits_t digits;
+        fieldState_t state = checkField(i, &field[i], &digits);
+        if (state == FIELD_EMPTY) {
+            *emptyStatus[i] = true;
+            continue;
         }
-    }
-    //Latitude-indicator (N/S) string validation
-    strcpy(temp1, strtok(NULL, ","));
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_latitudeInd = true;
-    }
-    else if ((temp1[0] == 'N' || temp1[0] == 'S') && strlen(temp1) == 1) {
-        //Store in the relevant struct variable
-        strncpy(s_parsedData.gpsData_position.LATITUDE.latInd, temp1, 1);
-    }
-    else {
-        //Error when indicator is invalid.
-        s_statusF.isFalse_latitudeInd = true;
-        printf("ERROR: Invalid Latitude indicator! \n");
-    }
-    //Longitude raw string parsing and validation
-    strcpy(temp1, strtok(NULL, ","));
-    s_temp = 0;
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_longitude = true;
-    }
-    else {
-        s_temp = 0;
-        //Loop to make sure the formatting is correct.
-        for (int i = 0; i <= LON_FIELD_LEN; i++ ) {
-            //Making sure only the allowed charchters are present in the string.
-            if ((temp1[i] >= '0' && temp1[i] <= '9') || temp1[i] == '.') {
-                s_temp++;
-            }
-            else {
-                break;
-            }
+        if (state == FIELD_FALSE) {
+            *falseStatus[i] = true;
+            continue;
         }
-        //Comparing the s_temp variable with the longitude string length to ensure the string is of valid length i.e, 10.
-        if (s_temp == strlen(temp1) && temp1[LON_DEC_PNT_POS] == '.') {
-            //parsing
-            char tempParse[LON_FIELD_LEN] = "0";
-            s_parsedData.gpsData_position.LONGITUDE.longDeg = atoi(strncpy(tempParse, temp1, LON_DEG_LEN));
-            s_parsedData.gpsData_position.LONGITUDE.longMin = atof(strncpy(tempParse, temp1 + LON_DEG_LEN, strlen(temp1) - LON_DEG_LEN));
-        }
-        else {
-            s_statusF.isFalse_longitude = true;
+        int64_t mantissa = digits.mantissa;
+        int decimals = digits.decimals;
+        parseReal_t value = (parseReal_t) mantissa / s_pow10[decimals];
+        value = digits.negative ? -value : value;
+        switch (i) {
+        case NMEA_FIELD_TIME: {
+            //hhmmss.sss, hours and minutes are the digits in front of the two seconds digits
+            int64_t secondsScale = 100 * s_pow10i[decimals];
+            int64_t hhmm = mantissa / secondsScale;
+            data->gpsData_time.hour = (int) (hhmm / 100);
+            data->gpsData_time.minutes = (int) (hhmm % 100);
+            data->gpsData_time.seconds = (parseReal_t) (mantissa % secondsScale) / s_pow10[decimals];
+            break;
         }
-    }
-    //Longitude-indicator (E/W) string validation.
-    strcpy(temp1, strtok(NULL, ","));
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_longitudeInd = true;
-    }
-    else if ((temp1[0] == 'W' || temp1[0] == 'E') && strlen(temp1) == 1) {
-        //Store in the relevant struct variable
-        strncpy(s_parsedData.gpsData_position.LONGITUDE.longInd, temp1, 1);
-    }
-    else {
-        //Error when indicator is invalid.
-        s_statusF.isFalse_longitudeInd = true;
-        printf("ERROR: Invalid Laongitude indicator! \n");
-    }
-    //GPS quality indicator
-    strcpy(temp1, strtok(NULL, ","));
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_qInd = true;
-    }
-    else if ((atoi(temp1) >= MIN_QI_VAL && atoi(temp1) <= MAX_QI_VAL) && strlen(temp1) == QI_FIELD_LEN) {
-        //Store in the relevant struct variable
-        s_parsedData.gpsData_qIndicator = atoi(temp1);
-    }
-    else {
-        //Error when indicator is invalid.
-        s_statusF.isFalse_qInd = true;
-    }
-    //Sattelites tracked for gps-data transmission
-    strcpy(temp1, strtok(NULL, ","));
-    s_temp = 0;
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_satellite = true;
-    }
-    else {
-        s_temp = 0;
-        //Loop to make sure the formatting is correct.
-        for (int i = 0; i <= SAT_FIELD_LEN; i++ ) {
-            //Making sure only the allowed charchters are present in the string. Also that maximum number of
-            //satellites can be 12 Reference: NMEA-0183 documentation.
-            if ((temp1[i] >= '0' && temp1[i] <= '9') && strlen(temp1) <= SAT_FIELD_LEN && (atoi(temp1) >= MIN_SAT_VAL && atoi(temp1) <= MAX_SAT_VAL)) {
-                s_temp++;
-            }
-            else {
+        case NMEA_FIELD_LATITUDE:
+        case NMEA_FIELD_LONGITUDE: {
+            //(d)ddmm.mmmm, the minutes are the last two integer digits with the decimals
+            int64_t minutesScale = 100 * s_pow10i[decimals];
+            int64_t minutes = mantissa % minutesScale;
+            if (minutes >= 60 * s_pow10i[decimals]) {
+                *falseStatus[i] = true;
                 break;
             }
-        }
-        //Comparing the s_temp variable with the satellite data string length to ensure the string is of valid length.
-        if (s_temp == strlen(temp1)) {
-            //Store in the relevant struct variable
-            s_parsedData.gpsData_satTracked = atoi(temp1);
-        }
-        else {
-            s_statusF.isFalse_satellite = true;
-        }
-    }
-    //HDOP data
-    strcpy(temp1, strtok(NULL, ","));
-    s_temp = 0;
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_hdop = true;
-    }
-    else {
-        s_temp = 0;
-        //Loop to make sure the formatting is correct.
-        for (int i = 0; i <= strlen(temp1); i++ ) {
-            //Making sure only the allowed charchters are present in the string.
-            if ((temp1[i] >= '0' && temp1[i] <= '9' && atof(temp1) > 0.00) || temp1[i] == '.' ) {
-                s_temp++;
+            if (i == NMEA_FIELD_LATITUDE) {
+                data->gpsData_position.LATITUDE.latDeg = (int) (mantissa / minutesScale);
+                data->gpsData_position.LATITUDE.latMin = (float) ((parseReal_t) minutes / s_pow10[decimals]);
             }
             else {
-                break;
+                data->gpsData_position.LONGITUDE.longDeg = (int) (mantissa / minutesScale);
+                data->gpsData_position.LONGITUDE.longMin = (float) ((parseReal_t) minutes / s_pow10[decimals]);
             }
+            break;
         }
-        //Comparing the s_temp variable with the HDOP string length to ensure the string is of valid length.
-        if (s_temp == strlen(temp1)) {
-            //Store in the relevant struct variable
-            s_parsedData.gpsData_hdop = atof(temp1);
-        }
-        else {
-            s_statusF.isFalse_hdop = true;
+        case NMEA_FIELD_LATITUDE_IND:   data->gpsData_position.LATITUDE.latInd[0] = str[0]; break;
+        case NMEA_FIELD_LONGITUDE_IND:  data->gpsData_position.LONGITUDE.longInd[0] = str[0]; break;
+        case NMEA_FIELD_QIND:           data->gpsData_qIndicator = (int) mantissa; break;
+        case NMEA_FIELD_SATELLITE:      data->gpsData_satTracked = (int) mantissa; break;
+        case NMEA_FIELD_HDOP:           data->gpsData_hdop = (float) value; break;
+        case NMEA_FIELD_ALTITUDE:       data->gpsData_position.ALTITUDE.alt = (float) value; break;
+        case NMEA_FIELD_ALTITUDE_IND:   data->gpsData_position.ALTITUDE.altInd[0] = str[0]; break;
+        case NMEA_FIELD_GEOSEP:         data->gpsData_gS.gpsData_geoSep = (float) value; break;
+        case NMEA_FIELD_GEOSEP_IND:     data->gpsData_gS.gpsData_geoSepInd[0] = str[0]; break;
+        case NMEA_FIELD_TDGPS:          data->gpsData_tDgps = (float) value; break;
+        case NMEA_FIELD_DRSID:
+            memcpy(data->gpsData_drsID, str, DRS_ID_ARR_LEN - 1);
+            data->gpsData_drsID[DRS_ID_ARR_LEN - 1] = '\0';
+            break;
+        default:
+            break;
         }
     }
-    //Altitude string parsing
-    strcpy(temp1, strtok(NULL, ","));
-    s_temp = 0;
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_altitude = true;
+}
+
+/**
+ * @brief Parse_gps_data function parses the validated string into readable information such as longitude, latitude, time etc.
+ * @param NMEA_SENTENCE is given to the function as the input parameter.
+ * @return The return type of the function is nmea_Parsed_t type which will provide the parsed data.
+ */
+
+nmea_Parsed_t Parse_gps_data(char *SENTENCE)
+{
+    nmea_FieldSlice_t field[NMEA_FIELD_COUNT];
+    //Validate the GGA string and split the data fields.
+    if (nmea_gga_validator(SENTENCE) == false || !splitFields(SENTENCE, strnlen(SENTENCE, CONFIG_GGA_PARSER_MAX_SENTENCE_LEN), field)) {
+        PARSER_LOG("ERROR: Data is not valid!\n");
+        static nmea_Parsed_t s_pData = DEFAULT_PARSED_DATA;
+        s_parsedData = s_pData;
+        return s_parsedData;
     }
-    else {
-        s_temp = 0;
-        //Parsing and validation of Altitude field
-        if (temp1[0] == '-') {
-            for (int i = 0; i <= strlen(temp1) - 1; i++) {
-                temp1[i] = temp1[i + 1];
-            }
-            temp1[strlen(temp1)] = '\0';
-            for (int i = 0; i <= strlen(temp1); i++ ) {
-            //Making sure only the allowed charchters are present in the string.
-            if ((temp1[i] >= '0' && temp1[i] <= '9' && atof(temp1) >= 0.00) || temp1[i] == '.' ) {
-                s_temp++;
-            }
-            else {
-                break;
-            }
-            }
-            //Comparing the s_temp variable with the Altitude string length to ensure the string is of valid length.
-            if (s_temp == strlen(temp1)) {
-                //Store in the relevant struct variable
-                s_parsedData.gpsData_position.ALTITUDE.alt = -1 * atof(temp1);
-            }
-            else {
-                s_statusF.isFalse_altitude = true;
-            }
-        }
-        else {
-            for (int i = 0; i <= strlen(temp1); i++ ) {
-                //Making sure only the allowed charchters are present in the string.
-                if ((temp1[i] >= '0' && temp1[i] <= '9' && atof(temp1) >= 0.00) || temp1[i] == '.' ) {
-                    s_temp++;
-                }
-                else {
-                    break;
-                }
-            }
-            //Comparing the s_temp variable with the Altitude string length to ensure the string is of valid length.
-            if (s_temp == strlen(temp1)) {
-                //Store in the relevant struct variable
-                s_parsedData.gpsData_position.ALTITUDE.alt = atof(temp1);
-            }
-            else {
-                s_statusF.isFalse_altitude = true;
-            }
-        }
+    //Validation and parsing of all the fields through the validation table, the indicator errors are logged from the
+    //status of this sentence only, the console status keeps its flags until the getters clear them
+    gpsData_isFalse_t statusF = DEFAULT_ISFALSE_STATUS;
+    interpretFields(field, NMEA_ALL_FIELDS, &s_parsedData, &s_statusE, &statusF);
+    if (statusF.isFalse_latitudeInd) {
+        PARSER_LOG("ERROR: Invalid Latitude indicator! \n");
     }
-    //Altitude units (meter/M)
-    strcpy(temp1, strtok(NULL, ","));
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_altitudeInd = true;
+    if (statusF.isFalse_longitudeInd) {
+        PARSER_LOG("ERROR: Invalid Laongitude indicator! \n");
     }
-    else if ((temp1[0] == 'M') && strlen(temp1) == 1) {
-        //Store in the relevant struct variable
-            strcpy(s_parsedData.gpsData_position.ALTITUDE.altInd, temp1);
+    if (statusF.isFalse_altitudeInd) {
+        PARSER_LOG("ERROR: Invalid Altitude unit! \n");
     }
-    else {
-        //Error when indicator is invalid.
-        s_statusF.isFalse_altitudeInd = true;
-        printf("ERROR: Invalid Altitude unit! \n");
+    if (statusF.isFalse_geoSepInd) {
+        PARSER_LOG("ERROR: Invalid geoid height indicator!\n");
     }
-    //Height of geoid string parsing
-    strcpy(temp1, strtok(NULL, ","));
-    s_temp = 0;
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_geoSep = true;
+    //gpsData_isFalse_t holds bools only
+    const bool *flag = (const bool *) &statusF;
+    bool *sticky = (bool *) &s_statusF;
+    for (size_t i = 0; i < sizeof(statusF) / sizeof(bool); i++) {
+        sticky[i] = sticky[i] || flag[i];
     }
-    else {
-        s_temp = 0;
-        //Parsing and validation of Geoid Separation field
-        if (temp1[0] == '-') {
-            for (int i = 0; i <= strlen(temp1) - 1; i++) {
-                temp1[i] = temp1[i + 1];
-            }
-            temp1[strlen(temp1)] = '\0';
-            for (int i = 0; i <= strlen(temp1); i++ ) {
-                //Making sure only the allowed charchters are present in the string.
-                if ((temp1[i] >= '0' && temp1[i] <= '9') || temp1[i] == '.') {
-                    s_temp++;
-                }
-                else {
-                    break;
-                }
-            }
-            //Comparing the s_temp variable with the geoid height string length to ensure the string is of valid length.
-            if (s_temp == strlen(temp1)) {
-                //Store in the relevant struct variable
-                s_parsedData.gpsData_gS.gpsData_geoSep = -1 * atof(temp1);
-            }
-            else {
-                s_statusF.isFalse_geoSep = true;
-            }
-        }
-        else {
-            for (int i = 0; i <= strlen(temp1); i++ ) {
-            //Making sure only the allowed charchters are present in the string.
-            if ((temp1[i] >= '0' && temp1[i] <= '9') || temp1[i] == '.') {
-                s_temp++;
-            }
-            else {
-                break;
-            }
-        }
-        //Comparing the s_temp variable with the geoid height string length to ensure the string is of valid length.
-        if (s_temp == strlen(temp1)) {
-            //Store in the relevant struct variable
-            s_parsedData.gpsData_gS.gpsData_geoSep = atof(temp1);
-        }
-        else {
-            s_statusF.isFalse_geoSep = true;
-        }
-        }
-        
+    return s_parsedData;
+}
+
+/**
+ * @brief nmea_gga_reset function sets a parse result to the default values with no empty or incorrect field
+ * @param result is the parse result
+ * @return void
+ */
+void PARSER_HOT nmea_gga_reset(nmea_ParseResult_t *result)
+{
+    static const nmea_Parsed_t PARSER_HOT_DATA s_default = DEFAULT_PARSED_DATA;
+    static const gpsData_isEmpty_t PARSER_HOT_DATA s_emptyStatus = DEFAULT_ISEMPTY_STATUS;
+    static const gpsData_isFalse_t PARSER_HOT_DATA s_falseStatus = DEFAULT_ISFALSE_STATUS;
+    result->data = s_default;
+    result->isEmpty = s_emptyStatus;
+    result->isFalse = s_falseStatus;
+}
+
+/**
+ * @brief nmea_gga_split function checks the "$GPGGA," prefix and the checksum and splits the 14 data fields
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param field holds the NMEA_FIELD_COUNT slices of the data fields (valid as long as the sentence is)
+ * @return bool is true if the sentence is a GGA sentence with a valid checksum and 14 data fields
+ */
+bool PARSER_HOT nmea_gga_split(const char *SENTENCE, size_t len, nmea_FieldSlice_t *field)
+{
+    return splitFields(SENTENCE, len, field);
+}
+
+/**
+ * @brief nmea_gga_decode function validates and stores only the selected data fields of a split sentence
+ * @param field is the slices from nmea_gga_split
+ * @param fieldMask is the bit of every field to decode (nmea_Field_t), the other fields are not read
+ * @param result is updated with the decoded fields and their isEmpty/isFalse status (reset it first)
+ * @return void
+ */
+void PARSER_HOT nmea_gga_decode(const nmea_FieldSlice_t *field, uint16_t fieldMask, nmea_ParseResult_t *result)
+{
+    interpretFields(field, fieldMask, &result->data, &result->isEmpty, &result->isFalse);
+    //Same time ranges as checkTime
+    gpsData_Time_t *time = &result->data.gpsData_time;
+    if ((fieldMask & (1u << NMEA_FIELD_TIME)) && !result->isEmpty.isEmpty_time && !result->isFalse.isFalse_time
+            && (time->hour > 24 || time->minutes >= 60 || time->seconds >= 60.0)) {
+        static const gpsData_Time_t PARSER_HOT_DATA s_defaultTime = DEFAULT_TIME;
+        result->isFalse.isFalse_time = true;
+        *time = s_defaultTime;
     }
-    //Geoid height units (meter/M)
-    strcpy(temp1, strtok(NULL, ","));
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_geoSepInd = true;
+}
+
+/**
+ * @brief nmea_gga_parse_r function is the reentrant version of Parse_gps_data.
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param result is filled with the parsed data and the isEmpty/isFalse status of every field
+ * @return true if the sentence is a GGA sentence with a valid checksum (the fields can still be empty or incorrect)
+ */
+bool PARSER_HOT nmea_gga_parse_r(const char *SENTENCE, size_t len, nmea_ParseResult_t *result)
+{
+    nmea_FieldSlice_t field[NMEA_FIELD_COUNT];
+    nmea_gga_reset(result);
+    if (!splitFields(SENTENCE, len, field)) {
+        result->isFalse.isFalse_gga = true;
+        return false;
     }
-    else if ((temp1[0] == 'M') && strlen(temp1) == 1) {
-        //Store in the relevant struct variable
-        strcpy(s_parsedData.gpsData_gS.gpsData_geoSepInd, temp1);
+    nmea_gga_decode(field, NMEA_ALL_FIELDS, result);
+    return true;
+}
+
+/**
+ * @brief nmea_gga_parse_bounded function is the deterministic version of nmea_gga_parse_r for hard deadlines.
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param result is filled with the parsed data and the isEmpty/isFalse status of every field
+ * @return true if the sentence is a GGA sentence of at most 82 charachters with "\r\n" (80 without) and a valid checksum
+ */
+bool nmea_gga_parse_bounded(const char *SENTENCE, size_t len, nmea_ParseResult_t *result)
+{
+    //The length rule of nmea_validate_line, it reads no charachter of longer input and at most two line-end
+    //charachters, after that splitFields reads at most NMEA_MAX_SENTENCE_LEN charachters and interpretFields at most
+    //MAX_ARR_LEN_INDV_FIELDS - 1 per field
+    if (nmea_sentence_overlong(SENTENCE, len)) {
+        nmea_gga_reset(result);
+        result->isFalse.isFalse_gga = true;
+        return false;
     }
-    else {
-        //Error when indicator is invalid.
-        s_statusF.isFalse_geoSepInd = true;
-        printf("ERROR: Invalid geoid height indicator!\n");
+    return nmea_gga_parse_r(SENTENCE, len, result);
+}
+
+/**
+ * @brief scaleDigits function rounds the digits of a field to a number of decimals (half away from zero)
+ * @param mantissa is the digits read as one integer
+ * @param decimals is the number of digits after the decimal point
+ * @param target is the number of decimals of the result
+ * @return int64_t is the value in 1/10^target units
+ */
+static inline int64_t PARSER_HOT scaleDigits(int64_t mantissa, int decimals, int target)
+{
+    if (decimals <= target) {
+        return mantissa * s_pow10i[target - decimals];
     }
-    //Time since last DGPS update string validation
-    strcpy(temp1, strtok(NULL, ","));
-    s_temp = 0;
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_tDgps = true;
+    int64_t divisor = s_pow10i[decimals - target];
+    return (mantissa + divisor / 2) / divisor;
+}
+
+/**
+ * @brief fixedMinutes function converts the digits of a (d)ddmm.mmmm field into 1/10000 of a minute
+ * @param digits is the digits of the field
+ * @param value holds the value
+ * @return bool is false if the minutes are out of range
+ */
+static bool PARSER_HOT fixedMinutes(const fieldDigits_t *digits, int32_t *value)
+{
+    int64_t minutesScale = 100 * s_pow10i[digits->decimals];
+    int64_t minutes = digits->mantissa % minutesScale;
+    if (minutes >= 60 * s_pow10i[digits->decimals]) {
+        return false;
     }
-    else {
-        s_temp = 0;
-        //Loop to make sure the formatting is correct.
-        for (int i = 0; i <= strlen(temp1); i++ ) {
-            //Making sure only the allowed charchters are present in the string.
-            if ((temp1[i] >= '0' && temp1[i] <= '9' && atof(temp1) >= 0.00) || temp1[i] == '.' ) {
-                s_temp++;
-            }
-            else {
-                break;
-            }
-        }
-        //Comparing the s_temp variable with the Time since last DGPS update string length to ensure the string is of valid length.
-        if (s_temp == strlen(temp1)) {
-            //Store in the relevant struct variable
-            s_parsedData.gpsData_tDgps = atof(temp1);
+    *value = (int32_t) (digits->mantissa / minutesScale * 600000 + scaleDigits(minutes, digits->decimals, 4));
+    return true;
+}
+
+/**
+ * @brief nmea_gga_parse_fixed function parses a sentence straight into the packed fixed-point record with integer
+ * -arithmetic only
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param fix holds the packed record
+ * @return true if the sentence is a GGA sentence with a valid checksum (the fields can still be empty or incorrect)
+ */
+bool PARSER_HOT nmea_gga_parse_fixed(const char *SENTENCE, size_t len, nmea_PackedFix_t *fix)
+{
+    nmea_FieldSlice_t field[NMEA_FIELD_COUNT];
+    fieldDigits_t digits[NMEA_FIELD_COUNT];
+    memset(fix, 0, sizeof(*fix));
+    if (!splitFields(SENTENCE, len, field)) {
+        fix->falseMask = NMEA_ALL_FIELDS;
+        return false;
+    }
+    for (int i = 0; i < NMEA_FIELD_COUNT; i++) {
+        fieldState_t state = checkField(i, &field[i], &digits[i]);
+        fix->emptyMask |= (uint16_t) ((state == FIELD_EMPTY) << i);
+        fix->falseMask |= (uint16_t) ((state == FIELD_FALSE) << i);
+    }
+    //Same ranges as nmea_gga_decode and nmea_pack_fix, a value which does not fit is marked incorrect
+    uint16_t bad = fix->emptyMask | fix->falseMask;
+    if (!(bad & (1u << NMEA_FIELD_TIME))) {
+        const fieldDigits_t *d = &digits[NMEA_FIELD_TIME];
+        int64_t secondsScale = 100 * s_pow10i[d->decimals];
+        int64_t hhmm = d->mantissa / secondsScale;
+        int64_t seconds = d->mantissa % secondsScale;
+        if (hhmm / 100 > 24 || hhmm % 100 >= 60 || seconds >= 60 * s_pow10i[d->decimals]) {
+            fix->falseMask |= 1u << NMEA_FIELD_TIME;
         }
         else {
-            s_statusF.isFalse_tDgps = true;
+            fix->timeMs = (uint32_t) ((hhmm / 100 * 60 + hhmm % 100) * 60000 + scaleDigits(seconds, d->decimals, 3));
         }
     }
-    //Differential reference station ID data string
-    strcpy(temp1, strtok(NULL, "\0"));
-    s_temp = 0;
-    if (temp1[0] == '@') {
-        //Setting the empty status true
-        s_statusE.isEmpty_drsID = true;
+    if (!(bad & (1u << NMEA_FIELD_LATITUDE))) {
+        if (!fixedMinutes(&digits[NMEA_FIELD_LATITUDE], &fix->latitude)) {
+            fix->falseMask |= 1u << NMEA_FIELD_LATITUDE;
+        }
+        else if (!(bad & (1u << NMEA_FIELD_LATITUDE_IND)) && field[NMEA_FIELD_LATITUDE_IND].ptr[0] == 'S') {
+            fix->latitude = -fix->latitude;
+        }
     }
-    else {
-        s_temp = 0;
-        //Loop to make sure the formatting is correct.
-        for (int i = 0; i <= 4; i++ ) {
-            //Making sure only the allowed charchters are present in the string. Also that maximum number of
-            //differential reference station IDs can be 1023 Reference: NMEA-0183 documentation.
-            if ((temp1[i] >= '0' && temp1[i] <= '9') && strlen(temp1) == 4 && (atoi(temp1) >= 0 && atoi(temp1) <= 1023)) {
-                s_temp++;
-            }
-            else {
-                break;
-            }
+    if (!(bad & (1u << NMEA_FIELD_LONGITUDE))) {
+        if (!fixedMinutes(&digits[NMEA_FIELD_LONGITUDE], &fix->longitude)) {
+            fix->falseMask |= 1u << NMEA_FIELD_LONGITUDE;
         }
-        //Comparing the s_temp variable with the differential reference station ID string length to ensure the string is of valid length.
-        if (s_temp == strlen(temp1)) {
-            //Store in the relevant struct variable
-            strcpy(s_parsedData.gpsData_drsID, temp1);
+        else if (!(bad & (1u << NMEA_FIELD_LONGITUDE_IND)) && field[NMEA_FIELD_LONGITUDE_IND].ptr[0] == 'W') {
+            fix->longitude = -fix->longitude;
         }
-        else {
-            s_statusF.isFalse_drsID = true;
+    }
+    if (!(bad & (1u << NMEA_FIELD_QIND))) fix->qIndicator = (uint8_t) digits[NMEA_FIELD_QIND].mantissa;
+    if (!(bad & (1u << NMEA_FIELD_SATELLITE))) fix->satTracked = (uint8_t) digits[NMEA_FIELD_SATELLITE].mantissa;
+    if (!(bad & (1u << NMEA_FIELD_HDOP))) {
+        int64_t hdop = scaleDigits(digits[NMEA_FIELD_HDOP].mantissa, digits[NMEA_FIELD_HDOP].decimals, 2);
+        if (hdop < UINT16_MAX) fix->hdop = (uint16_t) hdop;
+        else fix->falseMask |= 1u << NMEA_FIELD_HDOP;
+    }
+    if (!(bad & (1u << NMEA_FIELD_ALTITUDE))) {
+        const fieldDigits_t *d = &digits[NMEA_FIELD_ALTITUDE];
+        int64_t alt = scaleDigits(d->mantissa, d->decimals, 2);
+        if (alt < INT32_MAX) fix->altitude = (int32_t) (d->negative ? -alt : alt);
+        else fix->falseMask |= 1u << NMEA_FIELD_ALTITUDE;
+    }
+    if (!(bad & (1u << NMEA_FIELD_GEOSEP))) {
+        const fieldDigits_t *d = &digits[NMEA_FIELD_GEOSEP];
+        int64_t geoSep = scaleDigits(d->mantissa, d->decimals, 2);
+        if (geoSep < INT32_MAX) fix->geoSep = (int32_t) (d->negative ? -geoSep : geoSep);
+        else fix->falseMask |= 1u << NMEA_FIELD_GEOSEP;
+    }
+    if (!(bad & (1u << NMEA_FIELD_TDGPS))) {
+        int64_t tDgps = scaleDigits(digits[NMEA_FIELD_TDGPS].mantissa, digits[NMEA_FIELD_TDGPS].decimals, 2);
+        if (tDgps < INT32_MAX) fix->tDgps = (uint32_t) tDgps;
+        else fix->falseMask |= 1u << NMEA_FIELD_TDGPS;
+    }
+    if (!(bad & (1u << NMEA_FIELD_DRSID))) fix->drsID = (uint16_t) digits[NMEA_FIELD_DRSID].mantissa;
+    return true;
+}
+
+/**
+ * @brief roundToInt function rounds a value to the nearest integer (half away from zero)
+ * @param value is the value to round
+ * @return int32_t is the rounded value
+ */
+static int32_t roundToInt(double value)
+{
+    return (int32_t) ((value < 0.0) ? value - 0.5 : value + 0.5);
+}
+
+/**
+ * @brief nmea_pack_fix function converts a parse result into the packed fixed-point record
+ * @param result is the parse result
+ * @param fix holds the packed record
+ * @return void
+ */
+void nmea_pack_fix(const nmea_ParseResult_t *result, nmea_PackedFix_t *fix)
+{
+    const nmea_Parsed_t *data = &result->data;
+    const gpsData_isEmpty_t *e = &result->isEmpty;
+    const gpsData_isFalse_t *f = &result->isFalse;
+    memset(fix, 0, sizeof(*fix));
+    fix->emptyMask = (uint16_t) (e->isEmpty_time << NMEA_FIELD_TIME | e->isEmpty_latitude << NMEA_FIELD_LATITUDE
+                   | e->isEmpty_latitudeInd << NMEA_FIELD_LATITUDE_IND | e->isEmpty_longitude << NMEA_FIELD_LONGITUDE
+                   | e->isEmpty_longitudeInd << NMEA_FIELD_LONGITUDE_IND | e->isEmpty_qInd << NMEA_FIELD_QIND
+                   | e->isEmpty_satellite << NMEA_FIELD_SATELLITE | e->isEmpty_hdop << NMEA_FIELD_HDOP
+                   | e->isEmpty_altitude << NMEA_FIELD_ALTITUDE | e->isEmpty_altitudeInd << NMEA_FIELD_ALTITUDE_IND
+                   | e->isEmpty_geoSep << NMEA_FIELD_GEOSEP | e->isEmpty_geoSepInd << NMEA_FIELD_GEOSEP_IND
+                   | e->isEmpty_tDgps << NMEA_FIELD_TDGPS | e->isEmpty_drsID << NMEA_FIELD_DRSID);
+    fix->falseMask = (uint16_t) (f->isFalse_time << NMEA_FIELD_TIME | f->isFalse_latitude << NMEA_FIELD_LATITUDE
+                   | f->isFalse_latitudeInd << NMEA_FIELD_LATITUDE_IND | f->isFalse_longitude << NMEA_FIELD_LONGITUDE
+                   | f->isFalse_longitudeInd << NMEA_FIELD_LONGITUDE_IND | f->isFalse_qInd << NMEA_FIELD_QIND
+                   | f->isFalse_satellite << NMEA_FIELD_SATELLITE | f->isFalse_hdop << NMEA_FIELD_HDOP
+                   | f->isFalse_altitude << NMEA_FIELD_ALTITUDE | f->isFalse_altitudeInd << NMEA_FIELD_ALTITUDE_IND
+                   | f->isFalse_geoSep << NMEA_FIELD_GEOSEP | f->isFalse_geoSepInd << NMEA_FIELD_GEOSEP_IND
+                   | f->isFalse_tDgps << NMEA_FIELD_TDGPS | f->isFalse_drsID << NMEA_FIELD_DRSID);
+    //A sentence which is not GGA has no usable field at all
+    if (f->isFalse_gga) {
+        fix->falseMask = (1u << NMEA_FIELD_COUNT) - 1;
+        return;
+    }
+    uint16_t bad = fix->emptyMask | fix->falseMask;
+    if (!(bad & (1u << NMEA_FIELD_TIME))) {
+        fix->timeMs = (uint32_t) ((data->gpsData_time.hour * 60 + data->gpsData_time.minutes) * 60000) + (uint32_t) roundToInt(data->gpsData_time.seconds * 1000.0);
+    }
+    if (!(bad & (1u << NMEA_FIELD_LATITUDE))) {
+        fix->latitude = data->gpsData_position.LATITUDE.latDeg * 600000 + roundToInt(data->gpsData_position.LATITUDE.latMin * 10000.0);
+        if (!(bad & (1u << NMEA_FIELD_LATITUDE_IND)) && data->gpsData_position.LATITUDE.latInd[0] == 'S') fix->latitude = -fix->latitude;
+    }
+    if (!(bad & (1u << NMEA_FIELD_LONGITUDE))) {
+        fix->longitude = data->gpsData_position.LONGITUDE.longDeg * 600000 + roundToInt(data->gpsData_position.LONGITUDE.longMin * 10000.0);
+        if (!(bad & (1u << NMEA_FIELD_LONGITUDE_IND)) && data->gpsData_position.LONGITUDE.longInd[0] == 'W') fix->longitude = -fix->longitude;
+    }
+    if (!(bad & (1u << NMEA_FIELD_QIND))) fix->qIndicator = (uint8_t) data->gpsData_qIndicator;
+    if (!(bad & (1u << NMEA_FIELD_SATELLITE))) fix->satTracked = (uint8_t) data->gpsData_satTracked;
+    //Values which do not fit in the packed field are marked incorrect instead of wrapping around
+    if (!(bad & (1u << NMEA_FIELD_HDOP))) {
+        if (data->gpsData_hdop * 100.0 < UINT16_MAX) fix->hdop = (uint16_t) roundToInt(data->gpsData_hdop * 100.0);
+        else fix->falseMask |= 1u << NMEA_FIELD_HDOP;
+    }
+    if (!(bad & (1u << NMEA_FIELD_ALTITUDE))) {
+        if (data->gpsData_position.ALTITUDE.alt * 100.0 > INT32_MIN && data->gpsData_position.ALTITUDE.alt * 100.0 < INT32_MAX) fix->altitude = roundToInt(data->gpsData_position.ALTITUDE.alt * 100.0);
+        else fix->falseMask |= 1u << NMEA_FIELD_ALTITUDE;
+    }
+    if (!(bad & (1u << NMEA_FIELD_GEOSEP))) {
+        if (data->gpsData_gS.gpsData_geoSep * 100.0 > INT32_MIN && data->gpsData_gS.gpsData_geoSep * 100.0 < INT32_MAX) fix->geoSep = roundToInt(data->gpsData_gS.gpsData_geoSep * 100.0);
+        else fix->falseMask |= 1u << NMEA_FIELD_GEOSEP;
+    }
+    if (!(bad & (1u << NMEA_FIELD_TDGPS))) {
+        if (data->gpsData_tDgps * 100.0 < INT32_MAX) fix->tDgps = (uint32_t) roundToInt(data->gpsData_tDgps * 100.0);
+        else fix->falseMask |= 1u << NMEA_FIELD_TDGPS;
+    }
+    if (!(bad & (1u << NMEA_FIELD_DRSID))) fix->drsID = (uint16_t) digitsValue(data->gpsData_drsID, DRS_ID_ARR_LEN - 1);
+}
+
+/**
+ * @brief nmea_unpack_fix function converts a packed record back into a parse result
+ * @param fix is the packed record
+ * @param result holds the parse result (default values for the empty and incorrect fields)
+ * @return void
+ */
+void nmea_unpack_fix(const nmea_PackedFix_t *fix, nmea_ParseResult_t *result)
+{
+    static const nmea_Parsed_t s_default = DEFAULT_PARSED_DATA;
+    nmea_Parsed_t *data = &result->data;
+    gpsData_isEmpty_t *e = &result->isEmpty;
+    gpsData_isFalse_t *f = &result->isFalse;
+    uint16_t bad = fix->emptyMask | fix->falseMask;
+    *data = s_default;
+    e->isEmpty_time = fix->emptyMask >> NMEA_FIELD_TIME & 1;
+    e->isEmpty_latitude = fix->emptyMask >> NMEA_FIELD_LATITUDE & 1;
+    e->isEmpty_latitudeInd = fix->emptyMask >> NMEA_FIELD_LATITUDE_IND & 1;
+    e->isEmpty_longitude = fix->emptyMask >> NMEA_FIELD_LONGITUDE & 1;
+    e->isEmpty_longitudeInd = fix->emptyMask >> NMEA_FIELD_LONGITUDE_IND & 1;
+    e->isEmpty_altitude = fix->emptyMask >> NMEA_FIELD_ALTITUDE & 1;
+    e->isEmpty_altitudeInd = fix->emptyMask >> NMEA_FIELD_ALTITUDE_IND & 1;
+    e->isEmpty_qInd = fix->emptyMask >> NMEA_FIELD_QIND & 1;
+    e->isEmpty_satellite = fix->emptyMask >> NMEA_FIELD_SATELLITE & 1;
+    e->isEmpty_hdop = fix->emptyMask >> NMEA_FIELD_HDOP & 1;
+    e->isEmpty_geoSep = fix->emptyMask >> NMEA_FIELD_GEOSEP & 1;
+    e->isEmpty_geoSepInd = fix->emptyMask >> NMEA_FIELD_GEOSEP_IND & 1;
+    e->isEmpty_tDgps = fix->emptyMask >> NMEA_FIELD_TDGPS & 1;
+    e->isEmpty_drsID = fix->emptyMask >> NMEA_FIELD_DRSID & 1;
+    f->isFalse_gga = fix->falseMask == (1u << NMEA_FIELD_COUNT) - 1;
+    f->isFalse_time = fix->falseMask >> NMEA_FIELD_TIME & 1;
+    f->isFalse_latitude = fix->falseMask >> NMEA_FIELD_LATITUDE & 1;
+    f->isFalse_latitudeInd = fix->falseMask >> NMEA_FIELD_LATITUDE_IND & 1;
+    f->isFalse_longitude = fix->falseMask >> NMEA_FIELD_LONGITUDE & 1;
+    f->isFalse_longitudeInd = fix->falseMask >> NMEA_FIELD_LONGITUDE_IND & 1;
+    f->isFalse_altitude = fix->falseMask >> NMEA_FIELD_ALTITUDE & 1;
+    f->isFalse_altitudeInd = fix->falseMask >> NMEA_FIELD_ALTITUDE_IND & 1;
+    f->isFalse_qInd = fix->falseMask >> NMEA_FIELD_QIND & 1;
+    f->isFalse_satellite = fix->falseMask >> NMEA_FIELD_SATELLITE & 1;
+    f->isFalse_hdop = fix->falseMask >> NMEA_FIELD_HDOP & 1;
+    f->isFalse_geoSep = fix->falseMask >> NMEA_FIELD_GEOSEP & 1;
+    f->isFalse_geoSepInd = fix->falseMask >> NMEA_FIELD_GEOSEP_IND & 1;
+    f->isFalse_tDgps = fix->falseMask >> NMEA_FIELD_TDGPS & 1;
+    f->isFalse_drsID = fix->falseMask >> NMEA_FIELD_DRSID & 1;
+    if (!(bad & (1u << NMEA_FIELD_TIME))) {
+        data->gpsData_time.hour = (int) (fix->timeMs / 3600000u);
+        data->gpsData_time.minutes = (int) (fix->timeMs / 60000u % 60u);
+        data->gpsData_time.seconds = (double) (fix->timeMs % 60000u) / 1000.0;
+    }
+    if (!(bad & (1u << NMEA_FIELD_LATITUDE))) {
+        int32_t lat = (fix->latitude < 0) ? -fix->latitude : fix->latitude;
+        data->gpsData_position.LATITUDE.latDeg = (int) (lat / 600000);
+        data->gpsData_position.LATITUDE.latMin = (float) ((double) (lat % 600000) / 10000.0);
+    }
+    if (!(bad & (1u << NMEA_FIELD_LATITUDE_IND))) {
+        data->gpsData_position.LATITUDE.latInd[0] = (fix->latitude < 0) ? 'S' : 'N';
+    }
+    if (!(bad & (1u << NMEA_FIELD_LONGITUDE))) {
+        int32_t lon = (fix->longitude < 0) ? -fix->longitude : fix->longitude;
+        data->gpsData_position.LONGITUDE.longDeg = (int) (lon / 600000);
+        data->gpsData_position.LONGITUDE.longMin = (float) ((double) (lon % 600000) / 10000.0);
+    }
+    if (!(bad & (1u << NMEA_FIELD_LONGITUDE_IND))) {
+        data->gpsData_position.LONGITUDE.longInd[0] = (fix->longitude < 0) ? 'W' : 'E';
+    }
+    if (!(bad & (1u << NMEA_FIELD_QIND))) data->gpsData_qIndicator = fix->qIndicator;
+    if (!(bad & (1u << NMEA_FIELD_SATELLITE))) data->gpsData_satTracked = fix->satTracked;
+    if (!(bad & (1u << NMEA_FIELD_HDOP))) data->gpsData_hdop = (float) (fix->hdop / 100.0);
+    if (!(bad & (1u << NMEA_FIELD_ALTITUDE))) data->gpsData_position.ALTITUDE.alt = (float) (fix->altitude / 100.0);
+    if (!(bad & (1u << NMEA_FIELD_ALTITUDE_IND))) data->gpsData_position.ALTITUDE.altInd[0] = 'M';
+    if (!(bad & (1u << NMEA_FIELD_GEOSEP))) data->gpsData_gS.gpsData_geoSep = (float) (fix->geoSep / 100.0);
+    if (!(bad & (1u << NMEA_FIELD_GEOSEP_IND))) data->gpsData_gS.gpsData_geoSepInd[0] = 'M';
+    if (!(bad & (1u << NMEA_FIELD_TDGPS))) data->gpsData_tDgps = (float) (fix->tDgps / 100.0);
+    if (!(bad & (1u << NMEA_FIELD_DRSID))) {
+        unsigned drs = fix->drsID;
+        for (int i = DRS_ID_ARR_LEN - 2; i >= 0; i--) {
+            data->gpsData_drsID[i] = (char) ('0' + drs % 10);
+            drs /= 10;
         }
+        data->gpsData_drsID[DRS_ID_ARR_LEN - 1] = '\0';
     }
-    return s_parsedData;
 }
 
+#ifdef CONFIG_GGA_PARSER_PRINT
 /**
  * @brief checks the time format based on indvidual values of hr, min, and sec
  * @param void
@@ -698,6 +987,7 @@ void printParsedData (nmea_Parsed_t p_data)
     }
 }
 
+#ifdef CONFIG_GGA_PARSER_GETTERS
 /**
  * @brief getTime function prints the UTC-TIME to console and gives the hour, minute and second values to the user
  * @param NMEA_SENTENCE is given as the parameter
@@ -918,4 +1208,6 @@ void getDrs(char* SENTENCE, char* buffer)
         printf("DIFFERENTIAL REFERENCE STATION ID---> %s\n", getdrsID.gpsData_drsID);
         strcpy(buffer, getdrsID.gpsData_drsID); // Copy drsID value to buffer
     }
-}
\ No newline at end of file
+}
+#endif
+#endif
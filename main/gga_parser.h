@@ -5,10 +5,26 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+//Defaults when the sdkconfig options are not available (host builds outside of ESP-IDF): the full profile
+#ifndef CONFIG_GGA_PARSER_MAX_SENTENCE_LEN
+#define CONFIG_GGA_PARSER_MAX_SENTENCE_LEN 128
+#define CONFIG_GGA_PARSER_PRINT 1
+#define CONFIG_GGA_PARSER_GETTERS 1
+#define CONFIG_GGA_PARSER_CONVERSION_FLOAT 1
+#endif
+
 #define IND_ARR_LEN 2                   //indicator array length
 #define MAX_DATA_FIELDS 15              //Maximum number of data fields in GGA sentence
 #define MAX_ARR_LEN_INDV_FIELDS 15      //Maximum length set for indvidual fields (null charachter included) (min. val = 10)
@@ -144,6 +160,65 @@ typedef struct {
     bool isFalse_drsID;
 }gpsData_isFalse_t;
 
+/**
+ * @brief Parsed data along with its own isEmpty and isFalse status, used by the reentrant parser
+ */
+typedef struct {
+    nmea_Parsed_t data;
+    gpsData_isEmpty_t isEmpty;
+    gpsData_isFalse_t isFalse;
+} nmea_ParseResult_t;
+
+/**
+ * @brief Data fields of the GGA sentence in the order of the sentence, used as bit positions in the field masks
+ */
+typedef enum {
+    NMEA_FIELD_TIME = 0,
+    NMEA_FIELD_LATITUDE,
+    NMEA_FIELD_LATITUDE_IND,
+    NMEA_FIELD_LONGITUDE,
+    NMEA_FIELD_LONGITUDE_IND,
+    NMEA_FIELD_QIND,
+    NMEA_FIELD_SATELLITE,
+    NMEA_FIELD_HDOP,
+    NMEA_FIELD_ALTITUDE,
+    NMEA_FIELD_ALTITUDE_IND,
+    NMEA_FIELD_GEOSEP,
+    NMEA_FIELD_GEOSEP_IND,
+    NMEA_FIELD_TDGPS,
+    NMEA_FIELD_DRSID,
+    NMEA_FIELD_COUNT
+} nmea_Field_t;
+
+#define NMEA_ALL_FIELDS ((uint16_t) ((1u << NMEA_FIELD_COUNT) - 1))   //Field mask with every data field
+
+/**
+ * @brief Slice of one data field inside the sentence (not null terminated)
+ */
+typedef struct {
+    const char *ptr;
+    size_t len;
+} nmea_FieldSlice_t;
+
+/**
+ * @brief Packed fixed-point fix record (36 bytes) for storage and transport, field bits are nmea_Field_t values
+ */
+typedef struct {
+    uint32_t timeMs;                    //UTC time of the day in milliseconds
+    int32_t latitude;                   //latitude in 1/10000 of a minute, negative in the south
+    int32_t longitude;                  //longitude in 1/10000 of a minute, negative in the west
+    int32_t altitude;                   //altitude in centimetres
+    int32_t geoSep;                     //geoidal separation in centimetres
+    uint32_t tDgps;                     //time of last DGPS update in 1/100 of a second
+    uint16_t hdop;                      //HDOP in 1/100
+    uint16_t drsID;                     //differential reference station ID
+    uint16_t emptyMask;                 //bit set for every empty field
+    uint16_t falseMask;                 //bit set for every incorrect field
+    uint8_t qIndicator;                 //GPS quality indicator
+    uint8_t satTracked;                 //satellites tracked
+    uint8_t reserved[2];
+} nmea_PackedFix_t;
+
 /**
  * @brief default_values upon Incorrect data for time
  */
@@ -217,12 +292,102 @@ typedef struct {
  */
 nmea_Parsed_t Parse_gps_data(char* );
 
+/**
+ * @brief nmea_gga_parse_r is the reentrant version of Parse_gps_data, it keeps no global state, does not allocate and
+ * -does not print, so it can be called from several tasks/threads at the same time.
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param result is filled with the parsed data and the isEmpty/isFalse status of every field
+ * @return true if the sentence is a GGA sentence with a valid checksum (the fields can still be empty or incorrect)
+ */
+bool nmea_gga_parse_r(const char* , size_t , nmea_ParseResult_t* );
+
+/**
+ * @brief nmea_gga_reset function sets a parse result to the default values with no empty or incorrect field
+ * @param result is the parse result
+ * @return void
+ */
+void nmea_gga_reset(nmea_ParseResult_t* );
+
+/**
+ * @brief nmea_gga_split function checks the "$GPGGA," prefix and the checksum and splits the 14 data fields.
+ * -Together with nmea_gga_decode it lets a caller decode only some of the fields e.g., to drop a sentence early.
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param field holds the NMEA_FIELD_COUNT slices of the data fields (valid as long as the sentence is)
+ * @return bool is true if the sentence is a GGA sentence with a valid checksum and 14 data fields
+ */
+bool nmea_gga_split(const char* , size_t , nmea_FieldSlice_t* );
+
+/**
+ * @brief nmea_gga_decode function validates and stores only the selected data fields of a split sentence,
+ * -nmea_gga_parse_r is nmea_gga_reset, nmea_gga_split and nmea_gga_decode of NMEA_ALL_FIELDS
+ * @param field is the slices from nmea_gga_split
+ * @param fieldMask is the bit of every field to decode (nmea_Field_t), the other fields are not read
+ * @param result is updated with the decoded fields and their isEmpty/isFalse status (reset it first)
+ * @return void
+ */
+void nmea_gga_decode(const nmea_FieldSlice_t* , uint16_t , nmea_ParseResult_t* );
+
+/**
+ * @brief nmea_gga_parse_bounded function is the deterministic version of nmea_gga_parse_r for hard deadlines.
+ * -Input longer than the NMEA maximum (82 charachters, '$' to "\r\n" included, 80 without the "\r\n") is rejected
+ * -with the rule of nmea_validate_line (nmea_sentence_overlong) before it is parsed, so every loop is bounded by 82
+ * -charachters and 14 fields of at most 14 charachters. No heap, no I/O, no global state.
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param result is filled with the parsed data and the isEmpty/isFalse status of every field
+ * @return true if the sentence is a GGA sentence of at most 82 charachters with "\r\n" (80 without) and a valid checksum
+ */
+bool nmea_gga_parse_bounded(const char* , size_t , nmea_ParseResult_t* );
+
+/**
+ * @brief nmea_gga_parse_fixed function parses a sentence straight into the packed fixed-point record with integer
+ * -arithmetic only (no float, no double). The digits are rounded to the resolution of the record, so the record is the
+ * -one of nmea_gga_parse_r and nmea_pack_fix without the rounding of the float values in between.
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param fix holds the packed record (every field bit set in falseMask if the sentence is not a valid GGA sentence)
+ * @return true if the sentence is a GGA sentence with a valid checksum (the fields can still be empty or incorrect)
+ */
+bool nmea_gga_parse_fixed(const char* , size_t , nmea_PackedFix_t* );
+
+/**
+ * @brief nmea_pack_fix function converts a parse result into the packed fixed-point record
+ * @param result is the parse result
+ * @param fix holds the packed record
+ * @return void
+ */
+void nmea_pack_fix(const nmea_ParseResult_t* , nmea_PackedFix_t* );
+
+/**
+ * @brief nmea_unpack_fix function converts a packed record back into a parse result (default values for the
+ * -empty and incorrect fields)
+ * @param fix is the packed record
+ * @param result holds the parse result
+ * @return void
+ */
+void nmea_unpack_fix(const nmea_PackedFix_t* , nmea_ParseResult_t* );
+
+/**
+ * @brief nmea_cpp_decode_benchmark function (gga_parser_check.cpp) cross-checks gga::decode of gga_parser.hpp with
+ * -nmea_gga_parse_r + nmea_pack_fix on generated and mutated sentences and prints the time of both, for all fields
+ * -and for two fields
+ * @param sentences is the number of sentences
+ * @return void
+ */
+void nmea_cpp_decode_benchmark(uint32_t );
+
+#ifdef CONFIG_GGA_PARSER_PRINT
 /**
  * @brief printParseData function prints the parsed data in accordance with the isEmpty and isFalse status.
  * @param nmea_Parsed_t i.e., the parsed data (struct) is given as a parameter.
  * @return void
  */
 void printParsedData (nmea_Parsed_t );
+#endif
+
+#ifdef CONFIG_GGA_PARSER_GETTERS
 
 /**
  * @brief getTime function prints the UTC-TIME to console and gives the hour, minute and second values to the user
@@ -294,6 +459,7 @@ int getQInd (char* );
  * @return void
  */
 void getDrs(char* , char* );
+#endif
 
 #ifdef __cplusplus
 }
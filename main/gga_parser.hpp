@@ -0,0 +1,359 @@
+/**
+ * @brief Header-only C++17 GGA decoder with a compile-time field schema.
+ * -The field layout is a constexpr table and the validation rules are a Rules type (GgaRules uses the limits of
+ * -gga_parser.h such as TIME_DEC_PNT_POS, LAT_DEG_LEN and MAX_QI_VAL), the requested fields are template parameters.
+ * -For every field selection the compiler generates its own inlined decoder which works on a std::string_view, keeps
+ * -no global state and returns the fix in the nmea_PackedFix_t units (same values as nmea_gga_parse_r + nmea_pack_fix).
+ *
+ * Usage:
+ *     auto fix = gga::decode<gga::Field::Time, gga::Field::Latitude, gga::Field::LatitudeInd>(line);
+ *     if (fix && !(fix->falseMask & gga::maskOf(gga::Field::Latitude))) { ... }
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "gga_parser.h"
+
+namespace gga {
+
+/**
+ * @brief Data fields in the order of the sentence (same values as nmea_Field_t)
+ */
+enum class Field : unsigned {
+    Time = NMEA_FIELD_TIME,
+    Latitude = NMEA_FIELD_LATITUDE,
+    LatitudeInd = NMEA_FIELD_LATITUDE_IND,
+    Longitude = NMEA_FIELD_LONGITUDE,
+    LongitudeInd = NMEA_FIELD_LONGITUDE_IND,
+    QInd = NMEA_FIELD_QIND,
+    Satellite = NMEA_FIELD_SATELLITE,
+    Hdop = NMEA_FIELD_HDOP,
+    Altitude = NMEA_FIELD_ALTITUDE,
+    AltitudeInd = NMEA_FIELD_ALTITUDE_IND,
+    GeoSep = NMEA_FIELD_GEOSEP,
+    GeoSepInd = NMEA_FIELD_GEOSEP_IND,
+    TDgps = NMEA_FIELD_TDGPS,
+    DrsID = NMEA_FIELD_DRSID
+};
+
+constexpr std::size_t fieldCount = NMEA_FIELD_COUNT;
+
+constexpr std::uint16_t maskOf(Field f) { return static_cast<std::uint16_t>(1u << static_cast<unsigned>(f)); }
+
+constexpr std::uint16_t allFields = static_cast<std::uint16_t>((1u << NMEA_FIELD_COUNT) - 1);
+
+/**
+ * @brief Validation rules of the GGA fields, derive from it and override members to change a limit
+ */
+struct GgaRules {
+    static constexpr std::string_view header = "$GPGGA,";
+    static constexpr std::size_t timeMaxLen = TIME_FIELD_LEN + 1;
+    static constexpr std::size_t timeDecPntPos = TIME_DEC_PNT_POS;
+    static constexpr std::size_t timeHourLen = TIME_HOUR_STR_LEN;
+    static constexpr std::size_t timeMinLen = TIME_MIN_STR_LEN;
+    static constexpr std::size_t latMaxLen = LAT_FIELD_LEN + 1;
+    static constexpr std::size_t latDegLen = LAT_DEG_LEN;
+    static constexpr std::size_t lonMaxLen = LON_FIELD_LEN + 1;
+    static constexpr std::size_t lonDegLen = LON_DEG_LEN;
+    static constexpr std::size_t qiLen = QI_FIELD_LEN;
+    static constexpr int minQi = MIN_QI_VAL;
+    static constexpr int maxQi = MAX_QI_VAL;
+    static constexpr std::size_t satMaxLen = SAT_FIELD_LEN;
+    static constexpr int minSat = MIN_SAT_VAL;
+    static constexpr int maxSat = MAX_SAT_VAL;
+    static constexpr std::size_t drsLen = DRS_ID_ARR_LEN - 1;
+    static constexpr int maxDrs = 1023;
+};
+
+/**
+ * @brief Kind of decoding applied to a field
+ */
+enum class Kind { Time, Latitude, Longitude, NorthSouth, EastWest, QInd, Satellite, Hdop, Signed, Meters, Unsigned, Drs };
+
+/**
+ * @brief Field layout of the GGA sentence, entry i is the kind of the i-th data field
+ */
+constexpr std::array<Kind, fieldCount> ggaLayout = {
+    Kind::Time, Kind::Latitude, Kind::NorthSouth, Kind::Longitude, Kind::EastWest, Kind::QInd, Kind::Satellite,
+    Kind::Hdop, Kind::Signed, Kind::Meters, Kind::Signed, Kind::Meters, Kind::Unsigned, Kind::Drs
+};
+
+namespace detail {
+
+/**
+ * @brief digits function converts a run of decimal digits, -1 if a non digit charachter is found
+ */
+constexpr int digits(std::string_view s)
+{
+    int value = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return -1;
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+/**
+ * @brief scaled function converts an unsigned decimal string into an integer scaled by 10^Decimals (rounded half up)
+ */
+template <int Decimals>
+constexpr bool scaled(std::string_view s, std::int64_t &out)
+{
+    std::int64_t value = 0;
+    int count = 0;
+    int decimals = -1;
+    bool roundUp = false;
+    for (char c : s) {
+        if (c >= '0' && c <= '9') {
+            if (++count > 15) return false;
+            if (decimals < 0) {
+                value = value * 10 + (c - '0');
+            }
+            else if (decimals < Decimals) {
+                value = value * 10 + (c - '0');
+                decimals++;
+            }
+            else if (decimals == Decimals) {
+                roundUp = c >= '5';
+                decimals++;
+            }
+        }
+        else if (c == '.' && decimals < 0) {
+            decimals = 0;
+        }
+        else {
+            return false;
+        }
+    }
+    if (count == 0) return false;
+    for (int i = (decimals < 0) ? 0 : (decimals > Decimals ? Decimals : decimals); i < Decimals; i++) {
+        value *= 10;
+    }
+    out = value + (roundUp ? 1 : 0);
+    return true;
+}
+
+/**
+ * @brief signedScaled function is scaled with an optional leading '-'
+ */
+template <int Decimals>
+constexpr bool signedScaled(std::string_view s, std::int64_t &out)
+{
+    if (!s.empty() && s[0] == '-') {
+        if (!scaled<Decimals>(s.substr(1), out)) return false;
+        out = -out;
+        return true;
+    }
+    return scaled<Decimals>(s, out);
+}
+
+/**
+ * @brief hexValue function converts a hexadecimal charachter, -1 if it is not one
+ */
+constexpr int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * @brief coordinate function decodes ddmm.mmmm / dddmm.mmmm into 1/10000 of a minute
+ */
+template <std::size_t DegLen, std::size_t MaxLen>
+constexpr bool coordinate(std::string_view s, std::int32_t &out)
+{
+    std::int64_t minutes = 0;
+    if (s.size() > MaxLen || s.size() <= DegLen + 2 || s[DegLen + 2] != '.') return false;
+    int deg = digits(s.substr(0, DegLen));
+    if (deg < 0 || !scaled<4>(s.substr(DegLen), minutes) || minutes >= 600000) return false;
+    out = static_cast<std::int32_t>(deg * 600000 + minutes);
+    return true;
+}
+
+/**
+ * @brief decodeField function decodes the field I when it is requested, the kind comes from the layout table
+ * @return bool is false if the field is incorrect
+ */
+template <typename Rules, std::size_t I>
+constexpr bool decodeField(std::string_view s, nmea_PackedFix_t &fix)
+{
+    constexpr Kind kind = ggaLayout[I];
+    std::int64_t v = 0;
+    if constexpr (kind == Kind::Time) {
+        if (s.size() > Rules::timeMaxLen || s.size() <= Rules::timeDecPntPos || s[Rules::timeDecPntPos] != '.') return false;
+        int hour = digits(s.substr(0, Rules::timeHourLen));
+        int minutes = digits(s.substr(Rules::timeHourLen, Rules::timeMinLen));
+        if (hour < 0 || minutes < 0 || !scaled<3>(s.substr(Rules::timeHourLen + Rules::timeMinLen), v)) return false;
+        if (hour > 24 || minutes >= 60 || v >= 60000) return false;
+        fix.timeMs = static_cast<std::uint32_t>((hour * 60 + minutes) * 60000 + v);
+        return true;
+    }
+    else if constexpr (kind == Kind::Latitude) {
+        return coordinate<Rules::latDegLen, Rules::latMaxLen>(s, fix.latitude);
+    }
+    else if constexpr (kind == Kind::Longitude) {
+        return coordinate<Rules::lonDegLen, Rules::lonMaxLen>(s, fix.longitude);
+    }
+    else if constexpr (kind == Kind::NorthSouth) {
+        return s.size() == 1 && (s[0] == 'N' || s[0] == 'S');
+    }
+    else if constexpr (kind == Kind::EastWest) {
+        return s.size() == 1 && (s[0] == 'E' || s[0] == 'W');
+    }
+    else if constexpr (kind == Kind::QInd) {
+        int q = (s.size() == Rules::qiLen) ? digits(s) : -1;
+        if (q < Rules::minQi || q > Rules::maxQi) return false;
+        fix.qIndicator = static_cast<std::uint8_t>(q);
+        return true;
+    }
+    else if constexpr (kind == Kind::Satellite) {
+        int sat = (s.size() <= Rules::satMaxLen) ? digits(s) : -1;
+        if (sat < Rules::minSat || sat > Rules::maxSat) return false;
+        fix.satTracked = static_cast<std::uint8_t>(sat);
+        return true;
+    }
+    else if constexpr (kind == Kind::Hdop) {
+        if (!scaled<2>(s, v) || v <= 0 || v > UINT16_MAX) return false;
+        fix.hdop = static_cast<std::uint16_t>(v);
+        return true;
+    }
+    else if constexpr (kind == Kind::Signed) {
+        if (!signedScaled<2>(s, v) || v > INT32_MAX || v < INT32_MIN) return false;
+        (I == NMEA_FIELD_ALTITUDE ? fix.altitude : fix.geoSep) = static_cast<std::int32_t>(v);
+        return true;
+    }
+    else if constexpr (kind == Kind::Meters) {
+        return s.size() == 1 && s[0] == 'M';
+    }
+    else if constexpr (kind == Kind::Unsigned) {
+        if (!scaled<2>(s, v) || v > UINT32_MAX) return false;
+        fix.tDgps = static_cast<std::uint32_t>(v);
+        return true;
+    }
+    else {
+        int drs = (s.size() == Rules::drsLen) ? digits(s) : -1;
+        if (drs < 0 || drs > Rules::maxDrs) return false;
+        fix.drsID = static_cast<std::uint16_t>(drs);
+        return true;
+    }
+}
+
+/**
+ * @brief decodeFields function runs decodeField for every requested field, unrolled at compile time
+ */
+template <typename Rules, std::uint16_t Mask, std::size_t... I>
+constexpr void decodeFields(const std::array<std::string_view, fieldCount> &f, nmea_PackedFix_t &fix, std::index_sequence<I...>)
+{
+    auto one = [&](auto index) {
+        constexpr std::size_t i = decltype(index)::value;
+        if constexpr ((Mask >> i) & 1u) {
+            if (f[i].empty()) {
+                fix.emptyMask |= static_cast<std::uint16_t>(1u << i);
+            }
+            else if (!decodeField<Rules, i>(f[i], fix)) {
+                fix.falseMask |= static_cast<std::uint16_t>(1u << i);
+            }
+        }
+    };
+    (one(std::integral_constant<std::size_t, I>{}), ...);
+}
+
+/**
+ * @brief applySign function gives the coordinate the sign of its indicator when both are requested and correct
+ */
+constexpr void applySign(std::string_view ind, char negative, std::uint16_t bad, unsigned value, unsigned indicator, std::int32_t &coord)
+{
+    if (!((bad >> value) & 1u) && !((bad >> indicator) & 1u) && ind[0] == negative) {
+        coord = -coord;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Decoder for a selection of fields
+ * @tparam Rules is the validation rules type (GgaRules or a type derived from it)
+ * @tparam Mask is the bit mask of the requested fields (maskOf(Field) values)
+ */
+template <typename Rules, std::uint16_t Mask>
+struct Decoder {
+    /**
+     * @brief decode function validates the framing and the checksum and decodes the requested fields
+     * @param sentence is the sentence, the trailing "\r\n" is optional
+     * @return the packed fix (unrequested fields are 0 and not flagged) or std::nullopt if the sentence is not a
+     * -GGA sentence with a valid checksum and 14 data fields
+     */
+    static constexpr std::optional<nmea_PackedFix_t> decode(std::string_view sentence)
+    {
+        while (!sentence.empty() && (sentence.back() == '\n' || sentence.back() == '\r')) {
+            sentence.remove_suffix(1);
+        }
+        const std::size_t header = Rules::header.size();
+        if (sentence.size() < header + 2 || sentence.substr(0, header) != Rules::header) {
+            return std::nullopt;
+        }
+        //One pass over the data fields does the checksum and the field splitting together
+        std::array<std::string_view, fieldCount> f{};
+        int checksum = 0;
+        for (std::size_t i = 1; i < header; i++) {
+            checksum ^= static_cast<unsigned char>(sentence[i]);
+        }
+        std::size_t count = 0;
+        std::size_t begin = header;
+        std::size_t i = header;
+        for (; i < sentence.size() && sentence[i] != '*'; i++) {
+            char c = sentence[i];
+            checksum ^= static_cast<unsigned char>(c);
+            if (c == ',') {
+                if (count == fieldCount - 1) return std::nullopt;
+                f[count++] = sentence.substr(begin, i - begin);
+                begin = i + 1;
+            }
+        }
+        if (i == sentence.size() || count != fieldCount - 1 || sentence.size() - i - 1 < 1 || sentence.size() - i - 1 > 2) {
+            return std::nullopt;
+        }
+        f[count] = sentence.substr(begin, i - begin);
+        int expected = 0;
+        for (std::size_t j = i + 1; j < sentence.size(); j++) {
+            int nibble = detail::hexValue(sentence[j]);
+            if (nibble < 0) return std::nullopt;
+            expected = (expected << 4) | nibble;
+        }
+        if (checksum != expected) {
+            return std::nullopt;
+        }
+        nmea_PackedFix_t fix{};
+        detail::decodeFields<Rules, Mask>(f, fix, std::make_index_sequence<fieldCount>{});
+        //The sign of a coordinate is only known when its indicator is requested as well
+        std::uint16_t bad = fix.emptyMask | fix.falseMask;
+        if constexpr ((Mask & maskOf(Field::Latitude)) && (Mask & maskOf(Field::LatitudeInd))) {
+            detail::applySign(f[NMEA_FIELD_LATITUDE_IND], 'S', bad, NMEA_FIELD_LATITUDE, NMEA_FIELD_LATITUDE_IND, fix.latitude);
+        }
+        if constexpr ((Mask & maskOf(Field::Longitude)) && (Mask & maskOf(Field::LongitudeInd))) {
+            detail::applySign(f[NMEA_FIELD_LONGITUDE_IND], 'W', bad, NMEA_FIELD_LONGITUDE, NMEA_FIELD_LONGITUDE_IND, fix.longitude);
+        }
+        return fix;
+    }
+};
+
+/**
+ * @brief decode function decodes the requested fields with the default GGA rules (all fields when none are given)
+ */
+template <Field... Requested>
+constexpr std::optional<nmea_PackedFix_t> decode(std::string_view sentence)
+{
+    constexpr std::uint16_t mask = sizeof...(Requested) == 0 ? allFields : static_cast<std::uint16_t>((maskOf(Requested) | ... | 0u));
+    return Decoder<GgaRules, mask>::decode(sentence);
+}
+
+} // namespace gga
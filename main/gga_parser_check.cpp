@@ -0,0 +1,143 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "gga_parser.hpp"
+#include "gga_encode.h"
+#include "gga_validate.h"
+#include "gga_bench.h"
+
+namespace {
+
+/**
+ * @brief mutate function replaces a random charachter of the data fields and writes the checksum again, so the
+ * -sentence still reaches the field decoders
+ * @param line is the sentence
+ * @param len is the length of the sentence ("\r\n" included)
+ * @param rng is the generator state
+ * @return void
+ */
+void mutate(char *line, size_t len, uint32_t *rng)
+{
+    static const char s_chars[] = "0123456789.-,NSEWMA ";
+    const char *star = static_cast<const char*>(memchr(line, '*', len));
+    if (star == nullptr || star - line <= 7) {
+        return;
+    }
+    size_t dataLen = static_cast<size_t>(star - line) - 7;
+    line[7 + nmea_bench_random(rng) % dataLen] = s_chars[nmea_bench_random(rng) % (sizeof(s_chars) - 1)];
+    snprintf(line + (star - line) + 1, 3, "%02X", nmea_checksum(line + 1, static_cast<size_t>(star - line) - 1));
+    line[(star - line) + 3] = '\r';
+}
+
+} // namespace
+
+/**
+ * @brief nmea_cpp_decode_benchmark function cross-checks gga::decode of gga_parser.hpp with nmea_gga_parse_r +
+ * -nmea_pack_fix on generated and mutated sentences and prints the time of both, for all fields and for two fields
+ * @param sentences is the number of sentences
+ * @return void
+ */
+extern "C" void nmea_cpp_decode_benchmark(uint32_t sentences)
+{
+    char *capture = static_cast<char*>(malloc(static_cast<size_t>(sentences) * ENCODE_MAX_SENTENCE_LEN));
+    size_t *length = static_cast<size_t*>(malloc(static_cast<size_t>(sentences) * sizeof(size_t)));
+    if (capture == nullptr || length == nullptr) {
+        printf("ERROR: No memory for the C++ decoder benchmark!\n");
+        free(capture);
+        free(length);
+        return;
+    }
+    //Random fixes with empty fields now and then, every 4th sentence gets a random charachter (checksum fixed again)
+    uint32_t rng = 0x2545F491u;
+    for (uint32_t i = 0; i < sentences; i++) {
+        nmea_PackedFix_t fix{};
+        fix.timeMs = nmea_bench_random(&rng) % 86400000u;
+        fix.latitude = static_cast<int32_t>(nmea_bench_random(&rng) % 54000000u) - 27000000;
+        fix.longitude = static_cast<int32_t>(nmea_bench_random(&rng) % 108000000u) - 54000000;
+        fix.altitude = static_cast<int32_t>(nmea_bench_random(&rng) % 1000000u) - 50000;
+        fix.geoSep = static_cast<int32_t>(nmea_bench_random(&rng) % 20000u) - 10000;
+        fix.tDgps = nmea_bench_random(&rng) % 10000u;
+        fix.hdop = static_cast<uint16_t>(1 + nmea_bench_random(&rng) % 9999u);
+        fix.drsID = static_cast<uint16_t>(nmea_bench_random(&rng) % 1024u);
+        fix.qIndicator = static_cast<uint8_t>(nmea_bench_random(&rng) % 9u);
+        fix.satTracked = static_cast<uint8_t>(nmea_bench_random(&rng) % 13u);
+        if (nmea_bench_random(&rng) % 8 == 0) {
+            fix.emptyMask = static_cast<uint16_t>(nmea_bench_random(&rng) & gga::allFields);
+        }
+        char *line = capture + static_cast<size_t>(i) * ENCODE_MAX_SENTENCE_LEN;
+        length[i] = nmea_encode_packed(&fix, line, ENCODE_MAX_SENTENCE_LEN);
+        if (nmea_bench_random(&rng) % 4 == 0) {
+            mutate(line, length[i], &rng);
+        }
+    }
+    //Cross-check of every sentence: same acceptance and the same packed record
+    uint32_t accepted = 0;
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < sentences; i++) {
+        const char *line = capture + static_cast<size_t>(i) * ENCODE_MAX_SENTENCE_LEN;
+        nmea_ParseResult_t result;
+        nmea_PackedFix_t packed{};
+        bool ok = nmea_gga_parse_r(line, length[i], &result);
+        if (ok) {
+            nmea_pack_fix(&result, &packed);
+        }
+        auto fix = gga::decode<>(std::string_view(line, length[i]));
+        if (ok != fix.has_value() || (ok && memcmp(&packed, &*fix, sizeof(packed)) != 0)) {
+            if (mismatches++ == 0) {
+                printf("ERROR: C++ decoder differs on %.*s", static_cast<int>(length[i]), line);
+            }
+        }
+        accepted += ok;
+    }
+    //Timed loops, the records are summed so they are not optimized away
+    uint64_t sum = 0;
+    nmea_ParseResult_t result;
+    nmea_PackedFix_t packed;
+    uint64_t start = nmea_wall_us();
+    for (uint32_t i = 0; i < sentences; i++) {
+        if (nmea_gga_parse_r(capture + static_cast<size_t>(i) * ENCODE_MAX_SENTENCE_LEN, length[i], &result)) {
+            nmea_pack_fix(&result, &packed);
+            sum += packed.timeMs + static_cast<uint32_t>(packed.latitude);
+        }
+    }
+    uint64_t cUs = nmea_wall_us() - start;
+    start = nmea_wall_us();
+    for (uint32_t i = 0; i < sentences; i++) {
+        if (auto fix = gga::decode<>(std::string_view(capture + static_cast<size_t>(i) * ENCODE_MAX_SENTENCE_LEN, length[i]))) {
+            sum -= fix->timeMs + static_cast<uint32_t>(fix->latitude);
+        }
+    }
+    uint64_t cppUs = nmea_wall_us() - start;
+    //Two fields: split + selective decode against a decoder generated for the two fields
+    nmea_FieldSlice_t field[NMEA_FIELD_COUNT];
+    const uint16_t twoFields = gga::maskOf(gga::Field::Time) | gga::maskOf(gga::Field::QInd);
+    start = nmea_wall_us();
+    for (uint32_t i = 0; i < sentences; i++) {
+        if (nmea_gga_split(capture + static_cast<size_t>(i) * ENCODE_MAX_SENTENCE_LEN, length[i], field)) {
+            nmea_gga_reset(&result);
+            nmea_gga_decode(field, twoFields, &result);
+            sum += static_cast<uint64_t>(result.data.gpsData_qIndicator);
+        }
+    }
+    uint64_t cTwoUs = nmea_wall_us() - start;
+    start = nmea_wall_us();
+    for (uint32_t i = 0; i < sentences; i++) {
+        if (auto fix = gga::decode<gga::Field::Time, gga::Field::QInd>(std::string_view(capture + static_cast<size_t>(i) * ENCODE_MAX_SENTENCE_LEN, length[i]))) {
+            sum -= fix->qIndicator;
+        }
+    }
+    uint64_t cppTwoUs = nmea_wall_us() - start;
+    printf("C++ DECODER BENCHMARK: %lu sentences, %lu accepted (record sum %llu)\n", static_cast<unsigned long>(sentences),
+           static_cast<unsigned long>(accepted), static_cast<unsigned long long>(sum & 0xFFFF));
+    printf("C++ DECODER MISMATCHES--------------> %lu\n", static_cast<unsigned long>(mismatches));
+    printf("C PARSE + PACK----------------------> %.0f sentences/s (%llu us)\n",
+           (cUs != 0) ? static_cast<double>(sentences) * 1e6 / static_cast<double>(cUs) : 0.0, static_cast<unsigned long long>(cUs));
+    printf("C++ DECODE ALL FIELDS---------------> %.0f sentences/s (%llu us)\n",
+           (cppUs != 0) ? static_cast<double>(sentences) * 1e6 / static_cast<double>(cppUs) : 0.0, static_cast<unsigned long long>(cppUs));
+    printf("C SPLIT + DECODE TIME, QUALITY------> %.0f sentences/s (%llu us)\n",
+           (cTwoUs != 0) ? static_cast<double>(sentences) * 1e6 / static_cast<double>(cTwoUs) : 0.0, static_cast<unsigned long long>(cTwoUs));
+    printf("C++ DECODE TIME, QUALITY------------> %.0f sentences/s (%llu us)\n",
+           (cppTwoUs != 0) ? static_cast<double>(sentences) * 1e6 / static_cast<double>(cppTwoUs) : 0.0, static_cast<unsigned long long>(cppTwoUs));
+    free(capture);
+    free(length);
+}
@@ -0,0 +1,555 @@
+#ifdef __linux__
+#define _GNU_SOURCE                     //pthread_attr_setaffinity_np
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "gga_pipeline.h"
+#include "gga_encode.h"
+#include "gga_bench.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <unistd.h>
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#endif
+
+#define QUEUE_LEN CONFIG_GGA_PIPELINE_QUEUE_LEN
+#define BENCH_NOISE_EVERY 16            //A line of noise after this many sentences of the benchmark capture
+
+_Static_assert((QUEUE_LEN & (QUEUE_LEN - 1)) == 0, "CONFIG_GGA_PIPELINE_QUEUE_LEN must be a power of 2");
+
+struct nmea_Pipeline {
+    nmea_PipelineConfig_t config;
+    nmea_Queue_t *queue;                //stage one pushes, stage two pops
+    atomic_bool sleeping;               //stage two waits for a sentence
+    atomic_bool stop;                   //stop requested
+    atomic_bool sourceDone;             //stage one has ended
+    nmea_Scanner_t scanner;             //stage one only
+    char chunk[CONFIG_GGA_PIPELINE_READ_CHUNK]; //stage one only, read buffer (not on the task stack)
+    //Statistics, every counter is written by one stage only
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t sentences;
+    atomic_uint_fast64_t discardedBytes;
+    atomic_uint_fast64_t decoded;
+    atomic_uint_fast64_t latencySumUs;
+    atomic_uint_fast32_t latencyMinUs;
+    atomic_uint_fast32_t latencyMaxUs;
+    bool joined;
+#ifdef __linux__
+    pthread_t framingThread;
+    pthread_t decodeThread;
+    sem_t wake;
+#else
+    TaskHandle_t decodeTask;
+    SemaphoreHandle_t done;
+#endif
+};
+
+/**
+ * @brief wakeDecoder function wakes stage two if it waits for a sentence
+ * @param pipe is the pipeline
+ * @return void
+ */
+static inline void wakeDecoder(nmea_Pipeline_t *pipe)
+{
+    //Pairs with the fence of waitForWork: either stage two sees the sentence or stage one sees the flag
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_exchange(&pipe->sleeping, false)) {
+#ifdef __linux__
+        sem_post(&pipe->wake);
+#else
+        xTaskNotifyGive(pipe->decodeTask);
+#endif
+    }
+}
+
+/**
+ * @brief waitForWork function blocks stage two until stage one has handed over a sentence or has ended
+ * @param pipe is the pipeline
+ * @return void
+ */
+static void waitForWork(nmea_Pipeline_t *pipe)
+{
+    atomic_store(&pipe->sleeping, true);
+    //Checked again after the flag is set so a sentence handed over in between is not missed, the fence keeps the
+    //acquire loads of the ring from moving before the store of the flag
+    atomic_thread_fence(memory_order_seq_cst);
+    if (nmea_queue_depth(pipe->queue) != 0 || atomic_load(&pipe->sourceDone)) {
+        atomic_store(&pipe->sleeping, false);
+        return;
+    }
+#ifdef __linux__
+    while (sem_wait(&pipe->wake) != 0) {
+    }
+#else
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#endif
+}
+
+/**
+ * @brief handOff function puts a framed sentence into the ring (scanner callback of stage one)
+ * @param arg is the pipeline
+ * @param sentence is the sentence from '$' to "*hh"
+ * @param len is the length of the sentence
+ * @return void
+ */
+static void handOff(void *arg, const char *sentence, size_t len)
+{
+    nmea_Pipeline_t *pipe = arg;
+    if (nmea_queue_push(pipe->queue, 0, sentence, len, (uint32_t) nmea_wall_us())) {
+        wakeDecoder(pipe);
+    }
+}
+
+/**
+ * @brief framingStage function reads the source and frames the sentences until the source ends or stop is requested
+ * @param pipe is the pipeline
+ * @return void
+ */
+static void framingStage(nmea_Pipeline_t *pipe)
+{
+    while (!atomic_load(&pipe->stop)) {
+        size_t len = pipe->config.source(pipe->config.sourceArg, pipe->chunk, sizeof(pipe->chunk));
+        if (len == 0) {
+            break;
+        }
+        nmea_scan_feed(&pipe->scanner, pipe->chunk, len, handOff, pipe);
+        uint64_t discarded = 0;
+        for (int i = 0; i < NMEA_DISCARD_REASON_COUNT; i++) {
+            discarded += pipe->scanner.discardedBytes[i];
+        }
+        atomic_fetch_add_explicit(&pipe->bytes, len, memory_order_relaxed);
+        atomic_store_explicit(&pipe->sentences, pipe->scanner.sentences, memory_order_relaxed);
+        atomic_store_explicit(&pipe->discardedBytes, discarded, memory_order_relaxed);
+    }
+    atomic_store(&pipe->sourceDone, true);
+    wakeDecoder(pipe);
+}
+
+/**
+ * @brief decodeStage function decodes the sentences of the ring until stage one has ended and the ring is empty
+ * @param pipe is the pipeline
+ * @return void
+ */
+static void decodeStage(nmea_Pipeline_t *pipe)
+{
+    nmea_ParseResult_t result;
+    nmea_QueueItem_t item;
+    for (;;) {
+        if (!nmea_queue_pop(pipe->queue, &item)) {
+            //sourceDone is set after the last hand-off, the ring is read once more before ending
+            if (atomic_load(&pipe->sourceDone)) {
+                if (nmea_queue_depth(pipe->queue) == 0) {
+                    break;
+                }
+                continue;
+            }
+            waitForWork(pipe);
+            continue;
+        }
+        nmea_gga_parse_r(item.data, item.len, &result);
+        if (pipe->config.consumer != NULL) {
+            pipe->config.consumer(pipe->config.consumerArg, &result);
+        }
+        uint32_t latency = (uint32_t) nmea_wall_us() - item.timeUs;
+        atomic_fetch_add_explicit(&pipe->decoded, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&pipe->latencySumUs, latency, memory_order_relaxed);
+        if (latency < atomic_load_explicit(&pipe->latencyMinUs, memory_order_relaxed)) {
+            atomic_store_explicit(&pipe->latencyMinUs, latency, memory_order_relaxed);
+        }
+        if (latency > atomic_load_explicit(&pipe->latencyMaxUs, memory_order_relaxed)) {
+            atomic_store_explicit(&pipe->latencyMaxUs, latency, memory_order_relaxed);
+        }
+    }
+}
+
+#ifdef __linux__
+/**
+ * @brief framingThread function is the thread of stage one
+ * @param arg is the pipeline
+ * @return void* is NULL
+ */
+static void* framingThread(void *arg)
+{
+    framingStage(arg);
+    return NULL;
+}
+
+/**
+ * @brief decodeThread function is the thread of stage two
+ * @param arg is the pipeline
+ * @return void* is NULL
+ */
+static void* decodeThread(void *arg)
+{
+    decodeStage(arg);
+    return NULL;
+}
+
+/**
+ * @brief startThread function starts a stage thread pinned to a core when the core exists
+ * @param thread holds the thread
+ * @param entry is the thread function
+ * @param arg is the pipeline
+ * @param core is the core
+ * @return bool is true on success
+ */
+static bool startThread(pthread_t *thread, void *(*entry)(void *), void *arg, int core)
+{
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (core < sysconf(_SC_NPROCESSORS_ONLN)) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    }
+    bool ok = (pthread_create(thread, &attr, entry, arg) == 0);
+    pthread_attr_destroy(&attr);
+    return ok;
+}
+#else
+/**
+ * @brief framingTask function is the task of stage one
+ * @param arg is the pipeline
+ * @return void
+ */
+static void framingTask(void *arg)
+{
+    nmea_Pipeline_t *pipe = arg;
+    framingStage(pipe);
+    xSemaphoreGive(pipe->done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief decodeTask function is the task of stage two
+ * @param arg is the pipeline
+ * @return void
+ */
+static void decodeTask(void *arg)
+{
+    nmea_Pipeline_t *pipe = arg;
+    decodeStage(pipe);
+    xSemaphoreGive(pipe->done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief coreOf function gives the core of a stage, no affinity on single core builds
+ * @param core is the configured core
+ * @return BaseType_t is the core for xTaskCreatePinnedToCore
+ */
+static BaseType_t coreOf(int core)
+{
+    return (core < portNUM_PROCESSORS) ? (BaseType_t) core : tskNO_AFFINITY;
+}
+#endif
+
+/**
+ * @brief nmea_pipeline_start function creates the ring and starts both stages
+ * @param config is the configuration
+ * @return nmea_Pipeline_t* is the pipeline or NULL on failure
+ */
+nmea_Pipeline_t* nmea_pipeline_start(const nmea_PipelineConfig_t *config)
+{
+    if (config->source == NULL) {
+        printf("ERROR: Pipeline has no source!\n");
+        return NULL;
+    }
+    nmea_Pipeline_t *pipe = calloc(1, sizeof(nmea_Pipeline_t));
+    if (pipe == NULL) {
+        printf("ERROR: Pipeline allocation failed!\n");
+        return NULL;
+    }
+    pipe->config = *config;
+    pipe->queue = nmea_queue_create(QUEUE_LEN, 1, config->policy, config->sampleEvery);
+    if (pipe->queue == NULL) {
+        free(pipe);
+        return NULL;
+    }
+    nmea_scan_init(&pipe->scanner);
+    atomic_init(&pipe->latencyMinUs, UINT32_MAX);
+#ifdef __linux__
+    sem_init(&pipe->wake, 0, 0);
+    if (!startThread(&pipe->decodeThread, decodeThread, pipe, CONFIG_GGA_PIPELINE_DECODE_CORE)) {
+        printf("ERROR: Pipeline decode thread could not be started!\n");
+        sem_destroy(&pipe->wake);
+        nmea_queue_destroy(pipe->queue);
+        free(pipe);
+        return NULL;
+    }
+    if (!startThread(&pipe->framingThread, framingThread, pipe, CONFIG_GGA_PIPELINE_FRAMING_CORE)) {
+        printf("ERROR: Pipeline framing thread could not be started!\n");
+        atomic_store(&pipe->sourceDone, true);
+        wakeDecoder(pipe);
+        pthread_join(pipe->decodeThread, NULL);
+        sem_destroy(&pipe->wake);
+        nmea_queue_destroy(pipe->queue);
+        free(pipe);
+        return NULL;
+    }
+#else
+    pipe->done = xSemaphoreCreateCounting(2, 0);
+    if (pipe->done == NULL || xTaskCreatePinnedToCore(decodeTask, "gga_decode", CONFIG_GGA_PIPELINE_STACK_SIZE, pipe,
+            CONFIG_GGA_PIPELINE_PRIORITY, &pipe->decodeTask, coreOf(CONFIG_GGA_PIPELINE_DECODE_CORE)) != pdPASS) {
+        printf("ERROR: Pipeline decode task could not be started!\n");
+        if (pipe->done != NULL) vSemaphoreDelete(pipe->done);
+        nmea_queue_destroy(pipe->queue);
+        free(pipe);
+        return NULL;
+    }
+    if (xTaskCreatePinnedToCore(framingTask, "gga_framing", CONFIG_GGA_PIPELINE_STACK_SIZE, pipe,
+            CONFIG_GGA_PIPELINE_PRIORITY, NULL, coreOf(CONFIG_GGA_PIPELINE_FRAMING_CORE)) != pdPASS) {
+        printf("ERROR: Pipeline framing task could not be started!\n");
+        atomic_store(&pipe->sourceDone, true);
+        wakeDecoder(pipe);
+        xSemaphoreTake(pipe->done, portMAX_DELAY);
+        vSemaphoreDelete(pipe->done);
+        nmea_queue_destroy(pipe->queue);
+        free(pipe);
+        return NULL;
+    }
+#endif
+    return pipe;
+}
+
+/**
+ * @brief nmea_pipeline_stats function gives a snapshot of the statistics (can be called while running)
+ * @param pipeline is the pipeline
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_pipeline_stats(const nmea_Pipeline_t *pipeline, nmea_PipelineStats_t *stats)
+{
+    nmea_Pipeline_t *pipe = (nmea_Pipeline_t *) pipeline;
+    nmea_QueueStats_t queue;
+    nmea_queue_stats(pipe->queue, &queue);
+    stats->bytes = atomic_load_explicit(&pipe->bytes, memory_order_relaxed);
+    stats->sentences = atomic_load_explicit(&pipe->sentences, memory_order_relaxed);
+    stats->discardedBytes = atomic_load_explicit(&pipe->discardedBytes, memory_order_relaxed);
+    stats->dropped = queue.droppedNewest + queue.droppedOldest + queue.coalesced + queue.sampledOut;
+    stats->decoded = atomic_load_explicit(&pipe->decoded, memory_order_relaxed);
+    stats->latencySumUs = atomic_load_explicit(&pipe->latencySumUs, memory_order_relaxed);
+    stats->latencyMinUs = (stats->decoded != 0) ? (uint32_t) atomic_load_explicit(&pipe->latencyMinUs, memory_order_relaxed) : 0;
+    stats->latencyMaxUs = (uint32_t) atomic_load_explicit(&pipe->latencyMaxUs, memory_order_relaxed);
+    stats->queueHighWater = queue.highWater;
+}
+
+/**
+ * @brief nmea_pipeline_print function prints the statistics to console
+ * @param pipeline is the pipeline
+ * @return void
+ */
+void nmea_pipeline_print(const nmea_Pipeline_t *pipeline)
+{
+    nmea_PipelineStats_t stats;
+    nmea_pipeline_stats(pipeline, &stats);
+    printf("PIPELINE BYTES----------------------> %llu\n", (unsigned long long) stats.bytes);
+    printf("PIPELINE SENTENCES------------------> %llu\n", (unsigned long long) stats.sentences);
+    printf("PIPELINE DISCARDED BYTES------------> %llu\n", (unsigned long long) stats.discardedBytes);
+    printf("PIPELINE DROPPED (OVERLOAD)---------> %llu\n", (unsigned long long) stats.dropped);
+    printf("PIPELINE DECODED--------------------> %llu\n", (unsigned long long) stats.decoded);
+    printf("PIPELINE LATENCY (MIN/AVG/MAX us)---> %lu/%lu/%lu\n", (unsigned long) stats.latencyMinUs,
+           (unsigned long) (stats.decoded != 0 ? stats.latencySumUs / stats.decoded : 0), (unsigned long) stats.latencyMaxUs);
+    printf("PIPELINE RING HIGH WATER------------> %lu/%d\n", (unsigned long) stats.queueHighWater, QUEUE_LEN);
+    nmea_queue_print(pipeline->queue);
+}
+
+/**
+ * @brief nmea_pipeline_wait function waits until the source has ended and stage two has decoded every sentence
+ * @param pipeline is the pipeline
+ * @return void
+ */
+void nmea_pipeline_wait(nmea_Pipeline_t *pipeline)
+{
+    if (pipeline->joined) {
+        return;
+    }
+#ifdef __linux__
+    pthread_join(pipeline->framingThread, NULL);
+    pthread_join(pipeline->decodeThread, NULL);
+#else
+    xSemaphoreTake(pipeline->done, portMAX_DELAY);
+    xSemaphoreTake(pipeline->done, portMAX_DELAY);
+#endif
+    pipeline->joined = true;
+}
+
+/**
+ * @brief nmea_pipeline_stop function stops stage one after its current read, waits for both stages and frees the
+ * -pipeline
+ * @param pipeline is the pipeline
+ * @return void
+ */
+void nmea_pipeline_stop(nmea_Pipeline_t *pipeline)
+{
+    atomic_store(&pipeline->stop, true);
+    nmea_pipeline_wait(pipeline);
+#ifdef __linux__
+    sem_destroy(&pipeline->wake);
+#else
+    vSemaphoreDelete(pipeline->done);
+#endif
+    nmea_queue_destroy(pipeline->queue);
+    free(pipeline);
+}
+
+#ifdef __linux__
+/**
+ * @brief Capture read by the benchmark source
+ */
+typedef struct {
+    const char *data;
+    size_t len;
+    size_t pos;
+} benchSource_t;
+
+/**
+ * @brief Totals of the benchmark consumer
+ */
+typedef struct {
+    uint64_t sentences;
+    uint64_t satellites;                //summed so the decode is not optimized away
+} benchConsumer_t;
+
+/**
+ * @brief benchRead function is the source of the benchmark, it gives the capture in chunks
+ * @param arg is the capture
+ * @param buffer holds the chunk
+ * @param cap is the size of the buffer
+ * @return size_t is the length of the chunk or 0 at the end
+ */
+static size_t benchRead(void *arg, char *buffer, size_t cap)
+{
+    benchSource_t *source = arg;
+    size_t len = (source->len - source->pos < cap) ? source->len - source->pos : cap;
+    memcpy(buffer, source->data + source->pos, len);
+    source->pos += len;
+    return len;
+}
+
+/**
+ * @brief benchConsume function is the consumer of the benchmark
+ * @param arg is the totals
+ * @param result is the decoded sentence
+ * @return void
+ */
+static void benchConsume(void *arg, const nmea_ParseResult_t *result)
+{
+    benchConsumer_t *totals = arg;
+    totals->sentences++;
+    totals->satellites += (uint64_t) result->data.gpsData_satTracked;
+}
+
+/**
+ * @brief benchParse function is the scanner callback of the one-task baseline, it decodes the sentence at once
+ * @param arg is the totals
+ * @param sentence is the sentence from '$' to "*hh"
+ * @param len is the length of the sentence
+ * @return void
+ */
+static void benchParse(void *arg, const char *sentence, size_t len)
+{
+    nmea_ParseResult_t result;
+    nmea_gga_parse_r(sentence, len, &result);
+    benchConsume(arg, &result);
+}
+
+/**
+ * @brief nmea_pipeline_benchmark function runs a generated capture (with noise lines) through framing and decoding in
+ * -one thread and through both stages of the pipeline, with the drop-newest and the block policy, and prints the
+ * -throughput, the losses and the handoff latency
+ * @param sentences is the number of sentences of the capture
+ * @return void
+ */
+void nmea_pipeline_benchmark(uint32_t sentences)
+{
+    static const char s_noise[] = "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n";
+    size_t cap = (size_t) sentences * ENCODE_MAX_SENTENCE_LEN + (sentences / BENCH_NOISE_EVERY + 1) * sizeof(s_noise);
+    char *capture = malloc(cap);
+    if (capture == NULL || sentences == 0) {
+        printf("ERROR: Pipeline benchmark could not be started!\n");
+        free(capture);
+        return;
+    }
+    //Random fixes without DGPS fields (within the 82 charachter limit), a GSA sentence now and then for stage one to discard
+    size_t len = 0;
+    uint32_t rng = 0x2545F491u;
+    for (uint32_t i = 0; i < sentences; i++) {
+        nmea_PackedFix_t fix = { 0 };
+        fix.timeMs = nmea_bench_random(&rng) % 86400000u;
+        fix.latitude = (int32_t) (nmea_bench_random(&rng) % 54000000u) - 27000000;
+        fix.longitude = (int32_t) (nmea_bench_random(&rng) % 108000000u) - 54000000;
+        fix.altitude = (int32_t) (nmea_bench_random(&rng) % 300000u) - 5000;
+        fix.geoSep = (int32_t) (nmea_bench_random(&rng) % 2000u) - 1000;
+        fix.hdop = (uint16_t) (1 + nmea_bench_random(&rng) % 999u);
+        fix.emptyMask = (uint16_t) (1u << NMEA_FIELD_TDGPS | 1u << NMEA_FIELD_DRSID);
+        fix.qIndicator = (uint8_t) (1 + nmea_bench_random(&rng) % 5u);
+        fix.satTracked = (uint8_t) (nmea_bench_random(&rng) % 13u);
+        len += nmea_encode_packed(&fix, capture + len, ENCODE_MAX_SENTENCE_LEN);
+        if (i % BENCH_NOISE_EVERY == BENCH_NOISE_EVERY - 1) {
+            memcpy(capture + len, s_noise, sizeof(s_noise) - 1);
+            len += sizeof(s_noise) - 1;
+        }
+    }
+    printf("PIPELINE BENCHMARK: %lu sentences, %lu bytes, %d byte reads, ring of %d\n", (unsigned long) sentences,
+           (unsigned long) len, CONFIG_GGA_PIPELINE_READ_CHUNK, QUEUE_LEN);
+    //Baseline: the same chunks framed and decoded in one thread
+    benchConsumer_t totals = { 0 };
+    nmea_Scanner_t scanner;
+    nmea_scan_init(&scanner);
+    uint32_t start = (uint32_t) nmea_wall_us();
+    for (size_t pos = 0; pos < len; pos += CONFIG_GGA_PIPELINE_READ_CHUNK) {
+        size_t chunk = (len - pos < CONFIG_GGA_PIPELINE_READ_CHUNK) ? len - pos : CONFIG_GGA_PIPELINE_READ_CHUNK;
+        nmea_scan_feed(&scanner, capture + pos, chunk, benchParse, &totals);
+    }
+    uint32_t us = (uint32_t) nmea_wall_us() - start;
+    printf("PIPELINE ONE THREAD-----------------> %.0f sentences/s, %.1f MB/s, %llu decoded\n",
+           (us != 0) ? (double) totals.sentences * 1e6 / us : 0.0, (us != 0) ? (double) len / us : 0.0,
+           (unsigned long long) totals.sentences);
+    if (totals.sentences != sentences) {
+        printf("ERROR: One-thread baseline did NOT decode every sentence!\n");
+    }
+    //Both stages, once with the default policy and once with stage one waiting for stage two
+    static const nmea_OverloadPolicy_t s_policies[] = { NMEA_OVERLOAD_DROP_NEWEST, NMEA_OVERLOAD_BLOCK };
+    static const char *const s_names[] = { "DROP NEWEST", "BLOCK" };
+    for (size_t p = 0; p < sizeof(s_policies) / sizeof(s_policies[0]); p++) {
+        benchSource_t source = { capture, len, 0 };
+        benchConsumer_t consumed = { 0 };
+        nmea_PipelineConfig_t config = { benchRead, &source, benchConsume, &consumed, s_policies[p], 0 };
+        start = (uint32_t) nmea_wall_us();
+        nmea_Pipeline_t *pipe = nmea_pipeline_start(&config);
+        if (pipe == NULL) {
+            break;
+        }
+        nmea_pipeline_wait(pipe);
+        us = (uint32_t) nmea_wall_us() - start;
+        nmea_PipelineStats_t stats;
+        nmea_pipeline_stats(pipe, &stats);
+        //The rates are of the offered input (every framed sentence and every byte), the decoded count is what was delivered
+        printf("PIPELINE %s OFFERED%.*s> %.0f sentences/s, %.1f MB/s, %llu decoded, %llu dropped\n", s_names[p],
+               (int) (19 - strlen(s_names[p])), "-------------------",
+               (us != 0) ? (double) stats.sentences * 1e6 / us : 0.0, (us != 0) ? (double) len / us : 0.0,
+               (unsigned long long) stats.decoded, (unsigned long long) stats.dropped);
+        printf("PIPELINE LATENCY (MIN/AVG/MAX us)---> %lu/%lu/%lu, ring high water %lu\n", (unsigned long) stats.latencyMinUs,
+               (unsigned long) (stats.decoded != 0 ? stats.latencySumUs / stats.decoded : 0), (unsigned long) stats.latencyMaxUs,
+               (unsigned long) stats.queueHighWater);
+        //Every framed sentence is either decoded or counted as dropped, the block policy loses none
+        if (stats.sentences != sentences || stats.decoded + stats.dropped != sentences || consumed.sentences != stats.decoded
+            || (s_policies[p] == NMEA_OVERLOAD_BLOCK && stats.dropped != 0)) {
+            printf("ERROR: Pipeline sentences are NOT accounted for!\n");
+        }
+        nmea_pipeline_stop(pipe);
+    }
+    free(capture);
+}
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @brief Two stage parsing pipeline for dual-core targets.
+ * -Stage one reads the serial stream, finds the GGA sentences and checks their framing and checksum (gga_scan.h).
+ * -Stage two decodes the fields (nmea_gga_parse_r) and calls the consumer. The stages run as two tasks pinned to
+ * -different cores on the ESP32 (FreeRTOS) or as two threads on Linux (pthreads, pinned when the cores exist) so the
+ * -throughput and latency can be measured on the host. Sentences are handed over through the lock-free queue of
+ * -gga_queue.h, its overload policy decides what is lost when stage two falls behind (by default the newest sentence
+ * -is dropped and counted, stage one never waits for stage two).
+ * -The ring length, the cores, the stack size and the priority are sdkconfig options (Kconfig.projbuild).
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+#include "gga_scan.h"
+#include "gga_queue.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Defaults when the sdkconfig options are not available (host builds outside of ESP-IDF)
+#ifndef CONFIG_GGA_PIPELINE_QUEUE_LEN
+#define CONFIG_GGA_PIPELINE_QUEUE_LEN 32
+#endif
+#ifndef CONFIG_GGA_PIPELINE_FRAMING_CORE
+#define CONFIG_GGA_PIPELINE_FRAMING_CORE 0
+#endif
+#ifndef CONFIG_GGA_PIPELINE_DECODE_CORE
+#define CONFIG_GGA_PIPELINE_DECODE_CORE 1
+#endif
+#ifndef CONFIG_GGA_PIPELINE_STACK_SIZE
+#define CONFIG_GGA_PIPELINE_STACK_SIZE 4096
+#endif
+#ifndef CONFIG_GGA_PIPELINE_PRIORITY
+#define CONFIG_GGA_PIPELINE_PRIORITY 5
+#endif
+#ifndef CONFIG_GGA_PIPELINE_READ_CHUNK
+#define CONFIG_GGA_PIPELINE_READ_CHUNK 256
+#endif
+
+/**
+ * @brief Source of the stream, reads up to cap bytes (blocking) and returns the number of bytes or 0 at the end
+ */
+typedef size_t (*nmea_PipelineSource_t)(void* , char* , size_t );
+
+/**
+ * @brief Consumer of the decoded sentences, called by stage two
+ */
+typedef void (*nmea_PipelineConsumer_t)(void* , const nmea_ParseResult_t* );
+
+/**
+ * @brief Pipeline configuration
+ */
+typedef struct {
+    nmea_PipelineSource_t source;
+    void *sourceArg;
+    nmea_PipelineConsumer_t consumer;
+    void *consumerArg;
+    nmea_OverloadPolicy_t policy;       //overload policy of the ring (0 drops the newest sentence)
+    uint32_t sampleEvery;               //N of NMEA_OVERLOAD_SAMPLE
+} nmea_PipelineConfig_t;
+
+/**
+ * @brief Pipeline statistics
+ */
+typedef struct {
+    uint64_t bytes;                     //bytes read by stage one
+    uint64_t sentences;                 //valid GGA sentences found by stage one
+    uint64_t discardedBytes;            //bytes which are not part of a valid GGA sentence
+    uint64_t dropped;                   //sentences lost by the overload policy (dropped, coalesced or sampled out)
+    uint64_t decoded;                   //sentences decoded by stage two
+    uint64_t latencySumUs;              //handoff latency i.e., from the end of framing to the end of the consumer
+    uint32_t latencyMinUs;
+    uint32_t latencyMaxUs;
+    uint32_t queueHighWater;            //most sentences waiting in the ring at once
+} nmea_PipelineStats_t;
+
+typedef struct nmea_Pipeline nmea_Pipeline_t;
+
+/**
+ * @brief nmea_pipeline_start function creates the ring and starts both stages
+ * @param config is the configuration
+ * @return nmea_Pipeline_t* is the pipeline or NULL on failure
+ */
+nmea_Pipeline_t* nmea_pipeline_start(const nmea_PipelineConfig_t* );
+
+/**
+ * @brief nmea_pipeline_stats function gives a snapshot of the statistics (can be called while running)
+ * @param pipeline is the pipeline
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_pipeline_stats(const nmea_Pipeline_t* , nmea_PipelineStats_t* );
+
+/**
+ * @brief nmea_pipeline_print function prints the statistics to console
+ * @param pipeline is the pipeline
+ * @return void
+ */
+void nmea_pipeline_print(const nmea_Pipeline_t* );
+
+/**
+ * @brief nmea_pipeline_wait function waits until the source has ended and stage two has decoded every sentence
+ * @param pipeline is the pipeline
+ * @return void
+ */
+void nmea_pipeline_wait(nmea_Pipeline_t* );
+
+/**
+ * @brief nmea_pipeline_stop function stops stage one after its current read, waits for both stages and frees the
+ * -pipeline
+ * @param pipeline is the pipeline
+ * @return void
+ */
+void nmea_pipeline_stop(nmea_Pipeline_t* );
+
+#ifdef __linux__
+/**
+ * @brief nmea_pipeline_benchmark function runs a generated capture (with noise lines) through framing and decoding in
+ * -one thread and through both stages of the pipeline, with the drop-newest and the block policy, and prints the
+ * -throughput, the losses and the handoff latency
+ * @param sentences is the number of sentences of the capture
+ * @return void
+ */
+void nmea_pipeline_benchmark(uint32_t );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
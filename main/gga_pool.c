@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "gga_pool.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <semaphore.h>
+#include <time.h>
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#endif
+
+#define POOL_WORDS ((CONFIG_GGA_POOL_SIZE + 31) / 32)   //Words of the free bitmap
+
+_Static_assert(CONFIG_GGA_POOL_SIZE >= 1, "CONFIG_GGA_POOL_SIZE must be at least 1");
+
+struct nmea_Fix {
+    nmea_ParseResult_t result;
+    atomic_uint refs;
+};
+
+static nmea_Fix_t s_records[CONFIG_GGA_POOL_SIZE];
+static atomic_uint s_free[POOL_WORDS];  //bit set when the record is free
+static nmea_PoolPolicy_t s_policy = NMEA_POOL_DROP;
+static uint32_t s_waitMs = 0;
+static bool s_initialized = false;
+
+//Statistics, updated by every task which uses the pool. 32 bits wide, 64-bit atomics take a lock on the ESP32 (Xtensa)
+static atomic_uint s_acquired;
+static atomic_uint s_released;
+static atomic_uint s_exhausted;
+static atomic_uint s_waited;
+static atomic_uint s_invalid;
+static atomic_uint s_overReleased;
+static atomic_uint s_inUse;
+static atomic_uint s_highWater;
+
+//Counts the free records so NMEA_POOL_WAIT can block until a release, statically allocated
+#ifdef __linux__
+static sem_t s_available;
+#else
+static StaticSemaphore_t s_availableBuffer;
+static SemaphoreHandle_t s_available;
+#endif
+
+/**
+ * @brief takeRecord function clears the lowest free bit of the bitmap
+ * @param void
+ * @return nmea_Fix_t* is the record or NULL if every record is in use
+ */
+static nmea_Fix_t* takeRecord(void)
+{
+    for (int w = 0; w < POOL_WORDS; w++) {
+        unsigned int bits = atomic_load_explicit(&s_free[w], memory_order_acquire);
+        while (bits != 0) {
+            unsigned int bit = bits & (0u - bits);
+            if (atomic_compare_exchange_weak_explicit(&s_free[w], &bits, bits & ~bit, memory_order_acquire, memory_order_acquire)) {
+                return &s_records[w * 32 + __builtin_ctz(bit)];
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief waitForRelease function waits for a free record (NMEA_POOL_WAIT)
+ * @param timeoutMs is the longest wait in ms
+ * @return bool is true if a free record is reserved for the caller
+ */
+static bool waitForRelease(uint32_t timeoutMs)
+{
+#ifdef __linux__
+    if (timeoutMs == 0) {
+        return sem_trywait(&s_available) == 0;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000u;
+    deadline.tv_nsec += (long) (timeoutMs % 1000u) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    int status;
+    while ((status = sem_timedwait(&s_available, &deadline)) != 0 && errno == EINTR) {
+    }
+    return status == 0;
+#else
+    return xSemaphoreTake(s_available, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+#endif
+}
+
+/**
+ * @brief giveBack function puts a record without references back into the pool
+ * @param fix is the record
+ * @return void
+ */
+static void giveBack(nmea_Fix_t *fix)
+{
+    size_t index = (size_t) (fix - s_records);
+    atomic_fetch_or_explicit(&s_free[index / 32], 1u << (index % 32), memory_order_release);
+    atomic_fetch_sub_explicit(&s_inUse, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s_released, 1, memory_order_relaxed);
+    if (s_policy == NMEA_POOL_WAIT) {
+#ifdef __linux__
+        sem_post(&s_available);
+#else
+        xSemaphoreGive(s_available);
+#endif
+    }
+}
+
+/**
+ * @brief nmea_pool_init function sets the policy and gives every record back to the pool, call it before the
+ * -first acquire and while no record is in use
+ * @param policy is the behaviour when the pool is exhausted
+ * @param waitMs is the longest wait for a release in ms (NMEA_POOL_WAIT)
+ * @return void
+ */
+void nmea_pool_init(nmea_PoolPolicy_t policy, uint32_t waitMs)
+{
+    for (int w = 0; w < POOL_WORDS; w++) {
+        int count = CONFIG_GGA_POOL_SIZE - w * 32;
+        atomic_store(&s_free[w], (count >= 32) ? UINT32_MAX : (1u << count) - 1u);
+    }
+    for (int i = 0; i < CONFIG_GGA_POOL_SIZE; i++) {
+        atomic_store(&s_records[i].refs, 0);
+    }
+    atomic_store(&s_acquired, 0);
+    atomic_store(&s_released, 0);
+    atomic_store(&s_exhausted, 0);
+    atomic_store(&s_waited, 0);
+    atomic_store(&s_invalid, 0);
+    atomic_store(&s_overReleased, 0);
+    atomic_store(&s_inUse, 0);
+    atomic_store(&s_highWater, 0);
+#ifdef __linux__
+    if (s_initialized) {
+        sem_destroy(&s_available);
+    }
+    sem_init(&s_available, 0, CONFIG_GGA_POOL_SIZE);
+#else
+    //The semaphore of an earlier init is deleted first, it is created again in the same buffer with a full count
+    if (s_initialized) {
+        vSemaphoreDelete(s_available);
+    }
+    s_available = xSemaphoreCreateCountingStatic(CONFIG_GGA_POOL_SIZE, CONFIG_GGA_POOL_SIZE, &s_availableBuffer);
+#endif
+    s_policy = policy;
+    s_waitMs = waitMs;
+    s_initialized = true;
+}
+
+/**
+ * @brief nmea_pool_acquire function takes a free record with one reference, to be filled by the caller
+ * @param void
+ * @return nmea_Fix_t* is the record or NULL if the pool is exhausted
+ */
+nmea_Fix_t* nmea_pool_acquire(void)
+{
+    if (!s_initialized) {
+        printf("ERROR: Fix record pool is not initialized!\n");
+        return NULL;
+    }
+    if (s_policy == NMEA_POOL_WAIT) {
+        //The semaphore reserves a record, the bitmap then always has a free bit
+        if (!waitForRelease(0)) {
+            atomic_fetch_add_explicit(&s_waited, 1, memory_order_relaxed);
+            if (!waitForRelease(s_waitMs)) {
+                atomic_fetch_add_explicit(&s_exhausted, 1, memory_order_relaxed);
+                return NULL;
+            }
+        }
+    }
+    nmea_Fix_t *fix = takeRecord();
+    if (fix == NULL) {
+        atomic_fetch_add_explicit(&s_exhausted, 1, memory_order_relaxed);
+        return NULL;
+    }
+    atomic_store_explicit(&fix->refs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s_acquired, 1, memory_order_relaxed);
+    unsigned int inUse = atomic_fetch_add_explicit(&s_inUse, 1, memory_order_relaxed) + 1;
+    unsigned int highWater = atomic_load_explicit(&s_highWater, memory_order_relaxed);
+    while (inUse > highWater && !atomic_compare_exchange_weak_explicit(&s_highWater, &highWater, inUse,
+            memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return fix;
+}
+
+/**
+ * @brief nmea_pool_parse function decodes a sentence directly into a free record
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param refs is the number of references i.e., the number of consumers which release the record (at least 1)
+ * @return nmea_Fix_t* is the record or NULL if the pool is exhausted or the sentence is not a valid GGA sentence
+ */
+nmea_Fix_t* nmea_pool_parse(const char *SENTENCE, size_t len, uint32_t refs)
+{
+    nmea_Fix_t *fix = nmea_pool_acquire();
+    if (fix == NULL) {
+        return NULL;
+    }
+    if (!nmea_gga_parse_r(SENTENCE, len, &fix->result)) {
+        atomic_fetch_add_explicit(&s_invalid, 1, memory_order_relaxed);
+        atomic_store_explicit(&fix->refs, 0, memory_order_relaxed);
+        giveBack(fix);
+        return NULL;
+    }
+    //Release order so the consumers which get the handle through a queue see the decoded data
+    atomic_store_explicit(&fix->refs, (refs != 0) ? refs : 1, memory_order_release);
+    return fix;
+}
+
+/**
+ * @brief nmea_fix_data function gives the parse result of a record to fill it (only before it is shared)
+ * @param fix is the record
+ * @return nmea_ParseResult_t* is the parse result
+ */
+nmea_ParseResult_t* nmea_fix_data(nmea_Fix_t *fix)
+{
+    return &fix->result;
+}
+
+/**
+ * @brief nmea_fix_result function gives the parse result of a record (valid while a reference is held)
+ * @param fix is the record
+ * @return const nmea_ParseResult_t* is the parse result
+ */
+const nmea_ParseResult_t* nmea_fix_result(const nmea_Fix_t *fix)
+{
+    return &fix->result;
+}
+
+/**
+ * @brief nmea_fix_retain function adds one reference to a record e.g., to hand it over to one more task
+ * @param fix is the record (the caller must hold a reference)
+ * @return void
+ */
+void nmea_fix_retain(nmea_Fix_t *fix)
+{
+    atomic_fetch_add_explicit(&fix->refs, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief nmea_fix_release function removes one reference, the last release gives the record back to the pool
+ * @param fix is the record (NULL is ignored)
+ * @return void
+ */
+void nmea_fix_release(nmea_Fix_t *fix)
+{
+    if (fix == NULL) {
+        return;
+    }
+    unsigned int refs = atomic_load_explicit(&fix->refs, memory_order_relaxed);
+    do {
+        if (refs == 0) {
+            atomic_fetch_add_explicit(&s_overReleased, 1, memory_order_relaxed);
+            printf("ERROR: Fix record released without a reference!\n");
+            return;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&fix->refs, &refs, refs - 1, memory_order_acq_rel, memory_order_relaxed));
+    if (refs == 1) {
+        giveBack(fix);
+    }
+}
+
+/**
+ * @brief nmea_pool_stats function gives a snapshot of the pool statistics
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_pool_stats(nmea_PoolStats_t *stats)
+{
+    stats->acquired = atomic_load_explicit(&s_acquired, memory_order_relaxed);
+    stats->released = atomic_load_explicit(&s_released, memory_order_relaxed);
+    stats->exhausted = atomic_load_explicit(&s_exhausted, memory_order_relaxed);
+    stats->waited = atomic_load_explicit(&s_waited, memory_order_relaxed);
+    stats->invalid = atomic_load_explicit(&s_invalid, memory_order_relaxed);
+    stats->overReleased = atomic_load_explicit(&s_overReleased, memory_order_relaxed);
+    stats->inUse = atomic_load_explicit(&s_inUse, memory_order_relaxed);
+    stats->highWater = atomic_load_explicit(&s_highWater, memory_order_relaxed);
+}
+
+/**
+ * @brief nmea_pool_print function prints the pool statistics to console
+ * @param void
+ * @return void
+ */
+void nmea_pool_print(void)
+{
+    nmea_PoolStats_t stats;
+    nmea_pool_stats(&stats);
+    printf("POOL RECORDS IN USE/HIGH WATER------> %lu/%lu of %d\n", (unsigned long) stats.inUse,
+           (unsigned long) stats.highWater, CONFIG_GGA_POOL_SIZE);
+    printf("POOL ACQUIRED/RELEASED--------------> %lu/%lu\n", (unsigned long) stats.acquired,
+           (unsigned long) stats.released);
+    printf("POOL EXHAUSTED----------------------> %lu\n", (unsigned long) stats.exhausted);
+    printf("POOL WAITED FOR A RELEASE-----------> %lu\n", (unsigned long) stats.waited);
+    printf("POOL INVALID SENTENCES--------------> %lu\n", (unsigned long) stats.invalid);
+    printf("POOL RELEASES WITHOUT REFERENCE-----> %lu\n", (unsigned long) stats.overReleased);
+}
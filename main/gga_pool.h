@@ -0,0 +1,122 @@
+/**
+ * @brief Pool of reference counted fix records for zero-copy fan-out between tasks.
+ * -The records are statically allocated (CONFIG_GGA_POOL_SIZE) and a sentence is decoded directly into a free
+ * -record. The parsing task gives the record one reference per consumer, every consumer reads the result through
+ * -the handle and releases it, and the record goes back to the pool with the last release. A record can also be
+ * -retained again to hand it over to one more task. Free records are found in an atomic bitmap and the reference
+ * -counts are atomic, so nothing is copied or allocated. When the pool is exhausted the policy given to
+ * -nmea_pool_init decides between failing at once and waiting for a release, both are counted.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Default when the sdkconfig option is not available (host builds outside of ESP-IDF)
+#ifndef CONFIG_GGA_POOL_SIZE
+#define CONFIG_GGA_POOL_SIZE 16
+#endif
+
+/**
+ * @brief Behaviour when every record is in use
+ */
+typedef enum {
+    NMEA_POOL_DROP = 0,                 //fail at once, the sentence is dropped
+    NMEA_POOL_WAIT                      //wait up to the timeout for a release, then fail
+} nmea_PoolPolicy_t;
+
+/**
+ * @brief Pool statistics, the counters are 32 bits wide so that they are lock-free atomics on the ESP32 and wrap around
+ */
+typedef struct {
+    uint32_t acquired;                  //records handed out
+    uint32_t released;                  //records given back
+    uint32_t exhausted;                 //records not handed out because the pool was exhausted
+    uint32_t waited;                    //acquires which had to wait for a release (NMEA_POOL_WAIT)
+    uint32_t invalid;                   //sentences which were not GGA, their record was given back at once
+    uint32_t overReleased;              //releases of a record without a reference (bug in a consumer)
+    uint32_t inUse;                     //records in use now
+    uint32_t highWater;                 //most records in use at once
+} nmea_PoolStats_t;
+
+typedef struct nmea_Fix nmea_Fix_t;
+
+/**
+ * @brief nmea_pool_init function sets the policy and gives every record back to the pool, call it before the
+ * -first acquire and while no record is in use
+ * @param policy is the behaviour when the pool is exhausted
+ * @param waitMs is the longest wait for a release in ms (NMEA_POOL_WAIT)
+ * @return void
+ */
+void nmea_pool_init(nmea_PoolPolicy_t , uint32_t );
+
+/**
+ * @brief nmea_pool_parse function decodes a sentence directly into a free record
+ * @param SENTENCE is the NMEA sentence (the trailing "\r\n" is optional and does not need to be null terminated)
+ * @param len is the length of the sentence in bytes
+ * @param refs is the number of references i.e., the number of consumers which release the record (at least 1)
+ * @return nmea_Fix_t* is the record or NULL if the pool is exhausted or the sentence is not a valid GGA sentence
+ */
+nmea_Fix_t* nmea_pool_parse(const char* , size_t , uint32_t );
+
+/**
+ * @brief nmea_pool_acquire function takes a free record with one reference, to be filled by the caller
+ * @param void
+ * @return nmea_Fix_t* is the record or NULL if the pool is exhausted
+ */
+nmea_Fix_t* nmea_pool_acquire(void);
+
+/**
+ * @brief nmea_fix_data function gives the parse result of a record to fill it (only before it is shared)
+ * @param fix is the record
+ * @return nmea_ParseResult_t* is the parse result
+ */
+nmea_ParseResult_t* nmea_fix_data(nmea_Fix_t* );
+
+/**
+ * @brief nmea_fix_result function gives the parse result of a record (valid while a reference is held)
+ * @param fix is the record
+ * @return const nmea_ParseResult_t* is the parse result
+ */
+const nmea_ParseResult_t* nmea_fix_result(const nmea_Fix_t* );
+
+/**
+ * @brief nmea_fix_retain function adds one reference to a record e.g., to hand it over to one more task
+ * @param fix is the record (the caller must hold a reference)
+ * @return void
+ */
+void nmea_fix_retain(nmea_Fix_t* );
+
+/**
+ * @brief nmea_fix_release function removes one reference, the last release gives the record back to the pool
+ * @param fix is the record (NULL is ignored)
+ * @return void
+ */
+void nmea_fix_release(nmea_Fix_t* );
+
+/**
+ * @brief nmea_pool_stats function gives a snapshot of the pool statistics
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_pool_stats(nmea_PoolStats_t* );
+
+/**
+ * @brief nmea_pool_print function prints the pool statistics to console
+ * @param void
+ * @return void
+ */
+void nmea_pool_print(void);
+
+#ifdef __cplusplus
+}
+#endif
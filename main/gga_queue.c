@@ -0,0 +1,531 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "gga_queue.h"
+#include "gga_bench.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#endif
+
+static const char *const s_policyNames[NMEA_OVERLOAD_POLICY_COUNT] = {
+    "DROP NEWEST", "DROP OLDEST", "BLOCK", "KEEP LATEST", "SAMPLE"
+};
+
+/**
+ * @brief Latest sentence of a receiver (NMEA_OVERLOAD_KEEP_LATEST), written under a seqlock
+ */
+typedef struct {
+    atomic_uint seq;                    //odd while the producer writes the sentence
+    nmea_QueueItem_t item;
+} queueMailbox_t;
+
+struct nmea_Queue {
+    nmea_OverloadPolicy_t policy;
+    uint32_t capacity;
+    uint32_t receivers;
+    uint32_t sampleEvery;
+    nmea_QueueItem_t *slot;             //capacity slots
+    atomic_size_t head;                 //written by the producer
+    atomic_size_t tail;                 //written by the consumer (and by the producer for NMEA_OVERLOAD_DROP_OLDEST)
+    queueMailbox_t *mailbox;            //receivers mailboxes (NMEA_OVERLOAD_KEEP_LATEST)
+    atomic_bool *pending;               //the receiver id waits in ids
+    uint32_t *ids;                      //receivers waiting for the consumer, at most one entry per receiver
+    atomic_size_t idHead;
+    atomic_size_t idTail;
+    unsigned int *delivered;            //consumer only: seq of the latest sentence taken per receiver
+    uint32_t *sampleCount;              //producer only: sentences per receiver (NMEA_OVERLOAD_SAMPLE)
+    atomic_bool producerWaiting;        //NMEA_OVERLOAD_BLOCK: the producer waits for a free slot
+#ifdef __linux__
+    sem_t space;
+#else
+    StaticSemaphore_t spaceBuffer;
+    SemaphoreHandle_t space;
+#endif
+    //Statistics, every counter is written by one side only
+    atomic_uint_fast64_t pushed;
+    atomic_uint_fast64_t popped;
+    atomic_uint_fast64_t droppedNewest;
+    atomic_uint_fast64_t droppedOldest;
+    atomic_uint_fast64_t coalesced;
+    atomic_uint_fast64_t sampledOut;
+    atomic_uint_fast64_t blocked;
+    atomic_uint_fast64_t invalid;
+    atomic_uint_fast32_t highWater;
+};
+
+/**
+ * @brief fillItem function copies a sentence into an item
+ * @param item is the item
+ * @param receiver is the receiver
+ * @param sentence is the sentence
+ * @param len is the length of the sentence
+ * @param timeUs is the time of the sentence
+ * @return void
+ */
+static inline void fillItem(nmea_QueueItem_t *item, uint32_t receiver, const char *sentence, size_t len, uint32_t timeUs)
+{
+    item->receiver = receiver;
+    item->timeUs = timeUs;
+    item->len = (uint32_t) len;
+    memcpy(item->data, sentence, len);
+}
+
+/**
+ * @brief updateHighWater function records the depth after a push (producer only)
+ * @param queue is the queue
+ * @param depth is the depth
+ * @return void
+ */
+static inline void updateHighWater(nmea_Queue_t *queue, size_t depth)
+{
+    if (depth > atomic_load_explicit(&queue->highWater, memory_order_relaxed)) {
+        atomic_store_explicit(&queue->highWater, (uint32_t) depth, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief waitForSpace function blocks the producer until the consumer has freed a slot (NMEA_OVERLOAD_BLOCK)
+ * @param queue is the queue
+ * @param head is the next slot of the producer
+ * @return void
+ */
+static void waitForSpace(nmea_Queue_t *queue, size_t head)
+{
+    atomic_fetch_add_explicit(&queue->blocked, 1, memory_order_relaxed);
+    while (head - atomic_load_explicit(&queue->tail, memory_order_acquire) >= queue->capacity) {
+        atomic_store(&queue->producerWaiting, true);
+        //Checked again after the flag is set so a slot freed in between is not missed
+        if (head - atomic_load(&queue->tail) < queue->capacity) {
+            atomic_store(&queue->producerWaiting, false);
+            return;
+        }
+#ifdef __linux__
+        while (sem_wait(&queue->space) != 0) {
+        }
+#else
+        xSemaphoreTake(queue->space, portMAX_DELAY);
+#endif
+    }
+}
+
+/**
+ * @brief pushLatest function replaces the waiting sentence of the receiver (NMEA_OVERLOAD_KEEP_LATEST)
+ * @param queue is the queue
+ * @param receiver is the receiver
+ * @param sentence is the sentence
+ * @param len is the length of the sentence
+ * @param timeUs is the time of the sentence
+ * @return void
+ */
+static void pushLatest(nmea_Queue_t *queue, uint32_t receiver, const char *sentence, size_t len, uint32_t timeUs)
+{
+    queueMailbox_t *box = &queue->mailbox[receiver];
+    unsigned int seq = atomic_load_explicit(&box->seq, memory_order_relaxed);
+    atomic_store_explicit(&box->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    fillItem(&box->item, receiver, sentence, len, timeUs);
+    atomic_store_explicit(&box->seq, seq + 2, memory_order_release);
+    //The receiver is queued once, while it waits a newer sentence only replaces the mailbox (counted by popLatest)
+    if (atomic_exchange(&queue->pending[receiver], true)) {
+        return;
+    }
+    size_t idHead = atomic_load_explicit(&queue->idHead, memory_order_relaxed);
+    queue->ids[idHead % queue->receivers] = receiver;
+    atomic_store_explicit(&queue->idHead, idHead + 1, memory_order_release);
+    updateHighWater(queue, idHead + 1 - atomic_load_explicit(&queue->idTail, memory_order_acquire));
+}
+
+/**
+ * @brief popLatest function takes the sentence of the next waiting receiver (NMEA_OVERLOAD_KEEP_LATEST)
+ * @param queue is the queue
+ * @param item holds the sentence
+ * @return bool is false if no receiver waits
+ */
+static bool popLatest(nmea_Queue_t *queue, nmea_QueueItem_t *item)
+{
+    for (;;) {
+        size_t idTail = atomic_load_explicit(&queue->idTail, memory_order_relaxed);
+        if (idTail == atomic_load_explicit(&queue->idHead, memory_order_acquire)) {
+            return false;
+        }
+        uint32_t receiver = queue->ids[idTail % queue->receivers];
+        atomic_store_explicit(&queue->idTail, idTail + 1, memory_order_release);
+        //Cleared before the copy so a sentence written from now on queues the receiver again
+        atomic_store(&queue->pending[receiver], false);
+        queueMailbox_t *box = &queue->mailbox[receiver];
+        unsigned int seq;
+        do {
+            seq = atomic_load_explicit(&box->seq, memory_order_acquire);
+            if (seq & 1u) continue;
+            memcpy(item, &box->item, sizeof(*item));
+            atomic_thread_fence(memory_order_acquire);
+        } while ((seq & 1u) || atomic_load_explicit(&box->seq, memory_order_relaxed) != seq);
+        //The receiver can be queued again after this copy already got its newest sentence
+        if (seq == queue->delivered[receiver]) {
+            continue;
+        }
+        //Every push adds 2 to seq, the sentences between the last one taken and this one were replaced, also those
+        //-replaced while the receiver was not pending any more
+        atomic_fetch_add_explicit(&queue->coalesced, (seq - queue->delivered[receiver]) / 2u - 1u, memory_order_relaxed);
+        queue->delivered[receiver] = seq;
+        return true;
+    }
+}
+
+/**
+ * @brief nmea_queue_create function allocates a queue
+ * @param capacity is the number of slots (power of 2)
+ * @param receivers is the number of receivers (receiver ids 0 to receivers - 1)
+ * @param policy is the overload policy
+ * @param sampleEvery is N of NMEA_OVERLOAD_SAMPLE (0 and 1 queue every sentence)
+ * @return nmea_Queue_t* is the queue or NULL on failure
+ */
+nmea_Queue_t* nmea_queue_create(uint32_t capacity, uint32_t receivers, nmea_OverloadPolicy_t policy, uint32_t sampleEvery)
+{
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0 || receivers == 0 || policy >= NMEA_OVERLOAD_POLICY_COUNT) {
+        printf("ERROR: Queue capacity must be a power of 2 with at least one receiver!\n");
+        return NULL;
+    }
+    nmea_Queue_t *queue = calloc(1, sizeof(nmea_Queue_t));
+    if (queue == NULL) {
+        printf("ERROR: Queue allocation failed!\n");
+        return NULL;
+    }
+    queue->policy = policy;
+    queue->capacity = capacity;
+    queue->receivers = receivers;
+    queue->sampleEvery = (sampleEvery != 0) ? sampleEvery : 1;
+    queue->slot = calloc(capacity, sizeof(nmea_QueueItem_t));
+    queue->mailbox = calloc(receivers, sizeof(queueMailbox_t));
+    queue->pending = calloc(receivers, sizeof(atomic_bool));
+    queue->ids = calloc(receivers, sizeof(uint32_t));
+    queue->delivered = calloc(receivers, sizeof(unsigned int));
+    queue->sampleCount = calloc(receivers, sizeof(uint32_t));
+#ifdef __linux__
+    sem_init(&queue->space, 0, 0);
+#else
+    queue->space = xSemaphoreCreateBinaryStatic(&queue->spaceBuffer);
+#endif
+    if (queue->slot == NULL || queue->mailbox == NULL || queue->pending == NULL || queue->ids == NULL
+            || queue->delivered == NULL || queue->sampleCount == NULL) {
+        printf("ERROR: Queue allocation failed!\n");
+        nmea_queue_destroy(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+/**
+ * @brief nmea_queue_push function hands a sentence to the consumer, producer side (one task)
+ * @param queue is the queue
+ * @param receiver is the receiver of the sentence
+ * @param sentence is the sentence
+ * @param len is the length of the sentence (at most NMEA_MAX_SENTENCE_LEN)
+ * @param timeUs is the time of the sentence e.g., the end of framing, given back with the sentence
+ * @return bool is true if the sentence is waiting in the queue (a sentence dropped by the policy gives false)
+ */
+bool nmea_queue_push(nmea_Queue_t *queue, uint32_t receiver, const char *sentence, size_t len, uint32_t timeUs)
+{
+    atomic_fetch_add_explicit(&queue->pushed, 1, memory_order_relaxed);
+    if (receiver >= queue->receivers || len > NMEA_MAX_SENTENCE_LEN) {
+        atomic_fetch_add_explicit(&queue->invalid, 1, memory_order_relaxed);
+        return false;
+    }
+    if (queue->policy == NMEA_OVERLOAD_KEEP_LATEST) {
+        pushLatest(queue, receiver, sentence, len, timeUs);
+        return true;
+    }
+    if (queue->policy == NMEA_OVERLOAD_SAMPLE && queue->sampleCount[receiver]++ % queue->sampleEvery != 0) {
+        atomic_fetch_add_explicit(&queue->sampledOut, 1, memory_order_relaxed);
+        return false;
+    }
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head - tail >= queue->capacity) {
+        if (queue->policy == NMEA_OVERLOAD_BLOCK) {
+            waitForSpace(queue, head);
+        }
+        else if (queue->policy == NMEA_OVERLOAD_DROP_OLDEST) {
+            //If the consumer took the oldest sentence meanwhile the slot is free anyway
+            if (atomic_compare_exchange_strong_explicit(&queue->tail, &tail, tail + 1, memory_order_acq_rel, memory_order_acquire)) {
+                atomic_fetch_add_explicit(&queue->droppedOldest, 1, memory_order_relaxed);
+            }
+        }
+        else {
+            atomic_fetch_add_explicit(&queue->droppedNewest, 1, memory_order_relaxed);
+            return false;
+        }
+    }
+    fillItem(&queue->slot[head & (queue->capacity - 1)], receiver, sentence, len, timeUs);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    updateHighWater(queue, head + 1 - atomic_load_explicit(&queue->tail, memory_order_acquire));
+    return true;
+}
+
+/**
+ * @brief nmea_queue_pop function takes the next sentence, consumer side (one task), does not wait
+ * @param queue is the queue
+ * @param item holds the sentence
+ * @return bool is false if the queue is empty
+ */
+bool nmea_queue_pop(nmea_Queue_t *queue, nmea_QueueItem_t *item)
+{
+    if (queue->policy == NMEA_OVERLOAD_KEEP_LATEST) {
+        if (!popLatest(queue, item)) {
+            return false;
+        }
+        atomic_fetch_add_explicit(&queue->popped, 1, memory_order_relaxed);
+        return true;
+    }
+    for (;;) {
+        size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        if (tail == atomic_load_explicit(&queue->head, memory_order_acquire)) {
+            return false;
+        }
+        memcpy(item, &queue->slot[tail & (queue->capacity - 1)], sizeof(*item));
+        if (queue->policy != NMEA_OVERLOAD_DROP_OLDEST) {
+            atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+            break;
+        }
+        //The producer may have dropped this slot and be writing it again, the copy only counts if tail did not move
+        if (atomic_compare_exchange_strong_explicit(&queue->tail, &tail, tail + 1, memory_order_acq_rel, memory_order_acquire)) {
+            break;
+        }
+    }
+    atomic_fetch_add_explicit(&queue->popped, 1, memory_order_relaxed);
+    if (queue->policy == NMEA_OVERLOAD_BLOCK && atomic_exchange(&queue->producerWaiting, false)) {
+#ifdef __linux__
+        sem_post(&queue->space);
+#else
+        xSemaphoreGive(queue->space);
+#endif
+    }
+    return true;
+}
+
+/**
+ * @brief nmea_queue_depth function gives the number of waiting sentences (either side)
+ * @param queue is the queue
+ * @return uint32_t is the number of waiting sentences
+ */
+uint32_t nmea_queue_depth(const nmea_Queue_t *queue)
+{
+    nmea_Queue_t *q = (nmea_Queue_t *) queue;
+    if (q->policy == NMEA_OVERLOAD_KEEP_LATEST) {
+        size_t idTail = atomic_load_explicit(&q->idTail, memory_order_acquire);
+        return (uint32_t) (atomic_load_explicit(&q->idHead, memory_order_acquire) - idTail);
+    }
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    return (uint32_t) (atomic_load_explicit(&q->head, memory_order_acquire) - tail);
+}
+
+/**
+ * @brief nmea_queue_stats function gives a snapshot of the statistics (either side)
+ * @param queue is the queue
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_queue_stats(const nmea_Queue_t *queue, nmea_QueueStats_t *stats)
+{
+    nmea_Queue_t *q = (nmea_Queue_t *) queue;
+    stats->pushed = atomic_load_explicit(&q->pushed, memory_order_relaxed);
+    stats->popped = atomic_load_explicit(&q->popped, memory_order_relaxed);
+    stats->droppedNewest = atomic_load_explicit(&q->droppedNewest, memory_order_relaxed);
+    stats->droppedOldest = atomic_load_explicit(&q->droppedOldest, memory_order_relaxed);
+    stats->coalesced = atomic_load_explicit(&q->coalesced, memory_order_relaxed);
+    stats->sampledOut = atomic_load_explicit(&q->sampledOut, memory_order_relaxed);
+    stats->blocked = atomic_load_explicit(&q->blocked, memory_order_relaxed);
+    stats->invalid = atomic_load_explicit(&q->invalid, memory_order_relaxed);
+    stats->depth = nmea_queue_depth(queue);
+    stats->highWater = (uint32_t) atomic_load_explicit(&q->highWater, memory_order_relaxed);
+}
+
+/**
+ * @brief nmea_queue_print function prints the statistics to console
+ * @param queue is the queue
+ * @return void
+ */
+void nmea_queue_print(const nmea_Queue_t *queue)
+{
+    nmea_QueueStats_t stats;
+    nmea_queue_stats(queue, &stats);
+    uint32_t limit = (queue->policy == NMEA_OVERLOAD_KEEP_LATEST) ? queue->receivers : queue->capacity;
+    printf("QUEUE OVERLOAD POLICY---------------> %s\n", s_policyNames[queue->policy]);
+    printf("QUEUE PUSHED/POPPED-----------------> %llu/%llu\n", (unsigned long long) stats.pushed,
+           (unsigned long long) stats.popped);
+    printf("QUEUE DEPTH/HIGH WATER--------------> %lu/%lu of %lu\n", (unsigned long) stats.depth,
+           (unsigned long) stats.highWater, (unsigned long) limit);
+    printf("QUEUE DROPPED NEWEST/OLDEST---------> %llu/%llu\n", (unsigned long long) stats.droppedNewest,
+           (unsigned long long) stats.droppedOldest);
+    printf("QUEUE COALESCED/SAMPLED OUT---------> %llu/%llu\n", (unsigned long long) stats.coalesced,
+           (unsigned long long) stats.sampledOut);
+    printf("QUEUE BLOCKED PUSHES/INVALID--------> %llu/%llu\n", (unsigned long long) stats.blocked,
+           (unsigned long long) stats.invalid);
+}
+
+/**
+ * @brief nmea_queue_destroy function frees the queue, no task may use it any more
+ * @param queue is the queue
+ * @return void
+ */
+void nmea_queue_destroy(nmea_Queue_t *queue)
+{
+    if (queue == NULL) {
+        return;
+    }
+#ifdef __linux__
+    sem_destroy(&queue->space);
+#endif
+    free(queue->slot);
+    free(queue->mailbox);
+    free(queue->pending);
+    free(queue->ids);
+    free(queue->delivered);
+    free(queue->sampleCount);
+    free(queue);
+}
+
+#ifdef __linux__
+/**
+ * @brief Shared state of the stress test threads
+ */
+typedef struct {
+    nmea_Queue_t *queue;
+    uint32_t receivers;
+    uint32_t sentences;
+    uint32_t producerUs;
+    uint32_t consumerUs;
+    atomic_bool producerDone;
+    uint32_t *ages;                     //age of every sentence taken by the consumer
+    uint32_t taken;
+} stressState_t;
+
+/**
+ * @brief spinUntil function busy-waits until a time, sleeping would be too coarse for microsecond steps
+ * @param timeUs is the time
+ * @return void
+ */
+static void spinUntil(uint32_t timeUs)
+{
+    while ((int32_t) ((uint32_t) nmea_wall_us() - timeUs) < 0) {
+    }
+}
+
+/**
+ * @brief stressProducer function sends the sentences of the receivers in turn at a fixed rate
+ * @param arg is the stress state
+ * @return void* is NULL
+ */
+static void* stressProducer(void *arg)
+{
+    static const char s_sentence[] = "$GPGGA,002153.000,3342.6618,N,11751.3858,W,1,10,1.2,27.0,M,-34.2,M,,0000*5E";
+    stressState_t *state = arg;
+    uint32_t start = (uint32_t) nmea_wall_us();
+    for (uint32_t i = 0; i < state->sentences; i++) {
+        spinUntil(start + i * state->producerUs);
+        nmea_queue_push(state->queue, i % state->receivers, s_sentence, sizeof(s_sentence) - 1, (uint32_t) nmea_wall_us());
+    }
+    atomic_store(&state->producerDone, true);
+    return NULL;
+}
+
+/**
+ * @brief stressConsumer function takes the sentences, records their age and spends consumerUs on each
+ * @param arg is the stress state
+ * @return void* is NULL
+ */
+static void* stressConsumer(void *arg)
+{
+    stressState_t *state = arg;
+    nmea_QueueItem_t item;
+    for (;;) {
+        if (!nmea_queue_pop(state->queue, &item)) {
+            if (atomic_load(&state->producerDone) && nmea_queue_depth(state->queue) == 0) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        uint32_t now = (uint32_t) nmea_wall_us();
+        state->ages[state->taken++] = now - item.timeUs;
+        spinUntil(now + state->consumerUs);
+    }
+    return NULL;
+}
+
+/**
+ * @brief compareAges function orders two ages for qsort
+ * @param a is the first age
+ * @param b is the second age
+ * @return int is the order
+ */
+static int compareAges(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t*) a;
+    uint32_t y = *(const uint32_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief nmea_queue_stress function runs a producer thread which is faster than the consumer thread and prints the
+ * -age of the fixes when they reach the consumer (50th/99th percentile and maximum) together with the losses
+ * @param policy is the overload policy
+ * @param sampleEvery is N of NMEA_OVERLOAD_SAMPLE
+ * @param receivers is the number of receivers, the producer sends their sentences in turn
+ * @param sentences is the number of sentences sent by the producer
+ * @param producerUs is the time between two sentences of the producer
+ * @param consumerUs is the time the consumer spends on one sentence (more than producerUs for an overload)
+ * @return void
+ */
+void nmea_queue_stress(nmea_OverloadPolicy_t policy, uint32_t sampleEvery, uint32_t receivers, uint32_t sentences,
+                       uint32_t producerUs, uint32_t consumerUs)
+{
+    stressState_t state = { 0 };
+    state.queue = nmea_queue_create(32, receivers, policy, sampleEvery);
+    state.ages = malloc((size_t) (sentences + 1) * sizeof(uint32_t));
+    if (state.queue == NULL || state.ages == NULL || sentences == 0) {
+        printf("ERROR: Queue stress test could not be started!\n");
+        nmea_queue_destroy(state.queue);
+        free(state.ages);
+        return;
+    }
+    state.receivers = receivers;
+    state.sentences = sentences;
+    state.producerUs = producerUs;
+    state.consumerUs = consumerUs;
+    pthread_t producer;
+    pthread_t consumer;
+    uint32_t start = (uint32_t) nmea_wall_us();
+    pthread_create(&consumer, NULL, stressConsumer, &state);
+    pthread_create(&producer, NULL, stressProducer, &state);
+    pthread_join(producer, NULL);
+    uint32_t producerEnd = (uint32_t) nmea_wall_us();
+    pthread_join(consumer, NULL);
+    nmea_QueueStats_t stats;
+    nmea_queue_stats(state.queue, &stats);
+    //Every sentence is either taken, still waiting or counted by the policy
+    if (stats.pushed != sentences || stats.popped != state.taken || stats.pushed != stats.popped + stats.depth
+            + stats.droppedNewest + stats.droppedOldest + stats.coalesced + stats.sampledOut + stats.invalid) {
+        printf("ERROR: Queue stress sentences are NOT accounted for!\n");
+    }
+    qsort(state.ages, state.taken, sizeof(uint32_t), compareAges);
+    printf("QUEUE STRESS: %lu sentences of %lu receivers, one every %lu us, consumer %lu us per sentence\n",
+           (unsigned long) sentences, (unsigned long) receivers, (unsigned long) producerUs, (unsigned long) consumerUs);
+    nmea_queue_print(state.queue);
+    printf("QUEUE PRODUCER TIME-----------------> %lu us (%lu us planned)\n", (unsigned long) (producerEnd - start),
+           (unsigned long) (sentences * producerUs));
+    if (state.taken != 0) {
+        printf("QUEUE FIX AGE (P50/P99/MAX us)------> %lu/%lu/%lu\n", (unsigned long) state.ages[state.taken / 2],
+               (unsigned long) state.ages[(size_t) state.taken * 99 / 100], (unsigned long) state.ages[state.taken - 1]);
+    }
+    nmea_queue_destroy(state.queue);
+    free(state.ages);
+}
+#endif
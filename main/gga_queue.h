@@ -0,0 +1,139 @@
+/**
+ * @brief Sentence queue with overload policies for the ingest path.
+ * -A single producer (the framing task) hands framed sentences of one or more receivers to a single consumer (the
+ * -decode task) through fixed slots. When the consumer falls behind, the overload policy decides what is lost: the
+ * -newest sentence, the oldest waiting one, nothing (the producer blocks), every sentence but the latest of each
+ * -receiver, or all but every Nth sentence of a receiver. Every policy is O(1) per sentence and the producer never
+ * -takes a lock (NMEA_OVERLOAD_BLOCK only waits while the queue is full). Depth, high-water mark and the losses of
+ * -every policy are counted.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+#include "gga_validate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Overload policies
+ */
+typedef enum {
+    NMEA_OVERLOAD_DROP_NEWEST = 0,      //the incoming sentence is dropped while the queue is full
+    NMEA_OVERLOAD_DROP_OLDEST,          //the oldest waiting sentence makes room for the incoming one
+    NMEA_OVERLOAD_BLOCK,                //the producer waits for a free slot, nothing is lost
+    NMEA_OVERLOAD_KEEP_LATEST,          //one waiting sentence per receiver, a newer one replaces it (coalescing)
+    NMEA_OVERLOAD_SAMPLE,               //every Nth sentence of a receiver is queued, then as NMEA_OVERLOAD_DROP_NEWEST
+    NMEA_OVERLOAD_POLICY_COUNT
+} nmea_OverloadPolicy_t;
+
+/**
+ * @brief One sentence taken from the queue
+ */
+typedef struct {
+    uint32_t receiver;
+    uint32_t timeUs;                    //time given to nmea_queue_push
+    uint32_t len;
+    char data[NMEA_MAX_SENTENCE_LEN];
+} nmea_QueueItem_t;
+
+/**
+ * @brief Queue statistics
+ */
+typedef struct {
+    uint64_t pushed;                    //sentences given to nmea_queue_push
+    uint64_t popped;                    //sentences taken by the consumer
+    uint64_t droppedNewest;             //incoming sentences dropped because the queue was full
+    uint64_t droppedOldest;             //waiting sentences dropped to make room
+    uint64_t coalesced;                 //waiting sentences replaced by a newer one of the same receiver (counted when it is taken)
+    uint64_t sampledOut;                //sentences skipped by NMEA_OVERLOAD_SAMPLE
+    uint64_t blocked;                   //pushes which had to wait for a free slot
+    uint64_t invalid;                   //receiver out of range or sentence too long
+    uint32_t depth;                     //sentences waiting now
+    uint32_t highWater;                 //most sentences waiting at once
+} nmea_QueueStats_t;
+
+/**
+ * @brief Opaque queue handle
+ */
+typedef struct nmea_Queue nmea_Queue_t;
+
+/**
+ * @brief nmea_queue_create function allocates a queue
+ * @param capacity is the number of slots (power of 2)
+ * @param receivers is the number of receivers (receiver ids 0 to receivers - 1)
+ * @param policy is the overload policy
+ * @param sampleEvery is N of NMEA_OVERLOAD_SAMPLE (0 and 1 queue every sentence)
+ * @return nmea_Queue_t* is the queue or NULL on failure
+ */
+nmea_Queue_t* nmea_queue_create(uint32_t , uint32_t , nmea_OverloadPolicy_t , uint32_t );
+
+/**
+ * @brief nmea_queue_push function hands a sentence to the consumer, producer side (one task)
+ * @param queue is the queue
+ * @param receiver is the receiver of the sentence
+ * @param sentence is the sentence
+ * @param len is the length of the sentence (at most NMEA_MAX_SENTENCE_LEN)
+ * @param timeUs is the time of the sentence e.g., the end of framing, given back with the sentence
+ * @return bool is true if the sentence is waiting in the queue (a sentence dropped by the policy gives false)
+ */
+bool nmea_queue_push(nmea_Queue_t* , uint32_t , const char* , size_t , uint32_t );
+
+/**
+ * @brief nmea_queue_pop function takes the next sentence, consumer side (one task), does not wait
+ * @param queue is the queue
+ * @param item holds the sentence
+ * @return bool is false if the queue is empty
+ */
+bool nmea_queue_pop(nmea_Queue_t* , nmea_QueueItem_t* );
+
+/**
+ * @brief nmea_queue_depth function gives the number of waiting sentences (either side)
+ * @param queue is the queue
+ * @return uint32_t is the number of waiting sentences
+ */
+uint32_t nmea_queue_depth(const nmea_Queue_t* );
+
+/**
+ * @brief nmea_queue_stats function gives a snapshot of the statistics (either side)
+ * @param queue is the queue
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_queue_stats(const nmea_Queue_t* , nmea_QueueStats_t* );
+
+/**
+ * @brief nmea_queue_print function prints the statistics to console
+ * @param queue is the queue
+ * @return void
+ */
+void nmea_queue_print(const nmea_Queue_t* );
+
+/**
+ * @brief nmea_queue_destroy function frees the queue, no task may use it any more
+ * @param queue is the queue
+ * @return void
+ */
+void nmea_queue_destroy(nmea_Queue_t* );
+
+#ifdef __linux__
+/**
+ * @brief nmea_queue_stress function runs a producer thread which is faster than the consumer thread and prints the
+ * -age of the fixes when they reach the consumer (50th/99th percentile and maximum) together with the losses
+ * @param policy is the overload policy
+ * @param sampleEvery is N of NMEA_OVERLOAD_SAMPLE
+ * @param receivers is the number of receivers, the producer sends their sentences in turn
+ * @param sentences is the number of sentences sent by the producer
+ * @param producerUs is the time between two sentences of the producer
+ * @param consumerUs is the time the consumer spends on one sentence (more than producerUs for an overload)
+ * @return void
+ */
+void nmea_queue_stress(nmea_OverloadPolicy_t , uint32_t , uint32_t , uint32_t , uint32_t , uint32_t );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,670 @@
+#define _GNU_SOURCE                     //ptsname_r
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <termios.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include "gga_replay.h"
+#include "gga_encode.h"
+#include "gga_validate.h"
+#include "gga_bench.h"
+
+#define DAY_US 86400000000LL            //UTC time of the day wraps around at midnight
+#define WHEEL_MASK (REPLAY_WHEEL_SLOTS - 1)
+
+_Static_assert((REPLAY_WHEEL_SLOTS & WHEEL_MASK) == 0, "REPLAY_WHEEL_SLOTS must be a power of 2");
+
+/**
+ * @brief Epoch of the timeline, the bytes of the capture written at once
+ */
+typedef struct {
+    uint64_t offset;
+    uint32_t len;
+    uint64_t timeUs;                    //time after the first epoch at 1x
+} replayEpoch_t;
+
+/**
+ * @brief Virtual receiver
+ */
+typedef struct {
+    int fd;
+    bool socket;                        //written with send so a closed reader gives EPIPE without SIGPIPE
+    bool finished;
+    uint32_t epoch;                     //next epoch
+    uint32_t loop;                      //loops finished
+    uint64_t startUs;
+    uint64_t dueUs;                     //scheduled time of the next epoch after the start of the run
+    int next;                           //next receiver of the wheel slot, -1 ends the list
+} replayReceiver_t;
+
+struct nmea_Replay {
+    nmea_ReplayConfig_t config;
+    const char *capture;                //memory-mapped capture
+    size_t captureLen;
+    replayEpoch_t *epoch;
+    uint32_t epochs;
+    uint64_t loopUs;                    //timeline length plus one epoch interval, the distance between two loops
+    replayReceiver_t *receiver;
+    int receivers;
+    int wheel[REPLAY_WHEEL_SLOTS];      //first receiver of every slot
+    atomic_bool stop;
+    nmea_ReplayStats_t stats;
+    uint64_t late[REPLAY_LATE_BUCKETS];
+};
+
+/**
+ * @brief sleepUntilUs function sleeps until a CLOCK_MONOTONIC time
+ * @param timeUs is the time
+ * @return void
+ */
+static void sleepUntilUs(uint64_t timeUs)
+{
+    struct timespec ts = { (time_t) (timeUs / 1000000u), (long) (timeUs % 1000000u) * 1000 };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+/**
+ * @brief addEpoch function appends an epoch to the timeline
+ * @param replay is the handle
+ * @param cap is the capacity of the timeline
+ * @param offset is the offset of the first line of the epoch
+ * @param timeUs is the time of the epoch
+ * @return bool is false if the timeline could not grow
+ */
+static bool addEpoch(nmea_Replay_t *replay, uint32_t *cap, uint64_t offset, uint64_t timeUs)
+{
+    if (replay->epochs == *cap) {
+        uint32_t grown = (*cap != 0) ? *cap * 2 : 1024;
+        replayEpoch_t *epoch = realloc(replay->epoch, grown * sizeof(replayEpoch_t));
+        if (epoch == NULL) {
+            return false;
+        }
+        replay->epoch = epoch;
+        *cap = grown;
+    }
+    replay->epoch[replay->epochs++] = (replayEpoch_t) { offset, 0, timeUs };
+    return true;
+}
+
+/**
+ * @brief buildTimeline function splits the capture into epochs, a GGA sentence with a new UTC time starts an epoch
+ * -and the lines before the first one belong to the first epoch
+ * @param replay is the handle
+ * @return bool is false if the capture has no GGA sentence with a valid time
+ */
+static bool buildTimeline(nmea_Replay_t *replay)
+{
+    nmea_ParseResult_t result;
+    uint32_t cap = 0;
+    int64_t lastUs = -1;                //time of the day of the current epoch
+    uint64_t timeUs = 0;
+    const char *data = replay->capture;
+    size_t len = replay->captureLen;
+    for (size_t pos = 0; pos < len;) {
+        const char *nl = memchr(data + pos, '\n', len - pos);
+        size_t end = (nl != NULL) ? (size_t) (nl - data) + 1 : len;
+        if (nmea_gga_parse_r(data + pos, end - pos, &result) && !result.isEmpty.isEmpty_time && !result.isFalse.isFalse_time) {
+            const gpsData_Time_t *t = &result.data.gpsData_time;
+            int64_t dayUs = (int64_t) ((t->hour * 60 + t->minutes) * 60) * 1000000 + (int64_t) (t->seconds * 1e6 + 0.5);
+            if (lastUs < 0) {
+                if (!addEpoch(replay, &cap, 0, 0)) return false;
+            }
+            else if (dayUs != lastUs) {
+                //Forward within half a day, so the timeline continues after midnight
+                int64_t diff = ((dayUs - lastUs) % DAY_US + DAY_US + DAY_US / 2) % DAY_US - DAY_US / 2;
+                timeUs = (diff > 0) ? timeUs + (uint64_t) diff : timeUs;
+                replayEpoch_t *current = &replay->epoch[replay->epochs - 1];
+                current->len = (uint32_t) (pos - current->offset);
+                if (!addEpoch(replay, &cap, pos, timeUs)) return false;
+            }
+            lastUs = dayUs;
+        }
+        pos = end;
+    }
+    if (replay->epochs == 0) {
+        return false;
+    }
+    replayEpoch_t *last = &replay->epoch[replay->epochs - 1];
+    last->len = (uint32_t) (len - last->offset);
+    //One more epoch interval between two loops
+    replay->loopUs = (replay->epochs > 1) ? last->timeUs + last->timeUs / (replay->epochs - 1) : 1000000u;
+    return true;
+}
+
+/**
+ * @brief nmea_replay_create function loads a capture and builds its timeline
+ * @param path is the capture file
+ * @param config is the configuration, NULL selects the defaults
+ * @return nmea_Replay_t* is the handle or NULL on failure (no GGA sentence with a valid time in the capture)
+ */
+nmea_Replay_t* nmea_replay_create(const char *path, const nmea_ReplayConfig_t *config)
+{
+    nmea_Replay_t *replay = calloc(1, sizeof(nmea_Replay_t));
+    if (replay == NULL) {
+        printf("ERROR: Memory NOT allocated!\n");
+        return NULL;
+    }
+    if (config != NULL) {
+        replay->config = *config;
+    }
+    if (replay->config.speed <= 0.0) replay->config.speed = 1.0;
+    if (replay->config.tickUs == 0) replay->config.tickUs = REPLAY_DEFAULT_TICK_US;
+    if (replay->config.loops == 0) replay->config.loops = 1;
+    if (replay->config.maxReceivers <= 0) replay->config.maxReceivers = REPLAY_DEFAULT_RECEIVERS;
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0) {
+        printf("ERROR: Capture %s NOT opened!\n", path);
+        if (fd >= 0) close(fd);
+        free(replay);
+        return NULL;
+    }
+    replay->captureLen = (size_t) st.st_size;
+    replay->capture = mmap(NULL, replay->captureLen, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (replay->capture == MAP_FAILED) {
+        printf("ERROR: Capture %s NOT mapped!\n", path);
+        free(replay);
+        return NULL;
+    }
+    madvise((void *) replay->capture, replay->captureLen, MADV_SEQUENTIAL);
+    replay->receiver = calloc((size_t) replay->config.maxReceivers, sizeof(replayReceiver_t));
+    if (replay->receiver == NULL || !buildTimeline(replay)) {
+        printf("ERROR: Capture %s has no GGA sentence with a valid time!\n", path);
+        nmea_replay_destroy(replay);
+        return NULL;
+    }
+    //The capture stays mapped for the writes, which jump between the epochs of the receivers
+    madvise((void *) replay->capture, replay->captureLen, MADV_WILLNEED);
+    replay->stats.epochs = replay->epochs;
+    replay->stats.durationUs = replay->epoch[replay->epochs - 1].timeUs;
+    return replay;
+}
+
+/**
+ * @brief nmea_replay_add function adds a virtual receiver, the descriptor is switched to non-blocking mode and is owned
+ * -(closed) by the replay from now on
+ * @param replay is the handle
+ * @param fd is the write end (pty master, FIFO, pipe or connected local socket)
+ * @param startUs is the delay of the first epoch after the start of nmea_replay_run
+ * @return int is the receiver index or -1 if every slot is used
+ */
+int nmea_replay_add(nmea_Replay_t *replay, int fd, uint64_t startUs)
+{
+    if (replay->receivers == replay->config.maxReceivers) {
+        printf("ERROR: No free receiver slot!\n");
+        close(fd);
+        return -1;
+    }
+    struct stat st;
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    replayReceiver_t *rx = &replay->receiver[replay->receivers];
+    memset(rx, 0, sizeof(*rx));
+    rx->fd = fd;
+    rx->socket = (fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode));
+    rx->startUs = startUs;
+    rx->next = -1;
+    replay->stats.receivers = ++replay->receivers;
+    return replay->receivers - 1;
+}
+
+/**
+ * @brief nmea_replay_add_pty function creates a pseudo terminal in raw mode and adds its master as a receiver
+ * @param replay is the handle
+ * @param name holds the path of the terminal the consumer opens e.g., "/dev/pts/5"
+ * @param size is the size of name
+ * @param startUs is the delay of the first epoch after the start of nmea_replay_run
+ * @return int is the receiver index or -1 on failure
+ */
+int nmea_replay_add_pty(nmea_Replay_t *replay, char *name, size_t size, uint64_t startUs)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0 || ptsname_r(master, name, size) != 0) {
+        printf("ERROR: Pseudo terminal NOT created (%s)!\n", strerror(errno));
+        if (master >= 0) close(master);
+        return -1;
+    }
+    //Raw mode, the terminal would echo the sentences back into the master otherwise
+    int slave = open(name, O_RDWR | O_NOCTTY);
+    if (slave >= 0) {
+        struct termios tio;
+        if (tcgetattr(slave, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(slave, TCSANOW, &tio);
+        }
+        close(slave);
+    }
+    return nmea_replay_add(replay, master, startUs);
+}
+
+/**
+ * @brief schedule function puts a receiver into the wheel slot of the first tick at or after its due time
+ * @param replay is the handle
+ * @param index is the receiver
+ * @param tick is the tick being processed, the receiver goes at least into the next one
+ * @return void
+ */
+static void schedule(nmea_Replay_t *replay, int index, uint64_t tick)
+{
+    replayReceiver_t *rx = &replay->receiver[index];
+    uint64_t due = (rx->dueUs + replay->config.tickUs - 1) / replay->config.tickUs;
+    if (due <= tick) {
+        due = tick + 1;
+    }
+    int slot = (int) (due & WHEEL_MASK);
+    rx->next = replay->wheel[slot];
+    replay->wheel[slot] = index;
+}
+
+/**
+ * @brief dueOf function gives the scheduled time of the next epoch of a receiver
+ * @param replay is the handle
+ * @param rx is the receiver
+ * @return uint64_t is the time after the start of the run
+ */
+static inline uint64_t dueOf(const nmea_Replay_t *replay, const replayReceiver_t *rx)
+{
+    uint64_t timelineUs = (uint64_t) rx->loop * replay->loopUs + replay->epoch[rx->epoch].timeUs;
+    return rx->startUs + (uint64_t) ((double) timelineUs / replay->config.speed);
+}
+
+/**
+ * @brief lateBucket function gives the histogram bucket of a lateness, 8 buckets per power of 2
+ * @param lateUs is the lateness
+ * @return int is the bucket
+ */
+static inline int lateBucket(uint64_t lateUs)
+{
+    if (lateUs >= UINT32_MAX) {
+        return REPLAY_LATE_BUCKETS - 1;
+    }
+    if (lateUs < 8) {
+        return (int) lateUs;
+    }
+    int exponent = 31 - __builtin_clz((uint32_t) lateUs);
+    return (exponent - 2) * 8 + (int) ((lateUs >> (exponent - 3)) & 7u);
+}
+
+/**
+ * @brief bucketEdge function gives the largest lateness of a histogram bucket
+ * @param bucket is the bucket
+ * @return uint32_t is the lateness in us
+ */
+static inline uint32_t bucketEdge(int bucket)
+{
+    if (bucket < 8) {
+        return (uint32_t) bucket;
+    }
+    int exponent = bucket / 8 + 2;
+    return (uint32_t) (((uint64_t) (8 + bucket % 8 + 1) << (exponent - 3)) - 1);
+}
+
+/**
+ * @brief writeDue function writes every due epoch of a receiver with one call and records their lateness
+ * @param replay is the handle
+ * @param rx is the receiver
+ * @param nowUs is the time after the start of the run
+ * @return void
+ */
+static void writeDue(nmea_Replay_t *replay, replayReceiver_t *rx, uint64_t nowUs)
+{
+    //The epochs follow each other in the capture, up to the end of the loop
+    const replayEpoch_t *first = &replay->epoch[rx->epoch];
+    size_t len = 0;
+    do {
+        const replayEpoch_t *epoch = &replay->epoch[rx->epoch];
+        uint64_t late = nowUs - rx->dueUs;
+        len += epoch->len;
+        replay->stats.writes++;
+        replay->stats.lateSumUs += late;
+        if (late > replay->stats.lateMaxUs) {
+            replay->stats.lateMaxUs = (uint32_t) ((late < UINT32_MAX) ? late : UINT32_MAX);
+        }
+        replay->late[lateBucket(late)]++;
+        if (++rx->epoch == replay->epochs) {
+            rx->epoch = 0;
+            rx->loop++;
+        }
+        rx->dueUs = dueOf(replay, rx);
+    } while (rx->epoch != 0 && rx->dueUs <= nowUs);
+    const char *data = replay->capture + first->offset;
+    ssize_t n = rx->socket ? send(rx->fd, data, len, MSG_NOSIGNAL) : write(rx->fd, data, len);
+    replay->stats.calls++;
+    if (n < 0 && errno != EAGAIN && errno != EINTR) {
+        replay->stats.closed++;
+        rx->finished = true;
+        return;
+    }
+    size_t written = (n > 0) ? (size_t) n : 0;
+    replay->stats.bytes += written;
+    if (written < len) {
+        replay->stats.bytesDropped += len - written;
+        replay->stats.overruns++;
+    }
+    if (rx->loop == replay->config.loops) {
+        rx->finished = true;
+    }
+}
+
+/**
+ * @brief processTick function writes the due epochs of the receivers in the slot of a tick, a receiver which is due
+ * -again before the clock (high speed factors) writes those epochs at once
+ * @param replay is the handle
+ * @param tick is the tick
+ * @param startUs is the start of the run
+ * @return void
+ */
+static void processTick(nmea_Replay_t *replay, uint64_t tick, uint64_t startUs)
+{
+    int slot = (int) (tick & WHEEL_MASK);
+    int index = replay->wheel[slot];
+    replay->wheel[slot] = -1;
+    while (index >= 0) {
+        replayReceiver_t *rx = &replay->receiver[index];
+        int next = rx->next;
+        uint64_t nowUs = nmea_wall_us() - startUs;
+        //Receivers of a later turn of the wheel stay in the slot
+        while (!rx->finished && rx->dueUs <= nowUs) {
+            writeDue(replay, rx, nowUs);
+        }
+        if (rx->finished) {
+            close(rx->fd);
+            rx->fd = -1;
+            replay->stats.active--;
+        }
+        else {
+            schedule(replay, index, tick);
+        }
+        index = next;
+    }
+}
+
+/**
+ * @brief percentile function gives a percentile of the lateness (upper edge of its histogram bucket)
+ * @param replay is the handle
+ * @param part is the percentile (0 to 1)
+ * @return uint32_t is the lateness in us
+ */
+static uint32_t percentile(const nmea_Replay_t *replay, double part)
+{
+    uint64_t rank = (uint64_t) ((double) replay->stats.writes * part);
+    uint64_t seen = 0;
+    for (int i = 0; i < REPLAY_LATE_BUCKETS; i++) {
+        seen += replay->late[i];
+        if (seen > rank) {
+            uint32_t edge = bucketEdge(i);
+            return (edge < replay->stats.lateMaxUs) ? edge : replay->stats.lateMaxUs;
+        }
+    }
+    return replay->stats.lateMaxUs;
+}
+
+/**
+ * @brief nmea_replay_run function replays the capture into every receiver from the calling thread, it returns when
+ * -every receiver has finished its loops, after maxUs or after nmea_replay_stop
+ * @param replay is the handle
+ * @param maxUs is the longest run time (0 has no limit)
+ * @return void
+ */
+void nmea_replay_run(nmea_Replay_t *replay, uint64_t maxUs)
+{
+    //FIFOs and pipes raise SIGPIPE when their reader is gone, it is blocked here and taken back after the run
+    sigset_t pipeSet;
+    sigset_t oldSet;
+    sigemptyset(&pipeSet);
+    sigaddset(&pipeSet, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+
+    memset(replay->late, 0, sizeof(replay->late));
+    nmea_ReplayStats_t *stats = &replay->stats;
+    stats->writes = stats->calls = stats->bytes = stats->bytesDropped = stats->overruns = stats->closed = stats->ticks = 0;
+    stats->lateSumUs = 0;
+    stats->lateMaxUs = 0;
+    stats->active = 0;
+    for (int i = 0; i < REPLAY_WHEEL_SLOTS; i++) {
+        replay->wheel[i] = -1;
+    }
+    for (int i = 0; i < replay->receivers; i++) {
+        replayReceiver_t *rx = &replay->receiver[i];
+        if (rx->fd < 0) {
+            continue;
+        }
+        rx->finished = false;
+        rx->epoch = 0;
+        rx->loop = 0;
+        rx->dueUs = dueOf(replay, rx);
+        schedule(replay, i, 0);
+        stats->active++;
+    }
+    atomic_store(&replay->stop, false);
+    uint64_t tickUs = replay->config.tickUs;
+    uint64_t startUs = nmea_wall_us();
+    uint64_t tick = 1;
+    while (stats->active > 0 && !atomic_load(&replay->stop)) {
+        uint64_t nowUs = nmea_wall_us() - startUs;
+        if (maxUs != 0 && nowUs >= maxUs) {
+            break;
+        }
+        //Ticks missed while the thread was late are processed in order
+        for (; tick * tickUs <= nowUs; tick++) {
+            processTick(replay, tick, startUs);
+            stats->ticks++;
+        }
+        sleepUntilUs(startUs + tick * tickUs);
+    }
+    stats->runUs = nmea_wall_us() - startUs;
+    stats->lateP50Us = percentile(replay, 0.5);
+    stats->lateP99Us = percentile(replay, 0.99);
+    stats->lateP999Us = percentile(replay, 0.999);
+
+    struct timespec zero = { 0, 0 };
+    while (sigtimedwait(&pipeSet, NULL, &zero) == SIGPIPE) {
+    }
+    pthread_sigmask(SIG_SETMASK, &oldSet, NULL);
+}
+
+/**
+ * @brief nmea_replay_stop function makes nmea_replay_run return at its next tick (any thread or a signal handler)
+ * @param replay is the handle
+ * @return void
+ */
+void nmea_replay_stop(nmea_Replay_t *replay)
+{
+    atomic_store(&replay->stop, true);
+}
+
+/**
+ * @brief nmea_replay_stats function gives the statistics of the last run
+ * @param replay is the handle
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_replay_stats(const nmea_Replay_t *replay, nmea_ReplayStats_t *stats)
+{
+    *stats = replay->stats;
+}
+
+/**
+ * @brief nmea_replay_print function prints the statistics to console
+ * @param replay is the handle
+ * @return void
+ */
+void nmea_replay_print(const nmea_Replay_t *replay)
+{
+    const nmea_ReplayStats_t *stats = &replay->stats;
+    printf("REPLAY TIMELINE---------------------> %lu epochs, %.3f s at 1x, speed %.1fx\n", (unsigned long) stats->epochs,
+           (double) stats->durationUs / 1e6, replay->config.speed);
+    printf("REPLAY RECEIVERS (ACTIVE/CLOSED)----> %d (%d/%llu)\n", stats->receivers, stats->active,
+           (unsigned long long) stats->closed);
+    printf("REPLAY EPOCHS/CALLS/BYTES-----------> %llu/%llu/%llu in %llu us\n", (unsigned long long) stats->writes,
+           (unsigned long long) stats->calls, (unsigned long long) stats->bytes, (unsigned long long) stats->runUs);
+    printf("REPLAY OVERRUNS/BYTES DROPPED-------> %llu/%llu\n", (unsigned long long) stats->overruns,
+           (unsigned long long) stats->bytesDropped);
+    printf("REPLAY TICKS------------------------> %llu of %lu us\n", (unsigned long long) stats->ticks,
+           (unsigned long) replay->config.tickUs);
+    printf("REPLAY LATENESS AVG/MAX (us)--------> %llu/%lu\n",
+           (unsigned long long) (stats->writes != 0 ? stats->lateSumUs / stats->writes : 0), (unsigned long) stats->lateMaxUs);
+    printf("REPLAY LATENESS P50/P99/P99.9 (us)--> %lu/%lu/%lu\n", (unsigned long) stats->lateP50Us,
+           (unsigned long) stats->lateP99Us, (unsigned long) stats->lateP999Us);
+}
+
+/**
+ * @brief nmea_replay_destroy function closes the receivers and frees the replay
+ * @param replay is the handle
+ * @return void
+ */
+void nmea_replay_destroy(nmea_Replay_t *replay)
+{
+    if (replay == NULL) {
+        return;
+    }
+    for (int i = 0; replay->receiver != NULL && i < replay->receivers; i++) {
+        if (replay->receiver[i].fd >= 0) {
+            close(replay->receiver[i].fd);
+        }
+    }
+    if (replay->capture != NULL && replay->capture != MAP_FAILED) {
+        munmap((void *) replay->capture, replay->captureLen);
+    }
+    free(replay->receiver);
+    free(replay->epoch);
+    free(replay);
+}
+
+/**
+ * @brief Drain thread of the benchmark, reads every receiver like a consumer would
+ */
+typedef struct {
+    int epollFd;
+    atomic_bool stop;
+    uint64_t bytes;
+} replayDrain_t;
+
+/**
+ * @brief drainThread function reads the consumer ends of the benchmark receivers until stop
+ * @param arg is the drain state
+ * @return void* is NULL
+ */
+static void* drainThread(void *arg)
+{
+    replayDrain_t *drain = arg;
+    struct epoll_event events[64];
+    char buf[4096];
+    while (!atomic_load(&drain->stop)) {
+        int n = epoll_wait(drain->epollFd, events, 64, 10);
+        for (int i = 0; i < n; i++) {
+            ssize_t got;
+            while ((got = read(events[i].data.fd, buf, sizeof(buf))) > 0) {
+                drain->bytes += (uint64_t) got;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief nmea_replay_benchmark function replays a 10 Hz capture into many local socket receivers drained by a second
+ * -thread and prints the scheduling lateness
+ * @param receivers is the number of receivers
+ * @param epochs is the number of epochs of the capture
+ * @param speed is the speed factor
+ * @return void
+ */
+void nmea_replay_benchmark(int receivers, uint32_t epochs, double speed)
+{
+    static const char s_gsa[] = "GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1";
+    static const char s_path[] = "/tmp/gga_replay_capture.nmea";
+    //Every receiver needs two descriptors
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    //10 Hz capture from 10 s before midnight, a GSA sentence follows every GGA
+    FILE *file = fopen(s_path, "w");
+    if (file == NULL) {
+        printf("ERROR: Capture %s NOT created!\n", s_path);
+        return;
+    }
+    nmea_PackedFix_t fix = { 0 };
+    fix.latitude = 20056618;
+    fix.longitude = -70313858;
+    fix.altitude = 2700;
+    fix.geoSep = -3420;
+    fix.qIndicator = 1;
+    fix.satTracked = 9;
+    fix.hdop = 120;
+    fix.emptyMask = 1u << NMEA_FIELD_TDGPS;
+    char line[ENCODE_MAX_SENTENCE_LEN];
+    for (uint32_t i = 0; i < epochs; i++) {
+        fix.timeMs = (86390000u + i * 100u) % 86400000u;
+        fwrite(line, 1, nmea_encode_packed(&fix, line, sizeof(line)), file);
+        fprintf(file, "$%s*%02X\r\n", s_gsa, nmea_checksum(s_gsa, sizeof(s_gsa) - 1));
+    }
+    fclose(file);
+
+    nmea_ReplayConfig_t config = { .speed = speed, .maxReceivers = receivers };
+    nmea_Replay_t *replay = nmea_replay_create(s_path, &config);
+    replayDrain_t drain = { .epollFd = epoll_create1(0) };
+    if (replay == NULL || drain.epollFd < 0) {
+        printf("ERROR: Replay benchmark could not be started!\n");
+        nmea_replay_destroy(replay);
+        if (drain.epollFd >= 0) close(drain.epollFd);
+        unlink(s_path);
+        return;
+    }
+    int *peer = malloc((size_t) receivers * sizeof(int));
+    int added = 0;
+    //The receivers start spread over the first epoch interval like independent devices
+    uint64_t spreadUs = (uint64_t) (100000.0 / speed);
+    for (; peer != NULL && added < receivers; added++) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair) != 0) {
+            printf("ERROR: Only %d receivers created (%s)!\n", added, strerror(errno));
+            break;
+        }
+        struct epoll_event event = { .events = EPOLLIN, .data.fd = pair[1] };
+        epoll_ctl(drain.epollFd, EPOLL_CTL_ADD, pair[1], &event);
+        peer[added] = pair[1];
+        nmea_replay_add(replay, pair[0], spreadUs * (uint64_t) added / (uint64_t) receivers);
+    }
+    pthread_t thread;
+    bool draining = (pthread_create(&thread, NULL, drainThread, &drain) == 0);
+    nmea_replay_run(replay, 0);
+    atomic_store(&drain.stop, true);
+    if (draining) {
+        pthread_join(thread, NULL);
+    }
+    //What is still buffered in the sockets after the last write
+    char buf[4096];
+    for (int i = 0; i < added; i++) {
+        ssize_t got;
+        while ((got = read(peer[i], buf, sizeof(buf))) > 0) {
+            drain.bytes += (uint64_t) got;
+        }
+    }
+    printf("REPLAY BENCHMARK: %d socket receivers\n", added);
+    nmea_replay_print(replay);
+    printf("REPLAY BYTES READ BY CONSUMERS------> %llu\n", (unsigned long long) drain.bytes);
+    nmea_replay_destroy(replay);
+    for (int i = 0; i < added; i++) {
+        close(peer[i]);
+    }
+    free(peer);
+    close(drain.epollFd);
+    unlink(s_path);
+}
@@ -0,0 +1,142 @@
+/**
+ * @brief Real-time replay of an NMEA capture into many virtual receivers (Linux only).
+ * -The capture is parsed once into a timeline of epochs: every GGA sentence with a new UTC time starts an epoch and
+ * -the lines which follow it (other sentence types included) belong to it, the midnight rollovers are followed. Every
+ * -virtual receiver (pty, FIFO, pipe or local socket) replays the capture from its own start offset, one write per
+ * -epoch at the parsed time divided by the speed factor. All receivers are scheduled from the calling thread with a
+ * -hashed timer wheel (O(1) per epoch) and the lateness of every epoch against its scheduled time is measured. The
+ * -epochs of a receiver which are due at the same time (high speed factors) are written with one call.
+ * -A receiver which does not read fast enough loses bytes like a UART would, the replay never waits for it.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define REPLAY_DEFAULT_TICK_US 1000     //Default resolution of the timer wheel
+#define REPLAY_DEFAULT_RECEIVERS 4096   //Default maximum number of receivers
+#define REPLAY_WHEEL_SLOTS 4096         //Slots of the timer wheel (power of 2), one turn is 4096 ticks
+#define REPLAY_LATE_BUCKETS 240         //Lateness histogram buckets, 8 per power of 2 (at most 12.5% wide) up to 2^32 us
+
+/**
+ * @brief Replay configuration, the 0 members select the defaults
+ */
+typedef struct {
+    double speed;                       //1 replays in real time, 10 to 1000 compress the timeline (0 selects 1)
+    uint32_t tickUs;                    //resolution of the timer wheel (0 selects REPLAY_DEFAULT_TICK_US)
+    uint32_t loops;                     //times every receiver replays the capture (0 selects 1)
+    int maxReceivers;                   //number of receiver slots (0 selects REPLAY_DEFAULT_RECEIVERS)
+} nmea_ReplayConfig_t;
+
+/**
+ * @brief Replay statistics
+ */
+typedef struct {
+    uint32_t epochs;                    //epochs of the timeline
+    uint64_t durationUs;                //length of the timeline at 1x
+    int receivers;                      //receivers added
+    int active;                         //receivers still replaying
+    uint64_t writes;                    //epochs written
+    uint64_t calls;                     //write calls, the epochs of a receiver which are due together share one
+    uint64_t bytes;                     //bytes written
+    uint64_t bytesDropped;              //bytes the receivers did not take (full buffer)
+    uint64_t overruns;                  //writes which lost bytes
+    uint64_t closed;                    //receivers which failed or were closed by the reader
+    uint64_t ticks;                     //timer wheel ticks processed
+    uint64_t lateSumUs;                 //lateness of the writes against their scheduled time
+    uint32_t lateMaxUs;
+    uint32_t lateP50Us;                 //percentiles, upper edge of the histogram bucket
+    uint32_t lateP99Us;
+    uint32_t lateP999Us;
+    uint64_t runUs;                     //wall time of nmea_replay_run
+} nmea_ReplayStats_t;
+
+/**
+ * @brief Opaque replay handle
+ */
+typedef struct nmea_Replay nmea_Replay_t;
+
+/**
+ * @brief nmea_replay_create function loads a capture and builds its timeline
+ * @param path is the capture file
+ * @param config is the configuration, NULL selects the defaults
+ * @return nmea_Replay_t* is the handle or NULL on failure (no GGA sentence with a valid time in the capture)
+ */
+nmea_Replay_t* nmea_replay_create(const char* , const nmea_ReplayConfig_t* );
+
+/**
+ * @brief nmea_replay_add function adds a virtual receiver, the descriptor is switched to non-blocking mode and is owned
+ * -(closed) by the replay from now on
+ * @param replay is the handle
+ * @param fd is the write end (pty master, FIFO, pipe or connected local socket)
+ * @param startUs is the delay of the first epoch after the start of nmea_replay_run
+ * @return int is the receiver index or -1 if every slot is used
+ */
+int nmea_replay_add(nmea_Replay_t* , int , uint64_t );
+
+/**
+ * @brief nmea_replay_add_pty function creates a pseudo terminal in raw mode and adds its master as a receiver
+ * @param replay is the handle
+ * @param name holds the path of the terminal the consumer opens e.g., "/dev/pts/5"
+ * @param size is the size of name
+ * @param startUs is the delay of the first epoch after the start of nmea_replay_run
+ * @return int is the receiver index or -1 on failure
+ */
+int nmea_replay_add_pty(nmea_Replay_t* , char* , size_t , uint64_t );
+
+/**
+ * @brief nmea_replay_run function replays the capture into every receiver from the calling thread, it returns when
+ * -every receiver has finished its loops, after maxUs or after nmea_replay_stop
+ * @param replay is the handle
+ * @param maxUs is the longest run time (0 has no limit)
+ * @return void
+ */
+void nmea_replay_run(nmea_Replay_t* , uint64_t );
+
+/**
+ * @brief nmea_replay_stop function makes nmea_replay_run return at its next tick (any thread or a signal handler)
+ * @param replay is the handle
+ * @return void
+ */
+void nmea_replay_stop(nmea_Replay_t* );
+
+/**
+ * @brief nmea_replay_stats function gives the statistics of the last run
+ * @param replay is the handle
+ * @param stats holds the statistics
+ * @return void
+ */
+void nmea_replay_stats(const nmea_Replay_t* , nmea_ReplayStats_t* );
+
+/**
+ * @brief nmea_replay_print function prints the statistics to console
+ * @param replay is the handle
+ * @return void
+ */
+void nmea_replay_print(const nmea_Replay_t* );
+
+/**
+ * @brief nmea_replay_destroy function closes the receivers and frees the replay
+ * @param replay is the handle
+ * @return void
+ */
+void nmea_replay_destroy(nmea_Replay_t* );
+
+/**
+ * @brief nmea_replay_benchmark function replays a 10 Hz capture into many local socket receivers drained by a second
+ * -thread and prints the scheduling lateness
+ * @param receivers is the number of receivers
+ * @param epochs is the number of epochs of the capture
+ * @param speed is the speed factor
+ * @return void
+ */
+void nmea_replay_benchmark(int , uint32_t , double );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,190 @@
+#include <string.h>
+#include "gga_scan.h"
+
+#define CANDIDATE_NEED_MORE -2          //the candidate is not complete yet
+#define CANDIDATE_VALID -1              //the candidate is a valid GGA sentence
+#define PREFIX_LEN 7                    //"$GPGGA,"
+#define MAX_CANDIDATE_LEN (NMEA_MAX_SENTENCE_LEN - 2)   //'$' to "*hh", the line ending is not needed
+
+/**
+ * @brief isHex function checks for a hexadecimal charachter
+ * @param c is the charachter
+ * @return bool is true if the charachter is hexadecimal
+ */
+static inline bool isHex(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+}
+
+/**
+ * @brief hexByte function converts two hexadecimal charachters
+ * @param str is the pointer to the charachters
+ * @return int is the value
+ */
+static inline int hexByte(const char *str)
+{
+    int value = 0;
+    for (int i = 0; i < 2; i++) {
+        char c = str[i];
+        value = value << 4 | ((c <= '9') ? c - '0' : (c | 0x20) - 'a' + 10);
+    }
+    return value;
+}
+
+/**
+ * @brief evalCandidate function checks a candidate sentence starting with '$'
+ * @param p is the pointer to the '$'
+ * @param avail is the number of bytes available from p
+ * @param consumed holds the number of bytes to skip (the sentence length when it is valid)
+ * @return int is CANDIDATE_VALID, CANDIDATE_NEED_MORE or the nmea_DiscardReason_t
+ */
+static int evalCandidate(const char *p, size_t avail, size_t *consumed)
+{
+    //Talker and type are 5 upper case letters followed by ',' (this rejects a new '$' as well)
+    size_t n = (avail < PREFIX_LEN) ? avail : PREFIX_LEN;
+    for (size_t i = 1; i < n; i++) {
+        bool ok = (i < PREFIX_LEN - 1) ? (p[i] >= 'A' && p[i] <= 'Z') : (p[i] == ',');
+        if (!ok) {
+            *consumed = i;
+            return NMEA_DISCARD_BAD_PREFIX;
+        }
+    }
+    if (avail < PREFIX_LEN) {
+        return CANDIDATE_NEED_MORE;
+    }
+    if (memcmp(p + 1, "GPGGA", 5) != 0) {
+        *consumed = PREFIX_LEN;
+        return NMEA_DISCARD_OTHER_TYPE;
+    }
+    //The '*' has to come within the NMEA length limit and no new '$' may come before it
+    size_t window = (avail < MAX_CANDIDATE_LEN) ? avail : MAX_CANDIDATE_LEN;
+    const char *star = memchr(p + PREFIX_LEN, '*', window - PREFIX_LEN);
+    const char *limit = (star != NULL) ? star : p + window;
+    const char *dollar = memchr(p + PREFIX_LEN, '$', (size_t) (limit - p - PREFIX_LEN));
+    if (dollar != NULL) {
+        *consumed = (size_t) (dollar - p);
+        return NMEA_DISCARD_TRUNCATED;
+    }
+    if (star == NULL) {
+        if (avail < MAX_CANDIDATE_LEN) {
+            return CANDIDATE_NEED_MORE;
+        }
+        *consumed = window;
+        return NMEA_DISCARD_OVERLONG;
+    }
+    size_t len = (size_t) (star - p) + 3;
+    if (len > MAX_CANDIDATE_LEN) {
+        *consumed = (size_t) (star - p) + 1;
+        return NMEA_DISCARD_OVERLONG;
+    }
+    if (len > avail) {
+        return CANDIDATE_NEED_MORE;
+    }
+    if (!isHex(star[1]) || !isHex(star[2])) {
+        *consumed = (size_t) (star - p) + 1;
+        return NMEA_DISCARD_TRUNCATED;
+    }
+    *consumed = len;
+    if (nmea_checksum(p + 1, (size_t) (star - p) - 1) != hexByte(star + 1)) {
+        return NMEA_DISCARD_CHECKSUM;
+    }
+    return CANDIDATE_VALID;
+}
+
+/**
+ * @brief account function updates the counters for an evaluated candidate and gives a valid sentence to the callback
+ * @param scanner is the scanner
+ * @param status is the result of evalCandidate
+ * @param p is the pointer to the candidate
+ * @param consumed is the number of bytes consumed
+ * @param callback is the sentence callback
+ * @param arg is given to the callback
+ * @return size_t is 1 for a valid sentence or 0
+ */
+static size_t account(nmea_Scanner_t *scanner, int status, const char *p, size_t consumed, nmea_ScanCallback_t callback, void *arg)
+{
+    if (status == CANDIDATE_VALID) {
+        scanner->sentences++;
+        if (callback != NULL) {
+            callback(arg, p, consumed);
+        }
+        return 1;
+    }
+    scanner->discardedBytes[status] += consumed;
+    scanner->discardedCandidates[status]++;
+    return 0;
+}
+
+/**
+ * @brief nmea_scan_init function resets the scanner
+ * @param scanner is the scanner
+ * @return void
+ */
+void nmea_scan_init(nmea_Scanner_t *scanner)
+{
+    memset(scanner, 0, sizeof(*scanner));
+}
+
+/**
+ * @brief nmea_scan_feed function scans the next chunk of the stream
+ * @param scanner is the scanner
+ * @param data is the chunk
+ * @param len is the length of the chunk
+ * @param callback is called for every valid GGA sentence
+ * @param arg is given to the callback
+ * @return size_t is the number of GGA sentences found in this call
+ */
+size_t nmea_scan_feed(nmea_Scanner_t *scanner, const char *data, size_t len, nmea_ScanCallback_t callback, void *arg)
+{
+    const char *p = data;
+    const char *end = data + len;
+    size_t found = 0;
+    size_t consumed = 0;
+    //A candidate split across chunks is completed in the pending buffer (it never holds more than one sentence)
+    while (scanner->pendingLen > 0) {
+        size_t old = scanner->pendingLen;
+        size_t take = (size_t) (end - p);
+        if (take > sizeof(scanner->pending) - old) {
+            take = sizeof(scanner->pending) - old;
+        }
+        memcpy(scanner->pending + old, p, take);
+        int status = evalCandidate(scanner->pending, old + take, &consumed);
+        if (status == CANDIDATE_NEED_MORE) {
+            scanner->pendingLen = old + take;
+            return found;
+        }
+        found += account(scanner, status, scanner->pending, consumed, callback, arg);
+        if (consumed >= old) {
+            p += consumed - old;
+            scanner->pendingLen = 0;
+        }
+        else {
+            //Only the old bytes after the rejected part are scanned again, the new data is still in front of p
+            size_t rest = old - consumed;
+            const char *dollar = memchr(scanner->pending + consumed, '$', rest);
+            size_t skip = (dollar != NULL) ? (size_t) (dollar - scanner->pending) - consumed : rest;
+            scanner->discardedBytes[NMEA_DISCARD_NOISE] += skip;
+            memmove(scanner->pending, scanner->pending + consumed + skip, rest - skip);
+            scanner->pendingLen = rest - skip;
+        }
+    }
+    while (p < end) {
+        const char *dollar = memchr(p, '$', (size_t) (end - p));
+        if (dollar == NULL) {
+            scanner->discardedBytes[NMEA_DISCARD_NOISE] += (uint64_t) (end - p);
+            break;
+        }
+        scanner->discardedBytes[NMEA_DISCARD_NOISE] += (uint64_t) (dollar - p);
+        p = dollar;
+        int status = evalCandidate(p, (size_t) (end - p), &consumed);
+        if (status == CANDIDATE_NEED_MORE) {
+            //Incomplete candidates are always shorter than the pending buffer
+            scanner->pendingLen = (size_t) (end - p);
+            memcpy(scanner->pending, p, scanner->pendingLen);
+            break;
+        }
+        found += account(scanner, status, p, consumed, callback, arg);
+        p += consumed;
+    }
+    return found;
+}
@@ -0,0 +1,69 @@
+/**
+ * @brief Resynchronizing scanner for corrupted or noisy serial streams.
+ * -The stream is fed in chunks of any size, candidate '$' starts are found with memchr and impossible candidates are
+ * -rejected early (talker/type prefix, the 82 charachter NMEA limit, a new '$' before the "*hh" of the previous one).
+ * -A sentence ends at its "*hh" so a missing line ending does not lose it. Every valid GGA sentence is given to the
+ * -callback and every discarded byte is counted with its reason. Each byte is examined a bounded number of times so
+ * -the cost per byte stays flat during corruption bursts.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+#include "gga_validate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Reasons of discarded bytes
+ */
+typedef enum {
+    NMEA_DISCARD_NOISE = 0,             //bytes outside of any candidate sentence (line endings included)
+    NMEA_DISCARD_BAD_PREFIX,            //the candidate has no valid talker/type prefix
+    NMEA_DISCARD_OTHER_TYPE,            //well formed prefix of a sentence other than $GPGGA (not corruption)
+    NMEA_DISCARD_TRUNCATED,             //a new '$' or a bad "*hh" appeared before the end of the candidate
+    NMEA_DISCARD_OVERLONG,              //no "*hh" within NMEA_MAX_SENTENCE_LEN charachters
+    NMEA_DISCARD_CHECKSUM,              //the checksum does not match
+    NMEA_DISCARD_REASON_COUNT
+} nmea_DiscardReason_t;
+
+/**
+ * @brief Callback given every valid GGA sentence, from '$' to "*hh" (the pointer is only valid during the call)
+ */
+typedef void (*nmea_ScanCallback_t)(void* , const char* , size_t );
+
+/**
+ * @brief Scanner state, initialize with nmea_scan_init
+ */
+typedef struct {
+    char pending[NMEA_MAX_SENTENCE_LEN];//start of a candidate split across chunks
+    size_t pendingLen;
+    uint64_t sentences;                 //valid GGA sentences found
+    uint64_t discardedBytes[NMEA_DISCARD_REASON_COUNT];
+    uint64_t discardedCandidates[NMEA_DISCARD_REASON_COUNT];
+} nmea_Scanner_t;
+
+/**
+ * @brief nmea_scan_init function resets the scanner
+ * @param scanner is the scanner
+ * @return void
+ */
+void nmea_scan_init(nmea_Scanner_t* );
+
+/**
+ * @brief nmea_scan_feed function scans the next chunk of the stream
+ * @param scanner is the scanner
+ * @param data is the chunk
+ * @param len is the length of the chunk
+ * @param callback is called for every valid GGA sentence
+ * @param arg is given to the callback
+ * @return size_t is the number of GGA sentences found in this call
+ */
+size_t nmea_scan_feed(nmea_Scanner_t* , const char* , size_t , nmea_ScanCallback_t , void* );
+
+#ifdef __cplusplus
+}
+#endif
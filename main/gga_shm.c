@@ -0,0 +1,525 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include "gga_shm.h"
+#include "gga_bench.h"
+
+#define SHM_MAGIC 0x47474131u           //"GGA1"
+#define SHM_VERSION 1u                  //Layout version of the shared segment
+#define BENCH_END_RECEIVER UINT32_MAX   //Receiver id of the last record of a benchmark run
+#define BENCH_SLOW_EVERY 8              //The slow benchmark subscriber sleeps 1 ms after this many records
+#define BENCH_MAX_SUBSCRIBERS (SHM_MAX_CONSUMERS - 1)
+
+/**
+ * @brief Ring slot, seq holds the record sequence + 1 once the record is complete and 0 while it is being written
+ */
+typedef struct {
+    atomic_uint_fast64_t seq;
+    nmea_ShmRecord_t record;
+} shmSlot_t;
+
+/**
+ * @brief Subscriber cursor, each one on its own cache line so subscribers do not slow each other down
+ */
+typedef struct {
+    _Alignas(64) atomic_uint_fast64_t readSeq;
+    atomic_uint active;
+} shmConsumer_t;
+
+/**
+ * @brief Layout of the shared segment
+ */
+typedef struct {
+    atomic_uint magic;                  //written last by the publisher, the segment is ready once it is SHM_MAGIC
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t recordSize;
+    _Alignas(64) atomic_uint_fast64_t writeSeq;
+    shmConsumer_t consumer[SHM_MAX_CONSUMERS];
+    shmSlot_t slot[];
+} shmHeader_t;
+
+struct nmea_ShmPublisher {
+    shmHeader_t *hdr;
+    size_t size;
+    uint64_t seq;
+    char name[64];
+};
+
+struct nmea_ShmSubscriber {
+    shmHeader_t *hdr;
+    size_t size;
+    int index;
+    uint64_t readSeq;
+    uint64_t lost;
+};
+
+/**
+ * @brief segmentSize function gives the size of the shared segment for a capacity
+ * @param capacity is the number of records
+ * @return size_t is the size in bytes
+ */
+static size_t segmentSize(uint32_t capacity)
+{
+    return sizeof(shmHeader_t) + (size_t) capacity * sizeof(shmSlot_t);
+}
+
+/**
+ * @brief nmea_shm_publisher_create function creates (or re-creates) the shared-memory ring
+ * @param name is the POSIX shared-memory name e.g., "/gga_fixes"
+ * @param capacity is the number of records (power of 2, 0 selects SHM_DEFAULT_CAPACITY)
+ * @return nmea_ShmPublisher_t* is the handle or NULL on failure
+ */
+nmea_ShmPublisher_t* nmea_shm_publisher_create(const char *name, uint32_t capacity)
+{
+    if (capacity == 0) {
+        capacity = SHM_DEFAULT_CAPACITY;
+    }
+    if ((capacity & (capacity - 1)) != 0 || strlen(name) >= sizeof(((nmea_ShmPublisher_t *) 0)->name)) {
+        printf("ERROR: Shared-memory capacity must be a power of 2 and the name shorter than 64!\n");
+        return NULL;
+    }
+    nmea_ShmPublisher_t *pub = calloc(1, sizeof(*pub));
+    if (pub == NULL) {
+        printf("ERROR: Memory NOT allocated!\n");
+        return NULL;
+    }
+    //Any stale segment of a previous publisher is replaced, attached subscribers keep the old one until they detach
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    pub->size = segmentSize(capacity);
+    if (fd < 0 || ftruncate(fd, (off_t) pub->size) < 0) {
+        printf("ERROR: Shared memory NOT created (%s)!\n", strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+            shm_unlink(name);
+        }
+        free(pub);
+        return NULL;
+    }
+    pub->hdr = mmap(NULL, pub->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pub->hdr == MAP_FAILED) {
+        printf("ERROR: Shared memory NOT mapped (%s)!\n", strerror(errno));
+        shm_unlink(name);
+        free(pub);
+        return NULL;
+    }
+    strcpy(pub->name, name);
+    //ftruncate gives a zero filled segment, only the header has to be written
+    pub->hdr->version = SHM_VERSION;
+    pub->hdr->capacity = capacity;
+    pub->hdr->recordSize = sizeof(nmea_ShmRecord_t);
+    atomic_store_explicit(&pub->hdr->writeSeq, 0, memory_order_relaxed);
+    atomic_store_explicit(&pub->hdr->magic, SHM_MAGIC, memory_order_release);
+    return pub;
+}
+
+/**
+ * @brief nmea_shm_publish function writes one fix into the ring, it never blocks and makes no system call
+ * @param pub is the publisher handle
+ * @param fix is the packed fix
+ * @param receiverId is the id of the receiver which produced the fix
+ * @return uint64_t is the sequence number of the record
+ */
+uint64_t nmea_shm_publish(nmea_ShmPublisher_t *pub, const nmea_PackedFix_t *fix, uint32_t receiverId)
+{
+    uint64_t seq = pub->seq++;
+    shmSlot_t *slot = &pub->hdr->slot[seq & (pub->hdr->capacity - 1)];
+    //Seqlock write, a subscriber reading this slot meanwhile sees 0 or a different sequence and knows it was lapped
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->record.seq = seq;
+    slot->record.receiverId = receiverId;
+    slot->record.reserved = 0;
+    slot->record.fix = *fix;
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_release);
+    atomic_store_explicit(&pub->hdr->writeSeq, seq + 1, memory_order_release);
+    return seq;
+}
+
+/**
+ * @brief nmea_shm_publisher_lag function gives how many records a subscriber slot is behind the publisher
+ * @param pub is the publisher handle
+ * @param consumer is the subscriber slot (0 to SHM_MAX_CONSUMERS - 1)
+ * @return int64_t is the number of unread records or -1 if the slot is not in use
+ */
+int64_t nmea_shm_publisher_lag(nmea_ShmPublisher_t *pub, int consumer)
+{
+    if (consumer < 0 || consumer >= SHM_MAX_CONSUMERS || !atomic_load(&pub->hdr->consumer[consumer].active)) {
+        return -1;
+    }
+    return (int64_t) (pub->seq - atomic_load_explicit(&pub->hdr->consumer[consumer].readSeq, memory_order_relaxed));
+}
+
+/**
+ * @brief nmea_shm_publisher_destroy function unmaps and unlinks the shared-memory ring
+ * @param pub is the publisher handle
+ * @return void
+ */
+void nmea_shm_publisher_destroy(nmea_ShmPublisher_t *pub)
+{
+    if (pub == NULL) {
+        return;
+    }
+    munmap(pub->hdr, pub->size);
+    shm_unlink(pub->name);
+    free(pub);
+}
+
+/**
+ * @brief nmea_shm_subscribe function attaches to an existing ring and claims a subscriber slot
+ * @param name is the POSIX shared-memory name given to the publisher
+ * @return nmea_ShmSubscriber_t* is the handle or NULL on failure (no ring or no free slot)
+ */
+nmea_ShmSubscriber_t* nmea_shm_subscribe(const char *name)
+{
+    struct stat st;
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0 || fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(shmHeader_t)) {
+        printf("ERROR: Shared memory %s NOT available!\n", name);
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    shmHeader_t *hdr = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (hdr == MAP_FAILED) {
+        printf("ERROR: Shared memory NOT mapped (%s)!\n", strerror(errno));
+        return NULL;
+    }
+    if (atomic_load_explicit(&hdr->magic, memory_order_acquire) != SHM_MAGIC || hdr->version != SHM_VERSION
+            || hdr->recordSize != sizeof(nmea_ShmRecord_t) || (size_t) st.st_size < segmentSize(hdr->capacity)) {
+        printf("ERROR: Shared memory %s has an incompatible layout!\n", name);
+        munmap(hdr, (size_t) st.st_size);
+        return NULL;
+    }
+    for (int i = 0; i < SHM_MAX_CONSUMERS; i++) {
+        unsigned expected = 0;
+        if (atomic_compare_exchange_strong(&hdr->consumer[i].active, &expected, 1u)) {
+            nmea_ShmSubscriber_t *sub = calloc(1, sizeof(*sub));
+            if (sub == NULL) {
+                atomic_store(&hdr->consumer[i].active, 0u);
+                break;
+            }
+            sub->hdr = hdr;
+            sub->size = (size_t) st.st_size;
+            sub->index = i;
+            sub->readSeq = atomic_load_explicit(&hdr->writeSeq, memory_order_acquire);
+            atomic_store_explicit(&hdr->consumer[i].readSeq, sub->readSeq, memory_order_relaxed);
+            return sub;
+        }
+    }
+    printf("ERROR: No free subscriber slot in %s!\n", name);
+    munmap(hdr, (size_t) st.st_size);
+    return NULL;
+}
+
+/**
+ * @brief skipLapped function moves the cursor of a lapped subscriber to the oldest record that is still intact
+ * @param sub is the subscriber handle
+ * @param writeSeq is the current publisher sequence
+ * @return nmea_ShmStatus_t is always NMEA_SHM_LAPPED
+ */
+static nmea_ShmStatus_t skipLapped(nmea_ShmSubscriber_t *sub, uint64_t writeSeq)
+{
+    //One record of margin, the oldest slot may already be rewritten by the time it is read
+    uint64_t oldest = writeSeq - sub->hdr->capacity + 1;
+    if (writeSeq < sub->hdr->capacity) {
+        oldest = 0;
+    }
+    if (oldest > sub->readSeq) {
+        sub->lost += oldest - sub->readSeq;
+        sub->readSeq = oldest;
+    }
+    atomic_store_explicit(&sub->hdr->consumer[sub->index].readSeq, sub->readSeq, memory_order_relaxed);
+    return NMEA_SHM_LAPPED;
+}
+
+/**
+ * @brief nmea_shm_peek function gives the next record in place (zero copy)
+ * @param sub is the subscriber handle
+ * @param record holds the pointer to the record in shared memory
+ * @return nmea_ShmStatus_t is the status of the read
+ */
+nmea_ShmStatus_t nmea_shm_peek(nmea_ShmSubscriber_t *sub, const nmea_ShmRecord_t **record)
+{
+    uint64_t writeSeq = atomic_load_explicit(&sub->hdr->writeSeq, memory_order_acquire);
+    if (sub->readSeq == writeSeq) {
+        return NMEA_SHM_EMPTY;
+    }
+    if (writeSeq - sub->readSeq >= sub->hdr->capacity) {
+        return skipLapped(sub, writeSeq);
+    }
+    shmSlot_t *slot = &sub->hdr->slot[sub->readSeq & (sub->hdr->capacity - 1)];
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != sub->readSeq + 1) {
+        return skipLapped(sub, atomic_load_explicit(&sub->hdr->writeSeq, memory_order_acquire));
+    }
+    *record = &slot->record;
+    return NMEA_SHM_OK;
+}
+
+/**
+ * @brief nmea_shm_consume function releases the record given by nmea_shm_peek and checks it was not overwritten
+ * @param sub is the subscriber handle
+ * @return bool is true if the record was intact while it was used, false if it was lapped (discard what was read)
+ */
+bool nmea_shm_consume(nmea_ShmSubscriber_t *sub)
+{
+    shmSlot_t *slot = &sub->hdr->slot[sub->readSeq & (sub->hdr->capacity - 1)];
+    atomic_thread_fence(memory_order_acquire);
+    bool intact = atomic_load_explicit(&slot->seq, memory_order_relaxed) == sub->readSeq + 1;
+    if (!intact) {
+        sub->lost++;
+    }
+    sub->readSeq++;
+    atomic_store_explicit(&sub->hdr->consumer[sub->index].readSeq, sub->readSeq, memory_order_relaxed);
+    return intact;
+}
+
+/**
+ * @brief nmea_shm_read function copies the next record out of the ring
+ * @param sub is the subscriber handle
+ * @param record holds the copy of the record
+ * @return nmea_ShmStatus_t is the status of the read
+ */
+nmea_ShmStatus_t nmea_shm_read(nmea_ShmSubscriber_t *sub, nmea_ShmRecord_t *record)
+{
+    const nmea_ShmRecord_t *shared;
+    nmea_ShmStatus_t status = nmea_shm_peek(sub, &shared);
+    if (status != NMEA_SHM_OK) {
+        return status;
+    }
+    *record = *shared;
+    return nmea_shm_consume(sub) ? NMEA_SHM_OK : NMEA_SHM_LAPPED;
+}
+
+/**
+ * @brief nmea_shm_lapped function gives the total number of records this subscriber lost because it was lapped
+ * @param sub is the subscriber handle
+ * @return uint64_t is the number of lost records
+ */
+uint64_t nmea_shm_lapped(nmea_ShmSubscriber_t *sub)
+{
+    return sub->lost;
+}
+
+/**
+ * @brief nmea_shm_unsubscribe function releases the subscriber slot and unmaps the ring
+ * @param sub is the subscriber handle
+ * @return void
+ */
+void nmea_shm_unsubscribe(nmea_ShmSubscriber_t *sub)
+{
+    if (sub == NULL) {
+        return;
+    }
+    atomic_store(&sub->hdr->consumer[sub->index].active, 0u);
+    munmap(sub->hdr, sub->size);
+    free(sub);
+}
+
+/**
+ * @brief Result of a benchmark subscriber process, sent to the publisher through a pipe
+ */
+typedef struct {
+    uint64_t received;                  //records read intact, the end record included
+    uint64_t lapped;                    //records lost, from nmea_shm_lapped
+    uint64_t orderErrors;               //intact records which are not the next sequence number
+    uint64_t torn;                      //intact records whose content does not match their sequence number
+    uint64_t p50Ns;                     //publish to read latency
+    uint64_t p99Ns;
+} benchResult_t;
+
+/**
+ * @brief benchSleepUs function sleeps for some microseconds
+ * @param us is the time
+ * @return void
+ */
+static void benchSleepUs(long us)
+{
+    struct timespec pause = { 0, us * 1000 };
+    nanosleep(&pause, NULL);
+}
+
+/**
+ * @brief benchCompare function orders latencies for qsort
+ * @param a is the first latency
+ * @param b is the second latency
+ * @return int is the order
+ */
+static int benchCompare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief benchSubscriber function is the body of a subscriber process: it reads until the end record, checks the
+ * -order and the content of every record and measures the latency from the publish time stored in the fix
+ * @param name is the ring name
+ * @param fixes is the number of records of the run
+ * @param slow is true for the subscriber which sleeps after every BENCH_SLOW_EVERY records
+ * @param ready is the pipe which tells the publisher that the subscription is done
+ * @param out is the pipe which takes the result
+ * @return int is the exit status
+ */
+static int benchSubscriber(const char *name, uint32_t fixes, bool slow, int ready, int out)
+{
+    benchResult_t result = { 0 };
+    uint64_t *latency = malloc(((size_t) fixes + 1) * sizeof(uint64_t));
+    nmea_ShmSubscriber_t *sub = nmea_shm_subscribe(name);
+    char byte = (sub != NULL && latency != NULL) ? 1 : 0;
+    if (write(ready, &byte, 1) != 1 || byte == 0) {
+        free(latency);
+        nmea_shm_unsubscribe(sub);
+        return 1;
+    }
+    nmea_ShmRecord_t record;
+    uint64_t next = 0;
+    bool first = true;
+    for (;;) {
+        nmea_ShmStatus_t status = nmea_shm_read(sub, &record);
+        if (status == NMEA_SHM_EMPTY) {
+            benchSleepUs(50);
+            continue;
+        }
+        if (status == NMEA_SHM_LAPPED) {
+            first = true;
+            continue;
+        }
+        uint64_t now = nmea_wall_ns();
+        //The fix carries its own sequence number twice and the publish time
+        result.orderErrors += (!first && record.seq != next);
+        result.torn += (record.fix.timeMs != (uint32_t) record.seq || record.fix.tDgps != ~(uint32_t) record.seq);
+        uint64_t sentNs = (uint64_t) (uint32_t) record.fix.latitude | (uint64_t) (uint32_t) record.fix.longitude << 32;
+        latency[result.received++] = now - sentNs;
+        next = record.seq + 1;
+        first = false;
+        if (record.receiverId == BENCH_END_RECEIVER || result.received > fixes) {
+            break;
+        }
+        if (slow && result.received % BENCH_SLOW_EVERY == 0) {
+            benchSleepUs(1000);
+        }
+    }
+    result.lapped = nmea_shm_lapped(sub);
+    qsort(latency, (size_t) result.received, sizeof(uint64_t), benchCompare);
+    result.p50Ns = latency[result.received / 2];
+    result.p99Ns = latency[result.received * 99 / 100];
+    nmea_shm_unsubscribe(sub);
+    free(latency);
+    return (write(out, &result, sizeof(result)) == (ssize_t) sizeof(result)) ? 0 : 1;
+}
+
+/**
+ * @brief benchRun function publishes fixes to subscriber processes (plus one slow subscriber) at a given rate and
+ * -prints what every subscriber received, lost to laps and found out of order or torn
+ * @param fixes is the number of records
+ * @param rate is the publish rate in fixes per second (0 publishes as fast as possible)
+ * @param subscribers is the number of subscribers which keep up
+ * @return void
+ */
+static void benchRun(uint32_t fixes, uint32_t rate, int subscribers)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/gga_shm_bench_%d", (int) getpid());
+    nmea_ShmPublisher_t *pub = nmea_shm_publisher_create(name, SHM_DEFAULT_CAPACITY);
+    int ready[2] = { -1, -1 }, out[2] = { -1, -1 };
+    if (pub == NULL || pipe(ready) != 0 || pipe(out) != 0) {
+        printf("ERROR: Shared-memory benchmark NOT started!\n");
+        nmea_shm_publisher_destroy(pub);
+        return;
+    }
+    //Every subscriber is its own process, like the consumers of a gateway
+    int children = 0;
+    int attached = 0;
+    fflush(stdout);
+    for (int i = 0; i <= subscribers; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(ready[0]);
+            close(out[0]);
+            _exit(benchSubscriber(name, fixes, i == subscribers, ready[1], out[1]));
+        }
+        if (pid > 0) {
+            children++;
+        }
+    }
+    close(ready[1]);
+    close(out[1]);
+    for (int i = 0; i < children; i++) {
+        char byte = 0;
+        if (read(ready[0], &byte, 1) == 1 && byte == 1) {
+            attached++;
+        }
+    }
+    //Paced in 1 ms steps, the subscribers poll the ring and do not need the publisher to wake them
+    nmea_PackedFix_t fix = { 0 };
+    uint64_t start = nmea_wall_ns();
+    for (uint32_t i = 0; i < fixes; i++) {
+        if (rate != 0) {
+            while ((uint64_t) i * 1000000000u / rate > nmea_wall_ns() - start) {
+                benchSleepUs(1000);
+            }
+        }
+        uint64_t now = nmea_wall_ns();
+        fix.timeMs = i;
+        fix.tDgps = ~i;
+        fix.latitude = (int32_t) (uint32_t) now;
+        fix.longitude = (int32_t) (uint32_t) (now >> 32);
+        nmea_shm_publish(pub, &fix, (i + 1 == fixes) ? BENCH_END_RECEIVER : 0);
+    }
+    double seconds = (nmea_wall_ns() - start) / 1e9;
+    printf("SHM RUN-----------------------------> %lu fixes at %.0f fixes/s (%s), %d subscribers + 1 slow\n",
+           (unsigned long) fixes, fixes / seconds, rate ? "paced" : "unpaced", attached - 1);
+    benchResult_t result;
+    bool ok = (attached == children && children == subscribers + 1);
+    for (int i = 0; i < attached; i++) {
+        if (read(out[0], &result, sizeof(result)) != (ssize_t) sizeof(result)) {
+            ok = false;
+            break;
+        }
+        printf("SHM SUBSCRIBER----------------------> %llu read, %llu lapped, %llu order errors, %llu torn, latency P50/P99 %.1f/%.1f us\n",
+               (unsigned long long) result.received, (unsigned long long) result.lapped,
+               (unsigned long long) result.orderErrors, (unsigned long long) result.torn, result.p50Ns / 1e3, result.p99Ns / 1e3);
+        //Every record is either read or counted as lapped, and a record read intact is never out of order or torn
+        if (result.received + result.lapped != fixes || result.orderErrors != 0 || result.torn != 0) {
+            ok = false;
+        }
+    }
+    while (children-- > 0) {
+        wait(NULL);
+    }
+    if (!ok) {
+        printf("ERROR: Shared-memory subscribers lost records without a lap!\n");
+    }
+    close(ready[0]);
+    close(out[0]);
+    nmea_shm_publisher_destroy(pub);
+}
+
+/**
+ * @brief nmea_shm_benchmark function publishes fixes to subscriber processes at a paced rate and then as fast as
+ * -possible, one extra subscriber is too slow and gets lapped, and prints the records every subscriber read or lost
+ * @param fixes is the number of records of every run
+ * @param rate is the paced publish rate in fixes per second
+ * @param subscribers is the number of subscribers which keep up (up to SHM_MAX_CONSUMERS - 1)
+ * @return void
+ */
+void nmea_shm_benchmark(uint32_t fixes, uint32_t rate, int subscribers)
+{
+    if (fixes == 0 || subscribers < 0) {
+        return;
+    }
+    subscribers = (subscribers < BENCH_MAX_SUBSCRIBERS) ? subscribers : BENCH_MAX_SUBSCRIBERS;
+    benchRun(fixes, rate, subscribers);
+    benchRun(fixes, 0, subscribers);
+}
@@ -0,0 +1,135 @@
+/**
+ * @brief Shared-memory fan-out of packed fixes to local consumer processes (Linux only).
+ * -The publisher writes nmea_PackedFix_t records into a POSIX shared-memory ring (shm_open + mmap), every subscriber has
+ * -its own read cursor inside the shared segment. The publisher never waits for the subscribers, a subscriber that is
+ * -too slow is lapped and told so by the read function, after which it continues from the oldest record still available.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHM_DEFAULT_CAPACITY 4096       //Default number of records in the ring (power of 2)
+#define SHM_MAX_CONSUMERS 16            //Maximum number of subscribers attached at the same time
+
+/**
+ * @brief Record stored in the ring
+ */
+typedef struct {
+    uint64_t seq;                       //sequence number given by the publisher (0, 1, 2...)
+    uint32_t receiverId;                //receiver which produced the fix
+    uint32_t reserved;
+    nmea_PackedFix_t fix;
+} nmea_ShmRecord_t;
+
+/**
+ * @brief Status of a subscriber read
+ */
+typedef enum {
+    NMEA_SHM_EMPTY = 0,                 //no new record
+    NMEA_SHM_OK,                        //a record has been read
+    NMEA_SHM_LAPPED                     //the publisher overwrote unread records, the cursor moved to the oldest record
+} nmea_ShmStatus_t;
+
+/**
+ * @brief Opaque publisher and subscriber handles
+ */
+typedef struct nmea_ShmPublisher nmea_ShmPublisher_t;
+typedef struct nmea_ShmSubscriber nmea_ShmSubscriber_t;
+
+/**
+ * @brief nmea_shm_publisher_create function creates (or re-creates) the shared-memory ring
+ * @param name is the POSIX shared-memory name e.g., "/gga_fixes"
+ * @param capacity is the number of records (power of 2, 0 selects SHM_DEFAULT_CAPACITY)
+ * @return nmea_ShmPublisher_t* is the handle or NULL on failure
+ */
+nmea_ShmPublisher_t* nmea_shm_publisher_create(const char* , uint32_t );
+
+/**
+ * @brief nmea_shm_publish function writes one fix into the ring, it never blocks and makes no system call
+ * @param pub is the publisher handle
+ * @param fix is the packed fix
+ * @param receiverId is the id of the receiver which produced the fix
+ * @return uint64_t is the sequence number of the record
+ */
+uint64_t nmea_shm_publish(nmea_ShmPublisher_t* , const nmea_PackedFix_t* , uint32_t );
+
+/**
+ * @brief nmea_shm_publisher_lag function gives how many records a subscriber slot is behind the publisher
+ * @param pub is the publisher handle
+ * @param consumer is the subscriber slot (0 to SHM_MAX_CONSUMERS - 1)
+ * @return int64_t is the number of unread records or -1 if the slot is not in use
+ */
+int64_t nmea_shm_publisher_lag(nmea_ShmPublisher_t* , int );
+
+/**
+ * @brief nmea_shm_publisher_destroy function unmaps and unlinks the shared-memory ring
+ * @param pub is the publisher handle
+ * @return void
+ */
+void nmea_shm_publisher_destroy(nmea_ShmPublisher_t* );
+
+/**
+ * @brief nmea_shm_subscribe function attaches to an existing ring and claims a subscriber slot, reading starts at the
+ * -next record published
+ * @param name is the POSIX shared-memory name given to the publisher
+ * @return nmea_ShmSubscriber_t* is the handle or NULL on failure (no ring or no free slot)
+ */
+nmea_ShmSubscriber_t* nmea_shm_subscribe(const char* );
+
+/**
+ * @brief nmea_shm_peek function gives the next record in place (zero copy), the record stays valid until the
+ * -publisher laps it so nmea_shm_consume must be called once the record has been used
+ * @param sub is the subscriber handle
+ * @param record holds the pointer to the record in shared memory
+ * @return nmea_ShmStatus_t is the status of the read
+ */
+nmea_ShmStatus_t nmea_shm_peek(nmea_ShmSubscriber_t* , const nmea_ShmRecord_t** );
+
+/**
+ * @brief nmea_shm_consume function releases the record given by nmea_shm_peek and checks it was not overwritten
+ * @param sub is the subscriber handle
+ * @return bool is true if the record was intact while it was used, false if it was lapped (discard what was read)
+ */
+bool nmea_shm_consume(nmea_ShmSubscriber_t* );
+
+/**
+ * @brief nmea_shm_read function copies the next record out of the ring
+ * @param sub is the subscriber handle
+ * @param record holds the copy of the record
+ * @return nmea_ShmStatus_t is the status of the read
+ */
+nmea_ShmStatus_t nmea_shm_read(nmea_ShmSubscriber_t* , nmea_ShmRecord_t* );
+
+/**
+ * @brief nmea_shm_lapped function gives the total number of records this subscriber lost because it was lapped
+ * @param sub is the subscriber handle
+ * @return uint64_t is the number of lost records
+ */
+uint64_t nmea_shm_lapped(nmea_ShmSubscriber_t* );
+
+/**
+ * @brief nmea_shm_unsubscribe function releases the subscriber slot and unmaps the ring
+ * @param sub is the subscriber handle
+ * @return void
+ */
+void nmea_shm_unsubscribe(nmea_ShmSubscriber_t* );
+
+/**
+ * @brief nmea_shm_benchmark function publishes fixes to subscriber processes at a paced rate and then as fast as
+ * -possible, one extra subscriber is too slow and gets lapped, and prints the records every subscriber read or lost
+ * @param fixes is the number of records of every run
+ * @param rate is the paced publish rate in fixes per second
+ * @param subscribers is the number of subscribers which keep up (up to SHM_MAX_CONSUMERS - 1)
+ * @return void
+ */
+void nmea_shm_benchmark(uint32_t , uint32_t , int );
+
+#ifdef __cplusplus
+}
+#endif
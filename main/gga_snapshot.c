@@ -0,0 +1,473 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gga_snapshot.h"
+#include "gga_encode.h"
+#include "gga_validate.h"
+#include "gga_bench.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define SNAPSHOT_MAGIC 0x53414747u      //"GGAS" in little endian
+#define SNAPSHOT_CRC_OFFSET 8           //The CRC-32 covers the snapshot from the length on
+
+/**
+ * @brief Snapshot header, followed by the sections
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t crc;                       //CRC-32 of the bytes after this member
+    uint32_t length;                    //length of the snapshot, header included
+    uint16_t version;                   //NMEA_SNAPSHOT_VERSION
+    uint16_t receiver;
+    uint64_t timeUs;                    //wall time of the save
+} snapshotHeader_t;
+
+/**
+ * @brief Section header, followed by the bytes of the part
+ */
+typedef struct {
+    uint8_t type;                       //snapshotPart_t
+    uint8_t reserved;
+    uint16_t size;                      //size of the part, it must be the size of the struct of this firmware
+} snapshotSection_t;
+
+/**
+ * @brief Section types, new parts are added at the end
+ */
+typedef enum {
+    SNAPSHOT_SCANNER = 1,
+    SNAPSHOT_FILTER,
+    SNAPSHOT_DELTA,
+    SNAPSHOT_TRACK,
+    SNAPSHOT_LAST_FIX,
+    SNAPSHOT_PART_END
+} snapshotPart_t;
+
+_Static_assert(sizeof(snapshotHeader_t) == SNAPSHOT_HEADER_SIZE, "snapshot header must be SNAPSHOT_HEADER_SIZE bytes");
+_Static_assert(sizeof(snapshotSection_t) == SNAPSHOT_SECTION_SIZE, "section header must be SNAPSHOT_SECTION_SIZE bytes");
+_Static_assert(NMEA_SNAPSHOT_MAX_SIZE <= UINT16_MAX, "every part must fit the 16 bit section size");
+
+/**
+ * @brief partOf function gives a part of the receiver state and the size of its struct
+ * @param state is the receiver state
+ * @param type is the part
+ * @param size holds the size of the struct
+ * @return void* is the part or NULL if it is not in the state
+ */
+static void* partOf(const nmea_ReceiverState_t *state, int type, size_t *size)
+{
+    switch (type) {
+    case SNAPSHOT_SCANNER:
+        *size = sizeof(nmea_Scanner_t);
+        return state->scanner;
+    case SNAPSHOT_FILTER:
+        *size = sizeof(nmea_Filter_t);
+        return state->filter;
+    case SNAPSHOT_DELTA:
+        *size = sizeof(nmea_Delta_t);
+        return state->delta;
+    case SNAPSHOT_TRACK:
+        *size = sizeof(nmea_Track_t);
+        return state->track;
+    case SNAPSHOT_LAST_FIX:
+        *size = sizeof(nmea_PackedFix_t);
+        return state->lastFix;
+    default:
+        *size = 0;
+        return NULL;
+    }
+}
+
+/**
+ * @brief nmea_snapshot_size function gives the size of the snapshot of a receiver state
+ * @param state is the receiver state
+ * @return size_t is the size in bytes
+ */
+size_t nmea_snapshot_size(const nmea_ReceiverState_t *state)
+{
+    size_t total = SNAPSHOT_HEADER_SIZE;
+    for (int type = SNAPSHOT_SCANNER; type < SNAPSHOT_PART_END; type++) {
+        size_t size;
+        if (partOf(state, type, &size) != NULL) {
+            total += SNAPSHOT_SECTION_SIZE + size;
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief nmea_snapshot_save function writes the snapshot of a receiver state into a buffer
+ * @param state is the receiver state
+ * @param receiver is the receiver number
+ * @param timeUs is the wall time in microseconds which keeps running through deep sleep and restarts
+ * -(gettimeofday on the ESP32)
+ * @param buf holds the snapshot
+ * @param size is the size of buf (NMEA_SNAPSHOT_MAX_SIZE is always enough)
+ * @return size_t is the size of the snapshot or 0 if the buffer is too small
+ */
+size_t nmea_snapshot_save(const nmea_ReceiverState_t *state, uint16_t receiver, uint64_t timeUs, uint8_t *buf, size_t size)
+{
+    size_t total = nmea_snapshot_size(state);
+    if (total > size) {
+        return 0;
+    }
+    size_t pos = SNAPSHOT_HEADER_SIZE;
+    for (int type = SNAPSHOT_SCANNER; type < SNAPSHOT_PART_END; type++) {
+        size_t partSize;
+        const void *part = partOf(state, type, &partSize);
+        if (part == NULL) {
+            continue;
+        }
+        snapshotSection_t section = { (uint8_t) type, 0, (uint16_t) partSize };
+        memcpy(buf + pos, &section, SNAPSHOT_SECTION_SIZE);
+        memcpy(buf + pos + SNAPSHOT_SECTION_SIZE, part, partSize);
+        pos += SNAPSHOT_SECTION_SIZE + partSize;
+    }
+    snapshotHeader_t header = { SNAPSHOT_MAGIC, 0, (uint32_t) total, NMEA_SNAPSHOT_VERSION, receiver, timeUs };
+    memcpy(buf, &header, SNAPSHOT_HEADER_SIZE);
+    header.crc = nmea_crc32(0, buf + SNAPSHOT_CRC_OFFSET, total - SNAPSHOT_CRC_OFFSET);
+    memcpy(buf, &header, SNAPSHOT_HEADER_SIZE);
+    return total;
+}
+
+/**
+ * @brief nmea_snapshot_restore function checks a snapshot and restores the parts of the receiver state, nothing is
+ * -written unless the whole snapshot is valid. The parts which are not in the snapshot are left as they are.
+ * @param state is the receiver state
+ * @param receiver is the receiver number
+ * @param nowUs is the wall time in microseconds (the clock of nmea_snapshot_save)
+ * @param maxAgeUs is the oldest snapshot which is restored (0 has no limit)
+ * @param buf is the snapshot
+ * @param len is the length of the snapshot (can be larger than the snapshot e.g., the whole RTC buffer)
+ * @return nmea_SnapshotStatus_t is the result
+ */
+nmea_SnapshotStatus_t nmea_snapshot_restore(nmea_ReceiverState_t *state, uint16_t receiver, uint64_t nowUs,
+                                            uint64_t maxAgeUs, const uint8_t *buf, size_t len)
+{
+    snapshotHeader_t header;
+    if (len < SNAPSHOT_HEADER_SIZE) {
+        return NMEA_SNAPSHOT_NONE;
+    }
+    memcpy(&header, buf, SNAPSHOT_HEADER_SIZE);
+    if (header.magic != SNAPSHOT_MAGIC) {
+        return NMEA_SNAPSHOT_NONE;
+    }
+    if (header.length < SNAPSHOT_HEADER_SIZE || header.length > len ||
+        nmea_crc32(0, buf + SNAPSHOT_CRC_OFFSET, header.length - SNAPSHOT_CRC_OFFSET) != header.crc) {
+        return NMEA_SNAPSHOT_CORRUPT;
+    }
+    if (header.version != NMEA_SNAPSHOT_VERSION) {
+        return NMEA_SNAPSHOT_LAYOUT;
+    }
+    if (header.receiver != receiver) {
+        return NMEA_SNAPSHOT_RECEIVER;
+    }
+    if (nowUs < header.timeUs || (maxAgeUs != 0 && nowUs - header.timeUs > maxAgeUs)) {
+        return NMEA_SNAPSHOT_STALE;
+    }
+    //Every section is checked before the first part is written
+    for (int copy = 0; copy < 2; copy++) {
+        for (size_t pos = SNAPSHOT_HEADER_SIZE; pos < header.length; ) {
+            snapshotSection_t section;
+            size_t partSize;
+            if (header.length - pos < SNAPSHOT_SECTION_SIZE) {
+                return NMEA_SNAPSHOT_CORRUPT;
+            }
+            memcpy(&section, buf + pos, SNAPSHOT_SECTION_SIZE);
+            pos += SNAPSHOT_SECTION_SIZE;
+            if (section.size > header.length - pos) {
+                return NMEA_SNAPSHOT_CORRUPT;
+            }
+            void *part = partOf(state, section.type, &partSize);
+            if (!copy && (partSize == 0 || section.size != partSize)) {
+                return NMEA_SNAPSHOT_LAYOUT;
+            }
+            if (copy && part != NULL) {
+                memcpy(part, buf + pos, partSize);
+            }
+            pos += section.size;
+        }
+    }
+    //The stream starts again after the wake, a sentence split across the sleep is lost
+    if (state->scanner != NULL) {
+        state->scanner->pendingLen = 0;
+    }
+    return NMEA_SNAPSHOT_OK;
+}
+
+/**
+ * @brief nmea_snapshot_status_name function gives the name of a restore result
+ * @param status is the result
+ * @return const char* is the name
+ */
+const char* nmea_snapshot_status_name(nmea_SnapshotStatus_t status)
+{
+    static const char *const s_names[] = { "OK", "NONE", "CORRUPT", "LAYOUT", "RECEIVER", "STALE" };
+    return ((unsigned) status < sizeof(s_names) / sizeof(s_names[0])) ? s_names[status] : "UNKNOWN";
+}
+
+#ifdef __linux__
+/**
+ * @brief nmea_snapshot_save_file function writes the snapshot of a receiver state into a file (replaced atomically)
+ * @param path is the file
+ * @param state is the receiver state
+ * @param receiver is the receiver number
+ * @param timeUs is the wall time in microseconds
+ * @return int is 0 on success or -1 on failure
+ */
+int nmea_snapshot_save_file(const char *path, const nmea_ReceiverState_t *state, uint16_t receiver, uint64_t timeUs)
+{
+    uint8_t buf[NMEA_SNAPSHOT_MAX_SIZE];
+    char tmp[4096];
+    size_t len = nmea_snapshot_save(state, receiver, timeUs, buf, sizeof(buf));
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int) sizeof(tmp)) {
+        return -1;
+    }
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("ERROR: Snapshot file %s NOT created!\n", tmp);
+        return -1;
+    }
+    bool ok = (write(fd, buf, len) == (ssize_t) len) && fsync(fd) == 0;
+    ok = (close(fd) == 0) && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        printf("ERROR: Snapshot file %s NOT written!\n", path);
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief nmea_snapshot_restore_file function restores a receiver state from a snapshot file
+ * @param path is the file
+ * @param state is the receiver state
+ * @param receiver is the receiver number
+ * @param nowUs is the wall time in microseconds
+ * @param maxAgeUs is the oldest snapshot which is restored (0 has no limit)
+ * @return nmea_SnapshotStatus_t is the result (NMEA_SNAPSHOT_NONE if the file cannot be read)
+ */
+nmea_SnapshotStatus_t nmea_snapshot_restore_file(const char *path, nmea_ReceiverState_t *state, uint16_t receiver,
+                                                 uint64_t nowUs, uint64_t maxAgeUs)
+{
+    uint8_t buf[NMEA_SNAPSHOT_MAX_SIZE];
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NMEA_SNAPSHOT_NONE;
+    }
+    ssize_t len = read(fd, buf, sizeof(buf));
+    close(fd);
+    if (len <= 0) {
+        return NMEA_SNAPSHOT_NONE;
+    }
+    return nmea_snapshot_restore(state, receiver, nowUs, maxAgeUs, buf, (size_t) len);
+}
+#endif
+
+/**
+ * @brief Receiver of the benchmark: scanner, delta cache, track and last fix
+ */
+typedef struct {
+    nmea_Scanner_t scanner;
+    nmea_Delta_t delta;
+    nmea_Track_t track;
+    nmea_PackedFix_t lastFix;
+    uint16_t changed;                   //fields decoded for the last sentence
+    nmea_TrackStatus_t status;          //track status of the last sentence
+} benchReceiver_t;
+
+/**
+ * @brief benchSentence function processes a sentence found by the scanner of the benchmark receiver
+ * @param arg is the receiver
+ * @param sentence is the sentence
+ * @param len is the length of the sentence
+ * @return void
+ */
+static void benchSentence(void *arg, const char *sentence, size_t len)
+{
+    benchReceiver_t *rx = arg;
+    nmea_ParseResult_t result;
+    nmea_TrackOutput_t out;
+    if (nmea_delta_parse(&rx->delta, sentence, len, &result, &rx->changed)) {
+        rx->status = nmea_track_add(&rx->track, &result, &out);
+        rx->lastFix = out.fix;
+    }
+}
+
+/**
+ * @brief benchState function gives the parts of the benchmark receiver
+ * @param rx is the receiver
+ * @return nmea_ReceiverState_t is the receiver state
+ */
+static nmea_ReceiverState_t benchState(benchReceiver_t *rx)
+{
+    nmea_ReceiverState_t state = { &rx->scanner, NULL, &rx->delta, &rx->track, &rx->lastFix };
+    return state;
+}
+
+/**
+ * @brief benchCold function resets the benchmark receiver as after a power-on
+ * @param rx is the receiver
+ * @return void
+ */
+static void benchCold(benchReceiver_t *rx)
+{
+    nmea_scan_init(&rx->scanner);
+    nmea_delta_init(&rx->delta);
+    nmea_track_init(&rx->track, NULL);
+    memset(&rx->lastFix, 0, sizeof(rx->lastFix));
+}
+
+#define BENCH_SENTENCES 200             //Sentences of the base station stream, the snapshot is saved before the last one
+#define BENCH_MAX_AGE_US 600000000ull   //10 minutes
+
+/**
+ * @brief nmea_snapshot_benchmark function runs a receiver on a base station stream, saves and restores its state
+ * -and compares the first sentence after a cold and after a warm start, the stale, corrupted and foreign snapshots
+ * -must be rejected
+ * @param rounds is the number of timed rounds
+ * @return void
+ */
+void nmea_snapshot_benchmark(uint32_t rounds)
+{
+    static benchReceiver_t s_rx;
+    static uint8_t s_buf[NMEA_SNAPSHOT_MAX_SIZE];
+    static uint8_t s_bad[NMEA_SNAPSHOT_MAX_SIZE];
+    size_t size = (size_t) BENCH_SENTENCES * ENCODE_MAX_SENTENCE_LEN;
+    char *stream = malloc(size);
+    size_t *offset = malloc((BENCH_SENTENCES + 1) * sizeof(size_t));
+    if (stream == NULL || offset == NULL) {
+        printf("ERROR: No memory for the snapshot benchmark!\n");
+        free(stream);
+        free(offset);
+        return;
+    }
+    rounds = (rounds == 0) ? 1 : rounds;
+
+    //10 Hz base station, the position digits jitter now and then
+    uint32_t rng = 0x2545F491u;
+    nmea_PackedFix_t fix = { 0 };
+    fix.latitude = 20056618;
+    fix.longitude = -70313858;
+    fix.altitude = 2700;
+    fix.geoSep = -3420;
+    fix.qIndicator = 2;
+    fix.satTracked = 10;
+    fix.hdop = 90;
+    fix.emptyMask = (uint16_t) ((1u << NMEA_FIELD_TDGPS) | (1u << NMEA_FIELD_DRSID));
+    offset[0] = 0;
+    for (uint32_t i = 0; i < BENCH_SENTENCES; i++) {
+        uint32_t r = nmea_bench_random(&rng);
+        fix.timeMs = 43200000u + i * 100u;
+        if (r % 8 == 0) {
+            fix.latitude = 20056618 + (int32_t) (r >> 29);
+        }
+        if (r % 8 == 1) {
+            fix.longitude = -70313858 - (int32_t) (r >> 29);
+        }
+        offset[i + 1] = offset[i] + nmea_encode_packed(&fix, stream + offset[i], size - offset[i]);
+    }
+    const char *last = stream + offset[BENCH_SENTENCES - 1];
+    size_t lastLen = offset[BENCH_SENTENCES] - offset[BENCH_SENTENCES - 1];
+
+    //Steady state: the receiver runs on the stream, its state is saved before the last sentence
+    benchCold(&s_rx);
+    nmea_ReceiverState_t state = benchState(&s_rx);
+    uint64_t start = nmea_wall_us();
+    nmea_scan_feed(&s_rx.scanner, stream, offset[BENCH_SENTENCES - 1], benchSentence, &s_rx);
+    uint64_t steadyUs = nmea_wall_us() - start;
+    uint64_t savedUs = 1000000000ull;
+    size_t len = 0;
+    start = nmea_wall_us();
+    for (uint32_t i = 0; i < rounds; i++) {
+        len = nmea_snapshot_save(&state, 3, savedUs, s_buf, sizeof(s_buf));
+    }
+    uint64_t saveUs = nmea_wall_us() - start;
+
+    //Cold start: everything from scratch, every field is decoded and the track starts again
+    uint64_t coldUs = 0, warmUs = 0, restoreUs = 0;
+    uint16_t coldChanged = 0, warmChanged = 0;
+    nmea_TrackStatus_t coldStatus = NMEA_TRACK_INVALID, warmStatus = NMEA_TRACK_INVALID;
+    for (uint32_t i = 0; i < rounds; i++) {
+        benchCold(&s_rx);
+        start = nmea_wall_us();
+        nmea_scan_feed(&s_rx.scanner, last, lastLen, benchSentence, &s_rx);
+        coldUs += nmea_wall_us() - start;
+        coldChanged = s_rx.changed;
+        coldStatus = s_rx.status;
+    }
+    //Warm start: the snapshot is restored after the wake (5 minutes later)
+    nmea_SnapshotStatus_t restored = NMEA_SNAPSHOT_NONE;
+    for (uint32_t i = 0; i < rounds; i++) {
+        benchCold(&s_rx);
+        start = nmea_wall_us();
+        restored = nmea_snapshot_restore(&state, 3, savedUs + 300000000ull, BENCH_MAX_AGE_US, s_buf, sizeof(s_buf));
+        uint64_t mid = nmea_wall_us();
+        nmea_scan_feed(&s_rx.scanner, last, lastLen, benchSentence, &s_rx);
+        warmUs += nmea_wall_us() - mid;
+        restoreUs += mid - start;
+        warmChanged = s_rx.changed;
+        warmStatus = s_rx.status;
+    }
+
+    //Snapshots which must be rejected, nothing may be written into the state
+    nmea_SnapshotStatus_t checks[6];
+    nmea_PackedFix_t before = s_rx.lastFix;
+    checks[0] = nmea_snapshot_restore(&state, 3, savedUs + BENCH_MAX_AGE_US + 1, BENCH_MAX_AGE_US, s_buf, len);
+    checks[1] = nmea_snapshot_restore(&state, 3, savedUs - 1, BENCH_MAX_AGE_US, s_buf, len);
+    checks[2] = nmea_snapshot_restore(&state, 4, savedUs, BENCH_MAX_AGE_US, s_buf, len);
+    memcpy(s_bad, s_buf, len);
+    s_bad[len / 2] ^= 0x01;
+    checks[3] = nmea_snapshot_restore(&state, 3, savedUs, BENCH_MAX_AGE_US, s_bad, len);
+    memcpy(s_bad, s_buf, len);
+    s_bad[offsetof(snapshotHeader_t, version)]++;
+    uint32_t crc = nmea_crc32(0, s_bad + SNAPSHOT_CRC_OFFSET, len - SNAPSHOT_CRC_OFFSET);
+    memcpy(s_bad + offsetof(snapshotHeader_t, crc), &crc, sizeof(crc));
+    checks[4] = nmea_snapshot_restore(&state, 3, savedUs, BENCH_MAX_AGE_US, s_bad, len);
+    memset(s_bad, 0, sizeof(s_bad));
+    checks[5] = nmea_snapshot_restore(&state, 3, savedUs, BENCH_MAX_AGE_US, s_bad, sizeof(s_bad));
+    static const nmea_SnapshotStatus_t s_expected[6] = { NMEA_SNAPSHOT_STALE, NMEA_SNAPSHOT_STALE, NMEA_SNAPSHOT_RECEIVER,
+                                                         NMEA_SNAPSHOT_CORRUPT, NMEA_SNAPSHOT_LAYOUT, NMEA_SNAPSHOT_NONE };
+    bool checked = memcmp(&before, &s_rx.lastFix, sizeof(before)) == 0;
+    for (int i = 0; i < 6; i++) {
+        checked = checked && checks[i] == s_expected[i];
+    }
+
+    printf("SNAPSHOT BENCHMARK: %d sentences of a base station, %lu rounds\n", BENCH_SENTENCES, (unsigned long) rounds);
+    printf("SNAPSHOT SIZE-----------------------> %lu bytes (at most %lu)\n", (unsigned long) len,
+           (unsigned long) NMEA_SNAPSHOT_MAX_SIZE);
+    printf("SNAPSHOT SAVE/RESTORE---------------> %.0f/%.0f ns (%s)\n", (double) saveUs * 1000.0 / rounds,
+           (double) restoreUs * 1000.0 / rounds, nmea_snapshot_status_name(restored));
+    printf("SNAPSHOT STEADY-STATE SENTENCE------> %.0f ns\n", (double) steadyUs * 1000.0 / (BENCH_SENTENCES - 1));
+    printf("SNAPSHOT FIRST SENTENCE COLD/WARM---> %.0f/%.0f ns\n", (double) coldUs * 1000.0 / rounds,
+           (double) warmUs * 1000.0 / rounds);
+    printf("SNAPSHOT FIELDS DECODED COLD/WARM---> %d/%d\n", __builtin_popcount(coldChanged), __builtin_popcount(warmChanged));
+    printf("SNAPSHOT TRACK COLD/WARM------------> %s/%s\n", (coldStatus == NMEA_TRACK_STARTED) ? "started" : "not started",
+           (warmStatus == NMEA_TRACK_ACCEPTED) ? "continued" : "not continued");
+    printf("SNAPSHOT STALE/FUTURE/RECEIVER------> %s/%s/%s\n", nmea_snapshot_status_name(checks[0]),
+           nmea_snapshot_status_name(checks[1]), nmea_snapshot_status_name(checks[2]));
+    printf("SNAPSHOT CORRUPT/VERSION/EMPTY------> %s/%s/%s\n", nmea_snapshot_status_name(checks[3]),
+           nmea_snapshot_status_name(checks[4]), nmea_snapshot_status_name(checks[5]));
+    if (!checked) {
+        printf("ERROR: A stale or damaged snapshot was NOT rejected!\n");
+    }
+#ifdef __linux__
+    const char *path = "/tmp/gga_snapshot.bin";
+    benchCold(&s_rx);
+    nmea_SnapshotStatus_t fromFile = NMEA_SNAPSHOT_NONE;
+    nmea_snapshot_restore(&state, 3, savedUs, 0, s_buf, len);
+    if (nmea_snapshot_save_file(path, &state, 3, savedUs) == 0) {
+        benchCold(&s_rx);
+        fromFile = nmea_snapshot_restore_file(path, &state, 3, savedUs + 1, BENCH_MAX_AGE_US);
+        unlink(path);
+    }
+    printf("SNAPSHOT FILE ROUND TRIP------------> %s\n", nmea_snapshot_status_name(fromFile));
+#endif
+    free(stream);
+    free(offset);
+}
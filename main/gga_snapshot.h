@@ -0,0 +1,136 @@
+/**
+ * @brief Warm-start snapshot of the parser-side state of one receiver.
+ * -Battery units deep-sleep between bursts, after the wake the scanner statistics, the filter, the delta cache, the
+ * -track and the last fix are normally rebuilt from scratch. A snapshot holds every part of the receiver state which
+ * -is given to nmea_snapshot_save in one compact buffer: a versioned header with the receiver, the save time and a
+ * -CRC-32, then one section per part (type, size, the bytes of the struct). The buffer can be kept in RTC memory
+ * -(RTC_NOINIT_ATTR survives deep sleep and software restarts), in NVS (nvs_set_blob) or in a file on the host.
+ * -nmea_snapshot_restore checks the whole buffer before it writes anything, and rejects a buffer which holds no
+ * -snapshot, is corrupted, was written by a firmware with another layout, belongs to another receiver or is older than
+ * -the limit. The check (CRC-32) and the copy are linear in the size of the snapshot. A restored receiver processes
+ * -its first sentence like a steady-state one: the delta cache decodes only the changed fields and the track continues
+ * -(when the sleep was shorter than its maxGapMs). The snapshot is in the byte order and the struct layout of the
+ * -firmware which wrote it, it is not a transport format, NMEA_SNAPSHOT_VERSION must be raised when one of the saved
+ * -structs changes.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+#include "gga_scan.h"
+#include "gga_filter.h"
+#include "gga_delta.h"
+#include "gga_track.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NMEA_SNAPSHOT_VERSION 1         //Raised with every change of a saved struct
+#define SNAPSHOT_HEADER_SIZE 24         //Magic, CRC-32, length, version, receiver and save time
+#define SNAPSHOT_SECTION_SIZE 4         //Type, reserved byte and size of a section
+
+/**
+ * @brief Largest snapshot (every part saved), the size of an RTC memory or NVS buffer
+ */
+#define NMEA_SNAPSHOT_MAX_SIZE (SNAPSHOT_HEADER_SIZE + 5 * SNAPSHOT_SECTION_SIZE + sizeof(nmea_Scanner_t) + \
+                                sizeof(nmea_Filter_t) + sizeof(nmea_Delta_t) + sizeof(nmea_Track_t) + sizeof(nmea_PackedFix_t))
+
+/**
+ * @brief Parts of the state of one receiver, the NULL parts are not saved and not restored
+ */
+typedef struct {
+    nmea_Scanner_t *scanner;            //stream scanner, the start of a sentence split across chunks is not restored
+    nmea_Filter_t *filter;              //predicates, decimation and statistics
+    nmea_Delta_t *delta;                //field cache of the previous sentence
+    nmea_Track_t *track;                //outlier and smoothing filter
+    nmea_PackedFix_t *lastFix;          //last fix given to the application
+} nmea_ReceiverState_t;
+
+/**
+ * @brief Result of nmea_snapshot_restore
+ */
+typedef enum {
+    NMEA_SNAPSHOT_OK = 0,
+    NMEA_SNAPSHOT_NONE,                 //no snapshot in the buffer (e.g. RTC memory after power-on)
+    NMEA_SNAPSHOT_CORRUPT,              //wrong length, CRC or section
+    NMEA_SNAPSHOT_LAYOUT,               //written by a firmware with another version or struct layout
+    NMEA_SNAPSHOT_RECEIVER,             //snapshot of another receiver
+    NMEA_SNAPSHOT_STALE                 //older than the limit or saved in the future
+} nmea_SnapshotStatus_t;
+
+/**
+ * @brief nmea_snapshot_size function gives the size of the snapshot of a receiver state
+ * @param state is the receiver state
+ * @return size_t is the size in bytes
+ */
+size_t nmea_snapshot_size(const nmea_ReceiverState_t* );
+
+/**
+ * @brief nmea_snapshot_save function writes the snapshot of a receiver state into a buffer
+ * @param state is the receiver state
+ * @param receiver is the receiver number
+ * @param timeUs is the wall time in microseconds which keeps running through deep sleep and restarts
+ * -(gettimeofday on the ESP32)
+ * @param buf holds the snapshot
+ * @param size is the size of buf (NMEA_SNAPSHOT_MAX_SIZE is always enough)
+ * @return size_t is the size of the snapshot or 0 if the buffer is too small
+ */
+size_t nmea_snapshot_save(const nmea_ReceiverState_t* , uint16_t , uint64_t , uint8_t* , size_t );
+
+/**
+ * @brief nmea_snapshot_restore function checks a snapshot and restores the parts of the receiver state, nothing is
+ * -written unless the whole snapshot is valid. The parts which are not in the snapshot are left as they are.
+ * @param state is the receiver state
+ * @param receiver is the receiver number
+ * @param nowUs is the wall time in microseconds (the clock of nmea_snapshot_save)
+ * @param maxAgeUs is the oldest snapshot which is restored (0 has no limit)
+ * @param buf is the snapshot
+ * @param len is the length of the snapshot (can be larger than the snapshot e.g., the whole RTC buffer)
+ * @return nmea_SnapshotStatus_t is the result
+ */
+nmea_SnapshotStatus_t nmea_snapshot_restore(nmea_ReceiverState_t* , uint16_t , uint64_t , uint64_t , const uint8_t* , size_t );
+
+/**
+ * @brief nmea_snapshot_status_name function gives the name of a restore result
+ * @param status is the result
+ * @return const char* is the name
+ */
+const char* nmea_snapshot_status_name(nmea_SnapshotStatus_t );
+
+#ifdef __linux__
+/**
+ * @brief nmea_snapshot_save_file function writes the snapshot of a receiver state into a file (replaced atomically)
+ * @param path is the file
+ * @param state is the receiver state
+ * @param receiver is the receiver number
+ * @param timeUs is the wall time in microseconds
+ * @return int is 0 on success or -1 on failure
+ */
+int nmea_snapshot_save_file(const char* , const nmea_ReceiverState_t* , uint16_t , uint64_t );
+
+/**
+ * @brief nmea_snapshot_restore_file function restores a receiver state from a snapshot file
+ * @param path is the file
+ * @param state is the receiver state
+ * @param receiver is the receiver number
+ * @param nowUs is the wall time in microseconds
+ * @param maxAgeUs is the oldest snapshot which is restored (0 has no limit)
+ * @return nmea_SnapshotStatus_t is the result (NMEA_SNAPSHOT_NONE if the file cannot be read)
+ */
+nmea_SnapshotStatus_t nmea_snapshot_restore_file(const char* , nmea_ReceiverState_t* , uint16_t , uint64_t , uint64_t );
+#endif
+
+/**
+ * @brief nmea_snapshot_benchmark function runs a receiver on a base station stream, saves and restores its state
+ * -and compares the first sentence after a cold and after a warm start, the stale, corrupted and foreign snapshots
+ * -must be rejected
+ * @param rounds is the number of timed rounds
+ * @return void
+ */
+void nmea_snapshot_benchmark(uint32_t );
+
+#ifdef __cplusplus
+}
+#endif
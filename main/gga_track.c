@@ -0,0 +1,580 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "gga_track.h"
+#include "gga_bench.h"
+
+#define DAY_MS 86400000u                //Times wrap around at midnight
+#define HALF_CIRCLE (180 * 60 * 10000)  //180 degrees in 1/10000 of a minute
+#define UNITS_PER_DEGREE (60 * 10000)   //1/10000 of a minute per degree
+#define MAX_LATITUDE (90 * UNITS_PER_DEGREE)
+#define BIT(field) ((uint16_t) (1u << (field)))
+#define POSITION_BITS (BIT(NMEA_FIELD_LATITUDE) | BIT(NMEA_FIELD_LATITUDE_IND) | BIT(NMEA_FIELD_LONGITUDE) | BIT(NMEA_FIELD_LONGITUDE_IND))
+#define ALTITUDE_BITS (BIT(NMEA_FIELD_ALTITUDE) | BIT(NMEA_FIELD_ALTITUDE_IND))
+
+#define AXIS_NORTH 0
+#define AXIS_EAST 1
+#define AXIS_UP 2
+#define DEFAULT_HDOP 500                //HDOP in 1/100 assumed when the field is empty or incorrect
+#define MIN_HDOP 50                     //Smaller HDOP values are raised to it
+#define START_SPEED_MM_S 100000         //Standard deviation of the unknown velocity when the track starts
+#define MAX_SPEED_MM_S 400000           //Velocity limit, keeps the predicted positions in 32 bits
+#define MAX_INNOVATION_MM 100000000     //Fixes further than 100 km from the prediction are rejected without the gate
+#define RECENTER_MM 10000000            //The origin follows the track when it is 10 km away
+#define MAX_P00 100000000000000LL       //Variance limits, (10 km)^2, (100 m/s)^2 and their product
+#define MAX_P11 10000000000LL
+#define MAX_P01 1000000000000LL
+
+//Typical horizontal error at HDOP 1 in mm by quality indicator: invalid, GPS, DGPS, PPS, RTK fixed, float RTK,
+//dead reckoning, manual input, simulation
+static const uint16_t s_qualitySigma[MAX_QI_VAL + 1] = { 0, 3000, 1000, 2000, 20, 300, 10000, 1000, 3000 };
+
+//Cosine of 0 to 90 degrees in 1/32768, scale of the east axis
+static const uint16_t s_cosine[91] = {
+    32767, 32763, 32748, 32723, 32688, 32643, 32588, 32524, 32449, 32365, 32270, 32166, 32052, 31928, 31795, 31651,
+    31499, 31336, 31164, 30983, 30792, 30592, 30382, 30163, 29935, 29698, 29452, 29197, 28932, 28660, 28378, 28088,
+    27789, 27482, 27166, 26842, 26510, 26170, 25822, 25466, 25102, 24730, 24351, 23965, 23571, 23170, 22763, 22348,
+    21926, 21498, 21063, 20622, 20174, 19720, 19261, 18795, 18324, 17847, 17364, 16877, 16384, 15886, 15384, 14876,
+    14365, 13848, 13328, 12803, 12275, 11743, 11207, 10668, 10126, 9580, 9032, 8481, 7927, 7371, 6813, 6252, 5690,
+    5126, 4560, 3993, 3425, 2856, 2286, 1715, 1144, 572, 0
+};
+
+/**
+ * @brief divRound function divides with rounding to the nearest integer
+ * @param n is the dividend
+ * @param d is the divisor (positive)
+ * @return int64_t is the quotient
+ */
+static inline int64_t divRound(int64_t n, int64_t d)
+{
+    return (n >= 0) ? (n + d / 2) / d : -((-n + d / 2) / d);
+}
+
+/**
+ * @brief isqrt function is the integer square root
+ * @param x is the value
+ * @return uint32_t is the square root rounded down
+ */
+static uint32_t isqrt(uint64_t x)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ull << 62;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (root > UINT32_MAX) ? UINT32_MAX : (uint32_t) root;
+}
+
+/**
+ * @brief cosineOf function gives the cosine of a latitude by linear interpolation of the table
+ * @param lat is the latitude in 1/10000 of a minute
+ * @return uint16_t is the cosine in 1/32768 (at least 1)
+ */
+static uint16_t cosineOf(int32_t lat)
+{
+    uint32_t a = (uint32_t) ((lat < 0) ? -lat : lat);
+    uint32_t deg = a / UNITS_PER_DEGREE;
+    if (deg >= 90) {
+        return 1;
+    }
+    uint32_t frac = a % UNITS_PER_DEGREE;
+    uint32_t c = s_cosine[deg] - (uint32_t) ((uint64_t) (s_cosine[deg] - s_cosine[deg + 1]) * frac / UNITS_PER_DEGREE);
+    return (c == 0) ? 1 : (uint16_t) c;
+}
+
+/**
+ * @brief wrapLongitude function wraps a longitude or a longitude difference into -180 to 180 degrees
+ * @param lon is the longitude in 1/10000 of a minute
+ * @return int64_t is the wrapped longitude
+ */
+static inline int64_t wrapLongitude(int64_t lon)
+{
+    return (lon > HALF_CIRCLE) ? lon - 2 * HALF_CIRCLE : (lon <= -HALF_CIRCLE) ? lon + 2 * HALF_CIRCLE : lon;
+}
+
+/**
+ * @brief northMm function converts a latitude difference to millimetres (1/10000 of a minute is 185.2 mm)
+ * @param units is the difference in 1/10000 of a minute
+ * @return int64_t is the distance
+ */
+static inline int64_t northMm(int64_t units)
+{
+    return divRound(units * 1852, 10);
+}
+
+/**
+ * @brief eastMm function converts a longitude difference to millimetres at the origin latitude
+ * @param units is the difference in 1/10000 of a minute
+ * @param cosLat is the cosine of the origin latitude in 1/32768
+ * @return int64_t is the distance
+ */
+static inline int64_t eastMm(int64_t units, uint16_t cosLat)
+{
+    return divRound(units * 1852 * cosLat, 10 * 32768);
+}
+
+/**
+ * @brief clampAxis function keeps the state of an axis in its limits (no overflow, positive variances)
+ * @param axis is the axis
+ * @return void
+ */
+static void clampAxis(nmea_TrackAxis_t *axis)
+{
+    axis->vel = (axis->vel > MAX_SPEED_MM_S) ? MAX_SPEED_MM_S : (axis->vel < -MAX_SPEED_MM_S) ? -MAX_SPEED_MM_S : axis->vel;
+    axis->p00 = (axis->p00 > MAX_P00) ? MAX_P00 : (axis->p00 < 1) ? 1 : axis->p00;
+    axis->p11 = (axis->p11 > MAX_P11) ? MAX_P11 : (axis->p11 < 1) ? 1 : axis->p11;
+    axis->p01 = (axis->p01 > MAX_P01) ? MAX_P01 : (axis->p01 < -MAX_P01) ? -MAX_P01 : axis->p01;
+}
+
+/**
+ * @brief startAxis function starts an axis at a measured position with an unknown velocity
+ * @param axis is the axis
+ * @param pos is the position in mm
+ * @param r is the variance of the measurement in mm^2
+ * @return void
+ */
+static void startAxis(nmea_TrackAxis_t *axis, int32_t pos, int64_t r)
+{
+    axis->pos = pos;
+    axis->vel = 0;
+    axis->p00 = r;
+    axis->p01 = 0;
+    axis->p11 = (int64_t) START_SPEED_MM_S * START_SPEED_MM_S;
+    clampAxis(axis);
+}
+
+/**
+ * @brief predictAxis function moves an axis forward with its velocity, the variances grow by the acceleration noise
+ * -(piecewise constant acceleration: a^2 dt^4/4, a^2 dt^3/2 and a^2 dt^2)
+ * @param axis is the axis
+ * @param dtMs is the time step (at most TRACK_MAX_GAP_MS)
+ * @param q11 is the velocity noise a^2 dt^2 in mm^2/s^2
+ * @return void
+ */
+static void predictAxis(nmea_TrackAxis_t *axis, int64_t dtMs, int64_t q11)
+{
+    int64_t dtP11 = axis->p11 * dtMs / 1000;
+    axis->pos += (int32_t) divRound((int64_t) axis->vel * dtMs, 1000);
+    axis->p00 += (2 * axis->p01 + dtP11) * dtMs / 1000 + q11 * dtMs * dtMs / 4000000;
+    axis->p01 += dtP11 + q11 * dtMs / 2000;
+    axis->p11 += q11;
+    clampAxis(axis);
+}
+
+/**
+ * @brief updateAxis function corrects an axis with the innovation of a measurement (gains in 1/65536)
+ * @param axis is the axis
+ * @param y is the innovation (measurement minus prediction) in mm
+ * @param s is the variance of the innovation in mm^2
+ * @return void
+ */
+static void updateAxis(nmea_TrackAxis_t *axis, int64_t y, int64_t s)
+{
+    int64_t k0 = axis->p00 * 65536 / s;
+    int64_t k1 = axis->p01 * 65536 / s;
+    axis->pos += (int32_t) ((k0 * y) >> 16);
+    axis->vel += (int32_t) ((k1 * y) >> 16);
+    axis->p11 -= (k1 * axis->p01) >> 16;
+    axis->p01 -= (k0 * axis->p01) >> 16;
+    axis->p00 -= (k0 * axis->p00) >> 16;
+    clampAxis(axis);
+}
+
+/**
+ * @brief measurementVariance function gives the horizontal variance of a fix from its quality indicator and HDOP
+ * @param fix is the packed fix
+ * @return int64_t is the variance in mm^2
+ */
+static int64_t measurementVariance(const nmea_PackedFix_t *fix)
+{
+    uint16_t bad = fix->emptyMask | fix->falseMask;
+    uint32_t quality = ((bad & BIT(NMEA_FIELD_QIND)) || fix->qIndicator > MAX_QI_VAL) ? 1 : fix->qIndicator;
+    uint32_t hdop = (bad & BIT(NMEA_FIELD_HDOP)) ? DEFAULT_HDOP : (fix->hdop < MIN_HDOP) ? MIN_HDOP : fix->hdop;
+    int64_t sigma = (int64_t) s_qualitySigma[quality] * hdop / 100;
+    return (sigma < 1) ? 1 : sigma * sigma;
+}
+
+/**
+ * @brief recenter function moves the origin to the position of the track when it is far from it, so the north and
+ * -east positions stay small and the east scale fits the latitude
+ * @param track is the track state
+ * @return void
+ */
+static void recenter(nmea_Track_t *track)
+{
+    nmea_TrackAxis_t *north = &track->axis[AXIS_NORTH];
+    nmea_TrackAxis_t *east = &track->axis[AXIS_EAST];
+    if (north->pos < RECENTER_MM && north->pos > -RECENTER_MM && east->pos < RECENTER_MM && east->pos > -RECENTER_MM) {
+        return;
+    }
+    int64_t dLat = divRound((int64_t) north->pos * 10, 1852);
+    int64_t dLon = divRound((int64_t) east->pos * 10 * 32768, (int64_t) 1852 * track->cosLat);
+    int64_t lat = track->originLat + dLat;
+    lat = (lat > MAX_LATITUDE) ? MAX_LATITUDE : (lat < -MAX_LATITUDE) ? -MAX_LATITUDE : lat;
+    north->pos -= (int32_t) northMm(lat - track->originLat);
+    east->pos -= (int32_t) eastMm(dLon, track->cosLat);
+    track->originLat = (int32_t) lat;
+    track->originLon = (int32_t) wrapLongitude(track->originLon + dLon);
+    track->cosLat = cosineOf(track->originLat);
+}
+
+/**
+ * @brief start function restarts the track at a fix
+ * @param track is the track state
+ * @param fix is the packed fix
+ * @param r is the horizontal variance of the fix
+ * @return void
+ */
+static void start(nmea_Track_t *track, const nmea_PackedFix_t *fix, int64_t r)
+{
+    track->running = true;
+    track->timeMs = fix->timeMs;
+    track->acceptedMs = fix->timeMs;
+    track->originLat = fix->latitude;
+    track->originLon = fix->longitude;
+    track->cosLat = cosineOf(fix->latitude);
+    startAxis(&track->axis[AXIS_NORTH], 0, r);
+    startAxis(&track->axis[AXIS_EAST], 0, r);
+    track->hasAltitude = !((fix->emptyMask | fix->falseMask) & ALTITUDE_BITS);
+    if (track->hasAltitude) {
+        startAxis(&track->axis[AXIS_UP], fix->altitude * 10, r * 9 / 4);
+    }
+    track->stats.started++;
+}
+
+/**
+ * @brief output function writes the state of the track into the output
+ * @param track is the track state
+ * @param fix is the packed fix
+ * @param status is the status of the fix
+ * @param innovationMm is the horizontal innovation
+ * @param out holds the output
+ * @return nmea_TrackStatus_t is the status
+ */
+static nmea_TrackStatus_t output(const nmea_Track_t *track, const nmea_PackedFix_t *fix, nmea_TrackStatus_t status,
+                                 uint32_t innovationMm, nmea_TrackOutput_t *out)
+{
+    const nmea_TrackAxis_t *north = &track->axis[AXIS_NORTH];
+    const nmea_TrackAxis_t *east = &track->axis[AXIS_EAST];
+    out->fix = *fix;
+    out->status = status;
+    out->rejected = (status == NMEA_TRACK_REJECTED);
+    out->innovationMm = innovationMm;
+    if (!track->running) {
+        memset(out->velocity, 0, sizeof(out->velocity));
+        out->sigmaMm = UINT32_MAX;
+        return status;
+    }
+    int64_t lat = track->originLat + divRound((int64_t) north->pos * 10, 1852);
+    int64_t dLon = divRound((int64_t) east->pos * 10 * 32768, (int64_t) 1852 * track->cosLat);
+    out->fix.latitude = (int32_t) ((lat > MAX_LATITUDE) ? MAX_LATITUDE : (lat < -MAX_LATITUDE) ? -MAX_LATITUDE : lat);
+    out->fix.longitude = (int32_t) wrapLongitude(track->originLon + dLon);
+    out->fix.emptyMask &= (uint16_t) ~POSITION_BITS;
+    out->fix.falseMask &= (uint16_t) ~POSITION_BITS;
+    if (track->hasAltitude) {
+        out->fix.altitude = (int32_t) divRound(track->axis[AXIS_UP].pos, 10);
+        out->fix.emptyMask &= (uint16_t) ~ALTITUDE_BITS;
+        out->fix.falseMask &= (uint16_t) ~ALTITUDE_BITS;
+    }
+    for (int i = 0; i < 3; i++) {
+        out->velocity[i] = (i != AXIS_UP || track->hasAltitude) ? track->axis[i].vel : 0;
+    }
+    out->sigmaMm = isqrt((uint64_t) (north->p00 + east->p00));
+    return status;
+}
+
+/**
+ * @brief nmea_track_init function resets the track
+ * @param track is the track state
+ * @param config is the configuration, NULL selects the defaults
+ * @return void
+ */
+void nmea_track_init(nmea_Track_t *track, const nmea_TrackConfig_t *config)
+{
+    memset(track, 0, sizeof(*track));
+    if (config != NULL) {
+        track->config = *config;
+    }
+    if (track->config.accelMmS2 == 0) track->config.accelMmS2 = TRACK_DEFAULT_ACCEL_MM_S2;
+    if (track->config.accelMmS2 > TRACK_MAX_ACCEL_MM_S2) track->config.accelMmS2 = TRACK_MAX_ACCEL_MM_S2;
+    if (track->config.resetMs == 0) track->config.resetMs = TRACK_DEFAULT_RESET_MS;
+    if (track->config.maxGapMs == 0) track->config.maxGapMs = TRACK_DEFAULT_MAX_GAP_MS;
+    if (track->config.maxGapMs > TRACK_MAX_GAP_MS) track->config.maxGapMs = TRACK_MAX_GAP_MS;
+    if (track->config.gate == 0) track->config.gate = TRACK_DEFAULT_GATE;
+}
+
+/**
+ * @brief nmea_track_add_packed function is nmea_track_add for a packed fix
+ * @param track is the track state of the receiver (one task at a time)
+ * @param fix is the packed fix
+ * @param out holds the filtered fix
+ * @return nmea_TrackStatus_t is the status of the fix
+ */
+nmea_TrackStatus_t nmea_track_add_packed(nmea_Track_t *track, const nmea_PackedFix_t *fix, nmea_TrackOutput_t *out)
+{
+    uint16_t bad = fix->emptyMask | fix->falseMask;
+    track->stats.fixes++;
+    if ((bad & (POSITION_BITS | BIT(NMEA_FIELD_TIME))) || fix->qIndicator == 0 || fix->timeMs >= DAY_MS) {
+        track->stats.invalid++;
+        return output(track, fix, NMEA_TRACK_INVALID, 0, out);
+    }
+    int64_t r = measurementVariance(fix);
+    if (!track->running) {
+        start(track, fix, r);
+        return output(track, fix, NMEA_TRACK_STARTED, 0, out);
+    }
+    //The time step wraps around at midnight, an older fix is not used
+    uint32_t dtMs = (fix->timeMs + DAY_MS - track->timeMs) % DAY_MS;
+    if (dtMs >= DAY_MS / 2) {
+        track->stats.invalid++;
+        return output(track, fix, NMEA_TRACK_INVALID, 0, out);
+    }
+    if (dtMs > track->config.maxGapMs) {
+        track->stats.restartsByGap++;
+        start(track, fix, r);
+        return output(track, fix, NMEA_TRACK_STARTED, 0, out);
+    }
+    if (dtMs != 0) {
+        int64_t accel = track->config.accelMmS2;
+        int64_t q11 = accel * accel * dtMs * dtMs / 1000000;
+        for (int i = 0; i < 3; i++) {
+            if (i != AXIS_UP || track->hasAltitude) {
+                predictAxis(&track->axis[i], dtMs, q11);
+            }
+        }
+        track->timeMs = fix->timeMs;
+    }
+
+    //Innovation of every axis and its squared distance normalized by the variance (in 1/256)
+    int64_t y[3], s[3];
+    int64_t lonDiff = wrapLongitude((int64_t) fix->longitude - track->originLon);
+    y[AXIS_NORTH] = northMm((int64_t) fix->latitude - track->originLat) - track->axis[AXIS_NORTH].pos;
+    y[AXIS_EAST] = eastMm(lonDiff, track->cosLat) - track->axis[AXIS_EAST].pos;
+    s[AXIS_NORTH] = track->axis[AXIS_NORTH].p00 + r;
+    s[AXIS_EAST] = track->axis[AXIS_EAST].p00 + r;
+    bool altitude = !(bad & ALTITUDE_BITS);
+    int axes = 2;
+    if (altitude && track->hasAltitude) {
+        y[AXIS_UP] = (int64_t) fix->altitude * 10 - track->axis[AXIS_UP].pos;
+        s[AXIS_UP] = track->axis[AXIS_UP].p00 + r * 9 / 4;
+        axes = 3;
+    }
+    bool outside = false;
+    uint64_t distance = 0;
+    for (int i = 0; i < axes; i++) {
+        if (y[i] > MAX_INNOVATION_MM || y[i] < -MAX_INNOVATION_MM) {
+            outside = true;
+            break;
+        }
+        distance += (uint64_t) (y[i] * y[i] * 256 / s[i]);
+    }
+    uint32_t gate = track->config.gate;
+    outside = outside || distance > (uint64_t) gate * gate * 256;
+    uint32_t innovationMm = UINT32_MAX;
+    if (y[AXIS_NORTH] <= MAX_INNOVATION_MM && y[AXIS_NORTH] >= -MAX_INNOVATION_MM &&
+        y[AXIS_EAST] <= MAX_INNOVATION_MM && y[AXIS_EAST] >= -MAX_INNOVATION_MM) {
+        innovationMm = isqrt((uint64_t) (y[AXIS_NORTH] * y[AXIS_NORTH] + y[AXIS_EAST] * y[AXIS_EAST]));
+    }
+
+    if (outside) {
+        //A jump which lasts is real (e.g. the end of a tunnel), the track restarts at it
+        if ((fix->timeMs + DAY_MS - track->acceptedMs) % DAY_MS >= track->config.resetMs) {
+            track->stats.restartsByJump++;
+            start(track, fix, r);
+            return output(track, fix, NMEA_TRACK_STARTED, innovationMm, out);
+        }
+        track->stats.rejected++;
+        if (innovationMm > track->stats.innovationMaxMm) {
+            track->stats.innovationMaxMm = innovationMm;
+        }
+        recenter(track);
+        return output(track, fix, NMEA_TRACK_REJECTED, innovationMm, out);
+    }
+    for (int i = 0; i < axes; i++) {
+        updateAxis(&track->axis[i], y[i], s[i]);
+    }
+    if (altitude && !track->hasAltitude) {
+        track->hasAltitude = true;
+        startAxis(&track->axis[AXIS_UP], fix->altitude * 10, r * 9 / 4);
+    }
+    track->acceptedMs = fix->timeMs;
+    track->stats.accepted++;
+    recenter(track);
+    return output(track, fix, NMEA_TRACK_ACCEPTED, innovationMm, out);
+}
+
+/**
+ * @brief nmea_track_add function filters the next fix of the receiver
+ * @param track is the track state of the receiver (one task at a time)
+ * @param fix is the parse result
+ * @param out holds the filtered fix
+ * @return nmea_TrackStatus_t is the status of the fix
+ */
+nmea_TrackStatus_t nmea_track_add(nmea_Track_t *track, const nmea_ParseResult_t *fix, nmea_TrackOutput_t *out)
+{
+    nmea_PackedFix_t packed;
+    nmea_pack_fix(fix, &packed);
+    return nmea_track_add_packed(track, &packed, out);
+}
+
+/**
+ * @brief nmea_track_print function prints the track statistics to console
+ * @param track is the track state
+ * @return void
+ */
+void nmea_track_print(const nmea_Track_t *track)
+{
+    const nmea_TrackStats_t *s = &track->stats;
+    printf("TRACK FIXES-------------------------> %llu\n", (unsigned long long) s->fixes);
+    printf("TRACK ACCEPTED/REJECTED/INVALID-----> %llu/%llu/%llu\n", (unsigned long long) s->accepted,
+           (unsigned long long) s->rejected, (unsigned long long) s->invalid);
+    printf("TRACK STARTS (GAP/JUMP)-------------> %llu (%llu/%llu)\n", (unsigned long long) s->started,
+           (unsigned long long) s->restartsByGap, (unsigned long long) s->restartsByJump);
+    printf("TRACK LARGEST REJECTED JUMP---------> %.1f m\n", s->innovationMaxMm / 1000.0);
+}
+
+/**
+ * @brief benchNoise function gives roughly normal noise (sum of four uniform numbers)
+ * @param state is the generator state
+ * @param sigma is the standard deviation
+ * @return int64_t is the noise
+ */
+static int64_t benchNoise(uint32_t *state, int64_t sigma)
+{
+    int64_t sum = -131072;
+    for (int i = 0; i < 4; i++) {
+        sum += nmea_bench_random(state) & 0xFFFF;
+    }
+    return sum * sigma / 37837;
+}
+
+#define BENCH_CHUNK 256                 //Fixes generated at once, only the filter is timed
+
+/**
+ * @brief nmea_track_benchmark function filters a generated trajectory with noise and multipath jumps and prints the
+ * -accuracy against the true positions, the outliers rejected and missed and the time per fix
+ * @param fixes is the number of fixes
+ * @param rateHz is the fix rate (1 to 100)
+ * @return void
+ */
+void nmea_track_benchmark(uint32_t fixes, uint32_t rateHz)
+{
+    static nmea_Track_t s_track;
+    static nmea_PackedFix_t s_fix[BENCH_CHUNK];
+    static int64_t s_true[BENCH_CHUNK][2];          //true north and east position in mm
+    static bool s_outlier[BENCH_CHUNK];
+    uint32_t rng = 0x2545F491u;
+    rateHz = (rateHz < 1) ? 1 : (rateHz > 100) ? 100 : rateHz;
+    uint32_t periodMs = 1000 / rateHz;
+    nmea_track_init(&s_track, NULL);
+
+    //The vehicle starts 60 s before midnight, the acceleration changes every 2 s and the speed stays below 30 m/s
+    const int32_t lat0 = 20226618, lon0 = -70713858;
+    const uint16_t cos0 = cosineOf(lat0);
+    uint32_t timeMs = DAY_MS - 60000u;
+    int64_t pos[2] = { 0, 0 }, vel[2] = { 0, 0 }, acc[2] = { 0, 0 };
+    uint32_t hdop = 120, quality = 1, burst = 0;
+    int64_t jump[2] = { 0, 0 };
+
+    uint64_t injected = 0, detected = 0, missed = 0, falseRejects = 0, samples = 0;
+    double rawSq = 0.0, cleanSq = 0.0, filteredSq = 0.0, filteredMax = 0.0;
+    uint64_t cleanSamples = 0, elapsed = 0;
+    for (uint32_t done = 0; done < fixes; ) {
+        uint32_t n = (fixes - done < BENCH_CHUNK) ? fixes - done : BENCH_CHUNK;
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t k = done + i;
+            if (k % (2 * rateHz) == 0) {
+                for (int a = 0; a < 2; a++) {
+                    acc[a] = (int64_t) (nmea_bench_random(&rng) % 4001) - 2000;
+                }
+            }
+            //The sky view changes every 10 s: GPS or DGPS with a new HDOP
+            if (k % (10 * rateHz) == 0) {
+                quality = 1 + nmea_bench_random(&rng) % 2;
+                hdop = 80 + nmea_bench_random(&rng) % 170;
+            }
+            for (int a = 0; a < 2; a++) {
+                vel[a] += acc[a] * periodMs / 1000;
+                vel[a] = (vel[a] > 30000) ? 30000 : (vel[a] < -30000) ? -30000 : vel[a];
+                pos[a] += vel[a] * periodMs / 1000;
+            }
+            //Multipath bursts of up to 1 s, 100 to 500 m away
+            if (burst == 0 && nmea_bench_random(&rng) % 1000 < 5) {
+                burst = 1 + nmea_bench_random(&rng) % rateHz;
+                for (int a = 0; a < 2; a++) {
+                    jump[a] = (int64_t) (100000 + nmea_bench_random(&rng) % 400001) * ((nmea_bench_random(&rng) & 1) ? 1 : -1);
+                }
+            }
+            s_outlier[i] = (burst != 0);
+            int64_t sigma = (int64_t) s_qualitySigma[quality] * hdop / 100;
+            int64_t measured[2];
+            for (int a = 0; a < 2; a++) {
+                s_true[i][a] = pos[a];
+                measured[a] = pos[a] + benchNoise(&rng, sigma) + (burst != 0 ? jump[a] : 0);
+            }
+            burst -= (burst != 0);
+            nmea_PackedFix_t *fix = &s_fix[i];
+            memset(fix, 0, sizeof(*fix));
+            fix->timeMs = timeMs;
+            fix->latitude = lat0 + (int32_t) divRound(measured[0] * 10, 1852);
+            fix->longitude = (int32_t) wrapLongitude(lon0 + divRound(measured[1] * 10 * 32768, (int64_t) 1852 * cos0));
+            fix->altitude = 2700;
+            fix->hdop = (uint16_t) hdop;
+            fix->qIndicator = (uint8_t) quality;
+            fix->satTracked = 10;
+            timeMs = (timeMs + periodMs) % DAY_MS;
+        }
+
+        static nmea_TrackOutput_t s_out[BENCH_CHUNK];
+        uint64_t start = nmea_wall_us();
+        for (uint32_t i = 0; i < n; i++) {
+            nmea_track_add_packed(&s_track, &s_fix[i], &s_out[i]);
+        }
+        elapsed += nmea_wall_us() - start;
+
+        for (uint32_t i = 0; i < n; i++) {
+            double rawN = (double) northMm(s_fix[i].latitude - lat0) - (double) s_true[i][0];
+            double rawE = (double) eastMm(wrapLongitude((int64_t) s_fix[i].longitude - lon0), cos0) - (double) s_true[i][1];
+            double outN = (double) northMm(s_out[i].fix.latitude - lat0) - (double) s_true[i][0];
+            double outE = (double) eastMm(wrapLongitude((int64_t) s_out[i].fix.longitude - lon0), cos0) - (double) s_true[i][1];
+            double filtered = outN * outN + outE * outE;
+            rawSq += rawN * rawN + rawE * rawE;
+            filteredSq += filtered;
+            filteredMax = (filtered > filteredMax) ? filtered : filteredMax;
+            samples++;
+            if (s_outlier[i]) {
+                injected++;
+                detected += s_out[i].rejected;
+                missed += !s_out[i].rejected;
+            }
+            else {
+                cleanSq += rawN * rawN + rawE * rawE;
+                cleanSamples++;
+                falseRejects += s_out[i].rejected;
+            }
+        }
+        done += n;
+    }
+    printf("TRACK BENCHMARK: %lu fixes at %lu Hz, %llu multipath outliers\n", (unsigned long) fixes,
+           (unsigned long) rateHz, (unsigned long long) injected);
+    nmea_track_print(&s_track);
+    printf("TRACK RMS ERROR RAW/CLEAN/FILTERED--> %.2f/%.2f/%.2f m\n",
+           (samples != 0) ? sqrt(rawSq / (double) samples) / 1000.0 : 0.0,
+           (cleanSamples != 0) ? sqrt(cleanSq / (double) cleanSamples) / 1000.0 : 0.0,
+           (samples != 0) ? sqrt(filteredSq / (double) samples) / 1000.0 : 0.0);
+    printf("TRACK MAX FILTERED ERROR------------> %.2f m\n", sqrt(filteredMax) / 1000.0);
+    printf("TRACK OUTLIERS REJECTED/MISSED------> %llu/%llu\n", (unsigned long long) detected, (unsigned long long) missed);
+    printf("TRACK CLEAN FIXES REJECTED----------> %llu\n", (unsigned long long) falseRejects);
+    printf("TRACK TIME PER FIX------------------> %.0f ns (%llu us)\n",
+           (fixes != 0) ? (double) elapsed * 1000.0 / (double) fixes : 0.0, (unsigned long long) elapsed);
+}
@@ -0,0 +1,145 @@
+/**
+ * @brief Outlier rejection and smoothing of the fixes of one receiver.
+ * -Multipath gives position jumps of hundreds of metres which pass every check of the parser. The track is a
+ * -constant-velocity Kalman filter with one north, east and up axis in millimetres around an origin near the fix,
+ * -computed with integer arithmetic only. The measurement variance of every fix comes from its HDOP and the typical
+ * -error of its quality indicator (RTK centimetres, GPS metres), so good fixes pull harder than bad ones.
+ * -A fix whose innovation (distance from the prediction, normalized by its expected spread) is outside the gate is
+ * -rejected and the prediction is given instead. When the fixes stay outside the gate for too long the jump is taken
+ * -as real and the track restarts at the new position. Every fix costs the same few integer operations, no heap.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACK_DEFAULT_ACCEL_MM_S2 2000  //Default acceleration noise (standard deviation), a road vehicle
+#define TRACK_DEFAULT_GATE 4            //Default innovation gate in standard deviations
+#define TRACK_DEFAULT_RESET_MS 5000     //Default time outside the gate after which the track restarts
+#define TRACK_DEFAULT_MAX_GAP_MS 5000   //Default longest time without fixes before the track restarts
+#define TRACK_MAX_ACCEL_MM_S2 20000     //Larger acceleration noise is clamped (keeps the covariances in 64 bits)
+#define TRACK_MAX_GAP_MS 10000          //Larger gaps are clamped
+
+/**
+ * @brief Track configuration, the 0 members select the defaults
+ */
+typedef struct {
+    uint32_t accelMmS2;                 //acceleration noise in mm/s^2 (0 selects TRACK_DEFAULT_ACCEL_MM_S2)
+    uint32_t resetMs;                   //time outside the gate before the track restarts (0 selects TRACK_DEFAULT_RESET_MS)
+    uint32_t maxGapMs;                  //longest time without fixes (0 selects TRACK_DEFAULT_MAX_GAP_MS)
+    uint8_t gate;                       //innovation gate in standard deviations (0 selects TRACK_DEFAULT_GATE)
+} nmea_TrackConfig_t;
+
+/**
+ * @brief Result of nmea_track_add
+ */
+typedef enum {
+    NMEA_TRACK_ACCEPTED = 0,            //the fix went into the filter
+    NMEA_TRACK_STARTED,                 //first fix, fix after a gap or after resetMs outside the gate, the track restarts
+    NMEA_TRACK_REJECTED,                //the fix is outside the gate, the output is the prediction
+    NMEA_TRACK_INVALID                  //no position, time or fix (quality 0) or an older time, the fix is not used
+} nmea_TrackStatus_t;
+
+/**
+ * @brief Output of one fix
+ */
+typedef struct {
+    nmea_PackedFix_t fix;               //the fix with the filtered latitude, longitude and altitude
+    nmea_TrackStatus_t status;
+    bool rejected;                      //the fix was rejected as an outlier (status NMEA_TRACK_REJECTED)
+    int32_t velocity[3];                //north, east and up velocity in mm/s
+    uint32_t sigmaMm;                   //horizontal standard deviation of the filtered position
+    uint32_t innovationMm;              //horizontal distance of the fix from the prediction
+} nmea_TrackOutput_t;
+
+/**
+ * @brief Track statistics
+ */
+typedef struct {
+    uint64_t fixes;                     //fixes given to nmea_track_add
+    uint64_t accepted;
+    uint64_t started;
+    uint64_t rejected;
+    uint64_t invalid;
+    uint64_t restartsByGap;             //restarts because of a gap
+    uint64_t restartsByJump;            //restarts because the fixes stayed outside the gate
+    uint32_t innovationMaxMm;           //largest innovation of a rejected fix
+} nmea_TrackStats_t;
+
+/**
+ * @brief Filter state of one axis
+ */
+typedef struct {
+    int32_t pos;                        //position in mm (north and east from the origin, up above the mean sea level)
+    int32_t vel;                        //velocity in mm/s
+    int64_t p00;                        //variance of the position in mm^2
+    int64_t p01;                        //covariance of position and velocity in mm^2/s
+    int64_t p11;                        //variance of the velocity in mm^2/s^2
+} nmea_TrackAxis_t;
+
+/**
+ * @brief Track state of one receiver, initialize with nmea_track_init
+ */
+typedef struct {
+    nmea_TrackConfig_t config;
+    bool running;                       //the track has started
+    bool hasAltitude;                   //the up axis has started
+    uint32_t timeMs;                    //time of the state
+    uint32_t acceptedMs;                //time of the last accepted fix
+    int32_t originLat;                  //origin of the north and east axes in 1/10000 of a minute
+    int32_t originLon;
+    uint16_t cosLat;                    //cosine of the origin latitude in 1/32768 (east scale)
+    nmea_TrackAxis_t axis[3];           //north, east, up
+    nmea_TrackStats_t stats;
+} nmea_Track_t;
+
+/**
+ * @brief nmea_track_init function resets the track
+ * @param track is the track state
+ * @param config is the configuration, NULL selects the defaults
+ * @return void
+ */
+void nmea_track_init(nmea_Track_t* , const nmea_TrackConfig_t* );
+
+/**
+ * @brief nmea_track_add function filters the next fix of the receiver
+ * @param track is the track state of the receiver (one task at a time)
+ * @param fix is the parse result
+ * @param out holds the filtered fix
+ * @return nmea_TrackStatus_t is the status of the fix
+ */
+nmea_TrackStatus_t nmea_track_add(nmea_Track_t* , const nmea_ParseResult_t* , nmea_TrackOutput_t* );
+
+/**
+ * @brief nmea_track_add_packed function is nmea_track_add for a packed fix
+ * @param track is the track state of the receiver (one task at a time)
+ * @param fix is the packed fix
+ * @param out holds the filtered fix
+ * @return nmea_TrackStatus_t is the status of the fix
+ */
+nmea_TrackStatus_t nmea_track_add_packed(nmea_Track_t* , const nmea_PackedFix_t* , nmea_TrackOutput_t* );
+
+/**
+ * @brief nmea_track_print function prints the track statistics to console
+ * @param track is the track state
+ * @return void
+ */
+void nmea_track_print(const nmea_Track_t* );
+
+/**
+ * @brief nmea_track_benchmark function filters a generated trajectory with noise and multipath jumps and prints the
+ * -accuracy against the true positions, the outliers rejected and missed and the time per fix
+ * @param fixes is the number of fixes
+ * @param rateHz is the fix rate (1 to 100)
+ * @return void
+ */
+void nmea_track_benchmark(uint32_t , uint32_t );
+
+#ifdef __cplusplus
+}
+#endif
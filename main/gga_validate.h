@@ -0,0 +1,117 @@
+/**
+ * @brief Validate-only integrity scan of NMEA captures (every sentence type, not only GGA).
+ * -Every line is checked for framing ('$' or '!' start, at most 82 charachters with "\r\n") and for its "*hh" XOR
+ * -checksum, nothing is copied, tokenized or printed. The byte offsets of the bad lines are collected into a caller
+ * -array and every reason has its own counter.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NMEA_MAX_SENTENCE_LEN 82        //NMEA-0183 maximum sentence length ('$' to "\r\n" included)
+
+/**
+ * @brief Reasons of a bad line
+ */
+typedef enum {
+    NMEA_BAD_CHECKSUM = 0,              //the checksum does not match
+    NMEA_BAD_TRUNCATED,                 //no "*hh" at the end of the line
+    NMEA_BAD_FRAMING,                   //the line does not start with '$' or '!'
+    NMEA_BAD_OVERLONG,                  //the line is longer than NMEA_MAX_SENTENCE_LEN
+    NMEA_BAD_REASON_COUNT
+} nmea_BadReason_t;
+
+/**
+ * @brief One bad line
+ */
+typedef struct {
+    uint64_t offset;                    //byte offset of the start of the line
+    uint32_t length;                    //length of the line without the line ending
+    uint32_t reason;                    //nmea_BadReason_t
+} nmea_BadLine_t;
+
+/**
+ * @brief Report of a scan, set badLines/badCapacity (or leave them 0) and zero everything else before the first scan
+ */
+typedef struct {
+    uint64_t bytes;                     //bytes scanned
+    uint64_t lines;                     //non empty lines scanned
+    uint64_t good;                      //lines with correct framing and checksum
+    uint64_t bad[NMEA_BAD_REASON_COUNT];//bad lines per reason
+    nmea_BadLine_t *badLines;           //caller array for the bad line offsets (can be NULL)
+    size_t badCapacity;                 //size of the caller array
+    size_t badCount;                    //entries stored in the caller array (the counters keep counting when full)
+} nmea_ValidateReport_t;
+
+/**
+ * @brief nmea_crc32 function updates a CRC-32 (IEEE 802.3) with more bytes, the CRC of a buffer is the CRC of its parts
+ * -one after the other
+ * @param crc is the CRC-32 of the bytes before (0 at the start)
+ * @param data is the buffer
+ * @param len is the length of the buffer
+ * @return uint32_t is the CRC-32
+ */
+uint32_t nmea_crc32(uint32_t , const void* , size_t );
+
+/**
+ * @brief nmea_checksum function computes the NMEA XOR checksum of the charachters between '$' and '*'
+ * @param data is the pointer to the first charachter after '$'
+ * @param len is the number of charachters up to (not including) '*'
+ * @return uint8_t is the checksum
+ */
+uint8_t nmea_checksum(const char* , size_t );
+
+/**
+ * @brief nmea_sentence_overlong function is the length rule shared by the validator and the bounded parser: at most
+ * -NMEA_MAX_SENTENCE_LEN charachters with the "\r\n", NMEA_MAX_SENTENCE_LEN - 2 without it
+ * @param line is the sentence (without or with "\r\n")
+ * @param len is the length of the sentence
+ * @return bool is true if the sentence is too long
+ */
+bool nmea_sentence_overlong(const char* , size_t );
+
+/**
+ * @brief nmea_validate_line function checks the framing and the checksum of one line
+ * @param line is the line (without or with "\r\n")
+ * @param len is the length of the line
+ * @return int is -1 if the line is good or the nmea_BadReason_t
+ */
+int nmea_validate_line(const char* , size_t );
+
+/**
+ * @brief nmea_validate_buffer function scans the complete lines of a buffer
+ * @param buffer is the data
+ * @param len is the length of the data
+ * @param baseOffset is the offset of the buffer in the capture, used for the bad line offsets
+ * @param final is true if the data after the last '\n' is a line of its own (end of the capture)
+ * @param report is updated with the results
+ * @return size_t is the number of bytes consumed, the rest (a partial line) has to be given again with the next data
+ */
+size_t nmea_validate_buffer(const char* , size_t , uint64_t , bool , nmea_ValidateReport_t* );
+
+#ifdef __linux__
+/**
+ * @brief nmea_validate_file function memory-maps a capture file and scans it
+ * @param path is the path of the capture
+ * @param report is updated with the results
+ * @return int is 0 on success or -1 if the file cannot be mapped
+ */
+int nmea_validate_file(const char* , nmea_ValidateReport_t* );
+#endif
+
+/**
+ * @brief nmea_validate_print function prints the report to console
+ * @param report is the report
+ * @return void
+ */
+void nmea_validate_print(const nmea_ValidateReport_t* );
+
+#ifdef __cplusplus
+}
+#endif
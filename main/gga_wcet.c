@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <string.h>
+#include "gga_wcet.h"
+#include "gga_bench.h"
+
+#ifdef __linux__
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#endif
+
+#define OVERLONG_LEN 1024               //Length of the overlong input
+#define YIELD_INTERVAL 1024             //Samples between two task delays (idle task and watchdog)
+
+//Longest GGA sentence: 82 charachters with "\r\n", the checksum is written by buildMaxSentence
+static const char s_maxSentence[] = "$GPGGA,235959.999,8959.9999,S,17959.9999,W,8,12,9.99,-999.9,M,-99.9,M,99,1023*00\r\n";
+
+_Static_assert(sizeof(s_maxSentence) - 1 == NMEA_MAX_SENTENCE_LEN, "s_maxSentence must have the maximum length");
+
+static const char s_mutations[] = "0123456789.,-*NSEWM";
+
+static const char *const s_inputNames[NMEA_WCET_INPUT_COUNT] = {
+    "LONGEST VALID", "MUTATED", "BAD CHECKSUM", "NO CHECKSUM", "FIELD FLOOD", "RANDOM", "OVERLONG"
+};
+
+static char s_overlong[OVERLONG_LEN];
+
+/**
+ * @brief cycles function reads the cycle counter, on x86 rdtscp waits for the instructions before it and the lfence
+ * -keeps the instructions after it from starting early, so the parse is not moved out of the measured interval
+ * @param void
+ * @return uint32_t is the counter (wraps around, only differences are used)
+ */
+static inline uint32_t cycles(void)
+{
+#ifdef __linux__
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int aux;
+    uint32_t now = (uint32_t) __rdtscp(&aux);
+    _mm_lfence();
+    return now;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) ((uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec);
+#endif
+#else
+    return (uint32_t) esp_cpu_get_cycle_count();
+#endif
+}
+
+/**
+ * @brief bucketOf function gives the histogram bucket of a cycle count
+ * @param value is the cycle count
+ * @return int is the bucket
+ */
+static inline int bucketOf(uint32_t value)
+{
+    if (value < NMEA_WCET_SUB_BUCKETS) {
+        return (int) value;
+    }
+    int msb = 31 - __builtin_clz(value);
+    return (msb - 1) * NMEA_WCET_SUB_BUCKETS + (int) ((value >> (msb - 2)) & (NMEA_WCET_SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief writeChecksum function writes the "*hh" checksum of a sentence which has a '*' at star
+ * @param sentence is the sentence
+ * @param star is the position of '*'
+ * @return void
+ */
+static void writeChecksum(char *sentence, size_t star)
+{
+    static const char s_hex[] = "0123456789ABCDEF";
+    uint8_t checksum = nmea_checksum(sentence + 1, star - 1);
+    sentence[star + 1] = s_hex[checksum >> 4];
+    sentence[star + 2] = s_hex[checksum & 0x0F];
+}
+
+/**
+ * @brief makeInput function writes one input of a class
+ * @param input is the class
+ * @param buffer holds the input (NMEA_MAX_SENTENCE_LEN bytes)
+ * @param rng is the generator state
+ * @param data is set to the input (the buffer or the overlong input)
+ * @return size_t is the length of the input
+ */
+static size_t makeInput(nmea_WcetInput_t input, char *buffer, uint32_t *rng, const char **data)
+{
+    const size_t star = NMEA_MAX_SENTENCE_LEN - 5;
+    *data = buffer;
+    memcpy(buffer, s_maxSentence, NMEA_MAX_SENTENCE_LEN);
+    switch (input) {
+    case NMEA_WCET_MAX_VALID:
+        writeChecksum(buffer, star);
+        break;
+    case NMEA_WCET_MUTATED: {
+        int changes = 1 + (int) (nmea_bench_random(rng) % 4);
+        for (int i = 0; i < changes; i++) {
+            size_t pos = 7 + nmea_bench_random(rng) % (star - 7);
+            uint32_t r = nmea_bench_random(rng);
+            buffer[pos] = (r & 0x100) ? (char) r : s_mutations[r % (sizeof(s_mutations) - 1)];
+        }
+        writeChecksum(buffer, star);
+        break;
+    }
+    case NMEA_WCET_BAD_CHECKSUM:
+        writeChecksum(buffer, star);
+        buffer[star + 2] = (buffer[star + 2] == '0') ? '1' : '0';
+        break;
+    case NMEA_WCET_NO_CHECKSUM:
+        buffer[star] = '0';
+        break;
+    case NMEA_WCET_FIELD_FLOOD:
+        memset(buffer + 7, ',', star - 7);
+        writeChecksum(buffer, star);
+        break;
+    case NMEA_WCET_RANDOM:
+        for (size_t i = 7; i < NMEA_MAX_SENTENCE_LEN; i++) {
+            buffer[i] = (char) nmea_bench_random(rng);
+        }
+        break;
+    case NMEA_WCET_OVERLONG:
+        *data = s_overlong;
+        return OVERLONG_LEN;
+    default:
+        break;
+    }
+    return NMEA_MAX_SENTENCE_LEN;
+}
+
+/**
+ * @brief measure function parses one input and gives its cycle count without the counter overhead
+ * @param data is the input
+ * @param len is the length of the input
+ * @param overhead is the counter overhead
+ * @return uint32_t is the cycle count
+ */
+static uint32_t measure(const char *data, size_t len, uint32_t overhead)
+{
+    nmea_ParseResult_t result;
+#ifndef __linux__
+    portDISABLE_INTERRUPTS();
+#endif
+    uint32_t start = cycles();
+    nmea_gga_parse_bounded(data, len, &result);
+    uint32_t elapsed = cycles() - start;
+#ifndef __linux__
+    portENABLE_INTERRUPTS();
+#endif
+    return (elapsed > overhead) ? elapsed - overhead : 0;
+}
+
+/**
+ * @brief nmea_wcet_run function parses rounds of every input class and records the cycle counts
+ * @param report holds the report (it is reset first)
+ * @param rounds is the number of inputs of every class
+ * @param seed is the seed of the random inputs (0 is replaced with 1)
+ * @return void
+ */
+void nmea_wcet_run(nmea_WcetReport_t *report, uint32_t rounds, uint32_t seed)
+{
+    char buffer[NMEA_MAX_SENTENCE_LEN];
+    uint32_t rng = (seed != 0) ? seed : 1;
+    memset(report, 0, sizeof(nmea_WcetReport_t));
+    report->minCycles = UINT32_MAX;
+    memcpy(s_overlong, s_maxSentence, NMEA_MAX_SENTENCE_LEN);
+    memset(s_overlong + NMEA_MAX_SENTENCE_LEN, '9', OVERLONG_LEN - NMEA_MAX_SENTENCE_LEN);
+    //Counter overhead i.e., the smallest difference of two reads
+    report->overheadCycles = UINT32_MAX;
+    for (int i = 0; i < 64; i++) {
+        uint32_t start = cycles();
+        uint32_t elapsed = cycles() - start;
+        if (elapsed < report->overheadCycles) {
+            report->overheadCycles = elapsed;
+        }
+    }
+    //The classes are interleaved so slow phases of the system do not hit only one class
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (int input = 0; input < NMEA_WCET_INPUT_COUNT; input++) {
+            const char *data;
+            size_t len = makeInput((nmea_WcetInput_t) input, buffer, &rng, &data);
+            uint32_t elapsed = measure(data, len, report->overheadCycles);
+            report->histogram[bucketOf(elapsed)]++;
+            report->samples++;
+            report->sumCycles += elapsed;
+            if (elapsed < report->minCycles) {
+                report->minCycles = elapsed;
+            }
+            if (elapsed > report->maxCyclesPerInput[input]) {
+                report->maxCyclesPerInput[input] = elapsed;
+            }
+            if (elapsed > report->maxCycles || report->samples == 1) {
+                report->maxCycles = elapsed;
+                report->worstInput = (uint32_t) input;
+                report->worstLen = (uint32_t) len;
+                memcpy(report->worst, data, NMEA_MAX_SENTENCE_LEN);
+                report->worst[NMEA_MAX_SENTENCE_LEN] = '\0';
+            }
+#ifndef __linux__
+            if (report->samples % YIELD_INTERVAL == 0) {
+                vTaskDelay(1);
+            }
+#endif
+        }
+    }
+}
+
+/**
+ * @brief nmea_wcet_bucket_low function gives the lowest cycle count of a histogram bucket
+ * @param bucket is the bucket
+ * @return uint32_t is the lowest cycle count
+ */
+uint32_t nmea_wcet_bucket_low(int bucket)
+{
+    if (bucket < NMEA_WCET_SUB_BUCKETS) {
+        return (uint32_t) bucket;
+    }
+    int msb = bucket / NMEA_WCET_SUB_BUCKETS + 1;
+    return (uint32_t) (NMEA_WCET_SUB_BUCKETS + bucket % NMEA_WCET_SUB_BUCKETS) << (msb - 2);
+}
+
+/**
+ * @brief escapeBytes function writes bytes as printable text, "\r", "\n", "\\" and "\xHH" for the other bytes
+ * @param out is the output, at least 4 * len + 1 bytes
+ * @param data is the data
+ * @param len is the length of the data
+ * @return void
+ */
+static void escapeBytes(char *out, const char *data, size_t len)
+{
+    static const char s_hex[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = (uint8_t) data[i];
+        if (c == '\r' || c == '\n' || c == '\\') {
+            *out++ = '\\';
+            *out++ = (c == '\r') ? 'r' : (c == '\n') ? 'n' : '\\';
+        }
+        else if (c < 0x20 || c > 0x7E) {
+            *out++ = '\\';
+            *out++ = 'x';
+            *out++ = s_hex[c >> 4];
+            *out++ = s_hex[c & 0x0F];
+        }
+        else {
+            *out++ = (char) c;
+        }
+    }
+    *out = '\0';
+}
+
+/**
+ * @brief nmea_wcet_print function prints the report and the non-empty histogram buckets to console
+ * @param report is the report
+ * @return void
+ */
+void nmea_wcet_print(const nmea_WcetReport_t *report)
+{
+    if (report->samples == 0) {
+        printf("WARNING: WCET report is empty!\n");
+        return;
+    }
+    printf("WCET SAMPLES------------------------> %llu\n", (unsigned long long) report->samples);
+    printf("WCET COUNTER OVERHEAD (cycles)------> %lu\n", (unsigned long) report->overheadCycles);
+    printf("WCET CYCLES (MIN/AVG/MAX)-----------> %lu/%lu/%lu\n", (unsigned long) report->minCycles,
+           (unsigned long) (report->sumCycles / report->samples), (unsigned long) report->maxCycles);
+    for (int i = 0; i < NMEA_WCET_INPUT_COUNT; i++) {
+        printf("WCET MAX %s%.*s> %lu\n", s_inputNames[i], (int) (27 - strlen(s_inputNames[i])), "---------------------------",
+               (unsigned long) report->maxCyclesPerInput[i]);
+    }
+    //Only the first NMEA_MAX_SENTENCE_LEN bytes are kept, random inputs hold any byte
+    static char worst[4 * NMEA_MAX_SENTENCE_LEN + 1];
+    size_t kept = (report->worstLen < NMEA_MAX_SENTENCE_LEN) ? report->worstLen : NMEA_MAX_SENTENCE_LEN;
+    escapeBytes(worst, report->worst, kept);
+    printf("WCET SLOWEST INPUT------------------> %s, %lu bytes: %s%s\n", s_inputNames[report->worstInput],
+           (unsigned long) report->worstLen, worst, (kept < report->worstLen) ? "..." : "");
+    for (int i = 0; i < NMEA_WCET_BUCKETS; i++) {
+        if (report->histogram[i] != 0) {
+            uint32_t high = (i + 1 < NMEA_WCET_BUCKETS) ? nmea_wcet_bucket_low(i + 1) - 1 : UINT32_MAX;
+            printf("    %10lu - %10lu cycles: %lu\n", (unsigned long) nmea_wcet_bucket_low(i), (unsigned long) high,
+                   (unsigned long) report->histogram[i]);
+        }
+    }
+}
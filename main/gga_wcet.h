@@ -0,0 +1,79 @@
+/**
+ * @brief Worst-case execution time harness of nmea_gga_parse_bounded.
+ * -Adversarial inputs (the longest valid sentence, random mutations of it with a fixed-up checksum, bad checksums,
+ * -missing '*', comma floods, random bytes and overlong input) are parsed one at a time and the cycle count of every
+ * -call is recorded in a histogram with 4 buckets per power of two, together with the maximum of every input class
+ * -and the slowest input. On the ESP32 the cycles are read from the CPU cycle counter with the interrupts of the core
+ * -disabled during each call, on Linux from the time stamp counter (or the monotonic clock in ns), where preemption
+ * -can still inflate single samples.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+#include "gga_validate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NMEA_WCET_SUB_BUCKETS 4         //Histogram buckets per power of two
+#define NMEA_WCET_BUCKETS 124           //Histogram buckets (covers 32 bit cycle counts)
+
+/**
+ * @brief Classes of adversarial inputs
+ */
+typedef enum {
+    NMEA_WCET_MAX_VALID = 0,            //82 charachter GGA sentence with every field filled
+    NMEA_WCET_MUTATED,                  //random charachters of the longest sentence changed, checksum fixed up
+    NMEA_WCET_BAD_CHECKSUM,             //longest sentence with a wrong checksum
+    NMEA_WCET_NO_CHECKSUM,              //82 charachters without '*'
+    NMEA_WCET_FIELD_FLOOD,              //82 charachters of commas with a valid checksum
+    NMEA_WCET_RANDOM,                   //random bytes after "$GPGGA,"
+    NMEA_WCET_OVERLONG,                 //1 KiB input, rejected before it is read
+    NMEA_WCET_INPUT_COUNT
+} nmea_WcetInput_t;
+
+/**
+ * @brief Report of a run
+ */
+typedef struct {
+    uint32_t histogram[NMEA_WCET_BUCKETS];
+    uint64_t samples;
+    uint64_t sumCycles;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t maxCyclesPerInput[NMEA_WCET_INPUT_COUNT];
+    uint32_t overheadCycles;            //cost of reading the counter, subtracted from every sample
+    uint32_t worstInput;                //nmea_WcetInput_t of the slowest call
+    uint32_t worstLen;                  //length of the slowest input (only the first 82 charachters are kept)
+    char worst[NMEA_MAX_SENTENCE_LEN + 1];
+} nmea_WcetReport_t;
+
+/**
+ * @brief nmea_wcet_run function parses rounds of every input class and records the cycle counts
+ * @param report holds the report (it is reset first)
+ * @param rounds is the number of inputs of every class
+ * @param seed is the seed of the random inputs (0 is replaced with 1)
+ * @return void
+ */
+void nmea_wcet_run(nmea_WcetReport_t* , uint32_t , uint32_t );
+
+/**
+ * @brief nmea_wcet_bucket_low function gives the lowest cycle count of a histogram bucket
+ * @param bucket is the bucket
+ * @return uint32_t is the lowest cycle count
+ */
+uint32_t nmea_wcet_bucket_low(int );
+
+/**
+ * @brief nmea_wcet_print function prints the report and the non-empty histogram buckets to console
+ * @param report is the report
+ * @return void
+ */
+void nmea_wcet_print(const nmea_WcetReport_t* );
+
+#ifdef __cplusplus
+}
+#endif
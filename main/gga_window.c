@@ -0,0 +1,492 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include "gga_window.h"
+
+#define SAMPLES CONFIG_GGA_WINDOW_SLIDING_SAMPLES
+#define READ_RETRIES 16                 //Copies a reader tries before giving up while the parser keeps publishing
+#define METRES_PER_DEGREE 111320.0      //Length of one degree of latitude
+#define DEG_TO_RAD (3.14159265358979323846 / 180.0)
+
+#define SAMPLE_HDOP 0x01                //The sample has a correct HDOP
+#define SAMPLE_SATELLITES 0x02          //The sample has a correct satellite count
+#define SAMPLE_QUALITY 0x04             //The sample has a correct quality indicator
+#define SAMPLE_POSITION 0x08            //The sample has a correct position
+
+#define FIELD_OK(fix, name) (!(fix)->isEmpty.isEmpty_##name && !(fix)->isFalse.isFalse_##name)
+
+_Static_assert(SAMPLES >= 2 && SAMPLES <= 65535, "CONFIG_GGA_WINDOW_SLIDING_SAMPLES must be 2 to 65535");
+
+/**
+ * @brief Running mean and sum of squared differences (Welford)
+ */
+typedef struct {
+    uint32_t count;
+    double mean;
+    double m2;
+} welford_t;
+
+/**
+ * @brief The aggregated values of one fix
+ */
+typedef struct {
+    uint64_t timeMs;
+    float hdop;
+    float north;                        //m from the reference position
+    float east;
+    uint8_t satellites;
+    uint8_t quality;
+    uint8_t mask;                       //SAMPLE_ bits of the correct values
+} sample_t;
+
+/**
+ * @brief Aggregates of one window
+ */
+typedef struct {
+    uint64_t startMs;
+    uint32_t fixes;
+    welford_t hdop;
+    welford_t satellites;
+    welford_t north;
+    welford_t east;
+    float hdopMin;                      //min/max of the tumbling windows only
+    float hdopMax;
+    float satMin;
+    float satMax;
+    uint32_t quality[MAX_QI_VAL + 1];
+} accumulator_t;
+
+/**
+ * @brief Monotonic deque of ring positions, the values are increasing (min) or decreasing (max) from the front
+ */
+typedef struct {
+    uint16_t pos[SAMPLES];
+    uint16_t head;
+    uint16_t len;
+} deque_t;
+
+enum { METRIC_HDOP = 0, METRIC_SATELLITES, METRIC_COUNT };
+
+/**
+ * @brief Sliding window, the fixes in the window are kept in a ring
+ */
+typedef struct {
+    sample_t sample[SAMPLES];
+    uint16_t first;                     //ring position of the oldest fix
+    uint16_t count;                     //fixes in the ring
+    deque_t minDeque[METRIC_COUNT];
+    deque_t maxDeque[METRIC_COUNT];
+    accumulator_t acc;
+    uint64_t evicted;
+} sliding_t;
+
+/**
+ * @brief Windows of one receiver and their published snapshots
+ */
+typedef struct {
+    accumulator_t tumbling[NMEA_WINDOW_SLIDING];
+    sliding_t sliding;
+    bool hasReference;
+    double refLat;                      //degrees
+    double refLon;
+    double eastScale;                   //m per degree of longitude at the reference
+    atomic_uint seq[NMEA_WINDOW_COUNT]; //odd while the parser writes the snapshot
+    nmea_WindowSnapshot_t published[NMEA_WINDOW_COUNT];
+} receiver_t;
+
+static receiver_t s_receivers[CONFIG_GGA_WINDOW_RECEIVERS];
+
+static const uint32_t s_spanMs[NMEA_WINDOW_SLIDING] = { CONFIG_GGA_WINDOW_SHORT_MS, CONFIG_GGA_WINDOW_LONG_MS };
+static const char *const s_windowNames[NMEA_WINDOW_COUNT] = { "SHORT", "LONG", "SLIDING" };
+
+/**
+ * @brief welfordAdd function adds a value
+ * @param w is the running moments
+ * @param x is the value
+ * @return void
+ */
+static inline void welfordAdd(welford_t *w, double x)
+{
+    w->count++;
+    double delta = x - w->mean;
+    w->mean += delta / w->count;
+    w->m2 += delta * (x - w->mean);
+}
+
+/**
+ * @brief welfordRemove function removes a value which was added before
+ * @param w is the running moments
+ * @param x is the value
+ * @return void
+ */
+static inline void welfordRemove(welford_t *w, double x)
+{
+    if (w->count <= 1) {
+        w->count = 0;
+        w->mean = 0.0;
+        w->m2 = 0.0;
+        return;
+    }
+    double delta = x - w->mean;
+    w->mean -= delta / (w->count - 1);
+    w->m2 -= delta * (x - w->mean);
+    w->m2 = (w->m2 > 0.0) ? w->m2 : 0.0;
+    w->count--;
+}
+
+/**
+ * @brief welfordVariance function gives the sample variance
+ * @param w is the running moments
+ * @return double is the variance (0 with less than 2 values)
+ */
+static inline double welfordVariance(const welford_t *w)
+{
+    return (w->count > 1) ? w->m2 / (w->count - 1) : 0.0;
+}
+
+/**
+ * @brief toSample function takes the aggregated values out of a parse result
+ * @param rx is the receiver (its reference position is set by the first correct position)
+ * @param timeMs is the time of the fix
+ * @param fix is the parse result
+ * @param s holds the sample
+ * @return void
+ */
+static void toSample(receiver_t *rx, uint64_t timeMs, const nmea_ParseResult_t *fix, sample_t *s)
+{
+    const nmea_Parsed_t *data = &fix->data;
+    memset(s, 0, sizeof(sample_t));
+    s->timeMs = timeMs;
+    if (FIELD_OK(fix, hdop)) {
+        s->hdop = data->gpsData_hdop;
+        s->mask |= SAMPLE_HDOP;
+    }
+    if (FIELD_OK(fix, satellite)) {
+        s->satellites = (uint8_t) data->gpsData_satTracked;
+        s->mask |= SAMPLE_SATELLITES;
+    }
+    if (FIELD_OK(fix, qInd) && data->gpsData_qIndicator >= 0 && data->gpsData_qIndicator <= MAX_QI_VAL) {
+        s->quality = (uint8_t) data->gpsData_qIndicator;
+        s->mask |= SAMPLE_QUALITY;
+    }
+    if (FIELD_OK(fix, latitude) && FIELD_OK(fix, latitudeInd) && FIELD_OK(fix, longitude) && FIELD_OK(fix, longitudeInd)) {
+        const gpsData_Position_t *pos = &data->gpsData_position;
+        double lat = pos->LATITUDE.latDeg + pos->LATITUDE.latMin / 60.0;
+        double lon = pos->LONGITUDE.longDeg + pos->LONGITUDE.longMin / 60.0;
+        lat = (pos->LATITUDE.latInd[0] == 'S') ? -lat : lat;
+        lon = (pos->LONGITUDE.longInd[0] == 'W') ? -lon : lon;
+        if (!rx->hasReference) {
+            rx->hasReference = true;
+            rx->refLat = lat;
+            rx->refLon = lon;
+            rx->eastScale = METRES_PER_DEGREE * cos(lat * DEG_TO_RAD);
+        }
+        //Longitude difference across the antimeridian
+        double dLon = lon - rx->refLon;
+        dLon = (dLon >= 180.0) ? dLon - 360.0 : (dLon < -180.0) ? dLon + 360.0 : dLon;
+        s->north = (float) ((lat - rx->refLat) * METRES_PER_DEGREE);
+        s->east = (float) (dLon * rx->eastScale);
+        s->mask |= SAMPLE_POSITION;
+    }
+}
+
+/**
+ * @brief sampleValue function gives the value of a metric of a sample in the ring
+ * @param w is the sliding window
+ * @param pos is the ring position
+ * @param metric is the metric
+ * @return float is the value
+ */
+static inline float sampleValue(const sliding_t *w, uint16_t pos, int metric)
+{
+    return (metric == METRIC_HDOP) ? w->sample[pos].hdop : (float) w->sample[pos].satellites;
+}
+
+/**
+ * @brief dequePush function adds a ring position at the back after removing the values it dominates
+ * @param w is the sliding window
+ * @param d is the deque
+ * @param pos is the ring position of the new sample
+ * @param metric is the metric
+ * @param isMax is true for the max deque
+ * @return void
+ */
+static inline void dequePush(const sliding_t *w, deque_t *d, uint16_t pos, int metric, bool isMax)
+{
+    float x = sampleValue(w, pos, metric);
+    while (d->len > 0) {
+        float back = sampleValue(w, d->pos[(d->head + d->len - 1) % SAMPLES], metric);
+        if (isMax ? (back > x) : (back < x)) {
+            break;
+        }
+        d->len--;
+    }
+    d->pos[(d->head + d->len) % SAMPLES] = pos;
+    d->len++;
+}
+
+/**
+ * @brief dequeEvict function removes a leaving ring position from the front (it can only be at the front)
+ * @param d is the deque
+ * @param pos is the ring position of the leaving sample
+ * @return void
+ */
+static inline void dequeEvict(deque_t *d, uint16_t pos)
+{
+    if (d->len > 0 && d->pos[d->head] == pos) {
+        d->head = (uint16_t) ((d->head + 1) % SAMPLES);
+        d->len--;
+    }
+}
+
+/**
+ * @brief accumulate function adds a sample to the moments and counters of a window
+ * @param acc is the window
+ * @param s is the sample
+ * @return void
+ */
+static void accumulate(accumulator_t *acc, const sample_t *s)
+{
+    acc->fixes++;
+    if (s->mask & SAMPLE_HDOP) welfordAdd(&acc->hdop, s->hdop);
+    if (s->mask & SAMPLE_SATELLITES) welfordAdd(&acc->satellites, s->satellites);
+    if (s->mask & SAMPLE_QUALITY) acc->quality[s->quality]++;
+    if (s->mask & SAMPLE_POSITION) {
+        welfordAdd(&acc->north, s->north);
+        welfordAdd(&acc->east, s->east);
+    }
+}
+
+/**
+ * @brief evictOldest function removes the oldest fix from the sliding window
+ * @param w is the sliding window
+ * @return void
+ */
+static void evictOldest(sliding_t *w)
+{
+    const sample_t *s = &w->sample[w->first];
+    accumulator_t *acc = &w->acc;
+    acc->fixes--;
+    if (s->mask & SAMPLE_HDOP) welfordRemove(&acc->hdop, s->hdop);
+    if (s->mask & SAMPLE_SATELLITES) welfordRemove(&acc->satellites, s->satellites);
+    if (s->mask & SAMPLE_QUALITY) acc->quality[s->quality]--;
+    if (s->mask & SAMPLE_POSITION) {
+        welfordRemove(&acc->north, s->north);
+        welfordRemove(&acc->east, s->east);
+    }
+    for (int m = 0; m < METRIC_COUNT; m++) {
+        dequeEvict(&w->minDeque[m], w->first);
+        dequeEvict(&w->maxDeque[m], w->first);
+    }
+    w->first = (uint16_t) ((w->first + 1) % SAMPLES);
+    w->count--;
+}
+
+/**
+ * @brief slidingAdd function adds a fix to the sliding window after the fixes which left it are removed
+ * @param w is the sliding window
+ * @param s is the sample
+ * @return void
+ */
+static void slidingAdd(sliding_t *w, const sample_t *s)
+{
+    //A time going backwards restarts the window
+    if (w->count > 0 && s->timeMs < w->sample[(w->first + w->count - 1) % SAMPLES].timeMs) {
+        uint64_t evicted = w->evicted;
+        memset(w, 0, sizeof(sliding_t));
+        w->evicted = evicted;
+    }
+    while (w->count > 0 && w->sample[w->first].timeMs + CONFIG_GGA_WINDOW_SLIDING_MS <= s->timeMs) {
+        evictOldest(w);
+    }
+    if (w->count == SAMPLES) {
+        evictOldest(w);
+        w->evicted++;
+    }
+    uint16_t pos = (uint16_t) ((w->first + w->count) % SAMPLES);
+    w->sample[pos] = *s;
+    w->count++;
+    accumulate(&w->acc, s);
+    if (s->mask & SAMPLE_HDOP) {
+        dequePush(w, &w->minDeque[METRIC_HDOP], pos, METRIC_HDOP, false);
+        dequePush(w, &w->maxDeque[METRIC_HDOP], pos, METRIC_HDOP, true);
+    }
+    if (s->mask & SAMPLE_SATELLITES) {
+        dequePush(w, &w->minDeque[METRIC_SATELLITES], pos, METRIC_SATELLITES, false);
+        dequePush(w, &w->maxDeque[METRIC_SATELLITES], pos, METRIC_SATELLITES, true);
+    }
+}
+
+/**
+ * @brief toStat function fills the mean/min/max of one value
+ * @param w is the running moments
+ * @param min is the minimum
+ * @param max is the maximum
+ * @param stat holds the statistic
+ * @return void
+ */
+static inline void toStat(const welford_t *w, float min, float max, nmea_WindowStat_t *stat)
+{
+    stat->count = w->count;
+    stat->mean = (float) w->mean;
+    stat->min = (w->count != 0) ? min : 0.0f;
+    stat->max = (w->count != 0) ? max : 0.0f;
+}
+
+/**
+ * @brief toSnapshot function fills the common part of a snapshot from the aggregates of a window
+ * @param acc is the window
+ * @param snapshot holds the snapshot
+ * @return void
+ */
+static void toSnapshot(const accumulator_t *acc, nmea_WindowSnapshot_t *snapshot)
+{
+    snapshot->fixes = acc->fixes;
+    memcpy(snapshot->quality, acc->quality, sizeof(snapshot->quality));
+    snapshot->positions = acc->north.count;
+    snapshot->northVarM2 = welfordVariance(&acc->north);
+    snapshot->eastVarM2 = welfordVariance(&acc->east);
+    snapshot->evicted = 0;
+}
+
+/**
+ * @brief publish function writes a snapshot under the seqlock of its window
+ * @param rx is the receiver
+ * @param kind is the window
+ * @param snapshot is the snapshot
+ * @return void
+ */
+static void publish(receiver_t *rx, int kind, const nmea_WindowSnapshot_t *snapshot)
+{
+    unsigned int seq = atomic_load_explicit(&rx->seq[kind], memory_order_relaxed);
+    atomic_store_explicit(&rx->seq[kind], seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    rx->published[kind] = *snapshot;
+    atomic_store_explicit(&rx->seq[kind], seq + 2, memory_order_release);
+}
+
+/**
+ * @brief nmea_window_init function resets every receiver and window, call it before the first fix
+ * @param void
+ * @return void
+ */
+void nmea_window_init(void)
+{
+    memset(s_receivers, 0, sizeof(s_receivers));
+}
+
+/**
+ * @brief nmea_window_add function adds a fix to every window of a receiver, one task at a time per receiver
+ * @param receiver is the receiver (0 to CONFIG_GGA_WINDOW_RECEIVERS - 1)
+ * @param timeMs is the monotonic time of the fix in ms
+ * @param fix is the parse result, only its correct fields are aggregated
+ * @return bool is false if the receiver is out of range
+ */
+bool nmea_window_add(int receiver, uint64_t timeMs, const nmea_ParseResult_t *fix)
+{
+    if (receiver < 0 || receiver >= CONFIG_GGA_WINDOW_RECEIVERS) {
+        return false;
+    }
+    receiver_t *rx = &s_receivers[receiver];
+    nmea_WindowSnapshot_t snapshot;
+    sample_t s;
+    toSample(rx, timeMs, fix, &s);
+    //Tumbling windows, a fix after the end (or before the start) closes and publishes the window
+    for (int k = 0; k < NMEA_WINDOW_SLIDING; k++) {
+        accumulator_t *acc = &rx->tumbling[k];
+        if (acc->fixes != 0 && (timeMs >= acc->startMs + s_spanMs[k] || timeMs < acc->startMs)) {
+            toSnapshot(acc, &snapshot);
+            toStat(&acc->hdop, acc->hdopMin, acc->hdopMax, &snapshot.hdop);
+            toStat(&acc->satellites, acc->satMin, acc->satMax, &snapshot.satellites);
+            snapshot.startMs = acc->startMs;
+            snapshot.endMs = acc->startMs + s_spanMs[k];
+            publish(rx, k, &snapshot);
+            memset(acc, 0, sizeof(accumulator_t));
+        }
+        if (acc->fixes == 0) {
+            acc->startMs = timeMs - timeMs % s_spanMs[k];
+        }
+        if (s.mask & SAMPLE_HDOP) {
+            acc->hdopMin = (acc->hdop.count == 0 || s.hdop < acc->hdopMin) ? s.hdop : acc->hdopMin;
+            acc->hdopMax = (acc->hdop.count == 0 || s.hdop > acc->hdopMax) ? s.hdop : acc->hdopMax;
+        }
+        if (s.mask & SAMPLE_SATELLITES) {
+            acc->satMin = (acc->satellites.count == 0 || s.satellites < acc->satMin) ? s.satellites : acc->satMin;
+            acc->satMax = (acc->satellites.count == 0 || s.satellites > acc->satMax) ? s.satellites : acc->satMax;
+        }
+        accumulate(acc, &s);
+    }
+    //Sliding window, published after every fix
+    sliding_t *w = &rx->sliding;
+    slidingAdd(w, &s);
+    toSnapshot(&w->acc, &snapshot);
+    const deque_t *d = w->minDeque;
+    const deque_t *e = w->maxDeque;
+    toStat(&w->acc.hdop, (d[METRIC_HDOP].len != 0) ? sampleValue(w, d[METRIC_HDOP].pos[d[METRIC_HDOP].head], METRIC_HDOP) : 0.0f,
+           (e[METRIC_HDOP].len != 0) ? sampleValue(w, e[METRIC_HDOP].pos[e[METRIC_HDOP].head], METRIC_HDOP) : 0.0f, &snapshot.hdop);
+    toStat(&w->acc.satellites,
+           (d[METRIC_SATELLITES].len != 0) ? sampleValue(w, d[METRIC_SATELLITES].pos[d[METRIC_SATELLITES].head], METRIC_SATELLITES) : 0.0f,
+           (e[METRIC_SATELLITES].len != 0) ? sampleValue(w, e[METRIC_SATELLITES].pos[e[METRIC_SATELLITES].head], METRIC_SATELLITES) : 0.0f,
+           &snapshot.satellites);
+    snapshot.startMs = w->sample[w->first].timeMs;
+    snapshot.endMs = timeMs;
+    snapshot.evicted = w->evicted;
+    publish(rx, NMEA_WINDOW_SLIDING, &snapshot);
+    return true;
+}
+
+/**
+ * @brief nmea_window_snapshot function copies the latest published snapshot of a window without blocking the parser
+ * @param receiver is the receiver
+ * @param kind is the window
+ * @param snapshot holds the snapshot
+ * @return bool is true if a snapshot was copied (false if the window has no fixes yet or the parser kept publishing)
+ */
+bool nmea_window_snapshot(int receiver, nmea_WindowKind_t kind, nmea_WindowSnapshot_t *snapshot)
+{
+    if (receiver < 0 || receiver >= CONFIG_GGA_WINDOW_RECEIVERS || kind >= NMEA_WINDOW_COUNT) {
+        return false;
+    }
+    receiver_t *rx = &s_receivers[receiver];
+    for (int attempt = 0; attempt < READ_RETRIES; attempt++) {
+        unsigned int before = atomic_load_explicit(&rx->seq[kind], memory_order_acquire);
+        if (before == 0) {
+            return false;
+        }
+        if (before & 1u) {
+            continue;
+        }
+        *snapshot = rx->published[kind];
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&rx->seq[kind], memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief nmea_window_print function prints the snapshots of every window of a receiver to console
+ * @param receiver is the receiver
+ * @return void
+ */
+void nmea_window_print(int receiver)
+{
+    nmea_WindowSnapshot_t s;
+    for (int k = 0; k < NMEA_WINDOW_COUNT; k++) {
+        if (!nmea_window_snapshot(receiver, (nmea_WindowKind_t) k, &s)) {
+            printf("WARNING: %s window of receiver %d has no snapshot!\n", s_windowNames[k], receiver);
+            continue;
+        }
+        printf("%s WINDOW %llu-%llu ms---> %lu fixes\n", s_windowNames[k], (unsigned long long) s.startMs,
+               (unsigned long long) s.endMs, (unsigned long) s.fixes);
+        printf("    HDOP (MEAN/MIN/MAX)-------------> %.2f/%.2f/%.2f\n", s.hdop.mean, s.hdop.min, s.hdop.max);
+        printf("    SATELLITES (MEAN/MIN/MAX)-------> %.2f/%.0f/%.0f\n", s.satellites.mean, s.satellites.min, s.satellites.max);
+        printf("    POSITION VARIANCE (N/E m^2)-----> %.4f/%.4f\n", s.northVarM2, s.eastVarM2);
+        printf("    QUALITY (0-8)-------------------> ");
+        for (int q = 0; q <= MAX_QI_VAL; q++) {
+            printf("%lu%s", (unsigned long) s.quality[q], (q < MAX_QI_VAL) ? " " : "\n");
+        }
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * @brief Incremental windowed aggregates of the fix stream per receiver.
+ * -Every receiver has two tumbling windows (CONFIG_GGA_WINDOW_SHORT_MS and CONFIG_GGA_WINDOW_LONG_MS, e.g. per second
+ * -and per minute) and one sliding window (the last CONFIG_GGA_WINDOW_SLIDING_MS). A fix updates all of them in O(1):
+ * -mean and variance with Welford's method (removal included for the sliding window), min/max of the tumbling windows
+ * -directly and of the sliding window with monotonic deques, and the fix-quality distribution with counters. Positions
+ * -are aggregated as north/east offsets in metres from the first fix of the receiver. The memory is static and bounded
+ * -(CONFIG_GGA_WINDOW_RECEIVERS receivers, CONFIG_GGA_WINDOW_SLIDING_SAMPLES fixes in the sliding window).
+ * -Snapshots are published through a seqlock: the parser never waits for a reader, a reader copies again when the
+ * -parser has published meanwhile.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "gga_parser.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Defaults when the sdkconfig options are not available (host builds outside of ESP-IDF)
+#ifndef CONFIG_GGA_WINDOW_RECEIVERS
+#define CONFIG_GGA_WINDOW_RECEIVERS 2
+#endif
+#ifndef CONFIG_GGA_WINDOW_SHORT_MS
+#define CONFIG_GGA_WINDOW_SHORT_MS 1000
+#endif
+#ifndef CONFIG_GGA_WINDOW_LONG_MS
+#define CONFIG_GGA_WINDOW_LONG_MS 60000
+#endif
+#ifndef CONFIG_GGA_WINDOW_SLIDING_MS
+#define CONFIG_GGA_WINDOW_SLIDING_MS 10000
+#endif
+#ifndef CONFIG_GGA_WINDOW_SLIDING_SAMPLES
+#define CONFIG_GGA_WINDOW_SLIDING_SAMPLES 128
+#endif
+
+/**
+ * @brief Windows of every receiver
+ */
+typedef enum {
+    NMEA_WINDOW_SHORT = 0,              //tumbling, CONFIG_GGA_WINDOW_SHORT_MS (last completed window)
+    NMEA_WINDOW_LONG,                   //tumbling, CONFIG_GGA_WINDOW_LONG_MS (last completed window)
+    NMEA_WINDOW_SLIDING,                //sliding, the last CONFIG_GGA_WINDOW_SLIDING_MS up to the latest fix
+    NMEA_WINDOW_COUNT
+} nmea_WindowKind_t;
+
+/**
+ * @brief Mean/min/max of one value, count is the number of fixes in which the field was correct
+ */
+typedef struct {
+    uint32_t count;
+    float mean;
+    float min;
+    float max;
+} nmea_WindowStat_t;
+
+/**
+ * @brief Snapshot of one window
+ */
+typedef struct {
+    uint64_t startMs;                   //tumbling: start of the window, sliding: time of the oldest fix
+    uint64_t endMs;                     //tumbling: end of the window (excluded), sliding: time of the latest fix
+    uint32_t fixes;                     //fixes in the window
+    nmea_WindowStat_t hdop;
+    nmea_WindowStat_t satellites;
+    uint32_t quality[MAX_QI_VAL + 1];   //fixes per quality indicator
+    uint32_t positions;                 //fixes with a correct position
+    double northVarM2;                  //variance of the position in north direction (m^2)
+    double eastVarM2;                   //variance of the position in east direction (m^2)
+    uint64_t evicted;                   //sliding: fixes which left the window early because it was full
+} nmea_WindowSnapshot_t;
+
+/**
+ * @brief nmea_window_init function resets every receiver and window, call it before the first fix
+ * @param void
+ * @return void
+ */
+void nmea_window_init(void);
+
+/**
+ * @brief nmea_window_add function adds a fix to every window of a receiver, one task at a time per receiver
+ * @param receiver is the receiver (0 to CONFIG_GGA_WINDOW_RECEIVERS - 1)
+ * @param timeMs is the monotonic time of the fix in ms
+ * @param fix is the parse result, only its correct fields are aggregated
+ * @return bool is false if the receiver is out of range
+ */
+bool nmea_window_add(int , uint64_t , const nmea_ParseResult_t* );
+
+/**
+ * @brief nmea_window_snapshot function copies the latest published snapshot of a window without blocking the parser
+ * @param receiver is the receiver
+ * @param kind is the window
+ * @param snapshot holds the snapshot
+ * @return bool is true if a snapshot was copied (false if the window has no fixes yet or the parser kept publishing)
+ */
+bool nmea_window_snapshot(int , nmea_WindowKind_t , nmea_WindowSnapshot_t* );
+
+/**
+ * @brief nmea_window_print function prints the snapshots of every window of a receiver to console
+ * @param receiver is the receiver
+ * @return void
+ */
+void nmea_window_print(int );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""Flash, RAM and worst-case stack footprint of the GGA parser component.
+
+The section sizes of every gga_*.c object are read from the linker map (build/main.map). The stack frames and the
+call graph come from the .su and .ci files written by -fstack-usage and -fcallgraph-info=su
+(CONFIG_GGA_PARSER_STACK_REPORT). The worst-case stack of a function is its own frame plus the deepest chain of
+calls inside the component; library calls, calls through pointers and recursion are flagged, not counted.
+
+    cmake --build build --target gga_footprint
+    python tools/gga_footprint.py --map build/main.map --stack-dir build/esp-idf/main --sdkconfig build/config/sdkconfig.h
+"""
+
+import argparse
+import fnmatch
+import os
+import re
+import sys
+
+#Output sections by memory: (category, substrings of the output section name)
+CATEGORIES = [
+    ('iram', ('iram',)),
+    ('bss', ('bss',)),
+    ('data', ('.dram0.data', '.data')),
+    ('rodata', ('rodata',)),
+    ('code', ('.flash.text', '.text')),
+]
+IGNORED = ('.debug', '.comment', '.xt.', '.xtensa', '.note', '.stab', '.gnu', '.ARM', '.riscv')
+
+INPUT_RE = re.compile(r'^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+INPUT_NAME_RE = re.compile(r'^ (\S+)$')
+INPUT_CONT_RE = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+OUTPUT_RE = re.compile(r'^(\S+)')
+MEMBER_RE = re.compile(r'\(([^()]+)\)$')
+NODE_RE = re.compile(r'node:\s*\{\s*title:\s*"([^"]+)"\s*label:\s*"([^"]*)"')
+EDGE_RE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]+)"\s*targetname:\s*"([^"]+)"')
+FRAME_RE = re.compile(r'(\d+) bytes \(([^)]+)\)')
+
+
+def module_of(obj):
+    """Source file name of an object e.g., 'libmain.a(gga_parser.c.obj)' -> 'gga_parser.c'"""
+    member = MEMBER_RE.search(obj)
+    name = os.path.basename(member.group(1) if member else obj)
+    for ext in ('.obj', '.o'):
+        if name.endswith(ext):
+            name = name[:-len(ext)]
+    return name
+
+
+def category_of(output):
+    if output.startswith(IGNORED):
+        return None
+    for category, keys in CATEGORIES:
+        if any(key in output for key in keys):
+            return category
+    return 'other'
+
+
+def read_map(path, pattern):
+    """Bytes per module and category of the objects matching the pattern"""
+    sizes = {}
+    output = None
+    pending = None
+    started = False
+    with open(path, errors='replace') as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if not started:
+                started = line.startswith('Linker script and memory map')
+                continue
+            if pending is not None:
+                cont = INPUT_CONT_RE.match(line)
+                if cont:
+                    add_input(sizes, output, pending, int(cont.group(2), 16), cont.group(3), pattern)
+                pending = None
+                continue
+            if line.startswith(' ') and output is not None:
+                full = INPUT_RE.match(line)
+                if full:
+                    add_input(sizes, output, full.group(1), int(full.group(3), 16), full.group(4), pattern)
+                    continue
+                name = INPUT_NAME_RE.match(line)
+                if name and not name.group(1).startswith('*'):
+                    pending = name.group(1)
+                continue
+            head = OUTPUT_RE.match(line)
+            if head:
+                output = head.group(1)
+    if not started:
+        sys.exit('ERROR: %s is not a GNU ld map file!' % path)
+    return sizes
+
+
+def add_input(sizes, output, section, size, obj, pattern):
+    category = category_of(output)
+    module = module_of(obj.split()[0] if obj.startswith('0x') else obj)
+    if category is None or size == 0 or not fnmatch.fnmatch(module, pattern):
+        return
+    per_module = sizes.setdefault(module, {})
+    per_module[category] = per_module.get(category, 0) + size
+
+
+def read_call_graph(stack_dir, pattern):
+    """Frames and callees of every function from the .ci files, the .su files when there is no call graph"""
+    frames = {}
+    qualifiers = {}
+    edges = {}
+    for root, _, names in os.walk(stack_dir):
+        for name in names:
+            module = name[:-3]
+            if not fnmatch.fnmatch(module, pattern):
+                continue
+            path = os.path.join(root, name)
+            if name.endswith('.ci'):
+                with open(path, errors='replace') as f:
+                    text = f.read()
+                local = {}
+                for title, label in NODE_RE.findall(text):
+                    frame = FRAME_RE.search(label)
+                    if frame:
+                        #The title of a static function holds the path of its file, the label starts with the name
+                        local[title] = module + ':' + label.split('\\n')[0]
+                        frames[local[title]] = int(frame.group(1))
+                        qualifiers[local[title]] = frame.group(2)
+                for source, target in EDGE_RE.findall(text):
+                    if source in local:
+                        edges.setdefault(local[source], []).append(local.get(target, target))
+            elif name.endswith('.su') and not os.path.exists(path[:-3] + '.ci'):
+                with open(path, errors='replace') as f:
+                    for line in f:
+                        parts = line.rstrip('\n').split('\t')
+                        if len(parts) == 3:
+                            key = module + ':' + parts[0].split(':')[-1]
+                            frames[key] = int(parts[1])
+                            qualifiers[key] = parts[2]
+    #Calls to functions of other files of the component are resolved by name
+    by_name = {}
+    for key in frames:
+        by_name.setdefault(key.split(':', 1)[1], []).append(key)
+    for source, targets in edges.items():
+        edges[source] = [t if t in frames else (by_name[t][0] if len(by_name.get(t, [])) == 1 else t) for t in targets]
+    return frames, qualifiers, edges
+
+
+def worst_case(frames, qualifiers, edges):
+    """Worst-case stack and the flags of every function"""
+    result = {}
+
+    def visit(key, path):
+        if key in result:
+            return result[key]
+        if key in path:
+            return 0, {'recursion'}
+        path.add(key)
+        deepest = 0
+        flags = set()
+        if qualifiers.get(key, 'static') != 'static':
+            flags.add(qualifiers[key])
+        for target in edges.get(key, []):
+            if target in frames:
+                depth, sub = visit(target, path)
+                deepest = max(deepest, depth)
+                flags |= sub
+            elif target == '__indirect_call':
+                flags.add('indirect')
+            else:
+                flags.add('library')
+        path.discard(key)
+        result[key] = (frames[key] + deepest, flags)
+        return result[key]
+
+    for key in frames:
+        visit(key, set())
+    return result
+
+
+def read_profile(path):
+    options = []
+    with open(path, errors='replace') as f:
+        for line in f:
+            parts = line.split()
+            if len(parts) >= 3 and parts[0] == '#define' and parts[1].startswith('CONFIG_GGA_PARSER_'):
+                options.append('%s=%s' % (parts[1][len('CONFIG_'):], ' '.join(parts[2:])))
+    return options
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--map', help='linker map file e.g., build/main.map')
+    parser.add_argument('--stack-dir', help='directory searched for the .su and .ci files')
+    parser.add_argument('--sdkconfig', help='sdkconfig.h of the build, prints the parser profile')
+    parser.add_argument('--objects', default='gga_*', help='source files of the component (default gga_*)')
+    parser.add_argument('--top', type=int, default=25, help='functions in the stack report (0 for all)')
+    args = parser.parse_args()
+
+    profile = read_profile(args.sdkconfig) if args.sdkconfig and os.path.exists(args.sdkconfig) else []
+    if profile:
+        print('PROFILE: ' + ', '.join(profile))
+
+    if args.map:
+        if not os.path.exists(args.map):
+            sys.exit('ERROR: %s NOT found, build the app first!' % args.map)
+        sizes = read_map(args.map, args.objects)
+        columns = ['code', 'iram', 'rodata', 'data', 'bss', 'other']
+        print('\n%-20s %8s %8s %8s %8s %8s %8s %9s %8s' % ('MODULE', 'CODE', 'IRAM', 'RODATA', 'DATA', 'BSS', 'OTHER', 'FLASH', 'RAM'))
+        totals = dict.fromkeys(columns, 0)
+        for module in sorted(sizes):
+            row = [sizes[module].get(c, 0) for c in columns]
+            for c, v in zip(columns, row):
+                totals[c] += v
+            print('%-20s %8d %8d %8d %8d %8d %8d %9d %8d' % ((module,) + tuple(row) + flash_ram(sizes[module])))
+        print('%-20s %8d %8d %8d %8d %8d %8d %9d %8d' % (('TOTAL',) + tuple(totals[c] for c in columns) + flash_ram(totals)))
+
+    if args.stack_dir:
+        frames, qualifiers, edges = read_call_graph(args.stack_dir, args.objects)
+        if not frames:
+            print('\nNo stack usage found, enable CONFIG_GGA_PARSER_STACK_REPORT and build again.')
+            return
+        result = worst_case(frames, qualifiers, edges)
+        ranked = sorted(result.items(), key=lambda item: (-item[1][0], item[0]))
+        if args.top:
+            ranked = ranked[:args.top]
+        print('\n%-44s %8s %8s  %s' % ('FUNCTION', 'FRAME', 'WORST', 'NOT COUNTED'))
+        for key, (worst, flags) in ranked:
+            print('%-44s %8d %8d  %s' % (key, frames[key], worst, ', '.join(sorted(flags))))
+
+
+def flash_ram(size):
+    """Flash image (code, IRAM and initialized data are loaded from flash) and RAM (IRAM, data and bss)"""
+    flash = size.get('code', 0) + size.get('iram', 0) + size.get('rodata', 0) + size.get('data', 0)
+    ram = size.get('iram', 0) + size.get('data', 0) + size.get('bss', 0)
+    return flash, ram
+
+
+if __name__ == '__main__':
+    main()